@@ -441,7 +441,12 @@ TensorView* unaryOp(
 }
 
 // TENSOR FACTORIES
-TensorView* rand(const std::vector<Val*>& shape, DataType dtype) {
+namespace {
+
+TensorView* randomTensor(
+    RNGOpType type,
+    const std::vector<Val*>& shape,
+    DataType dtype) {
   auto n = shape.size();
   auto out = TensorViewBuilder()
                  .ndims(n)
@@ -449,10 +454,33 @@ TensorView* rand(const std::vector<Val*>& shape, DataType dtype) {
                  .contiguity(std::vector<bool>(n, true))
                  .shape(shape)
                  .build();
-  IrBuilder::create<RNGOp>(RNGOpType::Uniform, out);
+  IrBuilder::create<RNGOp>(type, out);
   return out;
 }
 
+std::vector<Val*> randomLikeShape(TensorView* v) {
+  TORCH_CHECK(
+      isFloatingPointType(v->dtype()),
+      "input must have floating point type, but got ",
+      v->dtype());
+  std::vector<Val*> shape;
+  shape.reserve(v->getMaybeRFactorDomain().size());
+  for (auto id : v->getMaybeRFactorDomain()) {
+    shape.emplace_back(id->getMaybeExpandedExtent());
+  }
+  return shape;
+}
+
+} // namespace
+
+TensorView* rand(const std::vector<Val*>& shape, DataType dtype) {
+  return randomTensor(RNGOpType::Uniform, shape, dtype);
+}
+
+TensorView* randn(const std::vector<Val*>& shape, DataType dtype) {
+  return randomTensor(RNGOpType::Normal, shape, dtype);
+}
+
 TensorView* arange(Val* end, DataType dtype) {
   return arange(FusionGuard::getCurFusion()->zeroVal(), end, dtype);
 }
@@ -505,22 +533,21 @@ NVFUSER_DEFINE_UNARY_OP(print, Print)
 #undef NVFUSER_DEFINE_UNARY_OP
 
 TensorView* randlike(TensorView* v) {
-  TORCH_CHECK(
-      isFloatingPointType(v->dtype()),
-      "input must have floating point type, but got ",
-      v->dtype());
-  std::vector<Val*> shape;
-  shape.reserve(v->getMaybeRFactorDomain().size());
-  for (auto id : v->getMaybeRFactorDomain()) {
-    shape.emplace_back(id->getMaybeExpandedExtent());
-  }
-  return rand(shape, v->dtype());
+  return rand(randomLikeShape(v), v->dtype());
 }
 
 Val* randlike(Val* v) {
   return randlike(v->as<TensorView>());
 }
 
+TensorView* randnlike(TensorView* v) {
+  return randn(randomLikeShape(v), v->dtype());
+}
+
+Val* randnlike(Val* v) {
+  return randnlike(v->as<TensorView>());
+}
+
 Val* bitwise_not(Val* v) {
   TORCH_CHECK(
       isIntegralType(v->dtype()) || v->dtype() == DataType::Bool,
@@ -0,0 +1,77 @@
+#include <third_party/nvfuser/arith.h>
+#include <third_party/nvfuser/fusion.h>
+#include <third_party/nvfuser/ir_builder.h>
+#include <third_party/nvfuser/kernel_cache.h>
+#include <third_party/nvfuser/ops/all_ops.h>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <vector>
+
+using namespace torch::jit::fuser::cuda;
+
+namespace {
+
+std::unique_ptr<FusionExecutorCache> makeBatchedFusion() {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = TensorViewBuilder().ndims(2).build();
+  fusion->addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Double>(1.0));
+  auto tv2 = sum(tv1, {1});
+  fusion->addOutput(tv2);
+  return std::make_unique<FusionExecutorCache>(std::move(fusion));
+}
+
+} // namespace
+
+// Host time of running range(0) input sets one by one, with kernel launch
+// disabled, see [ Note -- Batched Executions ]
+static void NvFuserScheduler_BatchedHostOverhead_OneByOne(
+    benchmark::State& benchmark_state) {
+  auto fec = makeBatchedFusion();
+  at::Tensor t0 = at::randn(
+      {128, 64}, at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0));
+  std::vector<std::vector<c10::IValue>> input_sets(
+      benchmark_state.range(0), {t0});
+  fec->runFusionWithInputs(input_sets.front());
+  fec->disableKernelLaunch();
+
+  for (auto _ : benchmark_state) {
+    for (const auto& inputs : input_sets) {
+      fec->runFusionWithInputs(inputs);
+    }
+  }
+  benchmark_state.SetItemsProcessed(
+      benchmark_state.iterations() * input_sets.size());
+}
+
+// Host time of running range(0) input sets as one batch, with kernel launch
+// disabled
+static void NvFuserScheduler_BatchedHostOverhead_Batched(
+    benchmark::State& benchmark_state) {
+  auto fec = makeBatchedFusion();
+  at::Tensor t0 = at::randn(
+      {128, 64}, at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0));
+  std::vector<std::vector<c10::IValue>> input_sets(
+      benchmark_state.range(0), {t0});
+  fec->runFusionWithInputsBatch(input_sets);
+  fec->disableKernelLaunch();
+
+  for (auto _ : benchmark_state) {
+    fec->runFusionWithInputsBatch(input_sets);
+  }
+  benchmark_state.SetItemsProcessed(
+      benchmark_state.iterations() * input_sets.size());
+}
+
+BENCHMARK(NvFuserScheduler_BatchedHostOverhead_OneByOne)
+    ->RangeMultiplier(4)
+    ->Range(1, 64)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(NvFuserScheduler_BatchedHostOverhead_Batched)
+    ->RangeMultiplier(4)
+    ->Range(1, 64)
+    ->Unit(benchmark::kMicrosecond);
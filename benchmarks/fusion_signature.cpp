@@ -0,0 +1,70 @@
+#include <third_party/nvfuser/arith.h>
+#include <third_party/nvfuser/fusion.h>
+#include <third_party/nvfuser/fusion_signature.h>
+#include <third_party/nvfuser/ir_builder.h>
+#include <third_party/nvfuser/ops/all_ops.h>
+
+#include <benchmark/benchmark.h>
+
+#include <c10/util/irange.h>
+
+#include <iostream>
+#include <sstream>
+
+using namespace torch::jit::fuser::cuda;
+
+namespace {
+
+//! A long chain of pointwise ops with a normalization every 50 ops
+void setupLongFusion(Fusion* fusion, int64_t num_ops) {
+  FusionGuard fg(fusion);
+  auto tv0 = TensorViewBuilder().ndims(3).build();
+  fusion->addInput(tv0);
+  TensorView* tv = tv0;
+  for (const auto i : c10::irange(num_ops)) {
+    tv = add(tv, IrBuilder::create<Double>((double)i));
+    if (i % 50 == 49) {
+      tv = broadcast(sum(tv, {2}), {false, false, true});
+    }
+  }
+  fusion->addOutput(tv);
+}
+
+} // namespace
+
+// Host cost of signing a fusion, see Note [Fusion Signature]
+static void NvFuserScheduler_FusionSignature(
+    benchmark::State& benchmark_state) {
+  Fusion fusion;
+  setupLongFusion(&fusion, benchmark_state.range(0));
+
+  for (auto _ : benchmark_state) {
+    benchmark::DoNotOptimize(structuralHash(&fusion));
+  }
+}
+
+// Host cost of printing the fusion math, which the signature replaced as a
+// cache key
+static void NvFuserScheduler_FusionPrintMath(
+    benchmark::State& benchmark_state) {
+  Fusion fusion;
+  setupLongFusion(&fusion, benchmark_state.range(0));
+
+  for (auto _ : benchmark_state) {
+    std::stringstream math;
+    auto cout_buf = std::cout.rdbuf(math.rdbuf());
+    fusion.printMath();
+    std::cout.rdbuf(cout_buf);
+    benchmark::DoNotOptimize(math.str());
+  }
+}
+
+BENCHMARK(NvFuserScheduler_FusionSignature)
+    ->RangeMultiplier(4)
+    ->Range(50, 800)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(NvFuserScheduler_FusionPrintMath)
+    ->RangeMultiplier(4)
+    ->Range(50, 800)
+    ->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,74 @@
+#include <third_party/nvfuser/arith.h>
+#include <third_party/nvfuser/fusion.h>
+#include <third_party/nvfuser/ir_builder.h>
+#include <third_party/nvfuser/kernel_cache.h>
+#include <third_party/nvfuser/ops/all_ops.h>
+
+#include <benchmark/benchmark.h>
+
+#include <c10/util/irange.h>
+
+#include <memory>
+#include <vector>
+
+using namespace torch::jit::fuser::cuda;
+
+namespace {
+
+constexpr int kMaxThreads = 8;
+
+//! One FusionExecutorCache per thread, each compiled and then switched to
+//!  skip kernel launches, so that only host time is measured
+std::vector<std::unique_ptr<FusionExecutorCache>>& throughputCaches(
+    const at::Tensor& t0) {
+  static std::vector<std::unique_ptr<FusionExecutorCache>> caches = [&]() {
+    std::vector<std::unique_ptr<FusionExecutorCache>> caches;
+    for (const auto i : c10::irange(kMaxThreads)) {
+      auto fusion = std::make_unique<Fusion>();
+      FusionGuard fg(fusion.get());
+      auto tv0 = TensorViewBuilder().ndims(2).build();
+      fusion->addInput(tv0);
+      auto tv1 = add(tv0, IrBuilder::create<Double>((double)i));
+      auto tv2 = sum(tv1, {1});
+      fusion->addOutput(tv2);
+      caches.emplace_back(
+          std::make_unique<FusionExecutorCache>(std::move(fusion)));
+      caches.back()->runFusionWithInputs({t0});
+      caches.back()->disableKernelLaunch();
+    }
+    return caches;
+  }();
+  return caches;
+}
+
+at::Tensor throughputInput() {
+  static at::Tensor t0 = at::randn(
+      {128, 64}, at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0));
+  return t0;
+}
+
+} // namespace
+
+// Host throughput of running fusions from multiple threads with kernel launch
+// disabled. With range(0) set, every thread runs its own cache, which should
+// scale with the number of threads as only runs of the same
+// FusionExecutorCache are serialized. Otherwise all threads share one cache.
+static void NvFuserScheduler_HostThroughput(benchmark::State& benchmark_state) {
+  auto t0 = throughputInput();
+  auto& caches = throughputCaches(t0);
+  bool independent = benchmark_state.range(0) != 0;
+  auto fec = caches[independent ? benchmark_state.thread_index() : 0].get();
+
+  for (auto _ : benchmark_state) {
+    fec->runFusionWithInputs({t0});
+  }
+  benchmark_state.SetItemsProcessed(benchmark_state.iterations());
+}
+
+BENCHMARK(NvFuserScheduler_HostThroughput)
+    ->ArgName("independent_caches")
+    ->Arg(0)
+    ->Arg(1)
+    ->ThreadRange(1, kMaxThreads)
+    ->UseRealTime()
+    ->Unit(benchmark::kMicrosecond);
@@ -146,6 +146,88 @@ class ExprFinder : kir::ConstIrVisitor {
   bool is_found_ = false;
 };
 
+// Note [Chunked Welford]
+//
+// A serial WelfordOp updates its average, M2 and count once per input
+// value, with a division in each update. When the reduction loop around it
+// is unrolled, e.g. over the vectorized or persistent elements of a layer
+// norm, the values of the loop are instead collected into a local chunk
+// and merged with welfordChunkCombine after the loop. The chunk is reduced
+// with a two-pass local mean, i.e. a sum and a sum of squared deviations,
+// and merged with Chan's formula by a single welfordCombine, so a chunk
+// costs one division instead of one per value.
+//
+// Values the loop predicates out are flagged invalid in the chunk and
+// skipped. Unswitched loops have no such predicates, so the flags fold away.
+//
+// Can be disabled with PYTORCH_NVFUSER_DISABLE=chunked_welford.
+
+//! Largest unrolled loop collected into a welford chunk
+constexpr int64_t kMaxWelfordChunkSize = 16;
+
+//! Collects the WelfordOps of exprs, looking through predicates but not
+//! loops. Returns false if a nested loop contains a WelfordOp.
+bool collectChunkWelfords(
+    const std::vector<Expr*>& exprs,
+    std::vector<const WelfordOp*>& welford_ops) {
+  for (auto expr : exprs) {
+    if (auto wop = dynamic_cast<const WelfordOp*>(expr)) {
+      welford_ops.push_back(wop);
+    } else if (auto ite = dynamic_cast<const kir::IfThenElse*>(expr)) {
+      if (!collectChunkWelfords(ite->thenBody().exprs(), welford_ops) ||
+          !collectChunkWelfords(ite->elseBody().exprs(), welford_ops)) {
+        return false;
+      }
+    } else if (
+        expr->isA<kir::ForLoop>() &&
+        ExprFinder::exists(expr, {ExprType::WelfordOp})) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Returns the serial WelfordOp reducing over an unrolled loop if the loop
+//! can be merged as a chunk, see Note [Chunked Welford]
+const WelfordOp* getChunkedWelford(const kir::ForLoop* loop) {
+  if (isOptionDisabled(DisableOption::ChunkedWelford) ||
+      !loop->iter_domain()->isReduction() || !loop->isUnrolled() ||
+      !loop->start()->isZeroInt() || !loop->step()->isOneInt() ||
+      !loop->stop()->isConstInt()) {
+    return nullptr;
+  }
+
+  const auto chunk_size = loop->stop()->getInt().value();
+  if (chunk_size < 2 || chunk_size > kMaxWelfordChunkSize) {
+    return nullptr;
+  }
+
+  std::vector<const WelfordOp*> welford_ops;
+  if (!collectChunkWelfords(loop->body().exprs(), welford_ops) ||
+      welford_ops.size() != 1) {
+    return nullptr;
+  }
+
+  // Only plain values, i.e. welfords of a tensor rather than merges of
+  // partial results, are collected
+  const auto wop = welford_ops.front();
+  if (!wop->out()->isA<kir::TensorIndex>() || !wop->inVar()->isZeroInt() ||
+      !wop->inN()->isOneInt()) {
+    return nullptr;
+  }
+
+  const auto out_tv = wop->out()->as<kir::TensorIndex>()->view();
+  const auto data_type = wop->outAvg()->dtype();
+  if (out_tv->getMemoryType() != MemoryType::Local ||
+      out_tv->domain()->hasBlockReduction() ||
+      out_tv->domain()->hasGridReduction() ||
+      (data_type != DataType::Float && data_type != DataType::Double)) {
+    return nullptr;
+  }
+
+  return wop;
+}
+
 class CudaKernelGenerator : private OptOutConstDispatch {
   static constexpr const char* kTab = "  ";
 
@@ -153,8 +235,26 @@ class CudaKernelGenerator : private OptOutConstDispatch {
   static std::string generateKernelDefinition(
       const kir::Kernel* kernel,
       const std::string& kernel_name) {
+    return generateFunctionDefinition(kernel, kernel_name, false);
+  }
+
+  //! Generates the packed kernel of kernels, see Note [Horizontal Fusion]
+  static std::string generateHorizontalKernelDefinition(
+      const std::vector<const kir::Kernel*>& kernels,
+      const std::string& kernel_name);
+
+  //! Generates the batched kernel of kernel, see Note [Batched Fusion]
+  static std::string generateBatchedKernelDefinition(
+      const kir::Kernel* kernel,
+      const std::string& kernel_name);
+
+ private:
+  static std::string generateFunctionDefinition(
+      const kir::Kernel* kernel,
+      const std::string& kernel_name,
+      bool device_function) {
     CudaKernelGenerator codegen(kernel);
-    codegen.genDeclaration(kernel_name);
+    codegen.genDeclaration(kernel_name, device_function);
     codegen.startBlock();
     codegen.genPrologue();
     codegen.genBody();
@@ -163,7 +263,6 @@ class CudaKernelGenerator : private OptOutConstDispatch {
     return codegen.code_.str();
   }
 
- private:
   explicit CudaKernelGenerator(const kir::Kernel* kernel) : kernel_(kernel) {
     initStringStreamFormat(code_);
   }
@@ -174,11 +273,12 @@ class CudaKernelGenerator : private OptOutConstDispatch {
     ss << std::scientific << std::setprecision(digits);
   }
 
-  // Generates the kernel function declaration
-  void genDeclaration(const std::string& kernel_name) {
+  // Returns the type and name of each kernel parameter: the inputs and
+  // outputs, the global buffers and the RNG state
+  std::vector<std::pair<std::string, std::string>> genParameters() {
     const auto& kernel_summary = kernel_->summary();
 
-    code_ << "__global__ void " << kernel_name << "(";
+    std::vector<std::pair<std::string, std::string>> param_decls;
 
     std::unordered_set<Val*> unique_args;
 
@@ -210,25 +310,22 @@ class CudaKernelGenerator : private OptOutConstDispatch {
         var_name_ss << "_duplicate_" << duplicate_counter++;
       }
 
+      std::stringstream type_ss;
       if (const auto tv = dynamic_cast<TensorView*>(params[i])) {
         if (tv->isCpuScalar()) {
-          code_ << " CpuScalarTensor<" << params[i]->dtype() << "> "
-                << var_name_ss.str();
+          type_ss << "CpuScalarTensor<" << params[i]->dtype() << ">";
         } else {
-          code_
+          type_ss
               << "Tensor<" << params[i]->dtype() << ", "
               << TensorDomain::noReductions(tv->getMaybeRFactorDomain()).size()
-              << "> " << var_name_ss.str();
+              << ">";
         }
       } else {
         TORCH_INTERNAL_ASSERT(params[i]->isScalar()); // NOLINT (LLVM bug 48525)
         TORCH_INTERNAL_ASSERT(params[i]->definition() == nullptr);
-        code_ << params[i]->dtype() << " " << var_name_ss.str();
-      }
-
-      if (i + 1 != params.size()) {
-        code_ << ", ";
+        type_ss << params[i]->dtype();
       }
+      param_decls.emplace_back(type_ss.str(), var_name_ss.str());
     }
 
     // Global buffers
@@ -242,13 +339,36 @@ class CudaKernelGenerator : private OptOutConstDispatch {
           maybe_rfactor_domain.begin(),
           maybe_rfactor_domain.end(),
           [](const IterDomain* id) { return !id->isReduction(); });
-      code_ << ", Tensor<" << tv->dtype() << ", " << nDims << "> "
-            << varName(tv);
+      std::stringstream type_ss;
+      type_ss << "Tensor<" << tv->dtype() << ", " << nDims << ">";
+      param_decls.emplace_back(type_ss.str(), varName(tv));
     }
 
     // Kernels generating random numbers take extra (seed, offset) arguments
     if (kernel_summary.max_rng_offsets >= 0) {
-      code_ << ", at::PhiloxCudaState philox_args";
+      param_decls.emplace_back("at::PhiloxCudaState", "philox_args");
+    }
+
+    return param_decls;
+  }
+
+  // Generates the kernel function declaration. A device function instead
+  // takes the block index and grid dimensions as parameters, shadowing the
+  // builtins, see Note [Horizontal Fusion]
+  void genDeclaration(const std::string& kernel_name, bool device_function) {
+    code_ << (device_function ? "__device__" : "__global__") << " void "
+          << kernel_name << "(";
+
+    const auto param_decls = genParameters();
+    for (auto i : c10::irange(param_decls.size())) {
+      if (i > 0) {
+        code_ << ", ";
+      }
+      code_ << param_decls[i].first << " " << param_decls[i].second;
+    }
+
+    if (device_function) {
+      code_ << ", const uint3 blockIdx, const dim3 gridDim";
     }
 
     code_ << ") ";
@@ -1321,6 +1441,16 @@ class CudaKernelGenerator : private OptOutConstDispatch {
 
     // Serial WelfordOp generation
     if (!has_block_reduce && !has_grid_reduce) {
+      // Collect the value into its chunk, see Note [Chunked Welford]
+      if (wop == chunked_welford_) {
+        const auto chunk_index = gen(chunked_welford_loop_->index());
+        indent() << chunked_welford_name_ << "_avg[" << chunk_index
+                 << "] = (" << out_avg->dtype() << ")" << gen(in_avg)
+                 << ";\n";
+        indent() << chunked_welford_name_ << "_valid[" << chunk_index
+                 << "] = true;\n";
+        return;
+      }
       indent() << "welfordCombine ("
                << "\n";
       indent() << kTab << gen(out_avg) << ",\n";
@@ -2413,6 +2543,48 @@ class CudaKernelGenerator : private OptOutConstDispatch {
       return;
     }
 
+    const auto chunked_welford = getChunkedWelford(loop);
+    if (chunked_welford != nullptr) {
+      handleChunkedWelford(loop, chunked_welford);
+      return;
+    }
+
+    genForLoop(loop);
+  }
+
+  //! Collect the values of an unrolled serial welford into a local chunk and
+  //! merge it after the loop, see Note [Chunked Welford]
+  void handleChunkedWelford(const kir::ForLoop* loop, const WelfordOp* wop) {
+    TORCH_INTERNAL_ASSERT(
+        chunked_welford_ == nullptr, "Nested chunked welfords not supported");
+    const auto chunk_size = loop->stop()->getInt().value();
+
+    std::stringstream name;
+    name << "welford_chunk_" << chunked_welford_count_++;
+    chunked_welford_name_ = name.str();
+
+    startBlock();
+    indent() << wop->outAvg()->dtype() << " " << chunked_welford_name_
+             << "_avg[" << chunk_size << "];\n";
+    indent() << "bool " << chunked_welford_name_ << "_valid[" << chunk_size
+             << "] = {};\n";
+
+    chunked_welford_ = wop;
+    chunked_welford_loop_ = loop;
+    genForLoop(loop);
+    chunked_welford_ = nullptr;
+    chunked_welford_loop_ = nullptr;
+
+    indent() << "welfordChunkCombine(\n";
+    indent() << kTab << gen(wop->outAvg()) << ",\n";
+    indent() << kTab << gen(wop->outVar()) << ",\n";
+    indent() << kTab << gen(wop->outN()) << ",\n";
+    indent() << kTab << chunked_welford_name_ << "_avg,\n";
+    indent() << kTab << chunked_welford_name_ << "_valid);\n";
+    endBlock();
+  }
+
+  void genForLoop(const kir::ForLoop* loop) {
     const auto gen_index = gen(loop->index());
     const auto gen_start = genInline(loop->start());
     const auto gen_stop = genInline(loop->stop());
@@ -2660,10 +2832,145 @@ class CudaKernelGenerator : private OptOutConstDispatch {
   std::deque<const kir::ForLoop*> grouped_loops_;
   //! Used to replace symbolic indices with concrete values
   std::unordered_map<const Int*, int64_t> index_replacement_map_;
+  //! Serial welford whose values are collected into a chunk, and the loop
+  //! over the chunk, see Note [Chunked Welford]
+  const WelfordOp* chunked_welford_ = nullptr;
+  const kir::ForLoop* chunked_welford_loop_ = nullptr;
+  std::string chunked_welford_name_;
+  int chunked_welford_count_ = 0;
 };
 
+std::string CudaKernelGenerator::generateHorizontalKernelDefinition(
+    const std::vector<const kir::Kernel*>& kernels,
+    const std::string& kernel_name) {
+  std::stringstream code;
+
+  // Each kernel becomes a device function, taking the wrapper's parameters
+  // prefixed with its index
+  std::vector<std::vector<std::string>> param_names;
+  std::vector<std::string> wrapper_params;
+  for (auto i : c10::irange(kernels.size())) {
+    const auto function_name = kernel_name + "_" + std::to_string(i);
+    code << generateFunctionDefinition(kernels[i], function_name, true) << "\n";
+
+    CudaKernelGenerator codegen(kernels[i]);
+    param_names.emplace_back();
+    for (const auto& param : codegen.genParameters()) {
+      const auto name = "k" + std::to_string(i) + "_" + param.second;
+      param_names.back().push_back(name);
+      wrapper_params.push_back(param.first + " " + name);
+    }
+  }
+
+  // Grid dimensions of each kernel
+  for (auto i : c10::irange(kernels.size())) {
+    for (const char* dim : {"x", "y", "z"}) {
+      wrapper_params.push_back(
+          "int64_t gdim" + std::string(dim) + "_" + std::to_string(i));
+    }
+  }
+
+  code << "__global__ void " << kernel_name << "(";
+  for (auto i : c10::irange(wrapper_params.size())) {
+    code << (i > 0 ? ", " : "") << wrapper_params[i];
+  }
+  code << ") {\n";
+
+  // Blocks are handed out to the kernels in order, linearized over x
+  code << kTab << "unsigned block = blockIdx.x;\n";
+  for (auto i : c10::irange(kernels.size())) {
+    const auto gdimx = "(unsigned)gdimx_" + std::to_string(i);
+    const auto gdimy = "(unsigned)gdimy_" + std::to_string(i);
+    const auto gdimz = "(unsigned)gdimz_" + std::to_string(i);
+    code << kTab << "if (block < " << gdimx << " * " << gdimy << " * " << gdimz
+         << ") {\n";
+    code << kTab << kTab << kernel_name << "_" << i << "(";
+    for (const auto& name : param_names[i]) {
+      code << name << ", ";
+    }
+    code << "uint3{block % " << gdimx << ", block / " << gdimx << " % "
+         << gdimy << ", block / (" << gdimx << " * " << gdimy << ")}, dim3("
+         << gdimx << ", " << gdimy << ", " << gdimz << "));\n";
+    code << kTab << kTab << "return;\n";
+    code << kTab << "}\n";
+    code << kTab << "block -= " << gdimx << " * " << gdimy << " * " << gdimz
+         << ";\n";
+  }
+  code << "}\n";
+
+  return code.str();
+}
+
 } // namespace
 
+std::string CudaKernelGenerator::generateBatchedKernelDefinition(
+    const kir::Kernel* kernel,
+    const std::string& kernel_name) {
+  std::stringstream code;
+
+  // The kernel runs on a single chunk as a device function
+  const auto chunk_function_name = kernel_name + "_chunk";
+  code << generateFunctionDefinition(kernel, chunk_function_name, true)
+       << "\n";
+
+  CudaKernelGenerator codegen(kernel);
+  const auto params = codegen.genParameters();
+  std::vector<Val*> vals(kernel->inputs().begin(), kernel->inputs().end());
+  vals.insert(vals.end(), kernel->outputs().begin(), kernel->outputs().end());
+  TORCH_CHECK(
+      params.size() == vals.size(),
+      "Batched kernels can't have global buffers or random numbers");
+
+  // Scalars are shared by all chunks, tensors are read from the table
+  code << "__global__ void " << kernel_name
+       << "(Tensor<int64_t, 1> table, int64_t num_chunks, int64_t chunk_size";
+  int64_t num_tensors = 0;
+  for (auto i : c10::irange(vals.size())) {
+    if (auto tv = dynamic_cast<TensorView*>(vals[i])) {
+      TORCH_CHECK(
+          !tv->isCpuScalar() &&
+              TensorDomain::noReductions(tv->getMaybeRFactorDomain()).size() ==
+                  1,
+          "Batched kernels only take 1D tensors, found: ",
+          tv->toString());
+      num_tensors++;
+    } else {
+      code << ", " << params[i].first << " " << params[i].second;
+    }
+  }
+  code << ") {\n";
+
+  code << kTab << "const int64_t* chunk = table.data + blockIdx.x * 2;\n";
+  code << kTab << "const int64_t* tensor_set = table.data + num_chunks * 2 + "
+       << "chunk[0] * " << num_tensors + 1 << ";\n";
+  code << kTab << "const nvfuser_index_t chunk_start = chunk[1];\n";
+  code << kTab << "const nvfuser_index_t chunk_numel = "
+       << "tensor_set[0] - chunk_start < chunk_size ? "
+       << "tensor_set[0] - chunk_start : chunk_size;\n";
+
+  int64_t tensor_i = 0;
+  for (auto i : c10::irange(vals.size())) {
+    if (!vals[i]->isA<TensorView>()) {
+      continue;
+    }
+    const auto& name = params[i].second;
+    code << kTab << params[i].first << " " << name << ";\n";
+    code << kTab << name << ".data = reinterpret_cast<" << vals[i]->dtype()
+         << "*>(tensor_set[" << ++tensor_i << "]) + chunk_start;\n";
+    code << kTab << name << ".size[0] = chunk_numel;\n";
+    code << kTab << name << ".stride[0] = 1;\n";
+  }
+
+  code << kTab << chunk_function_name << "(";
+  for (const auto& param : params) {
+    code << param.second << ", ";
+  }
+  code << "uint3{0, 0, 0}, dim3(1, 1, 1));\n";
+  code << "}\n";
+
+  return code.str();
+}
+
 std::string generateCudaKernel(
     const kir::Kernel* kernel,
     const std::string& kernel_name) {
@@ -2671,6 +2978,22 @@ std::string generateCudaKernel(
   return CudaKernelGenerator::generateKernelDefinition(kernel, kernel_name);
 }
 
+std::string generateHorizontalCudaKernel(
+    const std::vector<const kir::Kernel*>& kernels,
+    const std::string& kernel_name) {
+  FUSER_PERF_SCOPE("generateHorizontalCudaKernel");
+  return CudaKernelGenerator::generateHorizontalKernelDefinition(
+      kernels, kernel_name);
+}
+
+std::string generateBatchedCudaKernel(
+    const kir::Kernel* kernel,
+    const std::string& kernel_name) {
+  FUSER_PERF_SCOPE("generateBatchedCudaKernel");
+  return CudaKernelGenerator::generateBatchedKernelDefinition(
+      kernel, kernel_name);
+}
+
 } // namespace codegen
 } // namespace cuda
 } // namespace fuser
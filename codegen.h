@@ -4,6 +4,7 @@
 #include <third_party/nvfuser/kernel.h>
 
 #include <string>
+#include <vector>
 
 namespace torch {
 namespace jit {
@@ -16,6 +17,18 @@ TORCH_CUDA_CU_API std::string generateCudaKernel(
     const kir::Kernel* kernel,
     const std::string& kernel_name = "CUDAGeneratedKernel");
 
+//! Generates a single CUDA kernel running each of the given kernels on its
+//!  own range of blocks, see Note [Horizontal Fusion]
+TORCH_CUDA_CU_API std::string generateHorizontalCudaKernel(
+    const std::vector<const kir::Kernel*>& kernels,
+    const std::string& kernel_name);
+
+//! Generates a CUDA kernel running the given kernel on each chunk of a
+//!  table of tensors, see Note [Batched Fusion]
+TORCH_CUDA_CU_API std::string generateBatchedCudaKernel(
+    const kir::Kernel* kernel,
+    const std::string& kernel_name);
+
 } // namespace codegen
 } // namespace cuda
 } // namespace fuser
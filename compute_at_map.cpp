@@ -1,6 +1,7 @@
 #include <third_party/nvfuser/compute_at_map.h>
 
 #include <third_party/nvfuser/disjoint_set.h>
+#include <third_party/nvfuser/instrumentation.h>
 #include <third_party/nvfuser/ir_utils.h>
 #include <third_party/nvfuser/lower2device.h>
 #include <third_party/nvfuser/root_domain_map.h>
@@ -44,9 +45,7 @@ IterDomainGraph::IterDomainGraph(Fusion* fusion) {
 //!   Exact mapping based index hoisting of swizzled iterdomains
 //!   is disabled currently and will be re-enabled in the next
 //!   few build out steps.
-void mapMaybeSwizzleOp(
-    DisjointSets<IterDomain*>& disjoint_sets,
-    IterDomain* id) {
+void mapMaybeSwizzleOp(UnionFind<IterDomain*>& disjoint_sets, IterDomain* id) {
   if (auto swizzle_2d = dynamic_cast<Swizzle2D*>(id->definition())) {
     // Map each input to its corresponding output on the given
     //  disjoint set.
@@ -101,7 +100,7 @@ bool IterDomainGraph::exprsMap(Expr* first, Expr* second, bool forward) {
             zipped_ids.begin(),
             zipped_ids.end(),
             [&](std::pair<IterDomain*, IterDomain*> id_pair) {
-              return !exact_nodes_.strictAreMapped(
+              return !exact_uf_.strictAreMapped(
                   id_pair.first, id_pair.second);
             })) {
       return false;
@@ -168,12 +167,13 @@ void IterDomainGraph::mapThroughExpr(Expr* first, Expr* second, bool forward) {
       "\nand\n",
       second->toString());
   for (auto out_i : c10::irange(first_ids.size())) {
-    exact_nodes_.mapEntries(first_ids[out_i], second_ids[out_i]);
-    permissive_nodes_.mapEntries(first_ids[out_i], second_ids[out_i]);
+    exact_uf_.mapEntries(first_ids[out_i], second_ids[out_i]);
+    permissive_uf_.mapEntries(first_ids[out_i], second_ids[out_i]);
   }
 }
 
 void IterDomainGraph::build(Fusion* fusion) {
+  FUSER_PERF_SCOPE("IterDomainGraph::build");
   FusionGuard fg(fusion);
 
   // Initialize a node for every iteration domain
@@ -267,12 +267,12 @@ void IterDomainGraph::build(Fusion* fusion) {
           auto c_id = entry.first;
           auto f_id = entry.second;
           // Map the id's together
-          permissive_nodes_.mapEntries(f_id, c_id);
-          exact_nodes_.mapEntries(f_id, c_id);
+          permissive_uf_.mapEntries(f_id, c_id);
+          exact_uf_.mapEntries(f_id, c_id);
           if (idIsALeafDomain(f_id, first_output_tv)) {
-            loop_nodes_.mapEntries(f_id, c_id);
+            loop_uf_.mapEntries(f_id, c_id);
           }
-          sibling_sets_.mapEntries(f_id, c_id);
+          sibling_uf_.mapEntries(f_id, c_id);
         }
       }
 
@@ -319,22 +319,22 @@ void IterDomainGraph::build(Fusion* fusion) {
         for (auto entry : exact_c2p_map) {
           auto c_id = entry.first;
           auto p_id = entry.second;
-          exact_nodes_.mapEntries(c_id, p_id);
+          exact_uf_.mapEntries(c_id, p_id);
           consumers_.at(p_id).pushBack(c_id);
           producers_.at(c_id).pushBack(p_id);
 
           // Add the swizzle inputs to the same
           //  disjoint set as well if either c_id
           //  or p_id is swizzle output.
-          mapMaybeSwizzleOp(exact_nodes_, p_id);
-          mapMaybeSwizzleOp(exact_nodes_, c_id);
+          mapMaybeSwizzleOp(exact_uf_, p_id);
+          mapMaybeSwizzleOp(exact_uf_, c_id);
         }
 
         for (auto entry : permissive_c2p_map) {
           auto c_id = entry.first;
           auto p_id = entry.second;
           if (idIsAComputeAtLeafDomain(p_id, p_tv)) {
-            loop_nodes_.mapEntries(c_id, p_id);
+            loop_uf_.mapEntries(c_id, p_id);
           } else {
             // When there are trivial reductions merged with other dims, `p_id`
             // might not be a compute at leaf domain of `p_tv`, but it actually
@@ -343,19 +343,19 @@ void IterDomainGraph::build(Fusion* fusion) {
             for (int i = 0; i < p_tv->getComputeAtPosition(); i++) {
               auto id = p_tv->axis(i);
               if (permissive_disjoint_sets.permissiveAreMapped(p_id, id)) {
-                loop_nodes_.mapEntries(c_id, id);
+                loop_uf_.mapEntries(c_id, id);
               }
             }
           }
-          permissive_nodes_.mapEntries(c_id, p_id);
+          permissive_uf_.mapEntries(c_id, p_id);
           consumers_.at(p_id).pushBack(c_id);
           producers_.at(c_id).pushBack(p_id);
 
           // Add the swizzle inputs to the same
           //  disjoint set as well if either c_id
           //  or p_id is swizzle output.
-          mapMaybeSwizzleOp(permissive_nodes_, p_id);
-          mapMaybeSwizzleOp(permissive_nodes_, c_id);
+          mapMaybeSwizzleOp(permissive_uf_, p_id);
+          mapMaybeSwizzleOp(permissive_uf_, c_id);
         }
 
         // Make sure we always get root mapping for the permissive map.
@@ -364,7 +364,7 @@ void IterDomainGraph::build(Fusion* fusion) {
           auto c_id = entry.first;
           auto p_id = entry.second;
           // Map the id's together
-          permissive_nodes_.mapEntries(c_id, p_id);
+          permissive_uf_.mapEntries(c_id, p_id);
           consumers_.at(p_id).pushBack(c_id);
           producers_.at(c_id).pushBack(p_id);
         }
@@ -481,11 +481,11 @@ void IterDomainGraph::build(Fusion* fusion) {
 
       // Only need to be concerned here with mapping across rfactor iter
       // domains, so isolate out those.
-      auto all_exact_map_ids = exact_nodes_.getDisjointSetOf(first_rfactor_id);
+      auto all_exact_map_ids = exact_uf_.getMembersOf(first_rfactor_id);
       std::vector<IterDomain*> exact_map_rf_ids;
       std::copy_if(
-          all_exact_map_ids.vector().begin(),
-          all_exact_map_ids.vector().end(),
+          all_exact_map_ids.begin(),
+          all_exact_map_ids.end(),
           std::back_inserter(exact_map_rf_ids),
           [](IterDomain* id) { return id->isRFactorProduct(); });
 
@@ -515,20 +515,31 @@ void IterDomainGraph::build(Fusion* fusion) {
       }
     }
   }
+
+  // Materialize the union-find structures and release them, they're only
+  // needed while building.
+  permissive_nodes_ = permissive_uf_.toDisjointSets();
+  exact_nodes_ = exact_uf_.toDisjointSets();
+  loop_nodes_ = loop_uf_.toDisjointSets();
+  sibling_sets_ = sibling_uf_.toDisjointSets();
+  permissive_uf_.clear();
+  exact_uf_.clear();
+  loop_uf_.clear();
+  sibling_uf_.clear();
 }
 
 void IterDomainGraph::initializeId(
     IterDomain* id,
     bool is_view_rfactor_id,
     bool is_leaf_id) {
-  permissive_nodes_.initializeSet(id);
-  exact_nodes_.initializeSet(id);
+  permissive_uf_.initializeSet(id);
+  exact_uf_.initializeSet(id);
   if (is_leaf_id) {
-    loop_nodes_.initializeSet(id);
+    loop_uf_.initializeSet(id);
   }
   consumers_[id] = {};
   producers_[id] = {};
-  sibling_sets_.initializeSet(id);
+  sibling_uf_.initializeSet(id);
 
   all_ids_.pushBack(id);
 
@@ -543,6 +554,7 @@ ComputeAtMap::ComputeAtMap(Fusion* fusion)
 }
 
 void ComputeAtMap::build(Fusion* fusion) {
+  FUSER_PERF_SCOPE("ComputeAtMap::build");
   trivial_reduction_info_.build(fusion);
   buildConcreteIds();
 }
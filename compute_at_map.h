@@ -101,6 +101,14 @@ class TORCH_CUDA_CU_API IterDomainGraph {
   // and permissive map.
   void mapThroughExpr(Expr* first, Expr* second, bool forward);
 
+  // Mapping during build is done on union-find structures, which are
+  // materialized into the DisjointSets below once build is complete. This
+  // avoids copying and remapping whole sets on every merge.
+  UnionFind<IterDomain*> permissive_uf_;
+  UnionFind<IterDomain*> exact_uf_;
+  UnionFind<IterDomain*> loop_uf_;
+  UnionFind<IterDomain*> sibling_uf_;
+
   DisjointSets<IterDomain*> permissive_nodes_;
   DisjointSets<IterDomain*> exact_nodes_;
   DisjointSets<IterDomain*> loop_nodes_;
@@ -293,6 +293,21 @@ class DisjointSets {
     return all_elements;
   }
 
+  // Appends a new disjoint set holding all provided entries, in order. None of
+  // the entries may already belong to a set. Used to bulk load sets that were
+  // computed elsewhere (e.g. by UnionFind) without repeatedly merging.
+  void appendSet(const std::vector<T>& entries) {
+    TORCH_INTERNAL_ASSERT(!entries.empty(), "Cannot append an empty set.");
+    auto new_set = std::make_shared<VectorOfUniqueEntries<T, Hash>>();
+    for (auto entry : entries) {
+      TORCH_INTERNAL_ASSERT(
+          new_set->pushBack(entry) &&
+              disjoint_set_maps_.emplace(entry, new_set).second,
+          "Entry already belongs to a disjoint set.");
+    }
+    disjoint_sets_.push_back(std::move(new_set));
+  }
+
   // Completely clears all disjoint sets
   void clear() {
     disjoint_set_maps_.clear();
@@ -327,6 +342,213 @@ class DisjointSets {
   std::vector<std::shared_ptr<VectorOfUniqueEntries<T, Hash>>> disjoint_sets_;
 };
 
+//! Union-find over dense integer ids, with path compression and union by
+//! rank
+//!
+//! Entries are given an integer id the first time they're seen, after that
+//! all bookkeeping is on flat vectors indexed by that id. Merging two sets is
+//! near constant time, where DisjointSets::mapEntries copies the whole
+//! absorbed set and remaps each of its entries. Member lists of the sets are
+//! only materialized when requested, see getMembersOf and toDisjointSets.
+//!
+//! Members of each set are kept as an intrusive linked list, and mapEntries(a,
+//! b) appends the list of b to the list of a. This means the materialized sets
+//! and their order are exactly what DisjointSets would produce for the same
+//! sequence of initializeSet/mapEntries calls, so the two can be used
+//! interchangeably without changing deterministic iteration orders.
+template <typename T, typename Hash = std::hash<T>>
+class UnionFind {
+ public:
+  using IdType = int64_t;
+
+  UnionFind() = default;
+
+  // Returns if provided entry has been added to a set
+  bool mappingExists(T entry) const {
+    return entry_to_id_.find(entry) != entry_to_id_.end();
+  }
+
+  // Initializes a new set for provided entry if it doesn't already exist,
+  // returns the id of the entry.
+  IdType initializeSet(T entry) {
+    auto id_it = entry_to_id_.find(entry);
+    if (id_it != entry_to_id_.end()) {
+      return id_it->second;
+    }
+    IdType id = (IdType)entries_.size();
+    entry_to_id_.emplace(entry, id);
+    entries_.push_back(entry);
+    parent_.push_back(id);
+    rank_.push_back(0);
+    head_.push_back(id);
+    tail_.push_back(id);
+    next_.push_back(-1);
+    num_sets_++;
+    return id;
+  }
+
+  // Returns the id of the provided entry, asserts if it doesn't exist.
+  IdType idOf(T entry) const {
+    auto id_it = entry_to_id_.find(entry);
+    TORCH_INTERNAL_ASSERT(
+        id_it != entry_to_id_.end(),
+        "Could not find entry for ",
+        abstractToString(entry));
+    return id_it->second;
+  }
+
+  // Returns the entry registered with provided id
+  T entryOf(IdType id) const {
+    return entries_.at(id);
+  }
+
+  // Returns the id of the representative of the set containing id. Compresses
+  // the path walked so subsequent lookups are faster.
+  IdType findRoot(IdType id) const {
+    IdType root = id;
+    while (parent_[root] != root) {
+      root = parent_[root];
+    }
+    while (parent_[id] != root) {
+      auto next_id = parent_[id];
+      parent_[id] = root;
+      id = next_id;
+    }
+    return root;
+  }
+
+  // Merges the set of entry1 into the set of entry0, initializing sets for
+  // either entry if they don't exist yet.
+  void mapEntries(T entry0, T entry1) {
+    auto root0 = findRoot(initializeSet(entry0));
+    auto root1 = findRoot(initializeSet(entry1));
+    if (root0 == root1) {
+      return;
+    }
+
+    // Concatenate member lists, entries of set1 go after entries of set0
+    // regardless of which root ends up the representative.
+    auto head = head_[root0];
+    auto tail = tail_[root1];
+    next_[tail_[root0]] = head_[root1];
+
+    if (rank_[root0] < rank_[root1]) {
+      std::swap(root0, root1);
+    }
+    parent_[root1] = root0;
+    if (rank_[root0] == rank_[root1]) {
+      rank_[root0]++;
+    }
+    head_[root0] = head;
+    tail_[root0] = tail;
+    num_sets_--;
+  }
+
+  // Will assert if provided entry0 is not in any set, otherwise returns if
+  // entry0 and entry1 are in the same set.
+  bool strictAreMapped(T entry0, T entry1) const {
+    auto id0 = idOf(entry0);
+    auto id1_it = entry_to_id_.find(entry1);
+    if (id1_it == entry_to_id_.end()) {
+      return false;
+    }
+    return findRoot(id0) == findRoot(id1_it->second);
+  }
+
+  // Returns false if either entry is not in a set, otherwise returns if entry0
+  // and entry1 are in the same set.
+  bool permissiveAreMapped(T entry0, T entry1) const {
+    auto id0_it = entry_to_id_.find(entry0);
+    auto id1_it = entry_to_id_.find(entry1);
+    if (id0_it == entry_to_id_.end() || id1_it == entry_to_id_.end()) {
+      return false;
+    }
+    return findRoot(id0_it->second) == findRoot(id1_it->second);
+  }
+
+  // Returns all members of the set containing entry, in insertion order.
+  //
+  // Warning: constructed on every call.
+  std::vector<T> getMembersOf(T entry) const {
+    std::vector<T> members;
+    for (auto id = head_[findRoot(idOf(entry))]; id != -1; id = next_[id]) {
+      members.push_back(entries_[id]);
+    }
+    return members;
+  }
+
+  // Returns the number of entries across all sets
+  size_t size() const {
+    return entries_.size();
+  }
+
+  // Returns the number of disjoint sets
+  size_t numSets() const {
+    return num_sets_;
+  }
+
+  // Materializes all sets as DisjointSets. Set order and order within each set
+  // matches what DisjointSets would have built directly.
+  DisjointSets<T, Hash> toDisjointSets() const {
+    // The set that absorbs another keeps its position in
+    // DisjointSets::disjointSets(), and its first entry stays at the front of
+    // its list, so sets are ordered by the id of the head of their list.
+    std::vector<IdType> ordered_heads;
+    ordered_heads.reserve(num_sets_);
+    for (IdType id = 0; id < (IdType)entries_.size(); id++) {
+      if (parent_[id] == id) {
+        ordered_heads.push_back(head_[id]);
+      }
+    }
+    std::sort(ordered_heads.begin(), ordered_heads.end());
+
+    DisjointSets<T, Hash> disjoint_sets;
+    std::vector<T> members;
+    for (auto head : ordered_heads) {
+      members.clear();
+      for (auto id = head; id != -1; id = next_[id]) {
+        members.push_back(entries_[id]);
+      }
+      disjoint_sets.appendSet(members);
+    }
+    return disjoint_sets;
+  }
+
+  // Completely clears all sets
+  void clear() {
+    entry_to_id_.clear();
+    entries_.clear();
+    parent_.clear();
+    rank_.clear();
+    head_.clear();
+    tail_.clear();
+    next_.clear();
+    num_sets_ = 0;
+  }
+
+ private:
+  std::unordered_map<T, IdType, Hash> entry_to_id_;
+
+  // Entries indexed by their id
+  std::vector<T> entries_;
+
+  // Parent of each id, roots are their own parent. Mutable for path
+  // compression in findRoot.
+  mutable std::vector<IdType> parent_;
+
+  // Upper bound on the height of each root's tree
+  std::vector<int> rank_;
+
+  // First and last member of the set, only valid for roots
+  std::vector<IdType> head_;
+  std::vector<IdType> tail_;
+
+  // Next member in the same set, -1 terminates the list
+  std::vector<IdType> next_;
+
+  size_t num_sets_ = 0;
+};
+
 } // namespace cuda
 } // namespace fuser
 } // namespace jit
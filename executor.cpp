@@ -20,6 +20,7 @@
 #include <c10/cuda/CUDAStream.h>
 #include <c10/util/irange.h>
 
+#include <cstring>
 #include <fstream>
 
 namespace torch {
@@ -28,6 +29,8 @@ namespace fuser {
 namespace cuda {
 
 int FusionExecutor::fusion_id_counter_ = 0; // NOLINT
+int HorizontalFusionExecutor::id_counter_ = 0; // NOLINT
+int BatchedFusionExecutor::id_counter_ = 0; // NOLINT
 
 namespace {
 
@@ -72,7 +75,9 @@ static const std::string& defineComplexTypes() {
 
 } // namespace
 
-std::string FusionExecutor::getStructuredCode(const std::string& kernel) {
+std::string FusionExecutor::getStructuredCode(
+    const std::string& kernel,
+    KernelIndexMode index_mode) {
   // generating cuda code;
   std::string code = "";
 #ifdef USE_ROCM
@@ -84,11 +89,16 @@ std::string FusionExecutor::getStructuredCode(const std::string& kernel) {
   code += std::string("#pragma clang force_cuda_host_device begin\n");
 #endif
   code += std::string("namespace ") + FusionExecutor::kernelNamespace() +
-      " {\n" + defineIntegerTypes() + defineIndexMode(options_.index_mode) +
+      " {\n" + defineIntegerTypes() + defineIndexMode(index_mode) +
       defineComplexTypes() + executor_utils::kernelPreamble() + kernel + "}\n";
 #ifdef USE_ROCM
   code += std::string("#pragma clang force_cuda_host_device end\n");
 #endif
+  return code;
+}
+
+std::string FusionExecutor::getStructuredCode(const std::string& kernel) {
+  const auto code = getStructuredCode(kernel, options_.index_mode);
 
   if (isDebugDumpEnabled(DebugDumpOption::CudaKernel)) {
     std::cout << "\n======= Codegen output for kernel: " << kernelName()
@@ -158,8 +168,11 @@ void FusionExecutor::debugCompileFusionFromStr(
         "The static shared memory allocation is larger than available memory.");
   }
 
-  std::tie(compiled_kernel_, last_compiler_log_) =
+  executor_utils::NvrtcFunction function;
+  std::tie(function, last_compiler_log_) =
       executor_utils::nvrtcCompile(code, name, fusion_id_);
+  compiled_kernel_ = std::make_shared<const executor_utils::CompiledKernel>(
+      function, last_compiler_log_);
   TORCH_INTERNAL_ASSERT(
       fusion_id_ > 0, "assign a fusion_id_ <= 0 is not accepted.");
 }
@@ -293,11 +306,13 @@ void FusionExecutor::compileFusion(
   block_size_high_water_mark = std::max<int64_t>(
       (block_size.has_value() ? block_size.value() : 1),
       block_size_high_water_mark);
-  std::tie(compiled_kernel_, last_compiler_log_) = executor_utils::nvrtcCompile(
+  compiled_kernel_ = executor_utils::getCompiledKernel(
       structured_code,
-      (kernelNamespace() + "::" + kernelName()).c_str(),
+      kernelName(),
+      kernelNamespace() + "::" + kernelName(),
       fusion_id_,
       block_size);
+  last_compiler_log_ = compiled_kernel_->compiler_log;
   TORCH_INTERNAL_ASSERT(
       fusion_id_ > 0, "failed to assign a fusion_id_ after compilation.");
 
@@ -307,7 +322,7 @@ void FusionExecutor::compileFusion(
   AT_CUDA_DRIVER_CHECK(at::globalContext().getNVRTC().cuFuncGetAttribute(
       &max_dynamic_smem,
       CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
-      compiled_kernel_.function));
+      compiled_kernel_->function));
   maybe_available_dynamic_smem_ = max_dynamic_smem;
 #endif
 }
@@ -803,17 +818,14 @@ KernelArgumentHolder FusionExecutor::inferOutputSizes(
     const LaunchParams& launch_constraints) {
   FUSER_PERF_SCOPE("FusionExecutor::RunFusion");
 
-  ExecutorEntry* executor_entry = nullptr;
+  std::lock_guard<std::mutex> guard(mutex_);
   c10::optional<size_t> opt_code = args.getCacheId();
-  if (opt_code.has_value()) {
-    executor_entry = &executor_entry_lookup_[*opt_code];
-  }
 
   executor_utils::initializeCudaContext();
   TORCH_INTERNAL_ASSERT(lowered_);
 
   TORCH_INTERNAL_ASSERT(
-      !executor_entry || !executor_entry->init,
+      !opt_code.has_value() || executor_entry_lookup_.count(*opt_code) == 0,
       "compile kernel shouldn't hit a pre-existing cache");
   FUSER_PERF_SCOPE("ExecutorRunFusion::ValidateAndInitialize");
   // TODO: validate kernel inputs currently won't be happy, since our fusion
@@ -872,10 +884,11 @@ KernelArgumentHolder FusionExecutor::inferOutputSizes(
   return ret;
 }
 
-std::vector<at::Tensor> FusionExecutor::runFusion(
+std::vector<at::Tensor> FusionExecutor::runFusionImpl(
     KernelArgumentHolder& args,
     const LaunchParams& launch_constraints,
-    const std::vector<at::Tensor>& outputs) {
+    const std::vector<at::Tensor>& outputs,
+    LaunchParams* prepared_launch_params) {
   FUSER_PERF_SCOPE("FusionExecutor::RunFusion");
   TORCH_INTERNAL_ASSERT(compiled());
   TORCH_INTERNAL_ASSERT(
@@ -898,27 +911,36 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
     std::cout << launch_constraints.toString();
   }
 
-  ExecutorEntry* executor_entry = nullptr;
-  if (args.getCacheId().has_value()) {
-    executor_entry = &executor_entry_lookup_[*args.getCacheId()];
+  // See Note [Concurrent Kernel Launches]
+  std::unique_lock<std::mutex> lock(mutex_);
+  std::shared_ptr<const ExecutorEntry> executor_entry;
+  if (args.getCacheId().has_value() && !disable_parameter_cache_) {
+    auto entry_it = executor_entry_lookup_.find(*args.getCacheId());
+    if (entry_it != executor_entry_lookup_.end()) {
+      executor_entry = entry_it->second;
+    }
   }
+  // Held through the launch, see Note [Compiled Kernel Registry]
+  auto compiled_kernel = compiled_kernel_;
 
   c10::DeviceGuard dg(options_.device);
   auto stream = at::cuda::getCurrentCUDAStream();
   executor_utils::initializeCudaContext();
   TORCH_INTERNAL_ASSERT(lowered_);
-  launch_params_ = LaunchParams();
+  LaunchParams launch_params;
   // NOLINTNEXTLINE(cppcoreguidelines-init-variables)
   std::vector<at::Tensor> allocated_outputs;
   GlobalBuffers global_buffers;
   uint64_t rand_offset = 0;
 
-  if (executor_entry && executor_entry->init && !disable_parameter_cache_) {
+  if (executor_entry) {
+    launch_params_ = executor_entry->launch_params;
+    lock.unlock();
     {
       // context manager to disable auto grad for `empty_cuda` calls later
       at::AutoDispatchBelowADInplaceOrView non_variable_type_mode;
       // take the short-cut for launch if we see a recorded input set again
-      launch_params_ = executor_entry->launch_params;
+      launch_params = executor_entry->launch_params;
       // only allocate outputs when not given
       if (outputs.empty()) {
         FUSER_PERF_SCOPE("ExecutorRunFusion::OutputAlloc");
@@ -992,22 +1014,23 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
     evaluator_precomputed_values_->bindKernelInputs(lowered_->kernel(), args);
     expr_eval.precomputedValues() = evaluator_precomputed_values_.get();
 
-    launch_params_ =
+    launch_params =
         computeLaunchParams(launch_constraints, expr_eval, warp_size_);
 
     // Recompile the kernel if the number of threads in the block has increased
-    if (launch_params_.nThreads() > block_size_high_water_mark) {
+    if (launch_params.nThreads() > block_size_high_water_mark) {
       const auto kernel = lowered_->kernel();
       kernel_code_ = codegen::generateCudaKernel(kernel, kernelName());
       const auto structured_code = getStructuredCode(kernel_code_);
-      block_size_high_water_mark = launch_params_.nThreads();
-
-      std::tie(compiled_kernel_, last_compiler_log_) =
-          executor_utils::nvrtcCompile(
-              structured_code,
-              (kernelNamespace() + "::" + kernelName()).c_str(),
-              fusion_id_,
-              block_size_high_water_mark);
+      block_size_high_water_mark = launch_params.nThreads();
+
+      compiled_kernel_ = executor_utils::getCompiledKernel(
+          structured_code,
+          kernelName(),
+          kernelNamespace() + "::" + kernelName(),
+          fusion_id_,
+          block_size_high_water_mark);
+      last_compiler_log_ = compiled_kernel_->compiler_log;
     }
 
     if (kernel()->summary().has_cooperative_grid_reduction) {
@@ -1015,26 +1038,26 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
       int num_blocks_per_SM = -1;
       at::globalContext().getNVRTC().cuOccupancyMaxActiveBlocksPerMultiprocessor(
           &num_blocks_per_SM,
-          compiled_kernel_.function,
-          (int)(launch_params_.bdimx() * launch_params_.bdimy() * launch_params_.bdimz()),
-          (size_t)launch_params_.smem());
+          compiled_kernel_->function,
+          (int)(launch_params.bdimx() * launch_params.bdimy() * launch_params.bdimz()),
+          (size_t)launch_params.smem());
 
       TORCH_INTERNAL_ASSERT(
           (int64_t)(
               num_blocks_per_SM *
               at::cuda::getDeviceProperties(options_.device.index())
-                  ->multiProcessorCount) >= launch_params_.gdimx() *
-                  launch_params_.gdimy() * launch_params_.gdimz(),
+                  ->multiProcessorCount) >= launch_params.gdimx() *
+                  launch_params.gdimy() * launch_params.gdimz(),
           "Wanted to launch a cooperative kernel, however the number of blocks is greater than ",
           "what can be resident on the GPU at once. Need: ",
-          launch_params_.gdimx() * launch_params_.gdimy() *
-              launch_params_.gdimz(),
+          launch_params.gdimx() * launch_params.gdimy() *
+              launch_params.gdimz(),
           " (",
-          launch_params_.gdimx(),
+          launch_params.gdimx(),
           " * ",
-          launch_params_.gdimy(),
+          launch_params.gdimy(),
           " * ",
-          launch_params_.gdimz(),
+          launch_params.gdimz(),
           ") but limited to ",
           num_blocks_per_SM,
           " * ",
@@ -1109,27 +1132,35 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
 
     // This is the entry when we have provided `opt_code` but the entry has not
     // been initialized yet.
-    if (executor_entry) {
+    if (args.getCacheId().has_value()) {
       FUSER_PERF_SCOPE("ExecutorRunFusion::FillCacheEntry");
       // record the the short-cut executor entry for the given input set;
-      executor_entry->launch_params = launch_params_;
-      executor_entry->io_alias_indices = alias_indices;
+      auto new_entry = std::make_shared<ExecutorEntry>();
+      new_entry->launch_params = launch_params;
+      new_entry->io_alias_indices = alias_indices;
       for (const auto& output : allocated_outputs) {
-        executor_entry->output_sizes.push_back(output.sizes().vec());
-        executor_entry->output_strides.push_back(output.strides().vec());
-        executor_entry->output_types.push_back(output.scalar_type());
+        new_entry->output_sizes.push_back(output.sizes().vec());
+        new_entry->output_strides.push_back(output.strides().vec());
+        new_entry->output_types.push_back(output.scalar_type());
       }
 
       for (const auto& i : c10::irange(global_buffers.buffers.size())) {
-        executor_entry->buffer_sizes.push_back(
+        new_entry->buffer_sizes.push_back(
             global_buffers.buffers[i].sizes().vec());
-        executor_entry->buffer_types.push_back(
+        new_entry->buffer_types.push_back(
             global_buffers.buffers[i].scalar_type());
-        executor_entry->buffer_zero_init.push_back(global_buffers.zero_init[i]);
+        new_entry->buffer_zero_init.push_back(global_buffers.zero_init[i]);
       }
-      executor_entry->rand_offset = rand_offset;
-      executor_entry->init = true;
+      new_entry->rand_offset = rand_offset;
+      executor_entry_lookup_[*args.getCacheId()] = std::move(new_entry);
     }
+    launch_params_ = launch_params;
+  }
+
+  // The kernel may have been recompiled for a larger block size above
+  if (lock.owns_lock()) {
+    compiled_kernel = compiled_kernel_;
+    lock.unlock();
   }
 
   // push back global buffers
@@ -1140,8 +1171,15 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
     args.appendPhiloxRNGSeed(rand_offset);
   }
 
+  // The kernel is launched as part of a horizontal kernel, see
+  //  Note [Horizontal Fusion]
+  if (prepared_launch_params != nullptr) {
+    *prepared_launch_params = launch_params;
+    return allocated_outputs;
+  }
+
   if (isDebugDumpEnabled(DebugDumpOption::LaunchParam)) {
-    launch_params_.print();
+    launch_params.print();
   }
 
   if (isDebugDumpEnabled(DebugDumpOption::KernelArgs)) {
@@ -1182,29 +1220,21 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
 
   if (execute_kernel_) {
     if (maybe_available_dynamic_smem_.has_value() &&
-        launch_params_.smem() > maybe_available_dynamic_smem_.value()) {
-#ifndef USE_ROCM
-      // Increase limit of dynamic shared memory if needed.
-      AT_CUDA_DRIVER_CHECK(at::globalContext().getNVRTC().cuFuncSetAttribute(
-          compiled_kernel_.function,
-          CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
-          launch_params_.smem()));
-#else
-      TORCH_INTERNAL_ASSERT(
-          false, "cuFuncSetAttribute not supported with HIP.");
-#endif
+        launch_params.smem() > maybe_available_dynamic_smem_.value()) {
+      // The function may be shared with other executors
+      compiled_kernel->ensureDynamicSmem(launch_params.smem());
     }
     if (!kernel()->summary().has_cooperative_grid_reduction) {
       FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchKernel");
       AT_CUDA_DRIVER_CHECK(at::globalContext().getNVRTC().cuLaunchKernel(
-          compiled_kernel_.function,
-          launch_params_.gdimx(),
-          launch_params_.gdimy(),
-          launch_params_.gdimz(),
-          launch_params_.bdimx(),
-          launch_params_.bdimy(),
-          launch_params_.bdimz(),
-          launch_params_.smem(),
+          compiled_kernel->function,
+          launch_params.gdimx(),
+          launch_params.gdimy(),
+          launch_params.gdimz(),
+          launch_params.bdimx(),
+          launch_params.bdimy(),
+          launch_params.bdimz(),
+          launch_params.smem(),
           stream,
           args.getBuffer(),
           nullptr));
@@ -1213,14 +1243,14 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
       FUSER_PERF_SCOPE("ExecutorRunFusion::cuLaunchCooperativeKernel");
       AT_CUDA_DRIVER_CHECK(
           at::globalContext().getNVRTC().cuLaunchCooperativeKernel(
-              compiled_kernel_.function,
-              launch_params_.gdimx(),
-              launch_params_.gdimy(),
-              launch_params_.gdimz(),
-              launch_params_.bdimx(),
-              launch_params_.bdimy(),
-              launch_params_.bdimz(),
-              launch_params_.smem(),
+              compiled_kernel->function,
+              launch_params.gdimx(),
+              launch_params.gdimy(),
+              launch_params.gdimz(),
+              launch_params.bdimx(),
+              launch_params.bdimy(),
+              launch_params.bdimz(),
+              launch_params.smem(),
               stream,
               args.getBuffer()));
 #else
@@ -1236,30 +1266,37 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
     C10_CUDA_CHECK(cudaEventRecord(finish_event));
     C10_CUDA_CHECK(cudaEventSynchronize(start_event));
     C10_CUDA_CHECK(cudaEventSynchronize(finish_event));
+    float kernel_time_ms = 0;
     C10_CUDA_CHECK(
-        cudaEventElapsedTime(&kernel_time_ms_, start_event, finish_event));
+        cudaEventElapsedTime(&kernel_time_ms, start_event, finish_event));
     C10_CUDA_CHECK(cudaEventDestroy(start_event));
     C10_CUDA_CHECK(cudaEventDestroy(finish_event));
 
-    bytes_processed_ = 0;
+    int64_t bytes_processed = 0;
     // Figure how many bytes are inputs, outputs, and temporary buffers
     for (auto i : c10::irange(args.size())) {
       if (auto tensor_arg_abstract =
               dynamic_cast<const TensorArgAbstract*>(args[i])) {
-        bytes_processed_ += tensor_arg_abstract->numel() *
+        bytes_processed += tensor_arg_abstract->numel() *
             dataTypeSize(tensor_arg_abstract->getDataType());
       }
     }
     for (const auto& output : allocated_outputs) {
-      bytes_processed_ += output.numel() *
+      bytes_processed += output.numel() *
           dataTypeSize(aten_to_data_type(output.scalar_type()));
     }
 
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      kernel_time_ms_ = kernel_time_ms;
+      bytes_processed_ = bytes_processed;
+    }
+
     if (isDebugDumpEnabled(DebugDumpOption::EffectiveBandwidth)) {
       double gb_per_s =
-          ((double)bytes_processed_ / ((double)kernel_time_ms_ / 1000)) /
+          ((double)bytes_processed / ((double)kernel_time_ms / 1000)) /
           (double)1.0e9;
-      std::cout << "kernel" << fusion_id_ << " run in " << kernel_time_ms_
+      std::cout << "kernel" << fusion_id_ << " run in " << kernel_time_ms
                 << " ms, achieved: " << gb_per_s << " GB/s" << std::endl;
     }
   }
@@ -1271,6 +1308,33 @@ std::vector<at::Tensor> FusionExecutor::runFusion(
   return allocated_outputs;
 }
 
+size_t FusionExecutor::approximateMemoryBytes() const {
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t bytes = sizeof(FusionExecutor) + kernel_code_.size() +
+      last_compiler_log_.size();
+  if (lowered_) {
+    bytes += lowered_->kernel()->approximateMemoryBytes();
+  }
+  for (const auto& it : executor_entry_lookup_) {
+    const auto& entry = *it.second;
+    bytes += sizeof(ExecutorEntry) +
+        entry.io_alias_indices.size() * sizeof(std::pair<int, int>) +
+        entry.output_types.size() * sizeof(at::ScalarType) +
+        entry.buffer_types.size() * sizeof(at::ScalarType) +
+        entry.buffer_zero_init.size() / 8;
+    for (const auto& sizes : entry.output_sizes) {
+      bytes += sizes.size() * sizeof(int64_t);
+    }
+    for (const auto& strides : entry.output_strides) {
+      bytes += strides.size() * sizeof(int64_t);
+    }
+    for (const auto& sizes : entry.buffer_sizes) {
+      bytes += sizes.size() * sizeof(int64_t);
+    }
+  }
+  return bytes;
+}
+
 void FusionExecutor::compileRtc(
     const std::string& code,
     const std::string& name,
@@ -1286,8 +1350,11 @@ void FusionExecutor::compileRtc(
   fusion_id_ = 1;
   options_ = options;
 
-  std::tie(compiled_kernel_, last_compiler_log_) =
+  executor_utils::NvrtcFunction function;
+  std::tie(function, last_compiler_log_) =
       executor_utils::nvrtcCompile(scode, name, fusion_id_);
+  compiled_kernel_ = std::make_shared<const executor_utils::CompiledKernel>(
+      function, last_compiler_log_);
 }
 
 void FusionExecutor::runRtc(
@@ -1301,7 +1368,7 @@ void FusionExecutor::runRtc(
   KernelArgumentHolder kernel_arguments(options_.index_mode);
   kernel_arguments.push(args);
   AT_CUDA_DRIVER_CHECK(at::globalContext().getNVRTC().cuLaunchKernel(
-      compiled_kernel_.function,
+      compiled_kernel_->function,
       launch_params.gdimx(),
       launch_params.gdimy(),
       launch_params.gdimz(),
@@ -1314,6 +1381,382 @@ void FusionExecutor::runRtc(
       nullptr));
 }
 
+bool HorizontalFusionExecutor::canPack(const FusionExecutor& executor) {
+  if (!executor.compiled() || isOptionEnabled(EnableOption::KernelProfile)) {
+    return false;
+  }
+  const auto& kernel_summary = executor.kernel()->summary();
+  return !kernel_summary.has_grid_reductions &&
+      !kernel_summary.has_grid_broadcasts &&
+      !kernel_summary.has_cooperative_grid_reduction &&
+      kernel_summary.global_allocations.empty() &&
+      kernel_summary.max_rng_offsets < 0;
+}
+
+void HorizontalFusionExecutor::compile(
+    const std::vector<FusionExecutor*>& executors,
+    KernelIndexMode index_mode,
+    int64_t block_size) {
+  FUSER_PERF_SCOPE("HorizontalFusionExecutor::compile");
+  if (id_ < 0) {
+    id_ = ++id_counter_;
+  }
+
+  std::vector<const kir::Kernel*> kernels;
+  for (auto executor : executors) {
+    kernels.push_back(executor->kernel());
+  }
+  kernel_code_ = codegen::generateHorizontalCudaKernel(kernels, kernelName());
+  const auto structured_code =
+      FusionExecutor::getStructuredCode(kernel_code_, index_mode);
+  if (isDebugDumpEnabled(DebugDumpOption::CudaKernel)) {
+    std::cout << "\n======= Codegen output for kernel: " << kernelName()
+              << " =======\n\n"
+              << kernel_code_ << "\n======================================\n\n";
+  }
+
+  compiled_kernel_ = executor_utils::getCompiledKernel(
+      structured_code,
+      kernelName(),
+      FusionExecutor::kernelNamespace() + "::" + kernelName(),
+      id_,
+      block_size);
+  block_size_high_water_mark_ = block_size;
+}
+
+std::vector<std::vector<at::Tensor>> HorizontalFusionExecutor::runFusion(
+    const std::vector<FusionExecutor*>& executors,
+    const std::vector<KernelArgumentHolder*>& args,
+    const std::vector<LaunchParams>& launch_constraints) {
+  FUSER_PERF_SCOPE("HorizontalFusionExecutor::runFusion");
+  TORCH_INTERNAL_ASSERT(
+      !executors.empty() && executors.size() == args.size() &&
+          executors.size() == launch_constraints.size(),
+      "Expected the arguments and launch constraints of each kernel");
+
+  // Bind the arguments of each kernel
+  std::vector<std::vector<at::Tensor>> outputs;
+  std::vector<LaunchParams> launch_params(executors.size());
+  int64_t block_size = 1;
+  for (const auto i : c10::irange(executors.size())) {
+    TORCH_INTERNAL_ASSERT(
+        canPack(*executors[i]),
+        "Can't pack kernel ",
+        executors[i]->kernelName());
+    outputs.push_back(executors[i]->prepareLaunch(
+        *args[i], launch_constraints[i], launch_params[i]));
+    block_size = std::max(block_size, launch_params[i].nThreads());
+  }
+
+  // Kernels sharing block dimensions share a launch
+  std::vector<int> launch_ids(executors.size(), -1);
+  int num_launches = 0;
+  for (const auto i : c10::irange(executors.size())) {
+    if (launch_ids[i] >= 0) {
+      continue;
+    }
+    for (const auto j : c10::irange(i, executors.size())) {
+      if (launch_ids[j] < 0 &&
+          launch_params[j].bdimx() == launch_params[i].bdimx() &&
+          launch_params[j].bdimy() == launch_params[i].bdimy() &&
+          launch_params[j].bdimz() == launch_params[i].bdimz()) {
+        launch_ids[j] = num_launches;
+      }
+    }
+    num_launches++;
+  }
+
+  // Parameters of all kernels, followed by the grid dimensions of each
+  //  kernel in the current launch
+  std::vector<void*> kernel_args;
+  for (auto arg : args) {
+    const auto buffer = arg->getBuffer();
+    kernel_args.insert(kernel_args.end(), buffer, buffer + arg->size());
+  }
+  std::vector<int64_t> grid_dims(executors.size() * 3, 0);
+  for (auto& dim : grid_dims) {
+    kernel_args.push_back(&dim);
+  }
+
+  c10::DeviceGuard dg(
+      c10::Device(c10::DeviceType::CUDA, args.front()->getDeviceIndex()));
+  auto stream = at::cuda::getCurrentCUDAStream();
+  executor_utils::initializeCudaContext();
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (!compiled_kernel_ || block_size > block_size_high_water_mark_) {
+    compile(executors, args.front()->getIndexMode(), block_size);
+  }
+
+  for (const auto launch_id : c10::irange(num_launches)) {
+    LaunchParams block_params;
+    int64_t num_blocks = 0;
+    int64_t smem = 0;
+    for (const auto i : c10::irange(executors.size())) {
+      const auto& params = launch_params[i];
+      const bool in_launch = launch_ids[i] == launch_id;
+      grid_dims[i * 3] = in_launch ? params.gdimx() : 0;
+      grid_dims[i * 3 + 1] = in_launch ? params.gdimy() : 0;
+      grid_dims[i * 3 + 2] = in_launch ? params.gdimz() : 0;
+      if (in_launch) {
+        block_params = params;
+        num_blocks += params.gdimx() * params.gdimy() * params.gdimz();
+        smem = std::max(smem, params.smem());
+      }
+    }
+    if (num_blocks == 0) {
+      continue;
+    }
+
+    if (smem > 0) {
+      compiled_kernel_->ensureDynamicSmem(smem);
+    }
+
+    FUSER_PERF_SCOPE("HorizontalFusionExecutor::cuLaunchKernel");
+    AT_CUDA_DRIVER_CHECK(at::globalContext().getNVRTC().cuLaunchKernel(
+        compiled_kernel_->function,
+        num_blocks,
+        1,
+        1,
+        block_params.bdimx(),
+        block_params.bdimy(),
+        block_params.bdimz(),
+        smem,
+        stream,
+        kernel_args.data(),
+        nullptr));
+  }
+
+  return outputs;
+}
+
+BatchedFusionExecutor::Table BatchedFusionExecutor::packTable(
+    const std::vector<std::vector<at::Tensor>>& tensor_sets,
+    int64_t chunk_size) {
+  FUSER_PERF_SCOPE("BatchedFusionExecutor::packTable");
+  TORCH_CHECK(chunk_size > 0, "Invalid chunk size: ", chunk_size);
+
+  Table table;
+  std::vector<int64_t> set_words;
+  for (const auto set_i : c10::irange(tensor_sets.size())) {
+    const auto& tensors = tensor_sets[set_i];
+    TORCH_CHECK(!tensors.empty(), "Empty tensor set ", set_i);
+    const auto numel = tensors.front().numel();
+    set_words.push_back(numel);
+    for (const auto& tensor : tensors) {
+      TORCH_CHECK(
+          tensor.numel() == numel && tensor.is_contiguous(),
+          "Tensors of a batched set must be contiguous and have the same ",
+          "number of elements, set ",
+          set_i);
+      set_words.push_back(reinterpret_cast<int64_t>(tensor.data_ptr()));
+    }
+    for (int64_t chunk_start = 0; chunk_start < numel;
+         chunk_start += chunk_size) {
+      table.words.push_back((int64_t)set_i);
+      table.words.push_back(chunk_start);
+      table.num_chunks++;
+    }
+  }
+  table.words.insert(table.words.end(), set_words.begin(), set_words.end());
+  return table;
+}
+
+void BatchedFusionExecutor::compileFusion(
+    Fusion* fusion,
+    int64_t chunk_size,
+    CompileOptions options) {
+  FUSER_PERF_SCOPE("BatchedFusionExecutor::compileFusion");
+  TORCH_CHECK(chunk_size > 0, "Invalid chunk size: ", chunk_size);
+  TORCH_CHECK(
+      fusion->ioAlias().empty(), "Batched fusions can't alias inputs");
+
+  // Table entries are 64 bit
+  options_ = options;
+  options_.index_mode = KernelIndexMode::INT64;
+  chunk_size_ = chunk_size;
+  c10::DeviceGuard dg(options_.device);
+
+  lowered_ = std::make_unique<GpuLower>(fusion, DataType::Int);
+
+  // Each block runs one chunk, see Note [Batched Fusion]
+  const auto& kernel_summary = kernel()->summary();
+  TORCH_CHECK(
+      !kernel_summary.has_block_reductions &&
+          !kernel_summary.has_grid_reductions &&
+          !kernel_summary.has_block_welford &&
+          !kernel_summary.has_grid_welford &&
+          !kernel_summary.has_grid_broadcasts &&
+          kernel_summary.global_allocations.empty() &&
+          kernel_summary.dynamic_smem_allocations.empty() &&
+          kernel_summary.max_rng_offsets < 0 &&
+          kernel_summary.vectorized_accesses.empty(),
+      "Batched fusions must be pointwise without vectorization");
+
+  const auto& parallel_dimension_map = lowered_->parallelDimensionMap();
+  for (auto pt : kParallelTypeBIDs) {
+    TORCH_CHECK(
+        parallel_dimension_map.get(pt) == nullptr,
+        "Batched fusions can't be parallelized with ",
+        pt);
+  }
+  std::array<int64_t, 3> block_dims = {1, 1, 1};
+  for (const auto i : c10::irange(kParallelTypeTIDs.size())) {
+    auto dim = parallel_dimension_map.get(kParallelTypeTIDs[i]);
+    if (dim == nullptr) {
+      continue;
+    }
+    TORCH_CHECK(
+        dim->isConstInt(),
+        "Batched fusions need constant block dimensions, found: ",
+        dim->toString());
+    block_dims[i] = dim->evaluateInt();
+  }
+  bdimx_ = block_dims[0];
+  bdimy_ = block_dims[1];
+  bdimz_ = block_dims[2];
+
+  id_ = ++id_counter_;
+  kernel_code_ = codegen::generateBatchedCudaKernel(kernel(), kernelName());
+  const auto structured_code =
+      FusionExecutor::getStructuredCode(kernel_code_, options_.index_mode);
+  if (isDebugDumpEnabled(DebugDumpOption::CudaKernel)) {
+    std::cout << "\n======= Codegen output for kernel: " << kernelName()
+              << " =======\n\n"
+              << kernel_code_ << "\n======================================\n\n";
+  }
+
+  compiled_kernel_ = executor_utils::getCompiledKernel(
+      structured_code,
+      kernelName(),
+      FusionExecutor::kernelNamespace() + "::" + kernelName(),
+      id_,
+      bdimx_ * bdimy_ * bdimz_);
+}
+
+std::vector<std::vector<at::Tensor>> BatchedFusionExecutor::runFusion(
+    const std::vector<std::vector<c10::IValue>>& input_sets) {
+  FUSER_PERF_SCOPE("BatchedFusionExecutor::runFusion");
+  TORCH_INTERNAL_ASSERT(compiled(), "Cannot run fusion, it was not compiled.");
+  TORCH_CHECK(!input_sets.empty(), "No input sets to run");
+
+  c10::DeviceGuard dg(options_.device);
+  auto stream = at::cuda::getCurrentCUDAStream();
+  executor_utils::initializeCudaContext();
+
+  const auto& kernel_inputs = kernel()->inputs();
+
+  // Tensors of each set, inputs followed by the allocated outputs
+  std::vector<std::vector<at::Tensor>> tensor_sets;
+  std::vector<std::vector<at::Tensor>> outputs;
+  for (const auto set_i : c10::irange(input_sets.size())) {
+    const auto& inputs = input_sets[set_i];
+    TORCH_CHECK(
+        inputs.size() == kernel_inputs.size(),
+        "Expected ",
+        kernel_inputs.size(),
+        " inputs per set but found ",
+        inputs.size());
+    std::vector<at::Tensor> tensors;
+    for (const auto i : c10::irange(inputs.size())) {
+      if (!kernel_inputs[i]->isA<TensorView>()) {
+        // Scalars are kernel parameters, taken from the first set
+        TORCH_CHECK(
+            inputs[i] == input_sets.front()[i],
+            "Scalar input ",
+            i,
+            " of set ",
+            set_i,
+            " differs from the first set, but batched sets share scalars");
+        continue;
+      }
+      TORCH_CHECK(inputs[i].isTensor(), "Expected a tensor input ", i);
+      // The kernel reinterprets the data pointers in the table, so sets are
+      //  checked like validateKernelInputs, except for the shapes which are
+      //  flattened into chunks
+      const auto& tensor = inputs[i].toTensor();
+      TORCH_CHECK(
+          tensor.device() == options_.device,
+          "Expected input ",
+          i,
+          " of set ",
+          set_i,
+          " on device ",
+          options_.device,
+          " but found it on ",
+          tensor.device());
+      const auto dtype = kernel_inputs[i]->getDataType().value();
+      TORCH_CHECK(
+          aten_to_data_type(tensor.scalar_type()) == dtype,
+          "Expected input ",
+          i,
+          " of set ",
+          set_i,
+          " to be ",
+          dtype,
+          " but found ",
+          tensor.scalar_type());
+      tensors.push_back(tensor);
+    }
+    TORCH_CHECK(!tensors.empty(), "Batched fusions need a tensor input");
+
+    std::vector<at::Tensor> set_outputs;
+    for (auto output : kernel()->outputs()) {
+      set_outputs.push_back(at::native::empty_cuda(
+          tensors.front().sizes(),
+          data_type_to_aten(output->getDataType().value()),
+          c10::nullopt,
+          options_.device,
+          c10::nullopt));
+    }
+    tensors.insert(tensors.end(), set_outputs.begin(), set_outputs.end());
+    tensor_sets.push_back(std::move(tensors));
+    outputs.push_back(std::move(set_outputs));
+  }
+
+  const auto table = packTable(tensor_sets, chunk_size_);
+  if (table.num_chunks == 0) {
+    return outputs;
+  }
+
+  // Copy the table to the device in one memcpy
+  auto host_table = at::empty(
+      {(int64_t)table.words.size()},
+      at::TensorOptions().dtype(at::kLong).pinned_memory(true));
+  std::memcpy(
+      host_table.data_ptr(),
+      table.words.data(),
+      table.words.size() * sizeof(int64_t));
+  auto device_table =
+      host_table.to(options_.device, at::kLong, /*non_blocking=*/true);
+
+  KernelArgumentHolder args(options_.index_mode);
+  args.push(device_table);
+  args.push(table.num_chunks);
+  args.push(chunk_size_);
+  for (const auto i : c10::irange(kernel_inputs.size())) {
+    if (!kernel_inputs[i]->isA<TensorView>()) {
+      args.push(input_sets.front()[i]);
+    }
+  }
+
+  FUSER_PERF_SCOPE("BatchedFusionExecutor::cuLaunchKernel");
+  AT_CUDA_DRIVER_CHECK(at::globalContext().getNVRTC().cuLaunchKernel(
+      compiled_kernel_->function,
+      table.num_chunks,
+      1,
+      1,
+      bdimx_,
+      bdimy_,
+      bdimz_,
+      0,
+      stream,
+      args.getBuffer(),
+      nullptr));
+
+  return outputs;
+}
+
 } // namespace cuda
 } // namespace fuser
 } // namespace jit
@@ -11,6 +11,9 @@
 
 #include <c10/core/DeviceType.h>
 
+#include <memory>
+#include <mutex>
+
 namespace torch {
 namespace jit {
 namespace fuser {
@@ -59,7 +62,21 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   std::vector<at::Tensor> runFusion(
       KernelArgumentHolder& args,
       const LaunchParams& launch_constraints = LaunchParams(),
-      const std::vector<at::Tensor>& outputs = {});
+      const std::vector<at::Tensor>& outputs = {}) {
+    return runFusionImpl(args, launch_constraints, outputs, nullptr);
+  }
+
+  //! Prepares a launch of the kernel on args without launching it:
+  //!  allocates the outputs and intermediate buffers and appends them to
+  //!  args. Returns the outputs, and the launch parameters in launch_params.
+  //!  Used to launch the kernel as part of a horizontal kernel, see
+  //!  Note [Horizontal Fusion]
+  std::vector<at::Tensor> prepareLaunch(
+      KernelArgumentHolder& args,
+      const LaunchParams& launch_constraints,
+      LaunchParams& launch_params) {
+    return runFusionImpl(args, launch_constraints, {}, &launch_params);
+  }
 
   std::vector<at::Tensor> runFusion(
       const at::ArrayRef<IValue>& inputs,
@@ -88,18 +105,23 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   };
 
   void evictCache(size_t cache_id) {
+    std::lock_guard<std::mutex> guard(mutex_);
     executor_entry_lookup_.erase(cache_id);
   }
 
+  //! Rough estimate of the host memory held by this executor: the kernel IR,
+  //!  the kernel code and the recorded executor entries
+  size_t approximateMemoryBytes() const;
+
   // struct used to hold necessary information to launch compiled kernel on a
-  // given input set.
+  // given input set. Entries are recorded once fully initialized and are not
+  // modified afterwards.
   //
   // TODO: strides would also be important when we handle permutations in
   //       codegen.
   //
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
   struct ExecutorEntry {
-    bool init = false;
     LaunchParams launch_params;
     std::vector<std::pair<int, int>> io_alias_indices;
     std::vector<std::vector<int64_t>> output_sizes;
@@ -135,16 +157,19 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   //!    setMeasureKernelTimeFlag(true)
   //!
   float kernelTimeMs() const {
+    std::lock_guard<std::mutex> guard(mutex_);
     return measure_kernel_time_ ? kernel_time_ms_ : 0;
   }
 
   //! Returns the number of bytes processed last kernel execution
   int64_t bytesProcessed() const {
+    std::lock_guard<std::mutex> guard(mutex_);
     return bytes_processed_;
   }
 
   //! Returns the launch parameters from the last kernel execution
   LaunchParams lastLaunchParams() const {
+    std::lock_guard<std::mutex> guard(mutex_);
     return launch_params_;
   }
 
@@ -153,6 +178,13 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
     return kernel_code_;
   }
 
+  //! Returns the loaded kernel, see Note [Compiled Kernel Registry]
+  std::shared_ptr<const executor_utils::CompiledKernel> compiledKernel()
+      const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return compiled_kernel_;
+  }
+
   //! Returns the latest compile log
   std::string compilerLog() const {
     return last_compiler_log_;
@@ -198,6 +230,18 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   // Add preamble and wrap in namespace
   std::string getStructuredCode(const std::string& kernel);
 
+  static std::string getStructuredCode(
+      const std::string& kernel,
+      KernelIndexMode index_mode);
+
+  //! Runs the fusion, or only prepares the launch if prepared_launch_params
+  //!  is given, see prepareLaunch
+  std::vector<at::Tensor> runFusionImpl(
+      KernelArgumentHolder& args,
+      const LaunchParams& launch_constraints,
+      const std::vector<at::Tensor>& outputs,
+      LaunchParams* prepared_launch_params);
+
   LaunchParams computeLaunchParams(
       const LaunchParams& launch_constraints,
       kir::ExpressionEvaluator& expr_eval,
@@ -259,7 +303,9 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
   // https://docs.nvidia.com/cuda/cuda-c-programming-guide/index.html#shared-memory-8-x
   const int max_static_smem_ = 48 << 10;
   int warp_size_ = 0;
-  executor_utils::NvrtcFunction compiled_kernel_;
+  // Shared with other executors generating the same code, see
+  // Note [Compiled Kernel Registry]
+  std::shared_ptr<const executor_utils::CompiledKernel> compiled_kernel_;
 
   // TensorViews actually used in the kernel.
   std::vector<TensorView*> used_tvs_;
@@ -278,7 +324,17 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
 
   // lookup table to take short cut to retrieve recorded information in order to
   // launch kernels without re-inference parameters.
-  std::unordered_map<size_t, ExecutorEntry> executor_entry_lookup_;
+  std::unordered_map<size_t, std::shared_ptr<const ExecutorEntry>>
+      executor_entry_lookup_;
+
+  // Note [Concurrent Kernel Launches]
+  // runFusion can be called from multiple threads, e.g. to launch the same
+  // kernel on different streams. mutex_ guards the executor entry lookup, the
+  // expression evaluator, recompilation and the profiling state below. Runs
+  // hitting a recorded executor entry only hold it for the lookup, and
+  // allocate and launch unlocked. Entries are shared pointers, so evicting an
+  // entry doesn't invalidate an in-flight launch.
+  mutable std::mutex mutex_;
 
   // Compile time information caching. This is used for shape inference
   //  support. The cache stores graph information that are available
@@ -318,6 +374,178 @@ class TORCH_CUDA_CU_API FusionExecutor : public NonCopyable {
 
   // Profiling support: nvrtc log for debugging
   std::string last_compiler_log_;
+
+  friend class HorizontalFusionExecutor;
+  friend class BatchedFusionExecutor;
+};
+
+//! Note [Horizontal Fusion]
+//!
+//! Segments of a fusion with no edges between them are independent kernels.
+//!  When each of them is small, e.g. the per-parameter updates of an
+//!  optimizer step, the launch overhead rather than the bandwidth bounds
+//!  their run time. HorizontalFusionExecutor packs such kernels into one:
+//!   - each kernel is generated as a __device__ function taking its block
+//!     index and grid dimensions as parameters, which shadow the builtins,
+//!   - a __global__ wrapper takes the parameters of all kernels followed by
+//!     their grid dimensions, and hands each kernel its own range of a 1D
+//!     grid, dispatching on blockIdx.x.
+//!
+//! The packed kernel is generated and compiled once. A launch binds the
+//!  arguments of each kernel with FusionExecutor::prepareLaunch, and runs
+//!  with the sum of their grids and the maximum of their dynamic shared
+//!  memory. The kernels of a launch must agree on the block dimensions, so
+//!  kernels with different block dimensions run in separate launches of the
+//!  same packed kernel, with the grids of the other kernels set to zero.
+//!
+//! Kernels communicating across blocks, i.e. with grid reductions,
+//!  broadcasts or syncs, and kernels with global buffers or random numbers
+//!  can't be packed.
+//!
+//! FusionKernelRuntime packs the independent groups of a segmented fusion,
+//!  see SegmentedFusion::independentGroupWaves, when enabled with
+//!  PYTORCH_NVFUSER_ENABLE=horizontal_fusion.
+class TORCH_CUDA_CU_API HorizontalFusionExecutor : public NonCopyable {
+ public:
+  //! Whether the kernel of a compiled executor can be packed
+  static bool canPack(const FusionExecutor& executor);
+
+  //! Runs the kernels of executors, with args holding the inputs of each
+  //!  kernel. Returns the outputs of each kernel. The executors must be
+  //!  compiled, packable, and the same on every call.
+  std::vector<std::vector<at::Tensor>> runFusion(
+      const std::vector<FusionExecutor*>& executors,
+      const std::vector<KernelArgumentHolder*>& args,
+      const std::vector<LaunchParams>& launch_constraints);
+
+  //! Returns the string of the packed kernel
+  std::string kernelString() const {
+    std::lock_guard<std::mutex> guard(mutex_);
+    return kernel_code_;
+  }
+
+  std::string kernelName() const {
+    std::stringstream ss;
+    ss << "kernel_horizontal" << id_;
+    return ss.str();
+  }
+
+ private:
+  void compile(
+      const std::vector<FusionExecutor*>& executors,
+      KernelIndexMode index_mode,
+      int64_t block_size);
+
+ private:
+  // Counter to be used for kernel name.
+  int id_ = -1;
+  static int id_counter_;
+
+  std::string kernel_code_;
+
+  std::shared_ptr<const executor_utils::CompiledKernel> compiled_kernel_;
+
+  // Track the block size the kernel was compiled with, see
+  //  FusionExecutor::block_size_high_water_mark
+  int64_t block_size_high_water_mark_ = 0;
+
+  // Guards compilation and the configuration of the compiled kernel
+  mutable std::mutex mutex_;
+};
+
+//! Note [Batched Fusion]
+//!
+//! Optimizers apply the same pointwise fusion, e.g. an Adam update, to
+//!  hundreds of parameters of different sizes. Run one at a time, each
+//!  parameter is a kernel launch. BatchedFusionExecutor instead runs the
+//!  fusion on a list of input sets in one launch, in the style of
+//!  multi-tensor apply:
+//!   - the fusion is scheduled for a chunk of contiguous 1D tensors, with
+//!     only thread parallelization, e.g. [I/128, TIDx{128}],
+//!   - the tensors of each set are split into chunks of chunk_size
+//!     elements, and each block runs the fusion on one chunk,
+//!   - the host packs a table of the chunks and the tensors of each set,
+//!     and copies it to the device in one memcpy.
+//!
+//! The table is a list of int64_t words:
+//!   - num_chunks entries of (set index, chunk start),
+//!   - followed by one entry per set of (numel, data pointers), with the
+//!     pointers of the tensor inputs and then the outputs, in order.
+//!
+//! The generated kernel reads its chunk from the table, builds 1D tensors
+//!  of the chunk and calls the fusion as a device function. Scalar inputs
+//!  are kernel parameters, i.e. shared by all sets, so all sets have to
+//!  pass the same scalars.
+//!
+//! All tensors of a set must be contiguous and have the same number of
+//!  elements, which the outputs are allocated with. The fusion can't
+//!  reduce, use global buffers, random numbers or vectorization, since the
+//!  last chunk of a tensor may be partial.
+class TORCH_CUDA_CU_API BatchedFusionExecutor : public NonCopyable {
+ public:
+  //! Table of a batched launch, see Note [Batched Fusion]
+  struct Table {
+    std::vector<int64_t> words;
+    int64_t num_chunks = 0;
+  };
+
+  //! Packs the table of tensor_sets, holding the inputs and outputs of
+  //!  each set. Doesn't need a device.
+  static Table packTable(
+      const std::vector<std::vector<at::Tensor>>& tensor_sets,
+      int64_t chunk_size);
+
+  //! Lowers fusion, scheduled for a single chunk, and compiles its batched
+  //!  kernel
+  void compileFusion(
+      Fusion* fusion,
+      int64_t chunk_size,
+      CompileOptions options = CompileOptions());
+
+  bool compiled() const {
+    return compiled_kernel_ != nullptr;
+  }
+
+  //! Runs the fusion on each of input_sets in one launch. Scalar inputs are
+  //!  taken from the first set. Returns the outputs of each set.
+  std::vector<std::vector<at::Tensor>> runFusion(
+      const std::vector<std::vector<c10::IValue>>& input_sets);
+
+  kir::Kernel* kernel() const {
+    TORCH_INTERNAL_ASSERT(lowered_);
+    return lowered_->kernel();
+  }
+
+  //! Returns the string of the batched kernel
+  std::string kernelString() const {
+    return kernel_code_;
+  }
+
+  std::string kernelName() const {
+    std::stringstream ss;
+    ss << "kernel_batched" << id_;
+    return ss.str();
+  }
+
+ private:
+  CompileOptions options_;
+
+  // Counter to be used for kernel name.
+  int id_ = -1;
+  static int id_counter_;
+
+  std::unique_ptr<GpuLower> lowered_;
+
+  int64_t chunk_size_ = 0;
+
+  // Block dimensions, fixed by the schedule
+  int64_t bdimx_ = 1;
+  int64_t bdimy_ = 1;
+  int64_t bdimz_ = 1;
+
+  std::string kernel_code_;
+
+  std::shared_ptr<const executor_utils::CompiledKernel> compiled_kernel_;
 };
 
 } // namespace cuda
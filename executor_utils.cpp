@@ -50,6 +50,7 @@
 #include <cuda_occupancy.h>
 #endif
 
+#include <algorithm>
 #include <fstream>
 
 namespace torch {
@@ -741,7 +742,8 @@ void validateMisalignedVectorizedTensors(
 }
 
 // Check if there's any split that is non-divisible and vectorized. If
-// found, Vectorize is illegal.
+// found, Vectorize is illegal. Splits of rfactor domains, e.g., by
+// unflatten, are checked here as well.
 void validateVectorizedSplits(
     kir::Kernel* kernel,
     kir::ExpressionEvaluator& expr_eval) {
@@ -750,17 +752,18 @@ void validateVectorizedSplits(
     auto split_factor = expr_eval.evaluate(extent_factor.second);
     TORCH_INTERNAL_ASSERT(
         input_extent.has_value(),
-        "Could not check if a split with vectorization is divisible because the extent, ",
+        "Could not check if a split is divisible because the extent, ",
         extent_factor.first->toString(),
         ", is not possible to evaluate.");
     TORCH_INTERNAL_ASSERT(
-        input_extent.has_value(),
-        "Could not check if a split with vectorization is divisible because the split factor, ",
+        split_factor.has_value(),
+        "Could not check if a split is divisible because the split factor, ",
         extent_factor.second->toString(),
         ", is not possible to evaluate.");
-    TORCH_INTERNAL_ASSERT(
+    TORCH_CHECK(
         input_extent.value() % split_factor.value() == 0,
-        "Non-divisible split with vectorization is detected. ",
+        "Non-divisible split with vectorization or of an rfactor domain ",
+        "is detected. ",
         "Extent: ",
         input_extent.value(),
         ". Factor: ",
@@ -1266,6 +1269,199 @@ std::pair<NvrtcFunction, std::string> nvrtcCompile(
   return {compiled_kernel_, ptxas_log.str()};
 }
 
+CompiledKernel::~CompiledKernel() {
+  // Destructors can't throw, and the driver may already be shut down at exit
+  auto result = at::globalContext().getNVRTC().cuModuleUnload(module);
+  if (result != CUDA_SUCCESS && result != CUDA_ERROR_DEINITIALIZED) {
+    const char* error_string = nullptr;
+    at::globalContext().getNVRTC().cuGetErrorString(result, &error_string);
+    TORCH_WARN(
+        "Failed to unload a kernel module: ",
+        error_string != nullptr ? error_string : "unknown error");
+  }
+}
+
+void CompiledKernel::ensureDynamicSmem(int64_t smem) const {
+  if (smem <= max_dynamic_smem_.load(std::memory_order_acquire)) {
+    return;
+  }
+#ifndef USE_ROCM
+  std::lock_guard<std::mutex> guard(dynamic_smem_mutex_);
+  auto max_dynamic_smem = max_dynamic_smem_.load(std::memory_order_relaxed);
+  if (max_dynamic_smem < 0) {
+    // The driver API call requires an int argument.
+    int current_smem = 0;
+    AT_CUDA_DRIVER_CHECK(at::globalContext().getNVRTC().cuFuncGetAttribute(
+        &current_smem,
+        CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES,
+        function));
+    max_dynamic_smem = current_smem;
+  }
+  if (smem > max_dynamic_smem) {
+    // Increase limit of dynamic shared memory if needed.
+    AT_CUDA_DRIVER_CHECK(at::globalContext().getNVRTC().cuFuncSetAttribute(
+        function, CU_FUNC_ATTRIBUTE_MAX_DYNAMIC_SHARED_SIZE_BYTES, smem));
+    max_dynamic_smem = smem;
+  }
+  max_dynamic_smem_.store(max_dynamic_smem, std::memory_order_release);
+#else
+  TORCH_INTERNAL_ASSERT(false, "cuFuncSetAttribute not supported with HIP.");
+#endif
+}
+
+namespace {
+
+// Number of registry entries before expired ones are first pruned
+constexpr size_t kMinKernelRegistryPruneThreshold = 64;
+
+// Name kernels are renamed to in registry keys
+const std::string kRegistryKernelName = "kernel";
+
+} // namespace
+
+CompiledKernelRegistry& CompiledKernelRegistry::get() {
+  static CompiledKernelRegistry registry;
+  return registry;
+}
+
+std::string CompiledKernelRegistry::makeKey(
+    const std::string& code,
+    const std::string& kernel_name,
+    c10::optional<int> opt_block_size) {
+  FUSER_PERF_SCOPE("CompiledKernelRegistry::makeKey");
+  std::stringstream ss;
+  // Everything nvrtcCompile derives its compile options from
+  ss << (int)c10::cuda::current_device() << ';'
+     << opt_block_size.value_or(0) << ';'
+     << isOptionDisabled(DisableOption::Fma)
+     << isDebugDumpEnabled(DebugDumpOption::DebugInfo)
+     << isDebugDumpEnabled(DebugDumpOption::PrintPtxasLog)
+     << isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose)
+     << isOptionEnabled(EnableOption::KernelProfile) << ';';
+  if (const char* ptxas_opt_level = getenv("PYTORCH_NVFUSER_JIT_OPT_LEVEL")) {
+    ss << ptxas_opt_level;
+  }
+  ss << ';';
+
+  // The kernel name embeds the fusion id, which differs across executors
+  const std::string declaration = "__global__ void " + kernel_name + "(";
+  const auto name_pos = code.find(declaration);
+  if (name_pos == std::string::npos) {
+    ss << kernel_name << ';' << code;
+  } else {
+    const auto name_end = name_pos + declaration.size() - 1;
+    ss << kRegistryKernelName << ';';
+    ss.write(code.data(), name_pos);
+    ss << "__global__ void " << kRegistryKernelName;
+    ss.write(code.data() + name_end, code.size() - name_end);
+  }
+  return ss.str();
+}
+
+std::shared_ptr<const CompiledKernel> CompiledKernelRegistry::lookup(
+    const std::string& key) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto entry_it = entries_.find(key);
+  if (entry_it != entries_.end()) {
+    if (auto kernel = entry_it->second.lock()) {
+      hits_++;
+      return kernel;
+    }
+  }
+  misses_++;
+  return nullptr;
+}
+
+std::shared_ptr<const CompiledKernel> CompiledKernelRegistry::insert(
+    const std::string& key,
+    std::shared_ptr<const CompiledKernel> kernel) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& entry = entries_[key];
+  if (auto existing = entry.lock()) {
+    return existing;
+  }
+  entry = kernel;
+  if (entries_.size() >= prune_threshold_) {
+    pruneExpired();
+    prune_threshold_ =
+        std::max(kMinKernelRegistryPruneThreshold, 2 * entries_.size());
+  }
+  return kernel;
+}
+
+void CompiledKernelRegistry::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  prune_threshold_ = 0;
+  hits_ = 0;
+  misses_ = 0;
+}
+
+CompiledKernelRegistry::Stats CompiledKernelRegistry::stats() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.live = std::count_if(
+      entries_.begin(), entries_.end(), [](const auto& entry) {
+        return !entry.second.expired();
+      });
+  return stats;
+}
+
+std::string CompiledKernelRegistry::statsString() {
+  auto registry_stats = stats();
+  std::stringstream ss;
+  ss << "Compiled kernel registry: " << registry_stats.hits << " hits, "
+     << registry_stats.misses << " misses, " << registry_stats.live
+     << " loaded kernels";
+  return ss.str();
+}
+
+void CompiledKernelRegistry::pruneExpired() {
+  for (auto entry_it = entries_.begin(); entry_it != entries_.end();) {
+    if (entry_it->second.expired()) {
+      entry_it = entries_.erase(entry_it);
+    } else {
+      ++entry_it;
+    }
+  }
+}
+
+std::shared_ptr<const CompiledKernel> getCompiledKernel(
+    const std::string& code,
+    const std::string& kernel_name,
+    const std::string& func_name,
+    int id,
+    c10::optional<int> opt_block_size) {
+  auto compile = [&]() {
+    auto compiled = nvrtcCompile(code, func_name, id, opt_block_size);
+    return std::make_shared<const CompiledKernel>(
+        compiled.first, std::move(compiled.second));
+  };
+
+  // Dumps of the compiled code are produced by nvrtcCompile
+  if (isOptionDisabled(DisableOption::KernelRegistry) ||
+      isDebugDumpEnabled(DebugDumpOption::Ptx) ||
+      isDebugDumpEnabled(DebugDumpOption::Cubin)) {
+    return compile();
+  }
+
+  auto& registry = CompiledKernelRegistry::get();
+  const auto key =
+      CompiledKernelRegistry::makeKey(code, kernel_name, opt_block_size);
+  auto kernel = registry.lookup(key);
+  if (kernel == nullptr) {
+    // Compiled unlocked, identical compilations racing each other end up
+    //  sharing whichever kernel is registered first
+    kernel = registry.insert(key, compile());
+  }
+  if (isDebugDumpEnabled(DebugDumpOption::KernelRegistryStats)) {
+    std::cout << registry.statsString() << std::endl;
+  }
+  return kernel;
+}
+
 namespace caching {
 
 //! CompileTimeInfo is the actual subclass of CompileTimeInfoBase that will
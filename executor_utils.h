@@ -16,8 +16,13 @@
 #include <third_party/nvfuser/kernel.h>
 #include <third_party/nvfuser/kernel_expr_evaluator.h>
 #include <third_party/nvfuser/lower2device.h>
+#include <third_party/nvfuser/utils.h>
 
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace torch {
@@ -63,6 +68,114 @@ std::pair<NvrtcFunction, std::string> nvrtcCompile(
     int id,
     c10::optional<int> opt_block_size = c10::nullopt);
 
+//! A loaded kernel, owning its module. The module is unloaded when the last
+//!  executor using the kernel is destroyed.
+struct TORCH_CUDA_CU_API CompiledKernel : public NonCopyable {
+  CompiledKernel(NvrtcFunction nvrtc_function, std::string log)
+      : module(nvrtc_function.module),
+        function(nvrtc_function.function),
+        compiler_log(std::move(log)) {}
+
+  ~CompiledKernel();
+
+  //! Raises the dynamic shared memory limit of function to at least smem.
+  //!  The function is shared by the executors of the kernel, see
+  //!  Note [Compiled Kernel Registry], so the limit is never lowered.
+  void ensureDynamicSmem(int64_t smem) const;
+
+  CUmodule module = CUmodule();
+  CUfunction function = CUfunction();
+  std::string compiler_log;
+
+ private:
+  //! Current limit of function, -1 until it's first queried
+  mutable std::atomic<int64_t> max_dynamic_smem_{-1};
+  //! Serializes raising the limit
+  mutable std::mutex dynamic_smem_mutex_;
+};
+
+//! Note [Compiled Kernel Registry]
+//!
+//! Repeated layers of a model produce many segments that are scheduled
+//!  identically, yet each FusionKernelRuntime owns its own executors, and
+//!  each of them calls NVRTC and loads its own CUmodule.
+//!
+//! CompiledKernelRegistry is a process-wide map from the generated code and
+//!  everything else that determines the compilation, i.e. the device, the
+//!  block size bounding the register count and the compile flags, to the
+//!  loaded kernel. Executors generating the same code share one module and
+//!  function handle. The kernel name embeds the fusion id of the executor, so
+//!  the name is replaced in the key.
+//!
+//! The registry only keeps weak references. Executors own the kernel, and
+//!  its module is unloaded once the last of them is gone. Launches hold a
+//!  reference as well, so recompiling for a larger block size doesn't unload
+//!  a module that's still being launched.
+//!
+//! Can be disabled with PYTORCH_NVFUSER_DISABLE=kernel_registry, and stats
+//!  are printed with PYTORCH_NVFUSER_DUMP=kernel_registry_stats.
+class TORCH_CUDA_CU_API CompiledKernelRegistry : public NonCopyable {
+ public:
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    //! Number of kernels that are still loaded
+    size_t live = 0;
+  };
+
+  //! The process-wide instance
+  static CompiledKernelRegistry& get();
+
+  //! Build the lookup key of compiling code, which defines kernel_name
+  static std::string makeKey(
+      const std::string& code,
+      const std::string& kernel_name,
+      c10::optional<int> opt_block_size);
+
+  //! Returns the loaded kernel, nullptr if none is alive
+  std::shared_ptr<const CompiledKernel> lookup(const std::string& key);
+
+  //! Register kernel under key. Returns the registered kernel, which is an
+  //!  existing one if another thread compiled the same code first.
+  std::shared_ptr<const CompiledKernel> insert(
+      const std::string& key,
+      std::shared_ptr<const CompiledKernel> kernel);
+
+  //! Forget all kernels. Loaded kernels stay valid for their owners.
+  void clear();
+
+  Stats stats();
+
+  std::string statsString();
+
+ private:
+  CompiledKernelRegistry() = default;
+
+  //! Drop the entries of unloaded kernels
+  void pruneExpired();
+
+  std::mutex mutex_;
+
+  std::unordered_map<std::string, std::weak_ptr<const CompiledKernel>>
+      entries_;
+
+  //! Number of entries at which expired ones are pruned on insertion
+  size_t prune_threshold_ = 0;
+
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+};
+
+//! Returns the kernel compiled from code, reusing the loaded kernel of an
+//!  identical compilation if there is one, see Note [Compiled Kernel
+//!  Registry]. kernel_name is the unqualified name of the kernel in code.
+std::shared_ptr<const CompiledKernel> getCompiledKernel(
+    const std::string& code,
+    const std::string& kernel_name,
+    const std::string& func_name,
+    int id,
+    c10::optional<int> opt_block_size = c10::nullopt);
+
 namespace caching {
 // TODO: Could consider putting some of
 //  the logic in the common space and re-use
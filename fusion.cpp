@@ -12,6 +12,10 @@
 #include <third_party/nvfuser/kernel.h>
 #include <third_party/nvfuser/lower2device.h>
 
+#include <array>
+#include <atomic>
+#include <iomanip>
+
 namespace torch {
 namespace jit {
 namespace fuser {
@@ -19,6 +23,22 @@ namespace cuda {
 
 static thread_local Fusion* ACTIVE_FUSION = nullptr; // NOLINT
 
+namespace {
+
+// Analyses memoized by Fusion, see Note [Fusion Analysis Cache]
+enum AnalysisId : size_t { kExprs = 0, kUsedMathVals, kAllTvs, kNumAnalyses };
+
+constexpr std::array<const char*, kNumAnalyses> kAnalysisNames{
+    "exprs",
+    "usedMathVals",
+    "allTvs"};
+
+// Process-wide counters, static storage so they're zero initialized
+std::array<std::atomic<int64_t>, kNumAnalyses> analysis_cache_hits;
+std::array<std::atomic<int64_t>, kNumAnalyses> analysis_cache_misses;
+
+} // namespace
+
 FusionGuard::FusionGuard(Fusion* fusion) {
   prev_fusion = ACTIVE_FUSION;
   ACTIVE_FUSION = fusion;
@@ -141,6 +161,57 @@ void Fusion::clear() noexcept {
   is_during_update_uses_ = false;
 }
 
+template <typename T, typename ComputeFn>
+const std::vector<T>& Fusion::getCachedAnalysis(
+    CachedAnalysis<T>& cache,
+    size_t analysis_id,
+    ComputeFn compute) {
+  // Uses are in flux while they're being reset, don't cache anything
+  // computed in the middle of that.
+  if (is_during_update_uses_) {
+    cache.version = -1;
+    cache.result = compute();
+    return cache.result;
+  }
+
+  if (cache.version == version()) {
+    analysis_cache_hits[analysis_id]++;
+    return cache.result;
+  }
+
+  analysis_cache_misses[analysis_id]++;
+  cache.result = compute();
+  // Record the version after computing, the traversal itself may reset uses
+  // which bumps the version.
+  cache.version = version();
+  return cache.result;
+}
+
+std::string Fusion::analysisCacheStats() {
+  std::stringstream ss;
+  ss << "Fusion analysis cache {\n";
+  for (const auto i : c10::irange((size_t)kNumAnalyses)) {
+    auto hits = analysis_cache_hits[i].load();
+    auto misses = analysis_cache_misses[i].load();
+    ss << "  " << kAnalysisNames[i] << ": " << hits << " hits, " << misses
+       << " misses";
+    if (hits + misses > 0) {
+      ss << " (" << std::fixed << std::setprecision(1)
+         << 100.0 * (double)hits / (double)(hits + misses) << "% hit rate)";
+    }
+    ss << "\n";
+  }
+  ss << "}\n";
+  return ss.str();
+}
+
+void Fusion::resetAnalysisCacheStats() {
+  for (const auto i : c10::irange((size_t)kNumAnalyses)) {
+    analysis_cache_hits[i] = 0;
+    analysis_cache_misses[i] = 0;
+  }
+}
+
 void Fusion::removeExpr(Expr* expr) {
   assertInContainer(expr, "Cannot remove expr ");
   // If we hit this error too frequently, we could lighten the restrictions so
@@ -203,6 +274,7 @@ void Fusion::addInput(Val* input) {
   input->setIsFusionInput(true);
 
   all_tv_uses_valid_ = false;
+  bumpVersion();
 }
 
 void Fusion::addOutput(Val* output) {
@@ -228,6 +300,7 @@ void Fusion::addOutput(Val* output) {
   output->setIsFusionOutput(true);
 
   all_tv_uses_valid_ = false;
+  bumpVersion();
 }
 
 void Fusion::removeInput(Val* input) {
@@ -237,6 +310,7 @@ void Fusion::removeInput(Val* input) {
   }
   input->setIsFusionInput(false);
   all_tv_uses_valid_ = false;
+  bumpVersion();
 }
 
 void Fusion::removeOutput(Val* output) {
@@ -246,6 +320,7 @@ void Fusion::removeOutput(Val* output) {
   }
   output->setIsFusionOutput(false);
   all_tv_uses_valid_ = false;
+  bumpVersion();
 }
 
 void Fusion::replaceOutput(Val* output, Val* replacement) {
@@ -267,6 +342,7 @@ void Fusion::replaceOutput(Val* output, Val* replacement) {
       output->setIsFusionOutput(false);
       output->as<TensorView>()->setMemoryType(MemoryType::Local);
     }
+    bumpVersion();
     resetTvUses();
   }
 
@@ -280,7 +356,9 @@ void Fusion::replaceOutput(Val* output, Val* replacement) {
 }
 
 std::vector<Expr*> Fusion::exprs() {
-  return StmtSort::getExprs(this);
+  return getCachedAnalysis(exprs_cache_, kExprs, [this]() {
+    return StmtSort::getExprs(this, getTerminatingOutputs());
+  });
 }
 
 std::vector<Val*> Fusion::inputsOf(Val* val) {
@@ -481,17 +559,20 @@ void Fusion::resetTvUses() {
 
   all_tv_uses_valid_ = true;
   is_during_update_uses_ = false;
+  bumpVersion();
 }
 
-std::vector<Val*> Fusion::usedMathVals() {
+namespace {
+
+std::vector<Val*> computeUsedMathVals(Fusion* fusion) {
   // Note that using fusion->inputs() as the argument for the first
   // parameter of getAllValsBetween does not grab all used vals as
   // there can be vals that are created inside a fusion without using
   // anything from inputs. See, for example, tv0 in the
   // FusionOuterSplit test.
-  const auto inputs = InputsOf::outputs(this, outputs());
+  const auto inputs = InputsOf::outputs(fusion, fusion->outputs());
   auto used_math_vals = DependencyCheck::getAllValsBetween(
-      {inputs.begin(), inputs.end()}, outputs());
+      {inputs.begin(), inputs.end()}, fusion->outputs());
   // When an expre has multiple outputs and only some of them are
   // used, the rest aren't included in used_math_vals as they are not
   // used. However, we want them to be included as they must show up
@@ -521,6 +602,35 @@ std::vector<Val*> Fusion::usedMathVals() {
   return used_math_vals;
 }
 
+} // namespace
+
+std::vector<Val*> Fusion::usedMathVals() {
+  return getCachedAnalysis(used_math_vals_cache_, kUsedMathVals, [this]() {
+    return computeUsedMathVals(this);
+  });
+}
+
+std::vector<TensorView*> Fusion::allTvs() {
+  return getCachedAnalysis(all_tvs_cache_, kAllTvs, [this]() {
+    auto used_vals = usedMathVals();
+    auto used_tvs = ir_utils::filterByType<TensorView>(used_vals);
+
+    // This shouldn't be necessary but FusionSegmentIoAlias_CUDA due to
+    // aliasing is having an input disconnected from outputs, and these iter
+    // domains are being checked in compute at maps in scheduling logic. This
+    // shouldn't hurt AFAICT.
+    auto tv_inputs = ir_utils::filterByType<TensorView>(inputs());
+
+    // Sometimes inputs are not connected to outputs, however, we still
+    // include them when returning allTvs because they are registered as an
+    // input. Inputs can also be used so deduplicate while inserting.
+    VectorOfUniqueEntries<TensorView*> all_tvs;
+    all_tvs.insert(used_tvs.begin(), used_tvs.end());
+    all_tvs.insert(tv_inputs.begin(), tv_inputs.end());
+    return all_tvs.vector();
+  });
+}
+
 std::vector<Val*> Fusion::terminatingMathVals() {
   VectorOfUniqueEntries<Val*> result;
   auto used_vals = usedMathVals();
@@ -151,6 +151,10 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
   //! also included as they must show up in the final code.
   std::vector<Val*> usedMathVals();
 
+  //! Return all TensorViews in math expressions that cannot be eliminated,
+  //! as well as all TensorView inputs of the fusion.
+  std::vector<TensorView*> allTvs();
+
   //! Returns all vals that are produced by used math expressions and
   //!  also do not have further consumers.
   //!
@@ -229,6 +233,11 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
     return io_alias_;
   }
 
+  //! Process-wide hit and miss counts of the analysis cache, see
+  //! Note [Fusion Analysis Cache]
+  static std::string analysisCacheStats();
+  static void resetAnalysisCacheStats();
+
  protected:
   friend SegmentCandidateFinder;
   friend SegmentedFusion;
@@ -258,6 +267,27 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
   // Same DataType, ValType, and number of dimensions
   bool isAliasCompatible(Val* left, Val* right);
 
+  // Note [Fusion Analysis Cache]
+  //
+  // exprs(), usedMathVals() and allTvs() are called over and over by the
+  // schedulers, the segmenter and lowering on a fusion that isn't changing,
+  // and each call is a full traversal of the fusion. Their results are
+  // memoized along with the IrContainer::version() they were computed at, and
+  // recomputed once the version moves. On top of the container mutations,
+  // changing fusion inputs/outputs and resetting TensorView uses also bump the
+  // version as traversals start from the terminating outputs.
+  template <typename T>
+  struct CachedAnalysis {
+    int64_t version = -1;
+    std::vector<T> result;
+  };
+
+  template <typename T, typename ComputeFn>
+  const std::vector<T>& getCachedAnalysis(
+      CachedAnalysis<T>& cache,
+      size_t analysis_id,
+      ComputeFn compute);
+
  private:
   // Fusion inputs and outputs
   std::vector<Val*> inputs_;
@@ -276,6 +306,12 @@ class TORCH_CUDA_CU_API Fusion : public IrContainer {
   //  the states are either all valid or all invalid
   bool all_tv_uses_valid_ = false;
   bool is_during_update_uses_ = false;
+
+  // See Note [Fusion Analysis Cache], these are never copied or moved with
+  // the IR, versions of both fusions are bumped instead.
+  CachedAnalysis<Expr*> exprs_cache_;
+  CachedAnalysis<Val*> used_math_vals_cache_;
+  CachedAnalysis<TensorView*> all_tvs_cache_;
 };
 
 } // namespace cuda
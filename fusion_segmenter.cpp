@@ -9,7 +9,13 @@
 #include <third_party/nvfuser/ir_utils.h>
 #include <third_party/nvfuser/scheduler/debug_utils.h>
 
+#include <c10/core/thread_pool.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 namespace torch {
 namespace jit {
@@ -1185,6 +1191,43 @@ std::string toString(SegmentedFusion* segmented_fusion) {
   return ss.str();
 }
 
+std::vector<std::vector<SegmentedGroup*>> SegmentedFusion::
+    independentGroupWaves() const {
+  // A group's wave is one past the latest wave of its producers
+  std::unordered_map<SegmentedGroup*, size_t> group_wave;
+  std::vector<std::vector<SegmentedGroup*>> waves;
+  while (group_wave.size() < groups_.size()) {
+    bool one_placed = false;
+    for (auto group : groups_) {
+      if (group_wave.count(group)) {
+        continue;
+      }
+      size_t wave = 0;
+      bool ready = true;
+      for (auto edge : group->producer_edges) {
+        auto producer_wave_it = group_wave.find(edge->from);
+        if (producer_wave_it == group_wave.end()) {
+          ready = false;
+          break;
+        }
+        wave = std::max(wave, producer_wave_it->second + 1);
+      }
+      if (!ready) {
+        continue;
+      }
+      group_wave[group] = wave;
+      if (waves.size() <= wave) {
+        waves.resize(wave + 1);
+      }
+      waves[wave].push_back(group);
+      one_placed = true;
+    }
+    TORCH_INTERNAL_ASSERT(
+        one_placed, "Segmented groups have a cyclic dependency.");
+  }
+  return waves;
+}
+
 std::unique_ptr<Fusion> SegmentedFusion::makeFusion(SegmentedGroup* sg) {
   std::unique_ptr<Fusion> fusion_segment = std::make_unique<Fusion>();
 
@@ -1340,6 +1383,7 @@ void SegmentCandidateFinder::eraseGroups(
 }
 
 SegmentedGroup* SegmentCandidateFinder::mergeNodes() {
+  probed_merges_.clear();
   SegmentedGroup* last_merged = nullptr;
   auto it = to_merge_.begin();
   TORCH_INTERNAL_ASSERT(to_merge_.size() % 2 == 0);
@@ -1445,6 +1489,8 @@ SegmentedGroup* SegmentCandidateFinder::mergeAllGivenGroups(
       !groups_to_merge.empty(),
       "fusion segment :(mergeAllGivenGroups) tried to merge no groups")
 
+  probed_merges_.clear();
+
   // Make a set to detect internal edges
   std::unordered_set<SegmentedGroup*> group_set(
       groups_to_merge.begin(), groups_to_merge.end());
@@ -1673,6 +1719,15 @@ c10::optional<std::unique_ptr<SchedulerEntry>> SegmentedGroup::
           heuristic(), fusion, runtime_info, data_cache)) {
     return c10::nullopt;
   }
+  // Compile-time info is recorded on the first check of a group rather than
+  //  when the group is first scheduled, see makeInitialSchedulerEntry
+  if (data_cache == nullptr) {
+    auto data_cache_ptr =
+        std::make_unique<HeuristicSummary>(fusion, heuristic(), runtime_info);
+    data_cache = data_cache_ptr.get();
+    segmented_fusion_->setCachedHeuristicDataFor(
+        this, std::move(data_cache_ptr));
+  }
   return SchedulerEntry::makeEntry(
       heuristic(), fusion, runtime_info, data_cache);
 }
@@ -2629,11 +2684,132 @@ bool SegmentCandidateFinder::codeGenSupportedMerge(
   TORCH_INTERNAL_ASSERT(
       areDirectlyConnected(group1, group2),
       "only support testing immediate producer-consumer groups");
+  auto probed_it = probed_merges_.find({group1, group2});
+  if (probed_it != probed_merges_.end()) {
+    return probed_it->second;
+  }
   Fusion* fusion = segmented_fusion_->completeFusion();
   auto h = tryMerge(fusion, runtime_info_, group1, group2);
+  probed_merges_[{group1, group2}] = h.has_value();
   return h.has_value();
 }
 
+namespace {
+
+// Segmentation can itself run on the compile thread pool of kernel_cache.cpp,
+//  so probes get a pool of their own to avoid waiting behind the segmenter.
+c10::ThreadPool* getProbeThreadPool() {
+  static c10::ThreadPool pool(
+      std::max(1, static_cast<int>(std::thread::hardware_concurrency())));
+  return &pool;
+}
+
+// Number of probes that can be in flight at once, counting the calling thread
+size_t probeConcurrency() {
+  return getProbeThreadPool()->size() + 1;
+}
+
+} // namespace
+
+// Note [Parallel Merge Probing]
+//  Nearly all of the segmenter's time goes to tryMerge, i.e. running
+//  canSchedule of every scheduler on the would-be merged segment. Probes of
+//  different group pairs are independent, but they can't share the complete
+//  fusion since FusionSegmentGuard rewrites its inputs and outputs. Each
+//  worker instead probes on a private copy of the complete fusion with its
+//  own SchedulerRuntimeInfo, and the results are recorded in probed_merges_.
+//
+//  Selection of the pairs to merge is left to the serial loops of
+//  findSegments and finalMerge, which read the recorded results through
+//  codeGenSupportedMerge. They visit pairs in the same order as without
+//  parallel probing, so the segmentation is identical either way; the
+//  parallel path only probes some pairs the serial one would have skipped.
+void SegmentCandidateFinder::probeMergesInParallel(
+    const std::vector<std::pair<SegmentedGroup*, SegmentedGroup*>>& pairs) {
+  FUSER_PERF_SCOPE("SegmentCandidateFinder::probeMergesInParallel");
+
+  // Segment boundaries are resolved here, the workers only see the vals
+  std::vector<std::pair<SegmentedGroup*, SegmentedGroup*>> to_probe;
+  std::vector<std::vector<Val*>> probe_inputs;
+  std::vector<std::vector<Val*>> probe_outputs;
+  for (const auto& pair : pairs) {
+    if (probed_merges_.count(pair) ||
+        std::find(to_probe.begin(), to_probe.end(), pair) != to_probe.end()) {
+      continue;
+    }
+    to_probe.push_back(pair);
+    probe_inputs.push_back(getAllInputs(pair.first, pair.second));
+    probe_outputs.push_back(getAllOutputs(pair.first, pair.second));
+  }
+
+  // Not worth copying the fusion for, leave it to codeGenSupportedMerge
+  if (to_probe.size() < 2) {
+    return;
+  }
+
+  Fusion* complete_fusion = completeFusion();
+  std::vector<char> results(to_probe.size(), false);
+  std::atomic<size_t> next_probe{0};
+
+  const size_t num_workers = std::min(to_probe.size(), probeConcurrency());
+  std::mutex mutex;
+  std::condition_variable workers_done;
+  size_t running_workers = num_workers;
+  std::exception_ptr probe_error;
+
+  auto probe_worker = [&]() {
+    std::unique_ptr<Fusion> probe_fusion;
+    c10::optional<IrCloner> ir_cloner;
+    std::unique_ptr<SchedulerRuntimeInfo> probe_runtime_info;
+    try {
+      for (size_t probe_i = next_probe++; probe_i < to_probe.size();
+           probe_i = next_probe++) {
+        // Copy lazily, a worker can start after all probes are taken
+        if (probe_fusion == nullptr) {
+          probe_fusion = std::make_unique<Fusion>();
+          ir_cloner.emplace(Fusion::copy(complete_fusion, probe_fusion.get()));
+          probe_runtime_info = std::make_unique<SchedulerRuntimeInfo>(
+              probe_fusion.get(), runtime_inputs_, true);
+        }
+        FusionSegmentGuard fsg(
+            probe_fusion.get(),
+            ir_cloner->clone(probe_inputs[probe_i]),
+            ir_cloner->clone(probe_outputs[probe_i]));
+        results[probe_i] = SchedulerEntry::proposeHeuristics(
+                               probe_fusion.get(), *probe_runtime_info)
+                               .has_value();
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(mutex);
+      if (!probe_error) {
+        probe_error = std::current_exception();
+      }
+      next_probe = to_probe.size();
+    }
+    std::lock_guard<std::mutex> guard(mutex);
+    if (--running_workers == 0) {
+      workers_done.notify_all();
+    }
+  };
+
+  for (size_t worker_i = 1; worker_i < num_workers; worker_i++) {
+    getProbeThreadPool()->run(probe_worker);
+  }
+  probe_worker();
+
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    workers_done.wait(lock, [&]() { return running_workers == 0; });
+  }
+  if (probe_error) {
+    std::rethrow_exception(probe_error);
+  }
+
+  for (const auto probe_i : c10::irange(to_probe.size())) {
+    probed_merges_[to_probe[probe_i]] = results[probe_i];
+  }
+}
+
 // TODO: consider caching the heuristics value so tryMerge doesn't have to be
 //       called twice
 ScheduleHeuristic SegmentCandidateFinder::deriveHeuristic(
@@ -2650,6 +2826,9 @@ SegmentCandidateFinder::SegmentCandidateFinder(
     SegmentCandidateFinderOptions options)
     : options_(options),
       runtime_info_(fusion.get(), inputs, true),
+      parallel_probing_(
+          options.run_parallel_probing ||
+          isOptionEnabled(EnableOption::ParallelSegmenter)),
       runtime_inputs_(inputs) {
   segmented_fusion_ = std::make_unique<SegmentedFusion>(std::move(fusion));
   findSegments();
@@ -2846,6 +3025,18 @@ void SegmentCandidateFinder::findSegments() {
 
       resetLevels();
 
+      if (parallel_probing_) {
+        // No group is marked merged yet, so this covers every pair the loop
+        //  below can ask for
+        std::vector<std::pair<SegmentedGroup*, SegmentedGroup*>> pairs;
+        for (auto group : groups()) {
+          for (const auto& candidate : group->getMergeCandidates()) {
+            pairs.emplace_back(group, candidate.group);
+          }
+        }
+        probeMergesInParallel(pairs);
+      }
+
       for (auto& group : groups()) {
         if (group->merged_) {
           continue;
@@ -2900,38 +3091,83 @@ void SegmentCandidateFinder::findSegments() {
 void SegmentCandidateFinder::finalMerge() {
   auto producer_check = getGroupDependency();
 
+  // Consumers of producer_group it could be merged with, along with the edge
+  //  they would be merged through
+  auto get_merge_candidates = [&producer_check](
+                                  SegmentedGroup* producer_group) {
+    // Populate consumers and their corresponding consumer edges
+    std::unordered_map<SegmentedGroup*, SegmentedEdge*> consumer_edge_map;
+    std::vector<SegmentedGroup*> all_consumers_of_producer_group;
+    for (auto consumer : producer_group->consumer_edges) {
+      // Since this is the last fusion pass, we can enable fusion through
+      // outputs. Priority of this was decreased because if the only
+      // connection between groups is an output node, best case scenario we
+      // can save a single pass in memory. Where if it wasn't an output it
+      // would be two passes.
+      consumer_edge_map.insert({consumer->to, consumer});
+    }
+    // Populate all consumers from the map to avoid duplicate
+    std::transform(
+        consumer_edge_map.begin(),
+        consumer_edge_map.end(),
+        std::back_inserter(all_consumers_of_producer_group),
+        [](auto& it) { return it.first; });
+
+    std::vector<std::pair<SegmentedGroup*, SegmentedEdge*>> candidates;
+    for (auto consumer : all_consumers_of_producer_group) {
+      if (!producer_check->isConsumerOfAny(
+              consumer, all_consumers_of_producer_group)) {
+        candidates.emplace_back(consumer, consumer_edge_map.at(consumer));
+      }
+    }
+    return candidates;
+  };
+
   bool merged_nodes = true;
   while (merged_nodes) {
+    if (parallel_probing_) {
+      // Only one pair is merged per iteration, so probe in batches in the
+      //  order the loop below visits the pairs and stop at the first batch
+      //  with a mergeable pair
+      const size_t batch_size = 2 * probeConcurrency();
+      std::vector<std::pair<SegmentedGroup*, SegmentedGroup*>> batch;
+      auto probe_batch = [&]() {
+        probeMergesInParallel(batch);
+        bool found = std::any_of(batch.begin(), batch.end(), [&](auto& pair) {
+          auto probed_it = probed_merges_.find(pair);
+          return probed_it != probed_merges_.end() && probed_it->second;
+        });
+        batch.clear();
+        return found;
+      };
+      bool found = false;
+      for (auto producer_group : groups()) {
+        for (const auto& candidate : get_merge_candidates(producer_group)) {
+          batch.emplace_back(producer_group, candidate.first);
+        }
+        if (batch.size() >= batch_size) {
+          found = probe_batch();
+          if (found) {
+            break;
+          }
+        }
+      }
+      if (!found && !batch.empty()) {
+        probe_batch();
+      }
+    }
+
     // Iterate all groups and check if a group
     //  can merge with one of its consumers
     for (auto producer_group : groups()) {
-      // Populate consumers and their corresponding consumer edges
-      std::unordered_map<SegmentedGroup*, SegmentedEdge*> consumer_edge_map;
-      std::vector<SegmentedGroup*> all_consumers_of_producer_group;
-      for (auto consumer : producer_group->consumer_edges) {
-        // Since this is the last fusion pass, we can enable fusion through
-        // outputs. Priority of this was decreased because if the only
-        // connection between groups is an output node, best case scenario we
-        // can save a single pass in memory. Where if it wasn't an output it
-        // would be two passes.
-        consumer_edge_map.insert({consumer->to, consumer});
-      }
-      // Populate all consumers from the map to avoid duplicate
-      std::transform(
-          consumer_edge_map.begin(),
-          consumer_edge_map.end(),
-          std::back_inserter(all_consumers_of_producer_group),
-          [](auto& it) { return it.first; });
-
-      for (auto consumer : all_consumers_of_producer_group) {
-        if (!producer_check->isConsumerOfAny(
-                consumer, all_consumers_of_producer_group) &&
-            codeGenSupportedMerge(producer_group, consumer)) {
+      for (const auto& candidate : get_merge_candidates(producer_group)) {
+        auto consumer = candidate.first;
+        if (codeGenSupportedMerge(producer_group, consumer)) {
           to_merge_.emplace_back(producer_group);
           to_merge_.emplace_back(consumer);
           producer_group->merged_ = true;
           producer_group->merge_with_ = consumer;
-          producer_group->merge_through_ = consumer_edge_map.at(consumer);
+          producer_group->merge_through_ = candidate.second;
           consumer->merged_ = true;
           consumer->merge_with_ = producer_group;
           consumer->merge_through_ = producer_group->merge_through_;
@@ -3119,14 +3355,12 @@ FusionKernelRuntime::SchedulerEntryPtr SegmentedFusion::
         SchedulerRuntimeInfo& runtime_info) {
   auto local_fusion = completeFusion();
   FusionSegmentGuard fsg(local_fusion, getAllInputs(sg), getAllOutputs(sg));
-  // This will be the first time each group is scheduled. So we'd want to
-  //  construct the cache data here.
-  auto data_cache_ptr = std::make_unique<HeuristicSummary>(
-      local_fusion, sg->heuristic(), runtime_info);
-  auto data_cache = data_cache_ptr.get();
-  setCachedHeuristicDataFor(sg, std::move(data_cache_ptr));
+  // The compile-time info cache is not recorded here. A structurally equal
+  //  segment may have been scheduled before, in which case makeEntry skips
+  //  the analysis altogether (see Note [Heuristic Params Cache]). The cache
+  //  is instead recorded by the first getMaybeSchedulerEntry on the group.
   return SchedulerEntry::makeEntry(
-      sg->heuristic(), local_fusion, runtime_info, data_cache);
+      sg->heuristic(), local_fusion, runtime_info);
 }
 
 std::unique_ptr<FusionHeuristics> SegmentedFusion::makeInitialHeuristics(
@@ -3237,6 +3471,9 @@ std::string toString(const SegmentCandidateFinderOptions& segment_options) {
   if (segment_options.run_final_merge) {
     ss << "final merging\n";
   }
+  if (segment_options.run_parallel_probing) {
+    ss << "parallel probing\n";
+  }
   ss << "\n}\n";
   return ss.str();
 }
@@ -9,6 +9,7 @@
 
 #include <deque>
 #include <list>
+#include <map>
 #include <unordered_set>
 #include <vector>
 
@@ -305,6 +306,12 @@ class TORCH_CUDA_CU_API SegmentedFusion {
   //! Make a clone of the group and convert to fusion
   std::unique_ptr<Fusion> makeFusion(SegmentedGroup* sg);
 
+  //! Partitions the groups into waves of independent groups, i.e. groups
+  //!  with no edges between them. Each wave only consumes outputs of earlier
+  //!  waves, so the groups of a wave can run as a single horizontal kernel.
+  //!  See Note [Horizontal Fusion]
+  std::vector<std::vector<SegmentedGroup*>> independentGroupWaves() const;
+
   //! Make heuristics for all groups in this segmented fusion
   std::unique_ptr<FusionHeuristics> makeInitialHeuristics(
       const KernelArgumentHolder& inputs);
@@ -329,6 +336,11 @@ class TORCH_CUDA_CU_API SegmentedFusion {
 
   HeuristicSummary* getCachedHeuristicDataFor(SegmentedGroup* group);
 
+  //! Keep heuristic checking intermediate data
+  void setCachedHeuristicDataFor(
+      SegmentedGroup* group,
+      std::unique_ptr<HeuristicSummary> data);
+
  private:
   //! Unique name for segmented fusion
   int segmented_fusion_name_;
@@ -384,11 +396,6 @@ class TORCH_CUDA_CU_API SegmentedFusion {
   //!  groups that will cast to fp16
   void annotateFP16IntermediateTensors();
 
-  //! Keep heuristic checking intermediate data
-  void setCachedHeuristicDataFor(
-      SegmentedGroup* group,
-      std::unique_ptr<HeuristicSummary> data);
-
   //! Utility to give unique name for each segmented fusion
   static size_t segmentedFusionName() {
     static size_t counter = 0;
@@ -415,6 +422,9 @@ struct TORCH_CUDA_CU_API SegmentCandidateFinderOptions {
   bool run_combine_reductions = true;
   bool run_herrmann_merge = true;
   bool run_final_merge = true;
+  //! Probe candidate merges concurrently on private copies of the fusion,
+  //!  see Note [Parallel Merge Probing]
+  bool run_parallel_probing = false;
 };
 
 //!  SegmentCandidateFinder
@@ -490,6 +500,11 @@ class TORCH_CUDA_CU_API SegmentCandidateFinder {
 
   bool codeGenSupportedMerge(SegmentedGroup* group1, SegmentedGroup* group2);
 
+  //! Run the canSchedule probes of the given group pairs on a thread pool
+  //!  and record the results in probed_merges_
+  void probeMergesInParallel(
+      const std::vector<std::pair<SegmentedGroup*, SegmentedGroup*>>& pairs);
+
   void findSegments();
 
   std::unordered_set<SegmentedEdge*> disconnectGroup(SegmentedGroup* group);
@@ -596,6 +611,15 @@ class TORCH_CUDA_CU_API SegmentCandidateFinder {
 
   SchedulerRuntimeInfo runtime_info_;
 
+  //! Dispatch merge probes to a thread pool, from options or
+  //!  PYTORCH_NVFUSER_ENABLE=parallel_segmenter
+  bool parallel_probing_ = false;
+
+  //! Results of codeGenSupportedMerge in the current merge round. Cleared
+  //!  whenever groups are merged, as the boundaries of the probed segments
+  //!  may change with them.
+  std::map<std::pair<SegmentedGroup*, SegmentedGroup*>, bool> probed_merges_;
+
   //! Note:
   //!  Segmenter should eventually rely only on runtime_info_ for
   //!  safe caching. runtime_inputs_ is only used in translateWelford
@@ -0,0 +1,454 @@
+#include <third_party/nvfuser/fusion_signature.h>
+
+#include <third_party/nvfuser/instrumentation.h>
+#include <third_party/nvfuser/ir_all_nodes.h>
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cuda {
+
+namespace {
+
+// Tags separating the parts of the encoding, so that differently shaped
+//  fusions can't produce the same token stream
+enum class Tag : int64_t {
+  NewVal = 1,
+  ValRef,
+  Expr,
+  Symbolic,
+  Constant,
+  NamedScalar,
+  TensorDomain,
+  RFactor,
+  Inputs,
+  Outputs,
+  Aliases,
+  InputPermutations,
+  OutputPermutations
+};
+
+class SignatureEncoder {
+ public:
+  static std::vector<int64_t> encode(Fusion* fusion) {
+    SignatureEncoder encoder;
+    encoder.encodeFusion(fusion);
+    return std::move(encoder.tokens_);
+  }
+
+ private:
+  void push(Tag tag) {
+    tokens_.push_back(static_cast<int64_t>(tag));
+  }
+
+  template <typename T>
+  void push(T value) {
+    tokens_.push_back(static_cast<int64_t>(value));
+  }
+
+  void pushDouble(double value) {
+    int64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    tokens_.push_back(bits);
+  }
+
+  template <typename T>
+  void pushVector(const std::vector<T>& values) {
+    push(values.size());
+    for (const auto& value : values) {
+      push(value);
+    }
+  }
+
+  void encodeFusion(Fusion* fusion) {
+    push(Tag::Inputs);
+    push(fusion->inputs().size());
+    for (auto inp : fusion->inputs()) {
+      encodeUse(inp);
+    }
+
+    std::vector<Expr*> exprs;
+    std::unordered_set<Expr*> visited;
+    for (auto out : fusion->outputs()) {
+      collectExprs(out, true, visited, exprs);
+    }
+    for (auto expr : exprs) {
+      encodeExpr(expr);
+    }
+
+    push(Tag::Outputs);
+    push(fusion->outputs().size());
+    for (auto out : fusion->outputs()) {
+      encodeUse(out);
+    }
+
+    // Aliases and permutations are keyed on inputs and outputs, encode them
+    //  by position in a fixed order
+    auto position_of = [](const std::vector<Val*>& vals, Val* val) {
+      return std::distance(
+          vals.begin(), std::find(vals.begin(), vals.end(), val));
+    };
+    std::vector<std::pair<int64_t, int64_t>> aliases;
+    for (const auto& alias : fusion->ioAlias()) {
+      aliases.emplace_back(
+          position_of(fusion->outputs(), alias.first),
+          position_of(fusion->inputs(), alias.second));
+    }
+    std::sort(aliases.begin(), aliases.end());
+    push(Tag::Aliases);
+    push(aliases.size());
+    for (const auto& alias : aliases) {
+      push(alias.first);
+      push(alias.second);
+    }
+
+    encodePermutations(
+        Tag::InputPermutations, fusion->getPermutationInputMap());
+    encodePermutations(
+        Tag::OutputPermutations, fusion->getPermutationOutputMap());
+  }
+
+  void encodePermutations(
+      Tag tag,
+      const std::unordered_map<int, std::vector<int64_t>>& map) {
+    std::vector<int> positions;
+    for (const auto& entry : map) {
+      positions.push_back(entry.first);
+    }
+    std::sort(positions.begin(), positions.end());
+    push(tag);
+    push(positions.size());
+    for (auto position : positions) {
+      push(position);
+      pushVector(map.at(position));
+    }
+  }
+
+  // Post-order DFS over definitions, visiting expr inputs in order
+  static void collectExprs(
+      Val* val,
+      bool stop_at_inputs,
+      std::unordered_set<Expr*>& visited,
+      std::vector<Expr*>& exprs) {
+    if (stop_at_inputs && val->isFusionInput()) {
+      return;
+    }
+    auto def = val->definition();
+    if (def == nullptr || !visited.insert(def).second) {
+      return;
+    }
+    for (auto inp : def->inputs()) {
+      collectExprs(inp, stop_at_inputs, visited, exprs);
+    }
+    exprs.push_back(def);
+  }
+
+  // Encode a val as an operand, defining it on first use
+  void encodeUse(Val* val) {
+    auto id_it = val_ids_.find(val);
+    if (id_it == val_ids_.end() && val->definition() != nullptr &&
+        !val->isA<TensorView>() && !val->isA<IterDomain>() &&
+        !val->isFusionInput()) {
+      // Scalars computed outside of the math exprs, e.g. extents of view
+      //  outputs, carry their definition along
+      encodeExpr(val->definition());
+      id_it = val_ids_.find(val);
+    }
+    if (id_it != val_ids_.end()) {
+      push(Tag::ValRef);
+      push(id_it->second);
+      return;
+    }
+    encodeNewVal(val);
+  }
+
+  void encodeNewVal(Val* val) {
+    auto id = static_cast<int64_t>(val_ids_.size());
+    val_ids_[val] = id;
+    push(Tag::NewVal);
+    push(val->getValType().value());
+    push(val->getDataType().value());
+
+    if (auto tv = dynamic_cast<TensorView*>(val)) {
+      encodeTensorView(tv);
+    } else if (auto id_val = dynamic_cast<IterDomain*>(val)) {
+      encodeIterDomain(id_val);
+    } else if (auto ns = dynamic_cast<NamedScalar*>(val)) {
+      push(Tag::NamedScalar);
+      pushVector(std::vector<char>(ns->name().begin(), ns->name().end()));
+    } else {
+      encodeScalar(val);
+    }
+  }
+
+  void encodeScalar(Val* val) {
+    if (auto bool_val = dynamic_cast<Bool*>(val)) {
+      if (bool_val->value().has_value()) {
+        push(Tag::Constant);
+        push(bool_val->value().value());
+        return;
+      }
+    } else if (auto int_val = dynamic_cast<Int*>(val)) {
+      if (int_val->value().has_value()) {
+        push(Tag::Constant);
+        push(int_val->value().value());
+        return;
+      }
+    } else if (auto double_val = dynamic_cast<Double*>(val)) {
+      if (double_val->value().has_value()) {
+        push(Tag::Constant);
+        pushDouble(double_val->value().value());
+        return;
+      }
+    } else if (auto complex_val = dynamic_cast<ComplexDouble*>(val)) {
+      if (complex_val->value().has_value()) {
+        push(Tag::Constant);
+        pushDouble(complex_val->value().value().real());
+        pushDouble(complex_val->value().value().imag());
+        return;
+      }
+    }
+    push(Tag::Symbolic);
+  }
+
+  void encodeIterDomain(IterDomain* id) {
+    push(id->getIterType());
+    push(id->getParallelType());
+    push(id->isRFactorProduct());
+    encodeUse(id->start());
+    encodeUse(id->extent());
+    encodeUse(id->stopOffset());
+    push(id->hasExpandedExtent());
+    if (id->hasExpandedExtent()) {
+      encodeUse(id->expandedExtent());
+    }
+  }
+
+  void encodeTensorView(TensorView* tv) {
+    auto td = tv->domain();
+    push(Tag::TensorDomain);
+    push(tv->getMemoryType());
+    push(td->getRootDomain().size());
+    for (auto id : td->getRootDomain()) {
+      encodeUse(id);
+    }
+
+    // Transformations from the root to the rfactor and leaf domains
+    std::vector<Expr*> id_exprs;
+    std::unordered_set<Expr*> visited;
+    for (auto id : td->getMaybeRFactorDomain()) {
+      collectExprs(id, false, visited, id_exprs);
+    }
+    for (auto id : td->domain()) {
+      collectExprs(id, false, visited, id_exprs);
+    }
+    for (auto expr : id_exprs) {
+      encodeExpr(expr);
+    }
+
+    push(Tag::RFactor);
+    push(td->hasRFactor());
+    if (td->hasRFactor()) {
+      push(td->getRFactorDomain().size());
+      for (auto id : td->getRFactorDomain()) {
+        encodeUse(id);
+      }
+    }
+    push(td->domain().size());
+    for (auto id : td->domain()) {
+      encodeUse(id);
+    }
+    pushVector(td->contiguity());
+  }
+
+  void encodeExpr(Expr* expr) {
+    if (!encoded_exprs_.insert(expr).second) {
+      return;
+    }
+    push(Tag::Expr);
+    push(expr->getExprType().value());
+    encodeAttributes(expr);
+    push(expr->inputs().size());
+    for (auto inp : expr->inputs()) {
+      encodeUse(inp);
+    }
+    push(expr->outputs().size());
+    for (auto out : expr->outputs()) {
+      if (val_ids_.count(out)) {
+        // Defined as a fusion input of a guarded segment
+        encodeUse(out);
+      } else {
+        encodeNewVal(out);
+      }
+    }
+  }
+
+  void encodeAttributes(Expr* expr) {
+    switch (expr->getExprType().value()) {
+      case ExprType::ARangeOp: {
+        auto op = expr->as<ARangeOp>();
+        encodeUse(op->start());
+        encodeUse(op->end());
+        encodeUse(op->step());
+        break;
+      }
+      case ExprType::UnaryOp:
+        push(expr->as<UnaryOp>()->getUnaryOpType());
+        break;
+      case ExprType::BinaryOp:
+        push(expr->as<BinaryOp>()->getBinaryOpType());
+        break;
+      case ExprType::TernaryOp:
+        push(expr->as<TernaryOp>()->getTernaryOpType());
+        break;
+      case ExprType::RNGOp:
+        push(expr->as<RNGOp>()->getRNGOpType());
+        push(expr->as<RNGOp>()->getRNGOffset());
+        break;
+      case ExprType::BroadcastOp:
+        pushVector(expr->as<BroadcastOp>()->getBroadcastDimFlags());
+        break;
+      case ExprType::ReductionOp: {
+        auto op = expr->as<ReductionOp>();
+        push(op->getReductionOpType());
+        push(op->isAllreduce());
+        encodeUse(op->init());
+        break;
+      }
+      case ExprType::GroupedReductionOp: {
+        auto op = expr->as<GroupedReductionOp>();
+        pushVector(op->getReductionOpTypes());
+        push(op->isAllreduce());
+        for (auto init : op->initVals()) {
+          encodeUse(init);
+        }
+        break;
+      }
+      case ExprType::WelfordOp: {
+        auto op = expr->as<WelfordOp>();
+        push(op->isAllreduce());
+        push(op->hasInit());
+        for (auto init : op->getInitVals()) {
+          encodeUse(init);
+        }
+        break;
+      }
+      case ExprType::GroupedWelfordOp: {
+        auto op = expr->as<GroupedWelfordOp>();
+        push(op->isAllreduce());
+        for (const auto& init : op->initVals()) {
+          encodeUse(init.avg());
+          encodeUse(init.var());
+          encodeUse(init.N());
+        }
+        break;
+      }
+      case ExprType::TransposeOp:
+        pushVector(expr->as<TransposeOp>()->old2new());
+        break;
+      case ExprType::ShiftOp:
+        pushVector(expr->as<ShiftOp>()->offsets());
+        pushVector(expr->as<ShiftOp>()->padWidth());
+        break;
+      case ExprType::GatherOp: {
+        auto op = expr->as<GatherOp>();
+        pushVector(op->windowShape());
+        push(op->padWidth().size());
+        for (const auto& pad_width : op->padWidth()) {
+          pushVector(pad_width);
+        }
+        break;
+      }
+      case ExprType::ViewAsScalar:
+        encodeUse(expr->as<ViewAsScalar>()->vector_id());
+        encodeUse(expr->as<ViewAsScalar>()->index());
+        break;
+      case ExprType::LoadStoreOp:
+        push(expr->as<LoadStoreOp>()->opType());
+        break;
+      case ExprType::Split: {
+        auto split = expr->as<Split>();
+        push(split->innerSplit());
+        encodeUse(split->factor());
+        encodeUse(split->startOffset());
+        encodeUse(split->stopOffset());
+        break;
+      }
+      case ExprType::Swizzle2D:
+        push(expr->as<Swizzle2D>()->swizzleType());
+        push(expr->as<Swizzle2D>()->swizzleMode());
+        break;
+      case ExprType::MmaOp: {
+        // Options are usually set by the matmul scheduler, but a fusion can
+        //  be built with them, e.g. to pick the operand layout
+        auto op = expr->as<MmaOp>();
+        push(op->init() != nullptr);
+        if (op->init() != nullptr) {
+          encodeUse(op->init());
+        }
+        push(op->isConfigured());
+        if (op->isConfigured()) {
+          push(op->options().macro);
+          push(op->options().operand_layout);
+          push(op->options().accumulator_stride);
+        }
+        break;
+      }
+      default:
+        // The remaining fusion exprs, e.g. ExpandOp, ViewOp or Merge, are
+        //  described by their inputs and outputs.
+        break;
+    }
+  }
+
+ private:
+  std::vector<int64_t> tokens_;
+  std::unordered_map<Val*, int64_t> val_ids_;
+  std::unordered_set<Expr*> encoded_exprs_;
+};
+
+// 64-bit FNV-1a over the little-endian bytes of the tokens, independent of
+//  std::hash and of the host byte order
+size_t hashTokens(const std::vector<int64_t>& tokens) {
+  uint64_t hash = 14695981039346656037ull;
+  for (auto token : tokens) {
+    auto bits = static_cast<uint64_t>(token);
+    for (int byte = 0; byte < 8; byte++) {
+      hash ^= (bits >> (8 * byte)) & 0xff;
+      hash *= 1099511628211ull;
+    }
+  }
+  return static_cast<size_t>(hash);
+}
+
+} // namespace
+
+FusionSignature::FusionSignature(Fusion* fusion) {
+  FUSER_PERF_SCOPE("FusionSignature::FusionSignature");
+  tokens_ = SignatureEncoder::encode(fusion);
+  hash_ = hashTokens(tokens_);
+}
+
+std::string FusionSignature::bytes() const {
+  std::string bytes(tokens_.size() * sizeof(int64_t), '\0');
+  std::memcpy(&bytes[0], tokens_.data(), bytes.size());
+  return bytes;
+}
+
+size_t structuralHash(Fusion* fusion) {
+  return FusionSignature(fusion).hash();
+}
+
+bool structurallyEqual(Fusion* a, Fusion* b) {
+  return FusionSignature(a) == FusionSignature(b);
+}
+
+} // namespace cuda
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <c10/macros/Export.h>
+
+#include <third_party/nvfuser/fusion.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cuda {
+
+//! Note [Fusion Signature]
+//!
+//! A canonical encoding of the structure of a Fusion. Vals are numbered in
+//!  the order a deterministic traversal from the fusion outputs first meets
+//!  them, so the encoding doesn't depend on statement names or on the order
+//!  the fusion was built in. It covers:
+//!   - exprs and their op types and attributes, e.g. reduction init values
+//!     or broadcast flags,
+//!   - dtypes, and the iter types, extents and transformations of the
+//!     domains of all tensors, along with their contiguity,
+//!   - values of scalar constants,
+//!   - input/output aliasing and the input/output permutation maps.
+//!
+//! Two fusions are structurally equal iff their signatures are equal. Only
+//!  exprs the outputs depend on are encoded, stopping at fusion inputs, so
+//!  a fusion guarded to a segment gets the signature of the segment.
+//!
+//! hash() only depends on the encoding, so it's stable across processes
+//!  built from the same source and can key persistent caches. It's also far
+//!  cheaper to compute than printing the fusion math.
+class TORCH_CUDA_CU_API FusionSignature {
+ public:
+  explicit FusionSignature(Fusion* fusion);
+
+  size_t hash() const {
+    return hash_;
+  }
+
+  bool operator==(const FusionSignature& other) const {
+    return hash_ == other.hash_ && tokens_ == other.tokens_;
+  }
+
+  bool operator!=(const FusionSignature& other) const {
+    return !(*this == other);
+  }
+
+  //! The raw encoding as a byte string, e.g. for use as an exact map key
+  std::string bytes() const;
+
+  //! Number of tokens in the encoding
+  size_t size() const {
+    return tokens_.size();
+  }
+
+ private:
+  std::vector<int64_t> tokens_;
+  size_t hash_ = 0;
+};
+
+//! Shortcut for FusionSignature(fusion).hash()
+TORCH_CUDA_CU_API size_t structuralHash(Fusion* fusion);
+
+//! Shortcut for FusionSignature(a) == FusionSignature(b)
+TORCH_CUDA_CU_API bool structurallyEqual(Fusion* a, Fusion* b);
+
+} // namespace cuda
+} // namespace fuser
+} // namespace jit
+} // namespace torch
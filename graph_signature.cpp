@@ -0,0 +1,298 @@
+#include <third_party/nvfuser/graph_signature.h>
+
+#include <third_party/nvfuser/instrumentation.h>
+
+#include <c10/util/hash.h>
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cuda {
+
+namespace {
+
+// Tags separating the parts of the encoding, so that differently shaped
+//  graphs can't produce the same token stream
+enum class Tag : int64_t {
+  Block = 1,
+  Node,
+  Attribute,
+  Tensor,
+  Type,
+  Outputs
+};
+
+class GraphSignatureEncoder {
+ public:
+  static std::vector<int64_t> encode(const std::shared_ptr<Graph>& graph) {
+    GraphSignatureEncoder encoder;
+    encoder.encodeBlock(graph->block());
+    return std::move(encoder.tokens_);
+  }
+
+ private:
+  void push(Tag tag) {
+    tokens_.push_back(static_cast<int64_t>(tag));
+  }
+
+  template <typename T>
+  void push(T value) {
+    tokens_.push_back(static_cast<int64_t>(value));
+  }
+
+  void pushDouble(double value) {
+    int64_t bits = 0;
+    std::memcpy(&bits, &value, sizeof(bits));
+    tokens_.push_back(bits);
+  }
+
+  // Presence flag followed by the value, if any
+  template <typename T>
+  void pushOptional(const c10::optional<T>& value) {
+    push(value.has_value());
+    if (value.has_value()) {
+      push(value.value());
+    }
+  }
+
+  void pushString(const std::string& str) {
+    push(str.size());
+    for (size_t pos = 0; pos < str.size(); pos += sizeof(int64_t)) {
+      int64_t chunk = 0;
+      auto chunk_size = std::min(sizeof(int64_t), str.size() - pos);
+      std::memcpy(&chunk, str.data() + pos, chunk_size);
+      tokens_.push_back(chunk);
+    }
+  }
+
+  void defineValue(const Value* value) {
+    auto id = (int64_t)value_ids_.size();
+    value_ids_.emplace(value, id);
+    encodeType(value->type());
+  }
+
+  void useValue(const Value* value) {
+    auto id_it = value_ids_.find(value);
+    TORCH_INTERNAL_ASSERT(
+        id_it != value_ids_.end(),
+        "Value used before its definition: ",
+        value->debugName());
+    push(id_it->second);
+  }
+
+  void encodeBlock(const Block* block) {
+    push(Tag::Block);
+    push(block->inputs().size());
+    for (auto input : block->inputs()) {
+      defineValue(input);
+    }
+    for (auto node : block->nodes()) {
+      encodeNode(node);
+    }
+    push(Tag::Outputs);
+    push(block->outputs().size());
+    for (auto output : block->outputs()) {
+      useValue(output);
+    }
+  }
+
+  void encodeNode(const Node* node) {
+    push(Tag::Node);
+    push(static_cast<c10::unique_t>(node->kind()));
+    push(node->inputs().size());
+    for (auto input : node->inputs()) {
+      useValue(input);
+    }
+    encodeAttributes(node);
+    push(node->blocks().size());
+    for (auto block : node->blocks()) {
+      encodeBlock(block);
+    }
+    push(node->outputs().size());
+    for (auto output : node->outputs()) {
+      defineValue(output);
+    }
+  }
+
+  void encodeAttributes(const Node* node) {
+    auto names = node->attributeNames();
+    std::sort(names.begin(), names.end());
+    push(names.size());
+    for (auto name : names) {
+      push(Tag::Attribute);
+      push(static_cast<c10::unique_t>(name));
+      auto kind = node->kindOf(name);
+      push(kind);
+      switch (kind) {
+        case AttributeKind::f:
+          pushDouble(node->f(name));
+          break;
+        case AttributeKind::fs:
+          push(node->fs(name).size());
+          for (auto value : node->fs(name)) {
+            pushDouble(value);
+          }
+          break;
+        case AttributeKind::c:
+          pushDouble(node->c(name).real());
+          pushDouble(node->c(name).imag());
+          break;
+        case AttributeKind::cs:
+          push(node->cs(name).size());
+          for (const auto& value : node->cs(name)) {
+            pushDouble(value.real());
+            pushDouble(value.imag());
+          }
+          break;
+        case AttributeKind::i:
+          push(node->i(name));
+          break;
+        case AttributeKind::is:
+          push(node->is(name).size());
+          for (auto value : node->is(name)) {
+            push(value);
+          }
+          break;
+        case AttributeKind::s:
+          pushString(node->s(name));
+          break;
+        case AttributeKind::ss:
+          push(node->ss(name).size());
+          for (const auto& value : node->ss(name)) {
+            pushString(value);
+          }
+          break;
+        case AttributeKind::t:
+          encodeTensorConstant(node->t(name));
+          break;
+        case AttributeKind::ts:
+          push(node->ts(name).size());
+          for (const auto& value : node->ts(name)) {
+            encodeTensorConstant(value);
+          }
+          break;
+        case AttributeKind::g:
+          encodeSubgraph(node->g(name));
+          break;
+        case AttributeKind::gs:
+          push(node->gs(name).size());
+          for (const auto& value : node->gs(name)) {
+            encodeSubgraph(value);
+          }
+          break;
+        case AttributeKind::ty:
+          encodeType(node->ty(name));
+          break;
+        case AttributeKind::tys:
+          push(node->tys(name).size());
+          for (const auto& value : node->tys(name)) {
+            encodeType(value);
+          }
+          break;
+        case AttributeKind::ival: {
+          // Generic IValues are rare in fusion groups, fall back to printing
+          std::stringstream ss;
+          ss << node->ival(name);
+          pushString(ss.str());
+          break;
+        }
+        default:
+          TORCH_INTERNAL_ASSERT(false, "Unhandled attribute kind");
+      }
+    }
+  }
+
+  // Same information as printing the constant: type and shape, plus the
+  //  value of single element tensors
+  void encodeTensorConstant(const at::Tensor& tensor) {
+    push(Tag::Tensor);
+    push(tensor.scalar_type());
+    push(tensor.dim());
+    for (auto size : tensor.sizes()) {
+      push(size);
+    }
+    if (tensor.numel() == 1 && !tensor.is_complex()) {
+      pushDouble(tensor.item<double>());
+    }
+  }
+
+  // Subgraphs get their own value numbering
+  void encodeSubgraph(const std::shared_ptr<Graph>& graph) {
+    auto tokens = encode(graph);
+    push(tokens.size());
+    tokens_.insert(tokens_.end(), tokens.begin(), tokens.end());
+  }
+
+  void encodeType(const TypePtr& type) {
+    push(Tag::Type);
+    auto tensor_type = type->cast<TensorType>();
+    push(tensor_type != nullptr);
+    if (tensor_type == nullptr) {
+      pushString(type->str());
+      return;
+    }
+    pushOptional(tensor_type->scalarType());
+    auto device = tensor_type->device();
+    push(device.has_value());
+    if (device.has_value()) {
+      push(device->type());
+      push(device->index());
+    }
+    pushOptional(tensor_type->requiresGrad());
+    pushOptional(tensor_type->undefined());
+
+    auto sizes = tensor_type->symbolic_sizes().sizes();
+    push(sizes.has_value());
+    if (sizes.has_value()) {
+      push(sizes->size());
+      // Symbolic dims are process-unique ids, which would make graphs
+      //  profiled separately differ, so only static sizes are encoded, like
+      //  the printed graph does with `*`
+      for (const auto& size : sizes.value()) {
+        push(size.is_static());
+        if (size.is_static()) {
+          push(size.static_size());
+        }
+      }
+    }
+
+    auto strides = tensor_type->stride_properties().sizes();
+    push(strides.has_value());
+    if (strides.has_value()) {
+      push(strides->size());
+      for (const auto& stride : strides.value()) {
+        push(stride.has_value());
+        if (stride.has_value()) {
+          pushOptional(stride->stride_index_);
+          pushOptional(stride->contiguous_);
+          pushOptional(stride->stride_);
+        }
+      }
+    }
+  }
+
+ private:
+  std::vector<int64_t> tokens_;
+  std::unordered_map<const Value*, int64_t> value_ids_;
+};
+
+} // namespace
+
+GraphSignature::GraphSignature(const std::shared_ptr<Graph>& graph) {
+  FUSER_PERF_SCOPE("GraphSignature::GraphSignature");
+  tokens_ = GraphSignatureEncoder::encode(graph);
+  hash_ = tokens_.size();
+  for (auto token : tokens_) {
+    hash_ = c10::hash_combine(hash_, std::hash<int64_t>()(token));
+  }
+}
+
+} // namespace cuda
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <c10/macros/Export.h>
+#include <torch/csrc/jit/ir/ir.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cuda {
+
+//! Note [Graph Signature]
+//!
+//! A structural encoding of a TorchScript graph, used by CudaFusionManager
+//!  to find identical CudaFusionGroup subgraphs without rendering the graph
+//!  to text. Values are numbered in the order they're defined, so the
+//!  encoding doesn't depend on value names. It covers:
+//!   - node kinds and the values they consume, including nested blocks,
+//!   - node attributes, sorted by name,
+//!   - types of all values, including the scalar type, device, sizes and
+//!     stride properties of tensors, i.e. the profiled information
+//!     CudaFusionGuard checks at runtime. Dynamic dims are only marked as
+//!     such, since their symbols differ between profiling runs.
+//!
+//! Canonicalize the graph first, so that the node order is deterministic.
+//!
+//! Unlike FusionSignature, the encoding uses interned symbol ids and is
+//!  only meaningful within a process.
+class TORCH_CUDA_CU_API GraphSignature {
+ public:
+  explicit GraphSignature(const std::shared_ptr<Graph>& graph);
+
+  size_t hash() const {
+    return hash_;
+  }
+
+  bool operator==(const GraphSignature& other) const {
+    return hash_ == other.hash_ && tokens_ == other.tokens_;
+  }
+
+  bool operator!=(const GraphSignature& other) const {
+    return !(*this == other);
+  }
+
+  //! Number of tokens in the encoding
+  size_t size() const {
+    return tokens_.size();
+  }
+
+  struct Hash {
+    size_t operator()(const GraphSignature& signature) const {
+      return signature.hash();
+    }
+  };
+
+ private:
+  std::vector<int64_t> tokens_;
+  size_t hash_ = 0;
+};
+
+} // namespace cuda
+} // namespace fuser
+} // namespace jit
+} // namespace torch
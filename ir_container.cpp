@@ -25,6 +25,11 @@ void swap(IrContainer& a, IrContainer& b) noexcept {
   swap(a.val_type_name_map_, b.val_type_name_map_);
   swap(a.expr_name_counter_, b.expr_name_counter_);
 
+  // Versions are not swapped, the content of both containers changed so
+  // anything computed on either is now invalid.
+  a.bumpVersion();
+  b.bumpVersion();
+
   // Fixup the Statement::fusion_ links for a
   for (auto val : a.vals_) {
     val->ir_container_ = &a;
@@ -91,6 +96,14 @@ IrContainer::~IrContainer() {
   clear();
 }
 
+size_t IrContainer::approximateMemoryBytes() const noexcept {
+  // Nodes are polymorphic and own their own vectors, so this uses rough
+  //  averages that include the bookkeeping of a node in the container
+  constexpr size_t kBytesPerVal = 256;
+  constexpr size_t kBytesPerExpr = 192;
+  return vals_up_.size() * kBytesPerVal + exprs_up_.size() * kBytesPerExpr;
+}
+
 //! Register the Statement with this container
 void IrContainer::registerStmt(IrBuilderPasskey, Statement* stmt) {
   if (stmt->isVal()) {
@@ -130,6 +143,7 @@ void IrContainer::removeExpr(Expr* expr) {
   exprs_.erase(expr);
   exprs_up_.erase(expr_in_deque);
   raw_ptrs_.erase((void*)expr);
+  bumpVersion();
 }
 
 //! Completely remove val from the fusion, break all dependencies associated
@@ -157,6 +171,7 @@ void IrContainer::removeVal(Val* val) {
   vals_.erase(val);
   vals_up_.erase(val_in_deque);
   raw_ptrs_.erase((void*)val);
+  bumpVersion();
 }
 
 //! Register the Val with this container
@@ -180,6 +195,7 @@ void IrContainer::registerExpr(Expr* expr) {
   exprs_.emplace(exprs_up_.back().get());
   expr->setName(IrContainerPasskey(), getExprName());
   raw_ptrs_.emplace((void*)exprs_up_.back().get());
+  bumpVersion();
 }
 
 void IrContainer::clear() noexcept {
@@ -192,6 +208,7 @@ void IrContainer::clear() noexcept {
 
   val_type_name_map_.clear();
   expr_name_counter_ = 0;
+  bumpVersion();
 }
 
 bool IrContainer::inContainer(const Statement* stmt) const {
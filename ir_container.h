@@ -86,6 +86,17 @@ class TORCH_CUDA_CU_API IrContainer : public PolymorphicBase {
     return vals_;
   }
 
+  //! Counter that changes on every mutation of the IR graph, i.e. registering
+  //! or removing an Expr, or removing a Val. Analyses computed on this
+  //! container remain valid as long as the version doesn't change.
+  int64_t version() const noexcept {
+    return version_;
+  }
+
+  //! Rough estimate of the host memory held by the IR nodes of this
+  //!  container, e.g. for accounting in caches of fusions
+  size_t approximateMemoryBytes() const noexcept;
+
   // Shortcuts for frequently used vals
   Int* zeroVal();
   Int* oneVal();
@@ -126,6 +137,11 @@ class TORCH_CUDA_CU_API IrContainer : public PolymorphicBase {
 
   void clear() noexcept;
 
+  //! Invalidates any analysis computed at the current version
+  void bumpVersion() noexcept {
+    version_++;
+  }
+
   // Deque of unique pointer is the memory owning data structure
   std::deque<std::unique_ptr<Val>> vals_up_;
 
@@ -153,6 +169,9 @@ class TORCH_CUDA_CU_API IrContainer : public PolymorphicBase {
   // Expression names counter
   StmtNameType expr_name_counter_ = 0;
 
+  // See version()
+  int64_t version_ = 0;
+
   // Manually store some persistent, frequently used nodes. It's very
   // challenging to do this anything but manually as detecting when a container
   // may or may not have one of these vals is tricky. Specifically because if
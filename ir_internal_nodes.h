@@ -718,6 +718,11 @@ class TORCH_CUDA_CU_API MmaOp : public Expr {
     return options_.value();
   }
 
+  //! Whether the options were set, either on creation or by a scheduler
+  bool isConfigured() const {
+    return options_.has_value();
+  }
+
   bool sameAs(const Statement* const other) const override;
 
   auto accStride() const {
@@ -1544,6 +1549,12 @@ class TORCH_CUDA_CU_API TensorDomain : public Val {
 
   TensorDomain* flatten(int64_t start_dim, int64_t end_dim);
 
+  //! Split dim into [ceilDiv(extent, inner_size), inner_size] as an rfactor
+  //!  transform. The extent of dim must be divisible by inner_size,
+  //!  which is checked here for constant extents and at run time
+  //!  otherwise.
+  TensorDomain* unflatten(int64_t dim, int64_t inner_size);
+
   static std::vector<IterDomain*> orderedAs(
       const std::vector<IterDomain*>& td,
       const std::unordered_map<int, int>& old2new);
@@ -2331,6 +2331,66 @@ TensorDomain* TensorDomain::flatten(int64_t start_dim, int64_t end_dim) {
       std::vector<bool>(rfactor_domain.size(), true));
 }
 
+TensorDomain* TensorDomain::unflatten(int64_t dim, int64_t inner_size) {
+  auto inp_domain = noReductions(getMaybeRFactorDomain());
+
+  if (dim < 0) {
+    dim += inp_domain.size();
+  }
+  TORCH_CHECK(dim >= 0 && dim < inp_domain.size(), "Invalid dim ", dim);
+  TORCH_CHECK(inner_size > 0, "Invalid inner_size ", inner_size);
+  TORCH_CHECK(
+      !inp_domain[dim]->isBroadcast(), "Can't unflatten a broadcast domain");
+  // Symbolic extents are validated at run time, see
+  // NonDivisibleSplitInfo::addRFactorSplitsToValidate
+  auto extent = inp_domain[dim]->extent()->getInt();
+  TORCH_CHECK(
+      !extent.has_value() || extent.value() % inner_size == 0,
+      "Can't unflatten a domain of extent ",
+      extent.value_or(0),
+      " by ",
+      inner_size,
+      " as it's not divisible");
+
+  std::vector<IterDomain*> new_root_domain;
+  new_root_domain.reserve(inp_domain.size());
+  for (auto i : c10::irange(inp_domain.size())) {
+    new_root_domain.push_back(IterDomainBuilder(inp_domain[i])
+                                  .is_rfactor_domain(i == dim)
+                                  .build());
+  }
+
+  auto split_id = new_root_domain[dim];
+  auto factor = IrBuilder::create<Int>(split_id->container(), inner_size);
+  auto outer_id = IterDomainBuilder(
+                      split_id->container()->zeroVal(),
+                      ceilDiv(split_id->extent(), factor))
+                      .is_rfactor_domain(true)
+                      .build();
+  auto inner_id =
+      IterDomainBuilder(split_id->container()->zeroVal(), factor)
+          .is_rfactor_domain(true)
+          .build();
+  IrBuilder::create<Split>(outer_id, inner_id, split_id, factor, true);
+
+  std::vector<IterDomain*> rfactor_domain;
+  rfactor_domain.reserve(new_root_domain.size() + 1);
+  for (auto i : c10::irange(new_root_domain.size())) {
+    if (i == dim) {
+      rfactor_domain.push_back(outer_id);
+      rfactor_domain.push_back(inner_id);
+    } else {
+      rfactor_domain.push_back(new_root_domain[i]);
+    }
+  }
+
+  return IrBuilder::create<TensorDomain>(
+      new_root_domain,
+      rfactor_domain,
+      rfactor_domain,
+      std::vector<bool>(rfactor_domain.size(), true));
+}
+
 // TODO: Rfactor a Welford
 
 // pair is in order where second is the consumer of first
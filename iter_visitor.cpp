@@ -810,6 +810,10 @@ void StmtSort::handle(Statement* stmt) {
 }
 
 std::vector<Expr*> StmtSort::getExprs(Fusion* fusion, bool traverse_members) {
+  // Memoized by the fusion, see Note [Fusion Analysis Cache]
+  if (!traverse_members) {
+    return fusion->exprs();
+  }
   auto terminating_outputs = fusion->getTerminatingOutputs();
   return StmtSort::getExprs(fusion, terminating_outputs, traverse_members);
 }
@@ -4,11 +4,14 @@
 #include <third_party/nvfuser/ir_utils.h>
 #include <third_party/nvfuser/parser.h>
 #include <third_party/nvfuser/scheduler/debug_utils.h>
+#include <third_party/nvfuser/scheduler/heuristic_cache.h>
 #include <third_party/nvfuser/scheduler/registry.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/runtime/graph_executor.h>
 
+#include <ATen/cuda/CUDAEvent.h>
 #include <c10/core/thread_pool.h>
+#include <c10/cuda/CUDACachingAllocator.h>
 #include <c10/cuda/CUDAGuard.h>
 #include <c10/util/irange.h>
 #include <torch/csrc/jit/jit_log.h>
@@ -42,38 +45,40 @@ InputsIdLookup::IdLookupReturn InputsIdLookup::lookupId(
     const at::ArrayRef<IValue>& inputs) {
   IdLookupReturn ret;
 
-  // lock mutex_ because we are touching encoding_
-  std::lock_guard<std::mutex> guard(mutex_);
-  encoding_.clear();
+  // string to store encoded input meta information. Reuse the buffer instead of
+  // stringtream gives few us perf gain.
+  thread_local std::string encoding;
+  encoding.clear();
   for (const auto& input : inputs) {
     if (input.isTensor()) {
       auto& input_tensor = input.toTensor();
 
       for (auto size : input_tensor.sizes()) {
-        encodeBuffer(size, encoding_);
-        encoding_.push_back(' ');
+        encodeBuffer(size, encoding);
+        encoding.push_back(' ');
       }
-      encoding_.push_back('X');
-      encoding_.push_back(' ');
+      encoding.push_back('X');
+      encoding.push_back(' ');
       for (auto stride : input_tensor.strides()) {
-        encodeBuffer(stride, encoding_);
-        encoding_.push_back(' ');
+        encodeBuffer(stride, encoding);
+        encoding.push_back(' ');
       }
-      encoding_.push_back('a');
+      encoding.push_back('a');
       encodeBuffer(
           SchedulerRuntimeInfo::computeAlignmentSize(
               (size_t)input_tensor.data_ptr()),
-          encoding_);
-      encoding_.push_back('d');
-      encodeBuffer(input_tensor.device().index(), encoding_);
+          encoding);
+      encoding.push_back('d');
+      encodeBuffer(input_tensor.device().index(), encoding);
     } else {
       // encode s for scalar;
-      encoding_.push_back('s');
+      encoding.push_back('s');
     }
-    encoding_.push_back(';');
+    encoding.push_back(';');
   }
 
-  auto& entry = encoding_lookup_[encoding_];
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto& entry = encoding_lookup_[encoding];
 
   if (entry.id == 0) {
     // no entry existed for given input set, set id for given entry
@@ -97,7 +102,7 @@ InputsIdLookup::IdLookupReturn InputsIdLookup::lookupId(
   }
 
   ret.id = entry.id;
-  entry.lru_iter = used_entry_.insert(used_entry_.begin(), encoding_);
+  entry.lru_iter = used_entry_.insert(used_entry_.begin(), encoding);
   return ret;
 }
 
@@ -131,7 +136,7 @@ bool FusionExecutorCache::isCompiled(const at::ArrayRef<IValue>& inputs) {
   // Access kernels associated with the common device id
   KernelArgumentHolder args = prepareInputs(inputs);
 
-  return getKernelRuntimeFor(args)->isCompiled();
+  return getKernelRuntimeFor(args).kernel_runtime->isCompiled();
 }
 
 void FusionExecutorCache::compileFusionAsync(
@@ -139,7 +144,7 @@ void FusionExecutorCache::compileFusionAsync(
   FUSER_PERF_SCOPE("FusionExecutorCache::compileFusionAsync");
 
   KernelArgumentHolder args = prepareInputs(inputs);
-  auto kernel_runtime = getKernelRuntimeFor(args);
+  auto kernel_runtime = getKernelRuntimeFor(args).kernel_runtime;
 
   kernel_runtime->startAsyncCompile(args);
 }
@@ -175,26 +180,14 @@ std::vector<at::Tensor> FusionExecutorCache::runFusionWithInputs(
     const at::ArrayRef<IValue>& inputs) {
   FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithInputs");
 
-  // permute input tensor for kernel execution. See Part_1 in Note [ Channels
-  // Last support in nvfuser ]
-  at::ArrayRef<IValue> perm_inputs = inputs;
-  const auto& to_be_permuted_inputs = fusion_->getPermutationInputMap();
-  std::vector<IValue> inputs_vec;
-  if (!to_be_permuted_inputs.empty()) {
-    inputs_vec = inputs.vec();
-    for (const auto& pair : to_be_permuted_inputs) {
-      auto v = inputs_vec[pair.first];
-      TORCH_CHECK(
-          v.isTensor(), "input permutation can only be applied at tensor");
-      auto tensor = v.toTensor();
-      inputs_vec[pair.first] = tensor.permute(pair.second);
-    }
-    perm_inputs = inputs_vec;
-  }
+  std::vector<IValue> permuted_inputs;
+  auto perm_inputs = permuteInputs(inputs, permuted_inputs);
 
+  // See [ Note -- Concurrent Executions ]
   KernelArgumentHolder args = prepareInputs(perm_inputs);
 
-  auto kernel_runtime = getKernelRuntimeFor(args);
+  auto runtime_entry = getKernelRuntimeFor(args);
+  auto kernel_runtime = runtime_entry.kernel_runtime;
   most_recent_runtime_ = kernel_runtime;
   int seq_id = 0;
   // Record kernel input and output tensors so profiler can construct
@@ -203,9 +196,116 @@ std::vector<at::Tensor> FusionExecutorCache::runFusionWithInputs(
       "run_fused_kernel",
       std::vector<c10::IValue>(inputs.begin(), inputs.end()),
       seq_id);
-  auto outputs = kernel_runtime->runWithInput(args);
+  auto outputs = kernel_runtime->runWithInput(
+      args, runtime_entry.launch_constraints.get());
   RECORD_OUTPUTS(outputs);
 
+  finalizeOutputs(outputs);
+  return outputs;
+}
+
+std::vector<std::vector<at::Tensor>> FusionExecutorCache::
+    runFusionWithInputsBatch(
+        const std::vector<std::vector<IValue>>& input_sets,
+        const std::vector<c10::cuda::CUDAStream>& streams) {
+  FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithInputsBatch");
+
+  // See [ Note -- Batched Executions ]
+  std::vector<KernelArgumentHolder> args_list;
+  args_list.reserve(input_sets.size());
+  {
+    FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithInputsBatch::Prepare");
+    std::vector<IValue> permuted_inputs;
+    for (const auto& inputs : input_sets) {
+      args_list.push_back(
+          prepareInputs(permuteInputs(inputs, permuted_inputs)));
+    }
+  }
+
+  std::vector<RuntimeIndexEntry> runtime_entries;
+  runtime_entries.reserve(input_sets.size());
+  {
+    FUSER_PERF_SCOPE("FusionExecutorCache::runFusionWithInputsBatch::Lookup");
+    std::unordered_map<size_t, RuntimeIndexEntry> resolved_entries;
+    for (const auto& args : args_list) {
+      auto unique_id = *args.getCacheId();
+      auto entry_it = resolved_entries.find(unique_id);
+      if (entry_it == resolved_entries.end()) {
+        entry_it =
+            resolved_entries.emplace(unique_id, getKernelRuntimeFor(args))
+                .first;
+      }
+      runtime_entries.push_back(entry_it->second);
+    }
+  }
+
+  // The inputs are produced on the stream of the caller, so the given
+  // streams wait for the work queued on it so far
+  if (!streams.empty()) {
+    auto caller_stream = c10::cuda::getCurrentCUDAStream();
+    at::cuda::CUDAEvent inputs_ready;
+    inputs_ready.record(caller_stream);
+    for (const auto& stream : streams) {
+      if (stream != caller_stream) {
+        inputs_ready.block(stream);
+      }
+    }
+  }
+
+  std::vector<std::vector<at::Tensor>> outputs_list;
+  outputs_list.reserve(input_sets.size());
+  for (const auto i : c10::irange(input_sets.size())) {
+    c10::optional<c10::cuda::CUDAStreamGuard> stream_guard;
+    if (!streams.empty()) {
+      const auto& stream = streams[i % streams.size()];
+      stream_guard.emplace(stream);
+      // Keeps the caching allocator from reusing the memory of the inputs
+      // before the kernels reading them on this stream are done
+      for (const auto& input : input_sets[i]) {
+        if (input.isTensor() && input.toTensor().defined()) {
+          c10::cuda::CUDACachingAllocator::recordStream(
+              input.toTensor().storage().data_ptr(), stream);
+        }
+      }
+    }
+    auto kernel_runtime = runtime_entries[i].kernel_runtime;
+    most_recent_runtime_ = kernel_runtime;
+    int seq_id = 0;
+    RECORD_FUNCTION(
+        "run_fused_kernel",
+        std::vector<c10::IValue>(input_sets[i].begin(), input_sets[i].end()),
+        seq_id);
+    auto outputs = kernel_runtime->runWithInput(
+        args_list[i], runtime_entries[i].launch_constraints.get());
+    RECORD_OUTPUTS(outputs);
+
+    finalizeOutputs(outputs);
+    outputs_list.push_back(std::move(outputs));
+  }
+  return outputs_list;
+}
+
+at::ArrayRef<IValue> FusionExecutorCache::permuteInputs(
+    const at::ArrayRef<IValue>& inputs,
+    std::vector<IValue>& permuted_inputs) {
+  // permute input tensor for kernel execution. See Part_1 in Note [ Channels
+  // Last support in nvfuser ]
+  const auto& to_be_permuted_inputs = fusion_->getPermutationInputMap();
+  if (to_be_permuted_inputs.empty()) {
+    return inputs;
+  }
+  permuted_inputs = inputs.vec();
+  for (const auto& pair : to_be_permuted_inputs) {
+    auto v = permuted_inputs[pair.first];
+    TORCH_CHECK(
+        v.isTensor(), "input permutation can only be applied at tensor");
+    auto tensor = v.toTensor();
+    permuted_inputs[pair.first] = tensor.permute(pair.second);
+  }
+  return permuted_inputs;
+}
+
+void FusionExecutorCache::finalizeOutputs(std::vector<at::Tensor>& outputs) {
   // permute output tensor returned by kernel execution. See Part_3 in Note [
   // Permutation support in nvfuser ]
   for (const auto& pair : fusion_->getPermutationOutputMap()) {
@@ -222,23 +322,55 @@ std::vector<at::Tensor> FusionExecutorCache::runFusionWithInputs(
     outputs.erase(outputs.begin() + v - offset);
     offset++;
   }
-
-  return outputs;
 }
 
 void FusionExecutorCache::evictCache(size_t cache_id) {
-  auto it = id_to_kernel_runtime_.find(cache_id);
-  TORCH_INTERNAL_ASSERT(it != id_to_kernel_runtime_.end());
-  it->second->evictCache(cache_id);
-  id_to_kernel_runtime_.erase(it);
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto id_to_kernel_runtime = std::atomic_load(&id_to_kernel_runtime_);
+  auto it = id_to_kernel_runtime->find(cache_id);
+  // The id may not have been inserted yet by the thread that looked it up
+  if (it == id_to_kernel_runtime->end()) {
+    return;
+  }
+  it->second.kernel_runtime->evictCache(cache_id);
+
+  auto new_index = std::make_shared<RuntimeIndex>(*id_to_kernel_runtime);
+  new_index->erase(cache_id);
+  std::atomic_store(
+      &id_to_kernel_runtime_,
+      std::shared_ptr<const RuntimeIndex>(std::move(new_index)));
 }
 
-FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
-    const KernelArgumentHolder& args) {
-  // Check for id hit case
+size_t FusionExecutorCache::approximateMemoryBytes() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t bytes =
+      sizeof(FusionExecutorCache) + fusion_->approximateMemoryBytes();
+  for (auto& it : kernel_runtimes_) {
+    for (auto& kernel_runtime : it.second) {
+      bytes += kernel_runtime->approximateMemoryBytes();
+    }
+  }
+  return bytes;
+}
+
+FusionExecutorCache::RuntimeIndexEntry FusionExecutorCache::
+    getKernelRuntimeFor(const KernelArgumentHolder& args) {
+  // Check for id hit case, without locking
   auto unique_id = *args.getCacheId();
-  auto id_it = id_to_kernel_runtime_.find(unique_id);
-  if (id_it != id_to_kernel_runtime_.end()) {
+  {
+    auto id_to_kernel_runtime = std::atomic_load(&id_to_kernel_runtime_);
+    auto id_it = id_to_kernel_runtime->find(unique_id);
+    if (id_it != id_to_kernel_runtime->end()) {
+      return id_it->second;
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(mutex_);
+
+  // Another thread may have inserted the id in the meantime
+  auto id_to_kernel_runtime = std::atomic_load(&id_to_kernel_runtime_);
+  auto id_it = id_to_kernel_runtime->find(unique_id);
+  if (id_it != id_to_kernel_runtime->end()) {
     return id_it->second;
   }
 
@@ -262,22 +394,29 @@ FusionKernelRuntime* FusionExecutorCache::getKernelRuntimeFor(
         return true;
       });
 
-  FusionKernelRuntime* kernel_runtime = nullptr;
+  RuntimeIndexEntry entry;
   if (reuse_it != kernel_runtimes.end()) {
-    kernel_runtime = reuse_it->get();
-    kernel_runtime->updateHeuristicsLaunchParams(new_heuristics.get());
+    entry.kernel_runtime = reuse_it->get();
+    // Launch constraints of this input set, which are applied at launch
+    //  instead of being copied into the shared scheduler entries
+    entry.launch_constraints =
+        FusionKernelRuntime::launchConstraintsOf(new_heuristics.get());
   } else {
     // graph miss, need to re-build an optimized graph for this case
     kernel_runtimes.emplace_back(
         std::make_unique<FusionKernelRuntime>(fusion_.get(), args));
-    kernel_runtime = kernel_runtimes.back().get();
+    entry.kernel_runtime = kernel_runtimes.back().get();
     if (profiling_) {
-      kernel_runtime->profile(true);
+      entry.kernel_runtime->profile(true);
     }
   }
 
-  id_to_kernel_runtime_[unique_id] = kernel_runtime;
-  return kernel_runtime;
+  auto new_index = std::make_shared<RuntimeIndex>(*id_to_kernel_runtime);
+  (*new_index)[unique_id] = entry;
+  std::atomic_store(
+      &id_to_kernel_runtime_,
+      std::shared_ptr<const RuntimeIndex>(std::move(new_index)));
+  return entry;
 }
 
 FusionKernelRuntime::FusionKernelRuntime(
@@ -317,9 +456,17 @@ FusionKernelRuntime::FusionKernelRuntime(
 
   heuristics_ = segmented_fusion_->makeInitialHeuristics(args);
   executors_ = std::vector<FusionExecutor>(segmented_fusion_->groups().size());
+  executors_compiled_ =
+      std::make_unique<std::atomic<bool>[]>(executors_.size());
   if (isDebugDumpEnabled(DebugDumpOption::FusionSegments)) {
     segmented_fusion_->print();
   }
+  if (isDebugDumpEnabled(DebugDumpOption::AnalysisCacheStats)) {
+    std::cout << Fusion::analysisCacheStats() << std::endl;
+  }
+  if (isDebugDumpEnabled(DebugDumpOption::HeuristicCacheStats)) {
+    std::cout << HeuristicParamsCache::get().statsString() << std::endl;
+  }
 
   // Even if we go through the segmented path we may still end up
   //  with a segmented fusion with one group. This case still
@@ -333,9 +480,9 @@ FusionKernelRuntime::FusionKernelRuntime(
 
 std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
     KernelArgumentHolder& args,
-    SegmentedGroup* sg) {
+    SegmentedGroup* sg,
+    const LaunchParams& launch_constraints) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::runKernelWithInput");
-  std::lock_guard<std::mutex> guard(mutex_);
   // This function will be called once on un-segmented fusion,
   //  for segmented fusion, this function will be called on each segment
   //  In the case of segmented fusion, segmented group needs to be given so
@@ -345,32 +492,20 @@ std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
   TORCH_INTERNAL_ASSERT(sg, "runKernelWithInput: need valid group to run");
   auto group_id = sg->groupId();
 
-  LaunchParams launch_params;
+  const LaunchParams& launch_params = launch_constraints;
 
   auto scheduler_entry = schedulers()[group_id].get();
 
   // Check that the heuristics are matched, in the case of segmented fusion
   TORCH_INTERNAL_ASSERT(!sg || scheduler_entry->heuristic() == sg->heuristic());
 
-  if (!executors_[group_id].compiled()) {
-    FUSER_PERF_SCOPE("FusionKernelRuntime::runKernelWithInput::Compile");
-    std::unique_ptr<Fusion> fusion_to_run;
-
-    // Running a segment group as a single kernel,
-    //  make a fusion to run from segmented fusion
-    fusion_to_run = segmented_fusion_->makeFusion(sg);
-    FusionGuard fg(fusion_to_run.get());
-    scheduler_entry->schedule(fusion_to_run.get());
-    launch_params = scheduler_entry->params()->lparams;
-    executors_[group_id].compileFusion(
-        fusion_to_run.get(), args, launch_params);
-  } else {
-    launch_params = scheduler_entry->params()->lparams;
-  }
+  maybeCompileKernel(args, sg, launch_params);
 
   if (profiling_) {
+    std::lock_guard<std::mutex> guard(mutex_);
     most_recent_executor_log_.fusion_executor = &executors_[group_id];
     most_recent_executor_log_.params = scheduler_entry->params()->clone();
+    most_recent_executor_log_.params->lparams = launch_params;
   }
 
   auto& executor = executors_[group_id];
@@ -408,6 +543,34 @@ std::vector<at::Tensor> FusionKernelRuntime::runKernelWithInput(
   return outputs;
 }
 
+void FusionKernelRuntime::maybeCompileKernel(
+    const KernelArgumentHolder& args,
+    SegmentedGroup* sg,
+    const LaunchParams& launch_constraints) {
+  auto group_id = sg->groupId();
+  auto scheduler_entry = schedulers()[group_id].get();
+
+  // Only compilation is serialized, launches of compiled kernels are
+  //  re-entrant. See [ Note -- Concurrent Executions ]
+  auto& executor_compiled = executors_compiled_[group_id];
+  if (!executor_compiled.load(std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (!executors_[group_id].compiled()) {
+      FUSER_PERF_SCOPE("FusionKernelRuntime::runKernelWithInput::Compile");
+      std::unique_ptr<Fusion> fusion_to_run;
+
+      // Running a segment group as a single kernel,
+      //  make a fusion to run from segmented fusion
+      fusion_to_run = segmented_fusion_->makeFusion(sg);
+      FusionGuard fg(fusion_to_run.get());
+      scheduler_entry->schedule(fusion_to_run.get());
+      executors_[group_id].compileFusion(
+          fusion_to_run.get(), args, launch_constraints);
+    }
+    executor_compiled.store(true, std::memory_order_release);
+  }
+}
+
 void FusionKernelRuntime::prepareRuntimeOrder() {
   // Setup group run order:
   std::unordered_set<Val*> available_input;
@@ -463,6 +626,30 @@ void FusionKernelRuntime::prepareRuntimeOrder() {
         one_ran,
         "Couldn't run all groups, something must have gone wrong in segmentation.");
   }
+
+  // Independent groups can be packed into one kernel, see
+  //  Note [Horizontal Fusion]
+  runtime_workspace_.group_run_waves =
+      segmented_fusion_->independentGroupWaves();
+  horizontal_executors_.clear();
+  for (const auto& wave : runtime_workspace_.group_run_waves) {
+    horizontal_executors_.push_back(
+        wave.size() > 1 ? std::make_unique<HorizontalFusionExecutor>()
+                        : nullptr);
+  }
+}
+
+size_t FusionKernelRuntime::approximateMemoryBytes() {
+  // Executors are compiled under mutex_
+  std::lock_guard<std::mutex> guard(mutex_);
+  size_t bytes = sizeof(FusionKernelRuntime);
+  if (segmented_fusion_) {
+    bytes += segmented_fusion_->completeFusion()->approximateMemoryBytes();
+  }
+  for (const auto& executor : executors_) {
+    bytes += executor.approximateMemoryBytes();
+  }
+  return bytes;
 }
 
 // passing args by value, since we will be modify this
@@ -605,8 +792,10 @@ void FusionKernelRuntime::mapFusionInputsToArgs(
 }
 
 std::vector<at::Tensor> FusionKernelRuntime::runWithInput(
-    KernelArgumentHolder& args) {
+    KernelArgumentHolder& args,
+    const LaunchConstraints* launch_constraints) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::runWithInput");
+  std::shared_lock<std::shared_timed_mutex> run_guard(run_mutex_);
 
   TORCH_INTERNAL_ASSERT(
       args.size() == segmented_fusion_->inputs().size(),
@@ -631,9 +820,10 @@ std::vector<at::Tensor> FusionKernelRuntime::runWithInput(
 
   // group should share cache id.
   auto group_cache_id = args.getCacheId();
-  for (auto group_to_run : runtime_workspace_.group_run_order) {
+
+  // Prepare input vector of a group
+  auto group_inputs_of = [&](SegmentedGroup* group_to_run) {
     // TODO: index mode should be updated per segmented kernel
-    // Prepare input vector
     KernelArgumentHolder group_runtime_inputs(args.getIndexMode());
     group_runtime_inputs.setDeviceIndex(args.getDeviceIndex());
     if (group_cache_id.has_value()) {
@@ -642,26 +832,104 @@ std::vector<at::Tensor> FusionKernelRuntime::runWithInput(
     for (auto input : group_to_run->inputs()) {
       group_runtime_inputs.push(tensor_map.at(input));
     }
+    return group_runtime_inputs;
+  };
+
+  auto launch_constraints_of =
+      [&](SegmentedGroup* group_to_run) -> const LaunchParams& {
+    auto group_id = group_to_run->groupId();
+    return launch_constraints == nullptr
+        ? schedulers()[group_id]->params()->lparams
+        : launch_constraints->at(group_id);
+  };
+
+  // TODO: currently we are still outputing PyTorch tensors, instead of
+  // something abstract. This is quite unsatisfying.
+  auto record_group_outputs =
+      [&](SegmentedGroup* group_to_run,
+          const std::vector<at::Tensor>& group_runtime_outputs) {
+        const auto& group_outputs = group_to_run->outputs();
 
-    // TODO: currently we are still outputing PyTorch tensors, instead of
-    // something abstract. This is quite unsatisfying. Prepare input vector
+        // Insert graph segment output to tensor map
+        TORCH_INTERNAL_ASSERT(
+            group_outputs.size() == group_runtime_outputs.size(),
+            "output size does not match");
+        for (const size_t group_out_i : c10::irange(group_outputs.size())) {
+          output_holder[group_outputs[group_out_i]] =
+              group_runtime_outputs[group_out_i];
+
+          args.push(group_runtime_outputs[group_out_i]);
+          tensor_map.emplace(group_outputs[group_out_i], args.back());
+        }
+      };
+
+  auto run_group = [&](SegmentedGroup* group_to_run) {
+    auto group_runtime_inputs = group_inputs_of(group_to_run);
 
     // Run graph segment
-    std::vector<at::Tensor> group_runtime_outputs =
-        runKernelWithInput(group_runtime_inputs, group_to_run);
+    std::vector<at::Tensor> group_runtime_outputs = runKernelWithInput(
+        group_runtime_inputs,
+        group_to_run,
+        launch_constraints_of(group_to_run));
 
-    const auto& group_outputs = group_to_run->outputs();
+    record_group_outputs(group_to_run, group_runtime_outputs);
+  };
 
-    // Insert graph segment output to tensor map
-    TORCH_INTERNAL_ASSERT(
-        group_outputs.size() == group_runtime_outputs.size(),
-        "output size does not match");
-    for (const size_t group_out_i : c10::irange(group_outputs.size())) {
-      output_holder[group_outputs[group_out_i]] =
-          group_runtime_outputs[group_out_i];
-
-      args.push(group_runtime_outputs[group_out_i]);
-      tensor_map.emplace(group_outputs[group_out_i], args.back());
+  // Profiling and verbose perf debugging report on each kernel
+  const bool horizontal_fusion =
+      isOptionEnabled(EnableOption::HorizontalFusion) && !profiling_ &&
+      !isDebugDumpEnabled(DebugDumpOption::PerfDebugVerbose);
+
+  if (!horizontal_fusion) {
+    for (auto group_to_run : runtime_workspace_.group_run_order) {
+      run_group(group_to_run);
+    }
+  } else {
+    const auto& waves = runtime_workspace_.group_run_waves;
+    for (const auto wave_i : c10::irange(waves.size())) {
+      if (waves[wave_i].size() < 2) {
+        run_group(waves[wave_i].front());
+        continue;
+      }
+
+      // Compile the groups of the wave, and pack the ones that can be
+      //  packed, see Note [Horizontal Fusion]
+      std::vector<SegmentedGroup*> packed_groups;
+      std::vector<KernelArgumentHolder> packed_inputs;
+      packed_inputs.reserve(waves[wave_i].size());
+      for (auto group_to_run : waves[wave_i]) {
+        auto group_runtime_inputs = group_inputs_of(group_to_run);
+        maybeCompileKernel(
+            group_runtime_inputs,
+            group_to_run,
+            launch_constraints_of(group_to_run));
+        if (HorizontalFusionExecutor::canPack(
+                executors_[group_to_run->groupId()])) {
+          packed_groups.push_back(group_to_run);
+          packed_inputs.push_back(group_runtime_inputs);
+        } else {
+          run_group(group_to_run);
+        }
+      }
+
+      if (packed_groups.size() == 1) {
+        run_group(packed_groups.front());
+      } else if (packed_groups.size() > 1) {
+        std::vector<FusionExecutor*> packed_executors;
+        std::vector<KernelArgumentHolder*> packed_args;
+        std::vector<LaunchParams> packed_launch_constraints;
+        for (const auto i : c10::irange(packed_groups.size())) {
+          packed_executors.push_back(&executors_[packed_groups[i]->groupId()]);
+          packed_args.push_back(&packed_inputs[i]);
+          packed_launch_constraints.push_back(
+              launch_constraints_of(packed_groups[i]));
+        }
+        auto packed_outputs = horizontal_executors_[wave_i]->runFusion(
+            packed_executors, packed_args, packed_launch_constraints);
+        for (const auto i : c10::irange(packed_groups.size())) {
+          record_group_outputs(packed_groups[i], packed_outputs[i]);
+        }
+      }
     }
   }
 
@@ -716,22 +984,19 @@ const std::vector<FusionKernelRuntime::SchedulerEntryPtr>& FusionKernelRuntime::
   return heuristics_->heuristicsList();
 }
 
-void FusionKernelRuntime::updateHeuristicsLaunchParams(
-    FusionHeuristics* update_heuristics) {
-  FUSER_PERF_SCOPE("FusionKernelRuntime::updateHeuristicsLaunchParams");
-  auto scheduler_list_length = heuristics_->heuristicsList().size();
-  TORCH_INTERNAL_ASSERT(
-      update_heuristics->heuristicsList().size() == scheduler_list_length);
-  for (const auto i : c10::irange(scheduler_list_length)) {
-    auto& schedulerPtr = heuristics_->heuristicsList()[i];
-    schedulerPtr->updateLaunchConstraint(
-        update_heuristics->heuristicsList()[i]->params()->lparams);
+std::shared_ptr<const FusionKernelRuntime::LaunchConstraints>
+FusionKernelRuntime::launchConstraintsOf(FusionHeuristics* heuristics) {
+  auto launch_constraints = std::make_shared<LaunchConstraints>();
+  for (const auto& scheduler_entry : heuristics->heuristicsList()) {
+    launch_constraints->push_back(scheduler_entry->params()->lparams);
   }
+  return launch_constraints;
 }
 
 c10::optional<FusionKernelRuntime::HeuristicsPtr> FusionKernelRuntime::
     getMaybeHeuristicsFor(const KernelArgumentHolder& args) {
   FUSER_PERF_SCOPE("FusionKernelRuntime::getMaybeHeuristicsFor");
+  std::unique_lock<std::shared_timed_mutex> probe_guard(run_mutex_);
   auto complete_fusion = segmented_fusion_->completeFusion();
   SchedulerRuntimeInfo runtime_info(complete_fusion, args);
   precomputed_values_->bindFusionInputs(args);
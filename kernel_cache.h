@@ -7,10 +7,14 @@
 #include <third_party/nvfuser/scheduler/all_schedulers.h>
 #include <third_party/nvfuser/scheduler/registry.h>
 
+#include <c10/cuda/CUDAStream.h>
 #include <c10/macros/Export.h>
 #include <c10/util/ArrayRef.h>
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <type_traits>
 #include <unordered_map>
 
@@ -48,6 +52,9 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
   using HashType = size_t;
   using SchedulerEntryPtr = std::unique_ptr<SchedulerEntry>;
 
+  //! Launch constraints of each segmented group, indexed by group id
+  using LaunchConstraints = std::vector<LaunchParams>;
+
   //! Evicts internally cached parameters based on input sizes.
   //!  An interface used by runtime caches.
   void evictCache(size_t input_id) {
@@ -82,8 +89,15 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
       std::unordered_map<Val*, const ArgAbstract*>& tensor_map,
       KernelArgumentHolder& args);
 
-  //! Unified interface to run the managed kernels with given input
-  std::vector<at::Tensor> runWithInput(KernelArgumentHolder& args);
+  //! Unified interface to run the managed kernels with given input. Can be
+  //! called concurrently, see [ Note -- Concurrent Executions ].
+  //!
+  //! launch_constraints overrides the launch constraints of the scheduler
+  //! entries of this runtime, e.g. when running inputs that were matched to
+  //! this runtime through getMaybeHeuristicsFor.
+  std::vector<at::Tensor> runWithInput(
+      KernelArgumentHolder& args,
+      const LaunchConstraints* launch_constraints = nullptr);
 
   //! Turn On/Off profiling
   void profile(bool to_profile = true) {
@@ -119,6 +133,10 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
     return heuristics_.get();
   }
 
+  //! Rough estimate of the host memory held by this runtime: the segmented
+  //!  fusion and its executors
+  size_t approximateMemoryBytes();
+
   //! Return the most recently used executor, corresponding to the
   //!  most recent kernel launch.
   //! TODO: have a interface for grabbing all recent logs. Need to put a buffer
@@ -126,19 +144,22 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
   ExecutorLog getMostRecentExecutorLog() {
     TORCH_INTERNAL_ASSERT(
         profiling_, "Executor log is only produced in profiling mode");
+    std::lock_guard<std::mutex> guard(mutex_);
     return most_recent_executor_log_;
   }
 
   // Try to compute heuristics based on the SegmentedFusion managed
   //  in this kernel runtime, and will return a nullopt if either
-  //  any segment cannot be scheduled or the parameters don't match
+  //  any segment cannot be scheduled or the parameters don't match.
+  //  Waits for in-flight runWithInput calls, see run_mutex_
   using HeuristicsPtr = std::unique_ptr<FusionHeuristics>;
   c10::optional<HeuristicsPtr> getMaybeHeuristicsFor(
       const KernelArgumentHolder& args);
 
-  //! Copy the launch params given in the parameter heuristics to prepare
-  //!  for kernel launch for a new input dimension but same heuristics
-  void updateHeuristicsLaunchParams(FusionHeuristics* update_heuristics);
+  //! Collect the launch constraints of each group from heuristics, e.g. the
+  //!  ones returned by getMaybeHeuristicsFor
+  static std::shared_ptr<const LaunchConstraints> launchConstraintsOf(
+      FusionHeuristics* heuristics);
 
  private:
   //! Interface to run a single kernel, either one kernel for single-kernel
@@ -146,7 +167,14 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
   //! the kernel outputs.
   std::vector<at::Tensor> runKernelWithInput(
       KernelArgumentHolder& args,
-      SegmentedGroup* sg);
+      SegmentedGroup* sg,
+      const LaunchParams& launch_constraints);
+
+  //! Compiles the kernel of a segmented group unless it's already compiled
+  void maybeCompileKernel(
+      const KernelArgumentHolder& args,
+      SegmentedGroup* sg,
+      const LaunchParams& launch_constraints);
 
   //! Interface to compile a single kernel, either one kernel for single-kernel
   //! fusions, or a kernel for a segmentedGrouup in a segmented fusion. Returns
@@ -172,6 +200,15 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
   //! Executors holding compiled kernels
   std::vector<FusionExecutor> executors_;
 
+  //! Entries indexed by wave of runtime_workspace_.group_run_waves:
+  //! Executors packing the groups of a wave into one kernel, null for
+  //!  waves of a single group
+  std::vector<std::unique_ptr<HorizontalFusionExecutor>> horizontal_executors_;
+
+  //! Set once the executor of a group is known to be compiled, so launches
+  //!  only take mutex_ before that
+  std::unique_ptr<std::atomic<bool>[]> executors_compiled_;
+
   //! Heuristics object holding scheduler entries for all segments
   std::unique_ptr<FusionHeuristics> heuristics_;
 
@@ -187,6 +224,9 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
     //! Pre-determined order to run the segmented groups
     std::vector<SegmentedGroup*> group_run_order;
 
+    //! Waves of independent groups, see Note [Horizontal Fusion]
+    std::vector<std::vector<SegmentedGroup*>> group_run_waves;
+
     //! Pre-determined order to bind tensor input meta data
     std::vector<Val*> group_extent_binding_order;
   } runtime_workspace_;
@@ -197,12 +237,19 @@ class TORCH_CUDA_CU_API FusionKernelRuntime {
   // States for profiling support
   bool profiling_ = false;
 
+  //! Guards compilation of executors and the profiling log. Not held while
+  //! launching compiled kernels.
   std::mutex mutex_;
   // TODO: remove `compiling_` mutex and rely on `mutex_` only.
   // we don't need the second mutex, if only I could figure out how to pass
   // unique_lock into lambda
   std::mutex compiling_;
 
+  //! Held shared by runWithInput and exclusively by getMaybeHeuristicsFor,
+  //!  which rebinds precomputed_values_ and temporarily rewires the inputs
+  //!  and outputs of the complete fusion to check each segment
+  std::shared_timed_mutex run_mutex_;
+
   // The heuristics and executor for most recent kernel launch
   ExecutorLog most_recent_executor_log_;
 };
@@ -245,11 +292,8 @@ class TORCH_CUDA_CU_API InputsIdLookup : public NonCopyable {
   }
 
  private:
-  // string to store encoded input meta information. Reuse the buffer instead of
-  // stringtream gives few us perf gain.
-  std::string encoding_; // Note: shared state, guarded by mutex_
-
-  // mutex_ used to guard reused encoding_
+  // mutex_ used to guard the lookup table and LRU list below. Input meta
+  // information is encoded into a reused thread local buffer before taking it.
   std::mutex mutex_;
 
   //! entry stored in `encoding_lookup_` to implement LRU
@@ -321,6 +365,40 @@ class TORCH_CUDA_CU_API InputsIdLookup : public NonCopyable {
 //!     e) scalar type;
 //!
 //!
+//! [ Note -- Concurrent Executions ]
+//! A FusionExecutorCache can be run from multiple threads, and
+//! CudaFusionManager doesn't hold a lock while running a graph, so both
+//! different graphs and the same graph run concurrently, e.g. on per-thread
+//! streams. On a cache hit:
+//!     a. `InputsIdLookup` only locks to look up and refresh the LRU entry;
+//!     b. the runtime of the input id is read from an immutable snapshot of
+//!        the id index, without locking;
+//!     c. `FusionKernelRuntime` and `FusionExecutor` launch compiled kernels
+//!        re-entrantly, see Note [Concurrent Kernel Launches].
+//! Locks are only held to insert or evict entries and to compile kernels.
+//! Matching a new input id against an existing runtime mutates the runtime,
+//! so it waits for the runs in flight on that runtime to finish.
+//! Launch constraints are recorded per input id along with the runtime, so
+//! scheduler entries of a runtime are not mutated once it's created.
+//!
+//!
+//! [ Note -- Batched Executions ]
+//! runFusionWithInputsBatch runs the fusion on N input sets, e.g. the
+//! micro-batches of a step, in three passes instead of N full runs:
+//!     a. the permutation map is read once, and the inputs of every set are
+//!        permuted and converted to a `KernelArgumentHolder`, which looks up
+//!        their input id;
+//!     b. the runtime of each distinct input id is resolved once, so sets of
+//!        the same shapes share a single index lookup;
+//!     c. the kernels of all sets are launched back to back, optionally
+//!        round-robin on a list of streams.
+//! Outputs are allocated per set. `FusionExecutor` allocates them from the
+//! sizes recorded for the input id, and doesn't take pre-allocated outputs
+//! on that short cut, so a single allocation for all sets would cost more
+//! host time than it saves. The caching allocator serves the repeated
+//! allocations from its pool.
+//!
+//!
 //! [ Note -- Segmented Fusion Tentative Design ]
 //! Segmentation adds an extra dimension in caching. Initial implementation,
 //! assumed graph partition strategy is independent of input pattern, which we
@@ -341,6 +419,15 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
   std::vector<at::Tensor> runFusionWithInputs(
       const at::ArrayRef<IValue>& inputs);
 
+  //! Execute fusion graph on each of the input sets, see
+  //! [ Note -- Batched Executions ]. The input sets are assigned to streams
+  //! round-robin, or run on the current stream if no streams are given. The
+  //! given streams wait for the work already queued on the current stream.
+  //! The caller synchronizes the streams before using the outputs elsewhere.
+  std::vector<std::vector<at::Tensor>> runFusionWithInputsBatch(
+      const std::vector<std::vector<IValue>>& input_sets,
+      const std::vector<c10::cuda::CUDAStream>& streams = {});
+
   Fusion* fusion() {
     return fusion_.get();
   }
@@ -349,19 +436,25 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
     fusion_->printMath();
   }
 
+  //! Rough estimate of the host memory held by this cache: the unscheduled
+  //!  fusion and all the kernel runtimes created for it
+  size_t approximateMemoryBytes();
+
   FusionKernelRuntime* getMostRecentKernelRuntime() {
-    return most_recent_runtime_;
+    return most_recent_runtime_.load();
   }
 
   // TODO: in a follow up we need a global logging structure
   //  to capture runtime profiling info. We also need to define
   //  a suitable profiling window / buffer size.
   ExecutorLog getMostRecentExecutorInfo() {
-    TORCH_INTERNAL_ASSERT(most_recent_runtime_ != nullptr);
-    return most_recent_runtime_->getMostRecentExecutorLog();
+    auto most_recent_runtime = most_recent_runtime_.load();
+    TORCH_INTERNAL_ASSERT(most_recent_runtime != nullptr);
+    return most_recent_runtime->getMostRecentExecutorLog();
   }
 
   void profile(bool to_profile) {
+    std::lock_guard<std::mutex> guard(mutex_);
     profiling_ = to_profile;
     for (auto& it : kernel_runtimes_) {
       for (auto& kernel_runtime : it.second) {
@@ -372,6 +465,7 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
 
   //! Internal knob for profiling shape inference
   void disableLaunchParamCache() {
+    std::lock_guard<std::mutex> guard(mutex_);
     for (auto& it : kernel_runtimes_) {
       for (auto& kernel_runtime : it.second) {
         kernel_runtime->disableLaunchParamCache();
@@ -381,6 +475,7 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
 
   //! Internal knob for profiling shape inference
   void disableKernelLaunch() {
+    std::lock_guard<std::mutex> guard(mutex_);
     for (auto& it : kernel_runtimes_) {
       for (auto& kernel_runtime : it.second) {
         kernel_runtime->disableKernelLaunch();
@@ -389,7 +484,8 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
   }
 
   //! converts inputs from IValue to KernelArgumentHolder, also handles cache
-  //! lookup
+  //! lookup. Not synchronized, callers running the cache from multiple
+  //! threads need to serialize it with the other entry points.
   KernelArgumentHolder prepareInputs(const at::ArrayRef<IValue>& inputs);
 
   //! query if there's a kernel ready to go for given inputs
@@ -406,7 +502,27 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
   //! entry in `FusionExecutor`
   void evictCache(size_t cache_id);
 
-  FusionKernelRuntime* getKernelRuntimeFor(const KernelArgumentHolder& inputs);
+  //! Kernel runtime selected for an input id, with the launch constraints of
+  //!  the heuristics it was matched with
+  struct RuntimeIndexEntry {
+    FusionKernelRuntime* kernel_runtime = nullptr;
+    std::shared_ptr<const FusionKernelRuntime::LaunchConstraints>
+        launch_constraints;
+  };
+
+  using RuntimeIndex = std::unordered_map<size_t, RuntimeIndexEntry>;
+
+  RuntimeIndexEntry getKernelRuntimeFor(const KernelArgumentHolder& inputs);
+
+  //! Permutes input tensors for kernel execution, see Part_1 in
+  //! Note [ Permutation support in nvfuser ]. Returns inputs if none is
+  //! permuted, or a view of permuted_inputs otherwise.
+  at::ArrayRef<IValue> permuteInputs(
+      const at::ArrayRef<IValue>& inputs,
+      std::vector<IValue>& permuted_inputs);
+
+  //! Restores the layout of permuted outputs and removes aliased outputs
+  void finalizeOutputs(std::vector<at::Tensor>& outputs);
 
  private:
   //! original un-scheduled `Fusion`;
@@ -425,18 +541,25 @@ class TORCH_CUDA_CU_API FusionExecutorCache {
   //! Logging state for most recent compilation
   ExecutorLog most_recent_executor_log_;
 
-  //! short-cut for cache hit
-  std::unordered_map<size_t, FusionKernelRuntime*> id_to_kernel_runtime_;
+  //! short-cut for cache hit. An immutable snapshot, replaced as a whole on
+  //! insertion and eviction and read with std::atomic_load, so cache hits
+  //! don't take mutex_.
+  std::shared_ptr<const RuntimeIndex> id_to_kernel_runtime_ =
+      std::make_shared<const RuntimeIndex>();
 
   //! Profiling info:
   //! TODO: this can be largely expanded to look at complete
   //!   caching profiles. Currently it just makes it easier to test
-  FusionKernelRuntime* most_recent_runtime_ = nullptr;
+  std::atomic<FusionKernelRuntime*> most_recent_runtime_{nullptr};
 
   //! indices of fusion outputs that are aliased to inputs. These are used only
   //! to support in-place update and should have been dropped before pushing
   //! outputs to stack.
   std::set<int> aliased_output_indices_;
+
+  //! Guards insertion into the lookup tables above, see
+  //!  [ Note -- Concurrent Executions ]
+  std::mutex mutex_;
 };
 
 class GraphCache {
@@ -989,8 +989,11 @@ class AllocateReuseModifier {
         //    enabled.
         //  Need a few more checks to insert syncs if necessary before turning
         //    on this sharing.
+        //  Only thread private buffers, e.g. the persistent buffers of
+        //    Note [Shared Memory Persistence], are shared for now.
         if (!inner_aliasing_pass_ &&
-            alloc_info->mem_type == MemoryType::Shared) {
+            alloc_info->mem_type == MemoryType::Shared &&
+            !isValidThreadPrivateSharing(alloc_info, alloc_to_reuse)) {
           continue;
         }
 
@@ -1113,6 +1116,42 @@ class AllocateReuseModifier {
     return false;
   }
 
+  //! Shared memory buffers can share memory across live intervals without
+  //!  additional syncs if each element is only accessed by the thread
+  //!  writing it, i.e. no raw sync is needed, and both are indexed the same
+  //!  way.
+  bool isValidThreadPrivateSharing(
+      AllocationUseDefInfo* alloc_info,
+      AllocationUseDefInfo* to_reuse) {
+    auto this_tv = alloc_info->alloc_expr->buffer()->as<TensorView>();
+    auto reuse_tv = to_reuse->alloc_expr->buffer()->as<TensorView>();
+
+    const auto& sync_map = GpuLower::current()->syncMap();
+    if (!sync_map.needsRawSync(this_tv).none() ||
+        !sync_map.needsRawSync(reuse_tv).none()) {
+      return false;
+    }
+
+    if (this_tv->hasSwizzleOp() || reuse_tv->hasSwizzleOp()) {
+      return false;
+    }
+
+    auto& local_alloc_map = GpuLower::current()->localAllocationInfoMap();
+    auto alloc_it = local_alloc_map.find(alloc_info->alloc_expr);
+    auto to_reuse_it = local_alloc_map.find(to_reuse->alloc_expr);
+    if (alloc_it == local_alloc_map.end() ||
+        to_reuse_it == local_alloc_map.end()) {
+      return false;
+    }
+
+    if (alloc_it->second->has_halo || to_reuse_it->second->has_halo) {
+      return false;
+    }
+
+    return allocationDomainsIndexMapped(
+        alloc_it->second->alloc_domains, to_reuse_it->second->alloc_domains);
+  }
+
   InPlaceSharingInfo checkOpsInBetween(std::vector<Val*>& all_used_vals) {
     InPlaceSharingInfo info;
     std::unordered_set<Val*> all_used_val_set(
@@ -1,5 +1,6 @@
 #include <third_party/nvfuser/executor.h>
 #include <third_party/nvfuser/fusion.h>
+#include <third_party/nvfuser/graph_signature.h>
 #include <third_party/nvfuser/instrumentation.h>
 #include <third_party/nvfuser/ir_iostream.h>
 #include <third_party/nvfuser/kernel_cache.h>
@@ -20,6 +21,11 @@
 #include <c10/core/DeviceType.h>
 #include <c10/util/irange.h>
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
 
 namespace torch {
@@ -33,23 +39,25 @@ namespace cuda {
 //! node, including selection, construction and execution of FusionExecutors.
 //!
 //! CudaFusionManager bridges PyTorch IR node CudaFusionGroup to GraphCache.
-//! Therefore, we want to cache on stringified graph. But it is expensive to
-//! stringify and hash on a computational graph, we cache the hash of a
-//! stringified graph on node via cache_id.
+//! Therefore, we want to cache on the structure of the graph. Rendering the
+//! graph to text and hashing it is expensive for large fusion groups, so we
+//! key on a GraphSignature of the canonicalized graph (see Note [Graph
+//! Signature]), which is computed once per compilation of a node. The
+//! resulting id is cached on the node via cache_id.
 //!
 //! CudaFusionGroup node stores:
 //!     i.  a PyTorch IR in `attr::Subgraph`
-//!     ii. an int in `attr::cache_id`, (a cached hash value of
+//!     ii. an int in `attr::cache_id`, (the id assigned to the signature of
 //!     `attr::Subgraph`)
 //!
-//! We have 2 unordered_map at CudaFusionGroup:
-//!   std::unordered_map<std::string, int32_t> graph_cache_ids_;
-//!   std::unordered_map<int64_t, std::unique_ptr<GraphCache>> graph_cache_;
+//! We have 2 maps at CudaFusionManager:
+//!   std::unordered_map<GraphSignature, int32_t> graph_cache_ids_;
+//!   KernelIdTable kernel_id_table_;
 //!
-//! Mapping from std::string to graph_cache_id ensures that we assign the same
-//! cache_id to CudaFusionGroup with identical computational grah, allowing
-//! kernel reuse; Direct mapping from cache_id to GraphCache allows efficient
-//! graph_cache indexing;
+//! Mapping from GraphSignature to graph_cache_id ensures that we assign the
+//! same cache_id to CudaFusionGroup with identical computational grah,
+//! allowing kernel reuse; Direct mapping from cache_id to GraphCache allows
+//! efficient graph_cache indexing, without taking a lock at run time;
 
 namespace {
 
@@ -87,9 +95,95 @@ static std::unique_ptr<Code> createFallbackCode(const Node* fusion_node) {
   return code;
 }
 
-// CudaFusionManager is not thread safe!
-// TODO: we should make the tradeoff here to use thread_local instead of global
-// singleton;
+//! Table from kernel id to the GraphCache and fallback code registered under
+//!  it. Kernel ids are handed out densely by CudaFusionManager, so entries
+//!  live in fixed-size chunks that never move once allocated. The directory
+//!  of chunks doubles when an id is past its end; replaced directories are
+//!  kept alive for lookups that still read them. Lookups are atomic loads
+//!  that don't take the registration lock, while registration is serialized
+//!  by the caller.
+//!
+//! Graph caches are shared with the threads running them, so unregistering
+//!  a graph cache releases it once the last run holding it finishes.
+class KernelIdTable {
+ public:
+  struct Entry {
+    //! Only accessed through std::atomic_load and std::atomic_store
+    std::shared_ptr<GraphCache> graph_cache;
+    std::atomic<Code*> fallback_code{nullptr};
+  };
+
+  //! Lock-free lookup, returns nullptr if no entry was created for kernel_id
+  Entry* find(int32_t kernel_id) const {
+    if (kernel_id < 0) {
+      return nullptr;
+    }
+    auto directory = directory_.load(std::memory_order_acquire);
+    size_t chunk_index = kernel_id / kChunkSize;
+    if (directory == nullptr || chunk_index >= directory->size()) {
+      return nullptr;
+    }
+    auto chunk = (*directory)[chunk_index].load(std::memory_order_acquire);
+    return chunk == nullptr ? nullptr : &chunk[kernel_id % kChunkSize];
+  }
+
+  //! Returns the entry of kernel_id, allocating its chunk if needed. Calls
+  //!  need to be serialized, but can run concurrently with find.
+  Entry& getOrCreate(int32_t kernel_id) {
+    TORCH_CHECK(
+        kernel_id >= 0,
+        "Kernel id out of range of CudaFusionManager: ",
+        kernel_id);
+    size_t chunk_index = kernel_id / kChunkSize;
+    auto directory = directory_.load(std::memory_order_relaxed);
+    if (directory == nullptr || chunk_index >= directory->size()) {
+      directory = growDirectory(chunk_index + 1);
+    }
+    auto& chunk_ptr = (*directory)[chunk_index];
+    auto chunk = chunk_ptr.load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+      owned_chunks_.emplace_back(std::make_unique<Entry[]>(kChunkSize));
+      chunk = owned_chunks_.back().get();
+      chunk_ptr.store(chunk, std::memory_order_release);
+    }
+    return chunk[kernel_id % kChunkSize];
+  }
+
+ private:
+  using Directory = std::vector<std::atomic<Entry*>>;
+
+  //! Publishes a directory of at least min_chunks chunks holding the chunks
+  //!  allocated so far
+  Directory* growDirectory(size_t min_chunks) {
+    auto old_directory = directory_.load(std::memory_order_relaxed);
+    size_t old_size = old_directory == nullptr ? 0 : old_directory->size();
+    auto new_directory = std::make_unique<Directory>(
+        std::max({min_chunks, 2 * old_size, kInitialChunks}));
+    for (const auto i : c10::irange(new_directory->size())) {
+      (*new_directory)[i].store(
+          i < old_size ? (*old_directory)[i].load(std::memory_order_relaxed)
+                       : nullptr,
+          std::memory_order_relaxed);
+    }
+    owned_directories_.emplace_back(std::move(new_directory));
+    auto directory = owned_directories_.back().get();
+    directory_.store(directory, std::memory_order_release);
+    return directory;
+  }
+
+  static constexpr int32_t kChunkSize = 256;
+  static constexpr size_t kInitialChunks = 16;
+
+  std::atomic<Directory*> directory_{nullptr};
+  std::vector<std::unique_ptr<Directory>> owned_directories_;
+  std::vector<std::unique_ptr<Entry[]>> owned_chunks_;
+};
+
+//! CudaFusionManager is safe to use from multiple threads. Registration of
+//!  graphs and fallback code serializes on registration_mutex_, while running
+//!  a fusion node only does a lock-free lookup of its GraphCache. Executions
+//!  of the same graph are synchronized by its FusionExecutorCache, so
+//!  different graphs run concurrently.
 // NOLINTNEXTLINE(cppcoreguidelines-pro-type-member-init)
 class CudaFusionManager {
  public:
@@ -98,76 +192,86 @@ class CudaFusionManager {
     return cuda_fusion_manager_;
   };
 
-  // TODO: I'm assuming we have stride information in `graph->toString`
-  //       We need to make sure stride information is in the final string, as we
-  //       want to AVOID kernel reuse between different fusion_node, unless they
-  //       have identical contiguity information! (So identical stride + shape
-  //       is even more restricting in a good way)
-  int32_t registerOrGetCacheId(std::shared_ptr<Graph>& graph) {
+  // Signature of graph used as the key of graph_cache_ids_. Note the
+  //  signature includes stride properties of tensor types, as we want to AVOID
+  //  kernel reuse between different fusion_node, unless they have identical
+  //  contiguity information!
+  static GraphSignature makeSignature(const std::shared_ptr<Graph>& graph) {
     // prepare graph for lowering;
     // We should not call `EraseShapeInformation(graph);`, graph representation
     // does not incorporate static sizes, but just rank of input tensors, which
     // is exactly what we wanted.
     auto canonical_graph = Canonicalize(graph, false);
-    auto repr = canonical_graph->toString(false);
+    return GraphSignature(canonical_graph);
+  }
 
-    std::lock_guard<std::mutex> guard(mutex_);
+  int32_t registerOrGetCacheId(
+      const GraphSignature& signature,
+      std::shared_ptr<Graph>& graph) {
+    std::lock_guard<std::mutex> guard(registration_mutex_);
     // create new graph_cache_ids_ entry if none existed yet;
-    if (graph_cache_ids_.count(repr) == 0) {
-      int32_t kernel_id = getNextUniqueID();
-      graph_cache_ids_[repr] = kernel_id;
-      TORCH_CHECK(
-          graph_cache_.emplace(kernel_id, std::make_unique<GraphCache>(graph))
-              .second);
+    auto id_it = graph_cache_ids_.find(signature);
+    if (id_it != graph_cache_ids_.end()) {
+      return id_it->second;
     }
-    return graph_cache_ids_[repr];
+    // Built before an id is taken, so that a graph that fails to compile
+    //  does not use up an id
+    auto graph_cache = std::make_shared<GraphCache>(graph);
+    int32_t kernel_id = getNextUniqueID();
+    auto& entry = kernel_id_table_.getOrCreate(kernel_id);
+    TORCH_CHECK(std::atomic_load(&entry.graph_cache) == nullptr);
+    std::atomic_store(&entry.graph_cache, std::move(graph_cache));
+    graph_cache_ids_.emplace(signature, kernel_id);
+    return kernel_id;
   };
 
   // get fallback kernel id
   int32_t getFallbackKernelId() {
-    std::lock_guard<std::mutex> guard(mutex_);
+    std::lock_guard<std::mutex> guard(registration_mutex_);
     return getNextUniqueID();
   }
 
-  void unregisterCacheId(std::shared_ptr<Graph>& graph) {
-    auto canonical_graph = Canonicalize(graph, false);
-    auto repr = canonical_graph->toString(false);
-
-    // create new graph_cache_ids_ entry if none existed yet;
-    if (graph_cache_ids_.count(repr) > 0) {
-      int32_t kernel_id = graph_cache_ids_[repr];
-      graph_cache_.erase(kernel_id);
-      graph_cache_ids_.erase(repr);
+  void unregisterCacheId(const GraphSignature& signature) {
+    std::lock_guard<std::mutex> guard(registration_mutex_);
+    auto id_it = graph_cache_ids_.find(signature);
+    if (id_it == graph_cache_ids_.end()) {
+      return;
+    }
+    int32_t kernel_id = id_it->second;
+    graph_cache_ids_.erase(id_it);
+    // Threads still running the graph cache keep it alive until they finish
+    if (auto entry = kernel_id_table_.find(kernel_id)) {
+      std::atomic_store(&entry->graph_cache, std::shared_ptr<GraphCache>());
     }
   }
 
   std::vector<at::Tensor> runFusionNode(
       int32_t kernel_id,
       const at::ArrayRef<IValue> inputs) {
-    std::lock_guard<std::mutex> guard(mutex_);
+    auto entry = kernel_id_table_.find(kernel_id);
+    auto graph_cache =
+        entry == nullptr ? nullptr : std::atomic_load(&entry->graph_cache);
     TORCH_INTERNAL_ASSERT(
-        graph_cache_.count(kernel_id) > 0, "graph cache miss at run time");
-    return graph_cache_[kernel_id]->runGraphWithInputs(inputs);
+        graph_cache != nullptr, "graph cache miss at run time");
+    return graph_cache->runGraphWithInputs(inputs);
   }
 
   bool hasFallbackCode(int32_t kernel_id) {
-    std::lock_guard<std::mutex> guard(mutex_);
-    return fallback_cache_.count(kernel_id);
+    return lookupFallbackCode(kernel_id) != nullptr;
   }
 
   Code* getFallbackCode(int32_t kernel_id, const Node* fusion_node) {
-    {
-      std::lock_guard<std::mutex> guard(mutex_);
-      auto it = fallback_cache_.find(kernel_id);
-      if (it != fallback_cache_.end()) {
-        return it->second.get();
-      }
+    if (auto code = lookupFallbackCode(kernel_id)) {
+      return code;
     }
 
     std::unique_ptr<Code> code = createFallbackCode(fusion_node);
 
-    std::lock_guard<std::mutex> guard(mutex_);
+    std::lock_guard<std::mutex> guard(registration_mutex_);
+    auto& entry = kernel_id_table_.getOrCreate(kernel_id);
+    // Another thread may have registered the fallback in the meantime
     auto it = fallback_cache_.insert({kernel_id, std::move(code)}).first;
+    entry.fallback_code.store(it->second.get(), std::memory_order_release);
     return it->second.get();
   }
 
@@ -185,20 +289,38 @@ class CudaFusionManager {
     return false;
   }
 
+  Code* lookupFallbackCode(int32_t kernel_id) const {
+    auto entry = kernel_id_table_.find(kernel_id);
+    return entry == nullptr
+        ? nullptr
+        : entry->fallback_code.load(std::memory_order_acquire);
+  }
+
  private:
-  std::mutex mutex_;
+  //! Guards registration of kernel ids, graph caches and fallback code. Not
+  //!  taken when running fusion nodes.
+  std::mutex registration_mutex_;
 
   void runCudaKernel(
       int32_t key,
       const std::vector<int>& contiguity_tag,
       const c10::Device){};
 
+  //! Ids stay on the fusion nodes they are assigned to, and there is no
+  //!  notification when a node goes away, so ids are not handed out again.
+  //!  The table grows with them instead.
   int32_t getNextUniqueID() {
+    TORCH_CHECK(
+        next_unique_id_ < std::numeric_limits<int32_t>::max(),
+        "Ran out of kernel ids in CudaFusionManager");
     return next_unique_id_++;
   };
 
-  std::unordered_map<std::string, int32_t> graph_cache_ids_;
-  std::unordered_map<int64_t, std::unique_ptr<GraphCache>> graph_cache_;
+  //! Lock-free view of the graph caches and fallback codes below
+  KernelIdTable kernel_id_table_;
+
+  std::unordered_map<GraphSignature, int32_t, GraphSignature::Hash>
+      graph_cache_ids_;
   std::unordered_map<int64_t, std::unique_ptr<Code>> fallback_cache_;
 
   int32_t next_unique_id_ = 0;
@@ -218,6 +340,9 @@ void compileCudaFusionGroup(Node* fusion_node) {
   // This is not a critical code path, it's OK to do graph copy here;
   auto graph = fusion_node->g(attr::Subgraph)->copy();
 
+  // Computed once and shared by registration and the fallback path
+  c10::optional<GraphSignature> signature;
+
   auto compile_fusion = [&]() {
     // type propagation is needed, as the protocol only requires scalar type on
     // input tensors.
@@ -227,8 +352,10 @@ void compileCudaFusionGroup(Node* fusion_node) {
     PropagateShapesOnGraph(graph);
     TypePropagate(graph);
 
+    signature = CudaFusionManager::makeSignature(graph);
     int32_t fusion_cache_id =
-        CudaFusionManager::getManager().registerOrGetCacheId(graph);
+        CudaFusionManager::getManager().registerOrGetCacheId(
+            signature.value(), graph);
     fusion_node->i_(attr::cache_id, fusion_cache_id);
   };
 
@@ -245,7 +372,9 @@ void compileCudaFusionGroup(Node* fusion_node) {
           "To report the issue, try enable logging via setting the env"
           "variable ` export PYTORCH_JIT_LOG_LEVEL=manager.cpp`\n");
       GRAPH_DUMP("`compile_fusion` hits fallback on graph\n", graph);
-      CudaFusionManager::getManager().unregisterCacheId(graph);
+      if (signature.has_value()) {
+        CudaFusionManager::getManager().unregisterCacheId(signature.value());
+      }
     }
   } else {
     compile_fusion();
@@ -12,15 +12,15 @@ struct GemmTile {
   int m, n, k;
   GemmTile(int m_, int n_, int k_) : m(m_), n(n_), k(k_) {}
 
-  bool operator==(const GemmTile& other) {
+  bool operator==(const GemmTile& other) const {
     return m == other.m && n == other.n && k == other.k;
   }
 
-  GemmTile operator/(const GemmTile& other) {
+  GemmTile operator/(const GemmTile& other) const {
     return GemmTile(m / other.m, n / other.n, k / other.k);
   }
 
-  std::vector<int> toVector() {
+  std::vector<int> toVector() const {
     return {m, n, k};
   }
 };
@@ -40,7 +40,7 @@ struct TORCH_CUDA_CU_API MatMulTileOptions {
         warp_tile(warp_tile_),
         instruction_tile(instruction_tile_) {}
 
-  bool operator==(const MatMulTileOptions& other) {
+  bool operator==(const MatMulTileOptions& other) const {
     return cta_tile == other.cta_tile && warp_tile == other.warp_tile &&
         instruction_tile == other.instruction_tile;
   }
@@ -164,6 +164,14 @@ class TORCH_CUDA_CU_API MmaBuilder {
   //! Export all the parameters with user's configurations applied.
   MmaOptions build() const;
 
+  MmaOptions::MacroType macro() const {
+    return option_.macro;
+  }
+
+  MmaOptions::MmaInputLayout operandLayout() const {
+    return option_.operand_layout;
+  }
+
  private:
   MmaOptions option_;
 };
@@ -25,6 +25,10 @@ void NonDivisibleSplitInfo::build(Fusion* fusion) {
     clearReachability();
     traverseFrom(fusion, domain_vals);
     current_tv_ = nullptr;
+
+    if (tv->hasRFactor()) {
+      addRFactorSplitsToValidate(tv);
+    }
   }
 
   if (GpuLower::current() != nullptr) {
@@ -63,6 +67,27 @@ void NonDivisibleSplitInfo::handle(Split* split) {
   propagateReachability(split, is_protected);
 }
 
+void NonDivisibleSplitInfo::addRFactorSplitsToValidate(TensorView* tv) {
+  // A split between the root and rfactor domains reshapes the tensor,
+  // e.g., unflatten, so a remainder can't be predicated away as it
+  // would change which elements end up in each row. Constant extents
+  // are checked when the split is created. Symbolic ones are checked at
+  // run time.
+  const auto& root_domain = tv->getRootDomain();
+  const auto& rfactor_domain = tv->getRFactorDomain();
+  const auto exprs = DependencyCheck::getAllExprsBetween(
+      {root_domain.begin(), root_domain.end()},
+      {rfactor_domain.begin(), rfactor_domain.end()});
+  for (auto split : ir_utils::filterByType<Split>(exprs)) {
+    if (split->in()->isBroadcast()) {
+      continue;
+    }
+    if (getMaybeNonDivisibleExtent(split) != nullptr) {
+      splits_to_validate_.insert(split);
+    }
+  }
+}
+
 bool NonDivisibleSplitInfo::isReachableFromInnerDomains(IterDomain* id) const {
   return inner_domains_.find(id) != inner_domains_.end();
 }
@@ -24,7 +24,9 @@ namespace cuda {
 //! predicating the input domain of the non-divisible split results in
 //! a vectoried operation is predicated out entirely since we do not
 //! generate a fall-back non-vectorized else path. Runtime check is
-//! done for those domains.
+//! done for those domains. The same runtime check is done for
+//! splits of rfactor domains, e.g., by unflatten, as those reshape
+//! the tensor and can't be predicated.
 class TORCH_CUDA_CU_API NonDivisibleSplitInfo : public IterVisitor {
  public:
   void build(Fusion* fusion);
@@ -44,6 +46,11 @@ class TORCH_CUDA_CU_API NonDivisibleSplitInfo : public IterVisitor {
 
   void handle(Merge* merge) override;
 
+  //! Splits of rfactor domains must be divisible as they reshape
+  //! the tensor. Adds the ones not proven to be divisible to
+  //! splits_to_validate_.
+  void addRFactorSplitsToValidate(TensorView* tv);
+
   //! True if reachable from inner domains of splits
   bool isReachableFromInnerDomains(IterDomain* id) const;
 
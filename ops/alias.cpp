@@ -139,6 +139,16 @@ TensorView* flatten(TensorView* x, int64_t start_dim, int64_t end_dim) {
   return out;
 }
 
+TensorView* unflatten(TensorView* x, int64_t dim, int64_t inner_size) {
+  auto out = IrBuilder::create<TensorView>(
+      x->container(),
+      x->domain()->unflatten(dim, inner_size),
+      x->getDataType().value());
+
+  IrBuilder::create<ViewOp>(out, x);
+  return out;
+}
+
 TensorView* squeeze(TensorView* x, const std::vector<int64_t>& sizes) {
   const auto ndims = static_cast<int>(x->domain()->noReductions().size());
 
@@ -28,6 +28,15 @@ TORCH_CUDA_CU_API TensorView* flatten(
     int64_t start_dim = 0,
     int64_t end_dim = -1);
 
+//! Inverse of flatten, splits dim into [extent / inner_size, inner_size].
+//!  Unlike view, the extent of dim doesn't need to be known when the fusion
+//!  is defined, but it has to be divisible by inner_size. A constant
+//!  extent is checked here, a symbolic one when the fusion is run.
+TORCH_CUDA_CU_API TensorView* unflatten(
+    TensorView* x,
+    int64_t dim,
+    int64_t inner_size);
+
 TORCH_CUDA_CU_API TensorView* squeeze(
     TensorView* x,
     const std::vector<int64_t>& sizes);
@@ -1,5 +1,6 @@
 #include <third_party/nvfuser/arith.h>
 #include <third_party/nvfuser/ir_builder.h>
+#include <third_party/nvfuser/ops/alias.h>
 #include <third_party/nvfuser/ops/composite.h>
 #include <third_party/nvfuser/transform_view.h>
 
@@ -43,12 +44,85 @@ TensorView* dropout_backward(TensorView* dy, TensorView* mask, Val* scale) {
           scale->getDataType().value() == DataType::Double,
       "Scale is not a valid Double.");
 
+  if (mask->getDataType().value() == DataType::Int32) {
+    mask = unpack_mask(mask);
+  }
   auto grad_mask = mul(dy, mask);
   auto dx = mul(grad_mask, scale);
 
   return dx;
 }
 
+namespace {
+
+// Number of mask elements in a packed word, see Note [Packed Masks]
+constexpr int64_t kMaskBitsPerWord = 32;
+
+// Bit positions of a word, [0, kMaskBitsPerWord), broadcast to ndims
+//  dimensions along the innermost one
+TensorView* maskBitPositions(size_t ndims) {
+  auto positions =
+      arange(IrBuilder::create<Int>(kMaskBitsPerWord), DataType::Int);
+  std::vector<bool> bcast_flags(ndims, true);
+  bcast_flags.back() = false;
+  return broadcast(positions, bcast_flags);
+}
+
+} // namespace
+
+TensorView* pack_mask(TensorView* mask) {
+  TORCH_INTERNAL_ASSERT(mask != nullptr, "Mask is invalid");
+  TORCH_CHECK(
+      mask->getDataType().value() == DataType::Bool,
+      "Only Bool masks can be packed, but got ",
+      mask->getDataType().value());
+
+  auto mask_domain =
+      TensorDomain::noReductions(mask->getMaybeRFactorDomain());
+  TORCH_CHECK(!mask_domain.empty(), "Can't pack a 0-dim mask");
+  auto mask_extent = mask_domain.back()->extent()->getInt();
+  TORCH_CHECK(
+      !mask_extent.has_value() || mask_extent.value() % kMaskBitsPerWord == 0,
+      "The innermost extent of a mask to pack must be a multiple of ",
+      kMaskBitsPerWord,
+      ", but got ",
+      mask_extent.value_or(0));
+
+  // [..., N] -> [..., N / 32, 32]. A symbolic N is validated at run time
+  //  as unflatten is an rfactor split, see Note [Packed Masks]
+  auto words = unflatten(mask, -1, kMaskBitsPerWord);
+  auto ndims =
+      TensorDomain::noReductions(words->getMaybeRFactorDomain()).size();
+
+  auto bits = castOp(DataType::Int, words);
+  auto shifted = bitwise_left_shift(bits, maskBitPositions(ndims));
+  // Bits don't overlap, so the sum is the same as a bitwise or
+  auto packed = sum(shifted, {-1});
+  return castOp(DataType::Int32, packed);
+}
+
+TensorView* unpack_mask(TensorView* packed_mask) {
+  TORCH_INTERNAL_ASSERT(packed_mask != nullptr, "Packed mask is invalid");
+  TORCH_CHECK(
+      packed_mask->getDataType().value() == DataType::Int32,
+      "Packed masks are Int32, but got ",
+      packed_mask->getDataType().value());
+
+  // [..., N / 32] -> [..., N / 32, 32]
+  auto ndims =
+      TensorDomain::noReductions(packed_mask->getMaybeRFactorDomain()).size();
+  std::vector<bool> bcast_flags(ndims + 1, false);
+  bcast_flags.back() = true;
+  auto words = broadcast(castOp(DataType::Int, packed_mask), bcast_flags);
+
+  auto shifted = bitwise_right_shift(words, maskBitPositions(ndims + 1));
+  auto bits = bitwise_and(shifted, IrBuilder::create<Int>(1));
+  auto mask = ne(bits, IrBuilder::create<Int>(0));
+
+  // [..., N / 32, 32] -> [..., N]
+  return flatten(mask, -2, -1);
+}
+
 LstmResult lstm(
     TensorView* prev_cell,
     TensorView* in_x,
@@ -26,11 +26,32 @@ TORCH_CUDA_CU_API ForwardDropoutResult dropout(TensorView* x, Val* prob);
 TORCH_CUDA_CU_API ForwardDropoutResult
 dropout(TensorView* x, Val* prob, Val* scale);
 
+//! Mask may be either a Bool tensor or an Int32 tensor made by pack_mask
 TORCH_CUDA_CU_API TensorView* dropout_backward(
     TensorView* dy,
     TensorView* mask,
     Val* scale);
 
+//! Note [Packed Masks]
+//!
+//! A Bool mask takes a byte per element. pack_mask packs 32 consecutive
+//!  elements of the innermost dimension into the bits of an Int32 word,
+//!  element i of a word landing in bit i, which cuts the memory traffic of
+//!  saving the mask between forward and backward, e.g. for dropout, by 8x.
+//!  unpack_mask restores the Bool mask.
+//!
+//! The innermost extent of the mask must be a multiple of 32. pack_mask
+//!  checks a constant extent when the fusion is defined and a symbolic one
+//!  when it's run. The extent unpack_mask produces is always a multiple of
+//!  32.
+//!
+//! Packing is a sum over the 32 bits of each word, so a fusion that packs
+//!  its mask, e.g. a dropout forward, has a reduction and is scheduled by
+//!  the reduction scheduler rather than the pointwise one.
+TORCH_CUDA_CU_API TensorView* pack_mask(TensorView* mask);
+
+TORCH_CUDA_CU_API TensorView* unpack_mask(TensorView* packed_mask);
+
 struct LstmResult {
   TensorView* cell = nullptr;
   TensorView* hidden = nullptr;
@@ -1,14 +1,145 @@
 #include <third_party/nvfuser/python_frontend/fusion_cache.h>
 #include <third_party/nvfuser/python_frontend/fusion_record.h>
-#include <mutex>
+
+#include <c10/util/hash.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 
 namespace nvfuser {
 
 static std::mutex fusion_cache_lock;
 FusionCache* FusionCache::singleton_ = nullptr;
 
+namespace {
+
+// See Note [Fusion Cache Serialization]. The version needs to be bumped
+// whenever the layout below or the printed form of a record changes.
+constexpr char kFusionCacheMagic[8] = {'N', 'V', 'F', 'C', 'A', 'C', 'H', 'E'};
+constexpr uint64_t kFusionCacheVersion = 1;
+
+//! The max_fusions of a FusionCache created by a FusionDefinition
+constexpr size_t kDefaultMaxFusions = 8192;
+
+//! The key of a record in a saved cache: its type and its python definition,
+//! with constants printed at full precision.
+std::string serializeRecord(const RecordFunctor* rec) {
+  TORCH_CHECK(rec, "Record is null!");
+  std::stringstream ss;
+  ss << std::setprecision(std::numeric_limits<double>::max_digits10);
+  ss << static_cast<int>(rec->recordType()) << ":";
+  rec->print(ss);
+  return ss.str();
+}
+
+const std::string& endRecordKey() {
+  static const EndRecord end_record;
+  static const std::string end_key = serializeRecord(&end_record);
+  return end_key;
+}
+
+void writeUInt(std::ostream& os, uint64_t value) {
+  os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+uint64_t readUInt(std::istream& is) {
+  uint64_t value = 0;
+  is.read(reinterpret_cast<char*>(&value), sizeof(value));
+  TORCH_CHECK(is.good(), "Unexpected end of the FusionCache file!");
+  return value;
+}
+
+void writeString(std::ostream& os, const std::string& str) {
+  writeUInt(os, str.size());
+  os.write(str.data(), str.size());
+}
+
+std::string readString(std::istream& is) {
+  auto size = readUInt(is);
+  std::string str(size, '\0');
+  is.read(&str[0], size);
+  TORCH_CHECK(is.good(), "Unexpected end of the FusionCache file!");
+  return str;
+}
+
+//! Each entry is written as its key, fusion id, visits and its children in
+//! the order of their keys, so that saving a cache is deterministic.
+void saveEntry(
+    std::ostream& os,
+    const std::string& key,
+    const FusionCacheEntry* entry,
+    const std::function<std::mutex&(const FusionCacheEntry*)>& entry_lock) {
+  writeString(os, key);
+  writeUInt(os, entry->fusion_id);
+  writeUInt(os, entry->visits);
+
+  std::vector<std::pair<std::string, const FusionCacheEntry*>> children;
+  {
+    std::lock_guard<std::mutex> guard(entry_lock(entry));
+    for (auto& child : entry->record_hash_map) {
+      children.emplace_back(serializeRecord(child.first), child.second.get());
+    }
+    for (auto& child : entry->serialized_children) {
+      children.emplace_back(child.first, child.second.get());
+    }
+  }
+  std::sort(children.begin(), children.end());
+  writeUInt(os, children.size());
+  for (auto& child : children) {
+    saveEntry(os, child.first, child.second, entry_lock);
+  }
+}
+
+//! Terminal entries are gathered by the slot of their fusion id.
+std::unique_ptr<FusionCacheEntry> loadEntry(
+    std::istream& is,
+    std::string& key,
+    std::vector<FusionCacheEntry*>& terminal_entries,
+    const std::function<size_t(size_t)>& fusion_slot) {
+  key = readString(is);
+  auto fusion_id = readUInt(is);
+  auto entry = std::make_unique<FusionCacheEntry>(nullptr, fusion_id);
+  entry->visits = readUInt(is);
+  auto num_children = readUInt(is);
+
+  if (key == endRecordKey()) {
+    auto slot = fusion_slot(fusion_id);
+    TORCH_CHECK(
+        slot < terminal_entries.size() && terminal_entries[slot] == nullptr,
+        "Invalid fusion id ",
+        fusion_id,
+        " in the FusionCache file!");
+    TORCH_CHECK(
+        num_children == 0,
+        "There should be no children from a Terminal Cache Entry!");
+    terminal_entries[slot] = entry.get();
+  }
+
+  for (uint64_t i = 0; i < num_children; ++i) {
+    std::string child_key;
+    auto child = loadEntry(is, child_key, terminal_entries, fusion_slot);
+    child->parent = entry.get();
+    entry->serialized_children[child_key] = std::move(child);
+  }
+  return entry;
+}
+
+} // namespace
+
 FusionCacheEntry::FusionCacheEntry(RecordFunctor* rec, size_t _fusion_id)
-    : record(rec), record_hash_map(), fusion_id(_fusion_id), visits(0) {}
+    : record(rec),
+      record_hash_map(),
+      fusion_id(_fusion_id),
+      visits(0),
+      parent(nullptr),
+      lru_prev(nullptr),
+      lru_next(nullptr),
+      fingerprints() {}
 
 bool FusionCacheEntry::isTerminal() const {
   return (record.get()->recordType() == RecordType::End);
@@ -19,36 +150,61 @@ FusionCache* FusionCache::get(size_t max_fusions) {
   if (singleton_ == nullptr) {
     singleton_ = new FusionCache(max_fusions);
   }
+  std::lock_guard<std::mutex> cache_guard(singleton_->mutex_);
   TORCH_CHECK(
-      max_fusions >= singleton_->fusions_.size(),
+      max_fusions >= singleton_->numCachedFusions(),
       "The max fusions is set less than the number of fusions in the cache.");
   singleton_->max_fusions_ = max_fusions;
   return singleton_;
 }
 
+FusionCache* FusionCache::get() {
+  std::lock_guard<std::mutex> guard(fusion_cache_lock);
+  if (singleton_ == nullptr) {
+    singleton_ = new FusionCache(kDefaultMaxFusions);
+  }
+  return singleton_;
+}
+
 size_t FusionCache::numFusions() const {
-  return fusions_.size();
+  std::lock_guard<std::mutex> guard(mutex_);
+  return numCachedFusions();
 }
 
 void FusionCache::print(std::ostream& os) {
-  os << "Total Fusions: " << fusions_.size() << "\n";
+  std::lock_guard<std::mutex> guard(mutex_);
+  os << "Total Fusions: " << numCachedFusions() << "\n";
 
   // Does not make sense to print stats if the cache is disabled.
   if (fusions_.size() > 0) {
     os << "Cache Hits by Fusion Id:\n";
     auto total_cache_hits = 0;
-    for (size_t i = 0; i < terminal_cache_entries_.size(); ++i) {
+    size_t total_bytes = 0;
+    for (auto terminal_entry : terminal_cache_entries_) {
+      if (terminal_entry == nullptr) {
+        continue;
+      }
       // The first visit is a miss!
-      auto visits = terminal_cache_entries_[i]->visits - 1;
+      auto visits = terminal_entry->visits - 1;
       total_cache_hits += visits;
-      os << "\t" << i << " -> " << visits << " hits\n";
+      auto bytes = approximateMemoryBytes(terminal_entry->fusion_id);
+      total_bytes += bytes;
+      os << "\t" << terminal_entry->fusion_id << " -> " << visits
+         << " hits, ~" << bytes / 1024 << " KB\n";
     }
 
+    size_t lookups = fusion_cache_start_->visits;
     auto hit_rate = static_cast<float>(total_cache_hits) /
-        static_cast<float>(fusion_cache_start_->visits) * 100.0;
-    os << "Cache Lookups: " << fusion_cache_start_->visits;
+        static_cast<float>(lookups) * 100.0;
+    os << "Cache Lookups: " << lookups;
     os << " Cache Hits: " << total_cache_hits;
     os << " Hit Rate: " << hit_rate << "%\n";
+    os << "Fingerprint Hits: " << fingerprint_hits_ << "\n";
+    os << "Approximate Memory: " << total_bytes / 1024 << " KB";
+    os << " Max Fusions: " << max_fusions_;
+    os << " Evictions: " << evictions_;
+    os << " Evicted Memory: " << evicted_bytes_ / 1024 << " KB\n";
+    os << "Retired Entries: " << retired_entries_.size() << "\n";
   }
 }
 
@@ -61,49 +217,308 @@ void FusionCache::reset() {
   }
 }
 
+void FusionCache::save(const std::string& filename) const {
+  std::ofstream os(filename, std::ios::binary);
+  TORCH_CHECK(os.good(), "Unable to open ", filename, " to save the cache!");
+  os.write(kFusionCacheMagic, sizeof(kFusionCacheMagic));
+  writeUInt(os, kFusionCacheVersion);
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    writeUInt(os, fusions_.size());
+  }
+  saveEntry(
+      os,
+      "",
+      fusion_cache_start_.get(),
+      [this](const FusionCacheEntry* entry) -> std::mutex& {
+        return entryLock(entry);
+      });
+  TORCH_CHECK(os.good(), "Failed to save the FusionCache to ", filename);
+}
+
+void FusionCache::load(const std::string& filename) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  std::lock_guard<std::mutex> start_guard(
+      entryLock(fusion_cache_start_.get()));
+  TORCH_CHECK(
+      fusions_.empty() && fusion_cache_start_->record_hash_map.empty() &&
+          fusion_cache_start_->serialized_children.empty(),
+      "A FusionCache can only be loaded into an empty cache!");
+  std::ifstream is(filename, std::ios::binary);
+  TORCH_CHECK(is.good(), "Unable to open ", filename, " to load the cache!");
+
+  char magic[sizeof(kFusionCacheMagic)];
+  is.read(magic, sizeof(magic));
+  TORCH_CHECK(
+      is.good() && std::memcmp(magic, kFusionCacheMagic, sizeof(magic)) == 0,
+      filename,
+      " is not a FusionCache file!");
+  auto version = readUInt(is);
+  TORCH_CHECK(
+      version == kFusionCacheVersion,
+      "Unsupported FusionCache file version ",
+      version,
+      ", expected version ",
+      kFusionCacheVersion);
+  auto num_fusions = readUInt(is);
+
+  std::vector<FusionCacheEntry*> terminal_entries(num_fusions, nullptr);
+  std::string key;
+  auto start = loadEntry(is, key, terminal_entries, fusionSlot);
+  TORCH_CHECK(key.empty(), "Invalid top of tree in the FusionCache file!");
+  // Slots without a terminal entry were free when the cache was saved
+  size_t num_evicted = std::count(
+      terminal_entries.begin(), terminal_entries.end(), nullptr);
+  TORCH_CHECK(
+      num_fusions - num_evicted <= max_fusions_,
+      "The saved FusionCache has ",
+      num_fusions - num_evicted,
+      " fusions, more than the max_fusions of ",
+      max_fusions_);
+
+  fusion_cache_start_->visits = start->visits.load();
+  fusion_cache_start_->serialized_children =
+      std::move(start->serialized_children);
+  for (auto& child : fusion_cache_start_->serialized_children) {
+    child.second->parent = fusion_cache_start_.get();
+  }
+  fusions_.resize(num_fusions);
+  evictions_ = num_evicted;
+  terminal_cache_entries_ = std::move(terminal_entries);
+  // Loaded fusions are used in the order of their slots so far
+  for (size_t slot = 0; slot < terminal_cache_entries_.size(); ++slot) {
+    if (terminal_cache_entries_[slot] == nullptr) {
+      free_fusion_ids_.push_back(slot);
+    } else {
+      touchTerminalEntry(terminal_cache_entries_[slot]);
+    }
+  }
+}
+
 FusionCache::FusionCache(size_t max_fusions)
     : max_fusions_(max_fusions),
       fusion_cache_start_(nullptr),
-      fusion_cache_ptr_(nullptr),
-      fusions_() {
+      fusions_(),
+      terminal_cache_entries_(),
+      free_fusion_ids_(),
+      lru_front_(nullptr),
+      lru_back_(nullptr),
+      fingerprint_index_(),
+      fingerprint_hits_(0),
+      materializing_fusions_(),
+      evictions_(0),
+      evicted_bytes_(0),
+      retire_epoch_(0),
+      cursors_(),
+      retired_entries_() {
   RecordFunctor* start = new StartRecord();
   fusion_cache_start_ = std::make_unique<FusionCacheEntry>(start);
-  fusion_cache_ptr_ = fusion_cache_start_.get();
+}
+
+FusionCacheEntry* FusionCache::startFusionCacheLookup() {
+  auto entry = fusion_cache_start_.get();
+  TORCH_CHECK(entry->record->recordType() == RecordType::Start);
+  ++(entry->visits);
+  return entry;
+}
+
+size_t FusionCache::registerCursor() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  ++cursors_[retire_epoch_];
+  return retire_epoch_;
+}
+
+void FusionCache::releaseCursor(size_t epoch) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto cursor = cursors_.find(epoch);
+  TORCH_INTERNAL_ASSERT(
+      cursor != cursors_.end(), "No cursor registered in epoch ", epoch);
+  if (--cursor->second == 0) {
+    cursors_.erase(cursor);
+  }
+  freeRetiredEntries();
 }
 
 c10::optional<FusionCacheEntry*> FusionCache::lookupFusionCacheEntry(
+    FusionCacheEntry* entry,
     RecordFunctor* rec) const {
+  TORCH_CHECK(entry, "Cache entry is null!");
   TORCH_CHECK(
-      !fusionCachePtr()->isTerminal(),
+      !entry->isTerminal(),
       "There should be no children from a Terminal Cache Entry!");
   TORCH_CHECK(rec, "Record is null!");
-  auto cache_entry = fusionCachePtr()->record_hash_map.find(rec);
-  if (cache_entry == std::end(fusionCachePtr()->record_hash_map)) {
-    return c10::nullopt;
+  std::lock_guard<std::mutex> guard(entryLock(entry));
+  auto cache_entry = entry->record_hash_map.find(rec);
+  if (cache_entry == std::end(entry->record_hash_map)) {
+    return restoreFusionCacheEntry(entry, rec);
   } else {
     return c10::optional<FusionCacheEntry*>(cache_entry->second.get());
   }
 }
 
-c10::optional<size_t> FusionCache::createFusionCacheEntry(RecordFunctor* rec) {
-  c10::optional<size_t> result = c10::nullopt;
+FusionCacheEntry* FusionCache::createFusionCacheEntry(
+    FusionCacheEntry* entry,
+    RecordFunctor* rec) {
+  TORCH_CHECK(entry, "Cache entry is null!");
   TORCH_CHECK(
-      !fusionCachePtr()->isTerminal(),
+      !entry->isTerminal(),
       "Cannot create a cache entry from a terminal entry!");
   TORCH_CHECK(rec, "Record is null!");
 
-  size_t fusion_id = 0;
   if (rec->recordType() == RecordType::End) {
+    return createTerminalEntry(entry, rec);
+  }
+  std::lock_guard<std::mutex> guard(entryLock(entry));
+  return addFusionCacheEntry(entry, rec, 0);
+}
+
+FusionCacheEntry* FusionCache::traverseFusionCache(
+    FusionCacheEntry* entry,
+    RecordFunctor* rec) {
+  TORCH_CHECK(entry, "Cache entry is null!");
+  TORCH_CHECK(
+      !entry->isTerminal(), "Cannot traverse cache from a terminal entry!");
+  TORCH_CHECK(rec, "Record is null!");
+  FusionCacheEntry* child_entry = nullptr;
+  {
+    std::lock_guard<std::mutex> guard(entryLock(entry));
+    auto cache_entry = entry->record_hash_map.find(rec);
     TORCH_CHECK(
-        (fusions_.size() + 1) <= max_fusions_,
-        "The number of fusions in nvfuser has exceeded ",
-        max_fusions_,
-        "fusions.  The max_fusions for the FusionCache might need to be ",
-        "increased if the max number is not being exceeded due to an error.");
-    fusions_.push_back(std::make_unique<Nvf::FusionExecutorCache>(
-        std::make_unique<Nvf::Fusion>()));
-    fusion_id = fusions_.size() - 1;
-    result = c10::optional<size_t>(fusion_id);
+        cache_entry != std::end(entry->record_hash_map),
+        "Cache Entry for Cache Traverse is not found!");
+    TORCH_CHECK(cache_entry->second, "Record in Cache Entry is null!");
+    child_entry = cache_entry->second.get();
+  }
+  ++(child_entry->visits);
+  if (child_entry->isTerminal()) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    touchTerminalEntry(child_entry);
+  }
+  return child_entry;
+}
+
+size_t FusionCache::extendFingerprint(
+    size_t fingerprint,
+    const RecordFunctor* rec) {
+  TORCH_CHECK(rec, "Record is null!");
+  return c10::hash_combine(fingerprint, rec->hash());
+}
+
+c10::optional<FusionCacheEntry*> FusionCache::lookupFusionFingerprint(
+    size_t fingerprint,
+    const std::vector<std::unique_ptr<RecordFunctor>>& records) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto bucket = fingerprint_index_.find(fingerprint);
+  if (bucket == fingerprint_index_.end()) {
+    return c10::nullopt;
+  }
+  std::equal_to<RecordFunctor*> record_equal;
+  for (auto& entry : bucket->second) {
+    // The cached path ends with the End record, which is not recorded
+    if (entry.records.size() != records.size() + 1) {
+      continue;
+    }
+    bool match = true;
+    for (size_t i = 0; i < records.size(); ++i) {
+      if (!record_equal(entry.records[i], records[i].get())) {
+        match = false;
+        break;
+      }
+    }
+    if (match) {
+      ++(entry.terminal_entry->visits);
+      touchTerminalEntry(entry.terminal_entry);
+      ++fingerprint_hits_;
+      return c10::optional<FusionCacheEntry*>(entry.terminal_entry);
+    }
+  }
+  return c10::nullopt;
+}
+
+void FusionCache::registerFusionFingerprint(
+    size_t fingerprint,
+    const std::vector<FusionCacheEntry*>& path) {
+  TORCH_CHECK(
+      !path.empty() && path.back()->isTerminal(),
+      "Only complete definitions can be indexed by fingerprint!");
+  FingerprintEntry entry;
+  entry.records.reserve(path.size());
+  for (auto path_entry : path) {
+    entry.records.push_back(path_entry->record.get());
+  }
+  entry.terminal_entry = path.back();
+
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto terminal_entry = entry.terminal_entry;
+  // The fusion may have been evicted by a concurrent definition
+  if (cachedTerminalEntry(terminal_entry->fusion_id) != terminal_entry) {
+    return;
+  }
+  auto& bucket = fingerprint_index_[fingerprint];
+  for (auto& other : bucket) {
+    if (other.terminal_entry == terminal_entry) {
+      return;
+    }
+  }
+  bucket.push_back(std::move(entry));
+  terminal_entry->fingerprints.push_back(fingerprint);
+}
+
+bool FusionCache::materializeFusion(
+    size_t fusion_id,
+    const std::function<void()>& build_fusion_ir) {
+  // Held until the Fusion IR is built, so that concurrent definitions of
+  // the fusion don't execute it half way through
+  std::lock_guard<std::mutex> build_guard(
+      build_locks_[fusion_id % kNumLockStripes]);
+  // Keeps the fusion alive while it is built, and evictFusion skips it
+  std::shared_ptr<Nvf::FusionExecutorCache> fusion_executor_cache;
+  {
+    std::lock_guard<std::mutex> guard(mutex_);
+    TORCH_CHECK(
+        fusionSlot(fusion_id) < fusions_.size(), "Invalid fusion id!");
+    TORCH_CHECK(
+        cachedTerminalEntry(fusion_id) != nullptr,
+        "Fusion ",
+        fusion_id,
+        " was evicted from the FusionCache while it was being defined. ",
+        "The max_fusions for the FusionCache might need to be increased.");
+    auto& fusion = fusions_[fusionSlot(fusion_id)];
+    if (fusion) {
+      return false;
+    }
+    fusion_executor_cache = std::make_shared<Nvf::FusionExecutorCache>(
+        std::make_unique<Nvf::Fusion>());
+    fusion = fusion_executor_cache;
+    materializing_fusions_.insert(fusion_id);
+  }
+  try {
+    build_fusion_ir();
+  } catch (...) {
+    // The next definition of the fusion builds it again
+    std::lock_guard<std::mutex> guard(mutex_);
+    materializing_fusions_.erase(fusion_id);
+    fusions_[fusionSlot(fusion_id)].reset();
+    throw;
+  }
+  std::lock_guard<std::mutex> guard(mutex_);
+  materializing_fusions_.erase(fusion_id);
+  return true;
+}
+
+std::mutex& FusionCache::entryLock(const FusionCacheEntry* entry) const {
+  // Entries are heap allocated, the low bits of the address are alignment
+  auto address = reinterpret_cast<uintptr_t>(entry);
+  return entry_locks_[(address >> 4) % kNumLockStripes];
+}
+
+FusionCacheEntry* FusionCache::addFusionCacheEntry(
+    FusionCacheEntry* entry,
+    RecordFunctor* rec,
+    size_t fusion_id) {
+  auto cache_entry = entry->record_hash_map.find(rec);
+  if (cache_entry != std::end(entry->record_hash_map)) {
+    return cache_entry->second.get();
   }
 
   // Copying the record owned by the FusionDefinition that calls this function
@@ -111,45 +526,281 @@ c10::optional<size_t> FusionCache::createFusionCacheEntry(RecordFunctor* rec) {
   // than managing a shared pointer that would  only share with
   // FusionDefinition that creates a cache entry but not cache lookups
   RecordFunctor* new_rec = rec->clone();
-  fusionCachePtr()->record_hash_map[new_rec] =
-      std::make_unique<FusionCacheEntry>(new_rec, fusion_id);
-  if (rec->recordType() == RecordType::End) {
-    terminal_cache_entries_.push_back(
-        fusionCachePtr()->record_hash_map[new_rec].get());
-  }
+  auto new_entry = std::make_unique<FusionCacheEntry>(new_rec, fusion_id);
+  new_entry->parent = entry;
+  auto new_entry_ptr = new_entry.get();
+  entry->record_hash_map[new_rec] = std::move(new_entry);
   if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
     std::stringstream ss;
     new_rec->print(ss);
     std::cout << "\nFusionDefinition: Create new cache entry for: " << ss.str()
               << "\n";
   }
-  return result;
+  return new_entry_ptr;
 }
 
-void FusionCache::resetFusionCachePtr() {
-  fusion_cache_ptr_ = fusion_cache_start_.get();
-  TORCH_CHECK(fusionCachePtr()->record->recordType() == RecordType::Start);
-  ++(fusionCachePtr()->visits);
+size_t FusionCache::fusionSlot(size_t fusion_id) {
+  return fusion_id & ((size_t(1) << kFusionSlotBits) - 1);
 }
 
-void FusionCache::traverseFusionCache(RecordFunctor* rec) {
-  TORCH_CHECK(
-      !fusionCachePtr()->isTerminal(),
-      "Cannot traverse cache from a terminal entry!");
-  auto cache_entry = fusionCachePtr()->record_hash_map.find(rec);
+FusionCacheEntry* FusionCache::createTerminalEntry(
+    FusionCacheEntry* entry,
+    RecordFunctor* rec) {
+  // Fusion ids are allocated under mutex_, which is held from the check
+  // for an existing terminal entry to the creation of a new one
+  std::lock_guard<std::mutex> guard(mutex_);
+  {
+    std::lock_guard<std::mutex> entry_guard(entryLock(entry));
+    auto cache_entry = entry->record_hash_map.find(rec);
+    if (cache_entry != std::end(entry->record_hash_map)) {
+      return cache_entry->second.get();
+    }
+  }
+
+  if (numCachedFusions() + 1 > max_fusions_) {
+    evictFusion(entry);
+  }
   TORCH_CHECK(
-      cache_entry != std::end(fusionCachePtr()->record_hash_map),
-      "Cache Entry for Cache Traverse is not found!");
-  TORCH_CHECK(cache_entry->second, "Record in Cache Entry is null!");
-  fusion_cache_ptr_ = cache_entry->second.get();
-  ++(fusionCachePtr()->visits);
+      (numCachedFusions() + 1) <= max_fusions_,
+      "The number of fusions in nvfuser has exceeded ",
+      max_fusions_,
+      "fusions.  The max_fusions for the FusionCache might need to be ",
+      "increased if the max number is not being exceeded due to an error.");
+  size_t fusion_id = 0;
+  if (free_fusion_ids_.empty()) {
+    fusion_id = fusions_.size();
+    TORCH_INTERNAL_ASSERT(
+        fusionSlot(fusion_id) == fusion_id, "Out of FusionCache slots!");
+    fusions_.emplace_back(nullptr);
+    terminal_cache_entries_.push_back(nullptr);
+  } else {
+    fusion_id = free_fusion_ids_.back();
+    free_fusion_ids_.pop_back();
+  }
+
+  std::lock_guard<std::mutex> entry_guard(entryLock(entry));
+  auto terminal_entry = addFusionCacheEntry(entry, rec, fusion_id);
+  terminal_cache_entries_[fusionSlot(fusion_id)] = terminal_entry;
+  // A new fusion is not the least recently used one before it is traversed
+  touchTerminalEntry(terminal_entry);
+  return terminal_entry;
 }
 
-FusionCacheEntry* FusionCache::fusionCachePtr() const {
-  TORCH_INTERNAL_ASSERT(
-      fusion_cache_ptr_ != nullptr,
-      "The fusion cache entry is unexpectedly null.");
-  return fusion_cache_ptr_;
+std::shared_ptr<Nvf::FusionExecutorCache> FusionCache::fusionExecutorCache(
+    size_t fusion_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  TORCH_CHECK(fusionSlot(fusion_id) < fusions_.size(), "Invalid fusion id!");
+  if (cachedTerminalEntry(fusion_id) == nullptr) {
+    return nullptr;
+  }
+  return fusions_[fusionSlot(fusion_id)];
+}
+
+size_t FusionCache::numCachedFusions() const {
+  return fusions_.size() - free_fusion_ids_.size();
+}
+
+FusionCacheEntry* FusionCache::cachedTerminalEntry(size_t fusion_id) const {
+  auto slot = fusionSlot(fusion_id);
+  if (slot >= terminal_cache_entries_.size()) {
+    return nullptr;
+  }
+  auto terminal_entry = terminal_cache_entries_[slot];
+  // The slot may hold a newer fusion
+  if (terminal_entry == nullptr || terminal_entry->fusion_id != fusion_id) {
+    return nullptr;
+  }
+  return terminal_entry;
+}
+
+c10::optional<FusionCacheEntry*> FusionCache::restoreFusionCacheEntry(
+    FusionCacheEntry* entry,
+    RecordFunctor* rec) const {
+  auto& serialized_children = entry->serialized_children;
+  if (serialized_children.empty()) {
+    return c10::nullopt;
+  }
+  auto child = serialized_children.find(serializeRecord(rec));
+  if (child == serialized_children.end()) {
+    return c10::nullopt;
+  }
+  // The restored entry gets its own copy of the record, as in
+  // createFusionCacheEntry
+  RecordFunctor* new_rec = rec->clone();
+  auto cache_entry = child->second.get();
+  TORCH_INTERNAL_ASSERT(cache_entry->parent == entry);
+  cache_entry->record.reset(new_rec);
+  entry->record_hash_map[new_rec] = std::move(child->second);
+  serialized_children.erase(child);
+  if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
+    std::stringstream ss;
+    new_rec->print(ss);
+    std::cout << "\nFusionDefinition: Restored cache entry for: " << ss.str()
+              << "\n";
+  }
+  return c10::optional<FusionCacheEntry*>(cache_entry);
+}
+
+void FusionCache::touchTerminalEntry(FusionCacheEntry* entry) {
+  // The fusion may have been evicted by a concurrent definition
+  if (cachedTerminalEntry(entry->fusion_id) != entry || entry == lru_front_) {
+    return;
+  }
+  unlinkTerminalEntry(entry);
+  entry->lru_next = lru_front_;
+  if (lru_front_ != nullptr) {
+    lru_front_->lru_prev = entry;
+  }
+  lru_front_ = entry;
+  if (lru_back_ == nullptr) {
+    lru_back_ = entry;
+  }
+}
+
+void FusionCache::unlinkTerminalEntry(FusionCacheEntry* entry) {
+  if (entry->lru_prev != nullptr) {
+    entry->lru_prev->lru_next = entry->lru_next;
+  } else if (lru_front_ == entry) {
+    lru_front_ = entry->lru_next;
+  }
+  if (entry->lru_next != nullptr) {
+    entry->lru_next->lru_prev = entry->lru_prev;
+  } else if (lru_back_ == entry) {
+    lru_back_ = entry->lru_prev;
+  }
+  entry->lru_prev = nullptr;
+  entry->lru_next = nullptr;
+}
+
+bool FusionCache::evictFusion(const FusionCacheEntry* keep_entry) {
+  // Fusions being built are in use by their definition
+  auto lru_entry = lru_back_;
+  while (lru_entry != nullptr &&
+         materializing_fusions_.count(lru_entry->fusion_id)) {
+    lru_entry = lru_entry->lru_prev;
+  }
+  if (lru_entry == nullptr) {
+    return false;
+  }
+  auto fusion_id = lru_entry->fusion_id;
+  if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
+    std::cout << "\nFusionCache: Evicting fusion " << fusion_id << "\n";
+  }
+
+  // Fingerprints point to the records of the entries pruned below
+  for (auto fingerprint : lru_entry->fingerprints) {
+    auto bucket = fingerprint_index_.find(fingerprint);
+    if (bucket == fingerprint_index_.end()) {
+      continue;
+    }
+    auto& entries = bucket->second;
+    entries.erase(
+        std::remove_if(
+            entries.begin(),
+            entries.end(),
+            [lru_entry](const FingerprintEntry& entry) {
+              return entry.terminal_entry == lru_entry;
+            }),
+        entries.end());
+    if (entries.empty()) {
+      fingerprint_index_.erase(bucket);
+    }
+  }
+  lru_entry->fingerprints.clear();
+
+  evicted_bytes_ += approximateMemoryBytes(fusion_id);
+  unlinkTerminalEntry(lru_entry);
+  auto slot = fusionSlot(fusion_id);
+  fusions_.at(slot).reset();
+  terminal_cache_entries_.at(slot) = nullptr;
+  free_fusion_ids_.push_back(fusion_id + (size_t(1) << kFusionSlotBits));
+  ++evictions_;
+
+  // Prune the entries that no other fusion goes through. The entry a new
+  // fusion is created from is never pruned as it leads to that fusion.
+  auto entry = lru_entry;
+  while (entry->parent != nullptr && entry != keep_entry) {
+    auto parent = entry->parent;
+    std::unique_lock<std::mutex> entry_guard(entryLock(entry), std::defer_lock);
+    std::unique_lock<std::mutex> parent_guard(
+        entryLock(parent), std::defer_lock);
+    if (entry_guard.mutex() == parent_guard.mutex()) {
+      entry_guard.lock();
+    } else {
+      std::lock(entry_guard, parent_guard);
+    }
+    if (!entry->record_hash_map.empty() ||
+        !entry->serialized_children.empty()) {
+      break;
+    }
+
+    std::unique_ptr<FusionCacheEntry> pruned_entry;
+    if (entry->record) {
+      auto child = parent->record_hash_map.find(entry->record.get());
+      if (child == parent->record_hash_map.end() ||
+          child->second.get() != entry) {
+        // Pruned by an earlier eviction, while a definition went on from it
+        break;
+      }
+      pruned_entry = std::move(child->second);
+      parent->record_hash_map.erase(child);
+    } else {
+      auto child = std::find_if(
+          parent->serialized_children.begin(),
+          parent->serialized_children.end(),
+          [entry](const auto& child) { return child.second.get() == entry; });
+      if (child == parent->serialized_children.end()) {
+        break;
+      }
+      pruned_entry = std::move(child->second);
+      parent->serialized_children.erase(child);
+    }
+    // Cursors of definitions in flight may still point at the entry. The
+    // parent may be freed before the entry, see freeRetiredEntries.
+    pruned_entry->parent = nullptr;
+    retired_entries_.emplace_back(retire_epoch_, std::move(pruned_entry));
+    entry = parent;
+  }
+  ++retire_epoch_;
+  return true;
+}
+
+bool FusionCache::leadsToCachedFusion(const FusionCacheEntry* entry) const {
+  if (cachedTerminalEntry(entry->fusion_id) == entry) {
+    return true;
+  }
+  for (const auto& child : entry->record_hash_map) {
+    if (leadsToCachedFusion(child.second.get())) {
+      return true;
+    }
+  }
+  for (const auto& child : entry->serialized_children) {
+    if (leadsToCachedFusion(child.second.get())) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FusionCache::freeRetiredEntries() {
+  // Cursors registered after an entry was retired can't reach it, and no
+  // cursor is left to change the children of the entries checked here
+  auto oldest_epoch =
+      cursors_.empty() ? retire_epoch_ : cursors_.begin()->first;
+  retired_entries_.erase(
+      std::remove_if(
+          retired_entries_.begin(),
+          retired_entries_.end(),
+          [this, oldest_epoch](const auto& retired) {
+            return retired.first < oldest_epoch &&
+                !leadsToCachedFusion(retired.second.get());
+          }),
+      retired_entries_.end());
+}
+
+size_t FusionCache::approximateMemoryBytes(size_t fusion_id) {
+  auto& fusion = fusions_.at(fusionSlot(fusion_id));
+  return fusion ? fusion->approximateMemoryBytes() : 0;
 }
 
 } // namespace nvfuser
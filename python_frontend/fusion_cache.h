@@ -4,7 +4,16 @@
 #include <third_party/nvfuser/kernel_cache.h>
 #include <third_party/nvfuser/python_frontend/fusion_record.h>
 
+#include <array>
+#include <atomic>
+#include <functional>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 //! nvFuser Fusion IR namespace abbreviation
 namespace Nvf = torch::jit::fuser::cuda;
@@ -31,11 +40,28 @@ struct TORCH_CUDA_CU_API FusionCacheEntry {
   //! the hash function is virtual.
   std::unordered_map<RecordFunctor*, std::unique_ptr<FusionCacheEntry>>
       record_hash_map;
-  //! An index into FusionCache's vector of nvFuser object that holds an
-  //! unscheduled Fusion.  The id is only valid if the entry is terminal.
+  //! Children restored by FusionCache::load whose records have not been
+  //! defined again since, keyed by the serialized record.  These entries
+  //! have no record until they are matched, see
+  //! Note [Fusion Cache Serialization].
+  std::unordered_map<std::string, std::unique_ptr<FusionCacheEntry>>
+      serialized_children;
+  //! The id of the fusion, only valid if the entry is terminal.  It holds
+  //! the slot of FusionCache's vector of nvFuser objects that holds the
+  //! unscheduled Fusion, see Note [Fusion Ids].
   size_t fusion_id;
   //! Count of times the Entry is traversed
-  size_t visits;
+  std::atomic<size_t> visits;
+  //! The entry this entry is a child of, null at the top of the tree
+  FusionCacheEntry* parent;
+  //! Neighbours of a cached terminal entry in the FusionCache's list of
+  //! fusions from the most to the least recently used, guarded by its
+  //! mutex_.  Null for other entries.
+  FusionCacheEntry* lru_prev;
+  FusionCacheEntry* lru_next;
+  //! Fingerprints a terminal entry is indexed under, guarded by the
+  //! FusionCache's mutex_, so that evicting it only visits its own buckets
+  std::vector<size_t> fingerprints;
 };
 
 //! \class FusionCache
@@ -46,8 +72,73 @@ struct TORCH_CUDA_CU_API FusionCacheEntry {
 //! fusions.  A leaf of the tree with a terminal node contains an nvFuser
 //! Fusion IR container for a cached instance.
 //!
-//! \todo Add the ability to evict a fusion.  There is currently a max number
-//! of fusions that is checked to prevent a runaway case.
+//! Next to the tree, complete definitions are indexed by their fingerprint,
+//! a hash of the full record sequence computed once per FusionDefinition.
+//! A definition that was built before is found with a single hash map
+//! lookup rather than by walking the tree one record at a time, see
+//! Note [Fusion Fingerprint Fast Path].  The tree is still walked on a miss
+//! so that new definitions share the prefixes of the cached ones.
+//!
+//! Note [Fusion Cache Serialization]
+//!
+//! The cache can be saved to a versioned binary file and loaded in another
+//! process to skip redefining fusions at startup.  Records hold pointers to
+//! nvFuser arith functions, so a record is stored as its python definition
+//! (see RecordFunctor::print) rather than as its data.  Loading rebuilds the
+//! prefix tree with entries that only know their serialized record.  Such an
+//! entry is matched, and given a copy of the live record, the first time a
+//! FusionDefinition looks up a record with the same serialization.  Fusion
+//! ids are preserved, but the FusionExecutorCache of a loaded fusion is only
+//! created, and its Fusion IR built from the records, when a definition
+//! reaches its terminal entry.  Compiled kernels are not saved.
+//!
+//! The cache holds at most max_fusions fusions.  Making room for a new
+//! fusion evicts the least recently used one: its FusionExecutorCache is
+//! released along with the compiled kernels, and the entries of the tree
+//! only reachable through its terminal entry are pruned.  Cached fusions
+//! are kept in a list from the most to the least recently used one, and
+//! each terminal entry knows the fingerprints it is indexed under, so an
+//! eviction does not scan the whole cache.  print reports evictions and an
+//! approximate memory footprint of each fusion.
+//!
+//! Note [Fusion Ids]
+//!
+//! A fusion id holds the slot of the fusion in the vectors of fusions and
+//! terminal entries in its low 32 bits, and the generation of the slot
+//! above them.  The slot of an evicted fusion is handed out again to a new
+//! fusion under the next generation, so the cache does not grow past
+//! max_fusions slots while a FusionInterface of an evicted fusion still
+//! fails to execute rather than running another fusion.
+//!
+//! Note [Concurrent Fusion Definitions]
+//!
+//! FusionDefinitions on different threads, e.g. data loader and serving
+//! threads, look up and build fusions at the same time.  The cache itself
+//! holds no traversal state: each FusionDefinition walks the tree with its
+//! own cursor, an entry pointer handed from one call to the next.
+//!
+//!  - The children of an entry are guarded by one of a fixed set of entry
+//!    locks picked by the entry's address, so walks through different parts
+//!    of the tree rarely contend.  Creating a child that a concurrent
+//!    definition just created returns the existing one.
+//!  - visits are atomic, as they are bumped outside of locks.
+//!  - The fusions, terminal entries, free slots, the list of recently used
+//!    fusions, fingerprint index and eviction are guarded by mutex_, taken
+//!    before any entry lock.
+//!  - The Fusion IR of a new fusion is built by the first definition that
+//!    reaches its terminal entry, under a build lock picked by fusion id.
+//!    Concurrent definitions of the same fusion wait for it to be built.
+//!  - Entries pruned by eviction are retired rather than freed, as other
+//!    cursors may still point at them.  A definition that continues from a
+//!    pruned entry still gets a working fusion, it is just not shared.
+//!    Definitions register their cursor for the duration of the walk, and
+//!    retired entries are freed once every cursor registered before they
+//!    were retired is released, unless they lead to a cached fusion.
+//!  - FusionExecutorCaches are shared with FusionInterface, so an eviction
+//!    does not free a fusion that is still running.  Fusions whose Fusion IR
+//!    is being built are not evicted.
+//!
+//! save, load and reset are not meant to run during definitions.
 
 class TORCH_CUDA_CU_API FusionCache {
   //! The constructor is private given the FusionCache is only constructed
@@ -62,34 +153,131 @@ class TORCH_CUDA_CU_API FusionCache {
   //! The next 2 pubic methods are the python interface methods
 
   //! Gets a pointer to the singleton and creates a new one if necessary
-  static FusionCache* get(size_t max_fusions = 8192);
+  static FusionCache* get(size_t max_fusions);
+  //! Gets a pointer to the singleton, creating one with the default
+  //! max_fusions if necessary, and leaves the max_fusions as it is
+  static FusionCache* get();
   //! Number of fusions cached
   size_t numFusions() const;
   //! print cache stats
   void print(std::ostream& os);
   //! Reset Cache to an empty state
   static void reset();
+  //! Save the prefix tree to a file, see Note [Fusion Cache Serialization]
+  void save(const std::string& filename) const;
+  //! Restore a saved prefix tree into an empty cache
+  void load(const std::string& filename);
 
-  //! The rest of the public methods are only used in C++
+  //! The rest of the public methods are only used in C++.  A cache lookup
+  //! is a walk with a cursor owned by the caller, see
+  //! Note [Concurrent Fusion Definitions].
 
-  //! Queries the current cache entry to see if a record matches one of its
+  //! Returns the top of the tree, where the lookup of a definition starts,
+  //! and counts the lookup
+  FusionCacheEntry* startFusionCacheLookup();
+  //! Registers the cursor of a definition, so that the entries it reaches
+  //! are not freed if they are pruned before the cursor is released.
+  //! Returns the epoch to release the cursor with.
+  size_t registerCursor();
+  //! Releases a cursor registered in the given epoch and frees the retired
+  //! entries no registered cursor can point at anymore
+  void releaseCursor(size_t epoch);
+  //! Queries the given cache entry to see if a record matches one of its
   //! children
   c10::optional<FusionCacheEntry*> lookupFusionCacheEntry(
+      FusionCacheEntry* entry,
       RecordFunctor* rec) const;
-  //! Creates a child node for the current cache entry and an optional
-  //! fusion_id is returned if the new entry is terminal
-  c10::optional<size_t> createFusionCacheEntry(RecordFunctor* rec);
-  //! Resets the current cache pointer to the top of the tree
-  void resetFusionCachePtr();
-  //! Traverses the cache from the current entry to the child associated
-  //! with the record given.
-  void traverseFusionCache(RecordFunctor* rec);
+  //! Creates a child node for the given cache entry and returns it.  The
+  //! existing child is returned if a concurrent definition created it first.
+  //! A new terminal entry gets a free fusion id, its Fusion IR is built by
+  //! materializeFusion.
+  FusionCacheEntry* createFusionCacheEntry(
+      FusionCacheEntry* entry,
+      RecordFunctor* rec);
+  //! Traverses the cache from the given entry to the child associated
+  //! with the record given, and returns the child.
+  FusionCacheEntry* traverseFusionCache(
+      FusionCacheEntry* entry,
+      RecordFunctor* rec);
+
+  //! Folds the hash of the next record of a definition into its fingerprint
+  static size_t extendFingerprint(size_t fingerprint, const RecordFunctor* rec);
+  //! Queries the fingerprint index for the terminal entry of a complete
+  //! definition.  The records are compared against the cached ones to rule
+  //! out hash collisions.  A hit counts as a visit of the terminal entry.
+  c10::optional<FusionCacheEntry*> lookupFusionFingerprint(
+      size_t fingerprint,
+      const std::vector<std::unique_ptr<RecordFunctor>>& records);
+  //! Indexes a definition under the given fingerprint. The path holds the
+  //! entries traversed from the top of the tree to its terminal entry.
+  void registerFusionFingerprint(
+      size_t fingerprint,
+      const std::vector<FusionCacheEntry*>& path);
+  //! Creates the FusionExecutorCache of a fusion that has none yet, i.e. a
+  //! new fusion or one restored by load, and builds its Fusion IR with
+  //! build_fusion_ir.  Returns true if it was built by this call.
+  //! Concurrent calls for the same fusion wait until it is built.
+  bool materializeFusion(
+      size_t fusion_id,
+      const std::function<void()>& build_fusion_ir);
 
   friend class FusionInterface;
 
  private:
-  //! Returns the pointer to the current cache entry
-  FusionCacheEntry* fusionCachePtr() const;
+  //! Number of locks the entries and the fusion builds are striped over
+  static constexpr size_t kNumLockStripes = 64;
+  //! Number of low bits of a fusion id holding its slot, see
+  //! Note [Fusion Ids]
+  static constexpr size_t kFusionSlotBits = 32;
+
+  //! Returns the slot of a fusion id
+  static size_t fusionSlot(size_t fusion_id);
+
+  //! Returns the lock guarding the children of an entry
+  std::mutex& entryLock(const FusionCacheEntry* entry) const;
+  //! Adds a child holding a copy of the record to an entry, unless there is
+  //! one already, and returns the child. The entry lock is held by the
+  //! caller.
+  FusionCacheEntry* addFusionCacheEntry(
+      FusionCacheEntry* entry,
+      RecordFunctor* rec,
+      size_t fusion_id);
+  //! Creates a terminal entry and allocates its fusion id, reusing the slot
+  //! of an evicted fusion if there is one
+  FusionCacheEntry* createTerminalEntry(
+      FusionCacheEntry* entry,
+      RecordFunctor* rec);
+  //! Returns the FusionExecutorCache of a fusion for FusionInterface
+  std::shared_ptr<Nvf::FusionExecutorCache> fusionExecutorCache(
+      size_t fusion_id);
+  //! Number of fusions cached, mutex_ is held by the caller
+  size_t numCachedFusions() const;
+  //! Returns the terminal entry of a cached fusion, or null if the fusion
+  //! was evicted.  mutex_ is held by the caller.
+  FusionCacheEntry* cachedTerminalEntry(size_t fusion_id) const;
+  //! Moves the terminal entry of a cached fusion to the front of the list
+  //! of recently used fusions, mutex_ is held by the caller
+  void touchTerminalEntry(FusionCacheEntry* entry);
+  //! Removes a terminal entry from the list of recently used fusions,
+  //! mutex_ is held by the caller
+  void unlinkTerminalEntry(FusionCacheEntry* entry);
+  //! Evicts the least recently used fusion, returns false if there is none.
+  //! The entries leading to keep_entry are not pruned.
+  bool evictFusion(const FusionCacheEntry* keep_entry);
+  //! Approximate host memory held by a fusion, its IR and compiled kernels
+  size_t approximateMemoryBytes(size_t fusion_id);
+  //! Queries whether a fusion is still cached under the entry or its
+  //! children, i.e. a definition that went on from a retired entry
+  bool leadsToCachedFusion(const FusionCacheEntry* entry) const;
+  //! Frees the retired entries that were retired before the oldest
+  //! registered cursor, mutex_ is held by the caller
+  void freeRetiredEntries();
+  //! Matches a record against the restored children of a cache entry,
+  //! moving the matching child into the record_hash_map. The entry lock is
+  //! held by the caller.
+  c10::optional<FusionCacheEntry*> restoreFusionCacheEntry(
+      FusionCacheEntry* entry,
+      RecordFunctor* rec) const;
 
   //! The static pointer to the FusionCache
   static FusionCache* singleton_;
@@ -99,13 +287,52 @@ class TORCH_CUDA_CU_API FusionCache {
   //! The top of the prefix tree used to start a cache look up of a given
   //! fusion definition.
   std::unique_ptr<FusionCacheEntry> fusion_cache_start_;
-  //! A pointer to the current cache entry in a cache lookup of a fusion
-  //! definition.
-  FusionCacheEntry* fusion_cache_ptr_;
-  //! A vector of nvFuser Fusion IR fusions.
-  std::vector<std::unique_ptr<Nvf::FusionExecutorCache>> fusions_;
-  //! A vector of Terminal Cache Entries for Stats collection
+  //! Guards the children of the entries, picked by entryLock
+  mutable std::array<std::mutex, kNumLockStripes> entry_locks_;
+  //! Guards the Fusion IR while it is built, picked by fusion id
+  std::array<std::mutex, kNumLockStripes> build_locks_;
+  //! Guards the members below
+  mutable std::mutex mutex_;
+  //! A vector of nvFuser Fusion IR fusions, indexed by slot. Fusions are
+  //! null until they are materialized or while their slot is free.
+  std::vector<std::shared_ptr<Nvf::FusionExecutorCache>> fusions_;
+  //! A vector of Terminal Cache Entries for Stats collection, indexed by
+  //! slot. Entries of free slots are null.
   std::vector<FusionCacheEntry*> terminal_cache_entries_;
+  //! The ids a new fusion takes the free slots with, i.e. the ids of the
+  //! evicted fusions in the next generation of their slot
+  std::vector<size_t> free_fusion_ids_;
+  //! The most and the least recently used cached fusions
+  FusionCacheEntry* lru_front_;
+  FusionCacheEntry* lru_back_;
+
+  //! A complete definition indexed by its fingerprint. The records are
+  //! owned by the entries of the tree along the path to the terminal entry.
+  struct FingerprintEntry {
+    std::vector<RecordFunctor*> records;
+    FusionCacheEntry* terminal_entry;
+  };
+  //! Flat index of complete definitions, keyed by fingerprint. Collisions
+  //! are chained.
+  std::unordered_map<size_t, std::vector<FingerprintEntry>>
+      fingerprint_index_;
+  //! Count of definitions found through the fingerprint index
+  size_t fingerprint_hits_;
+  //! Ids of the fusions whose Fusion IR is being built by materializeFusion,
+  //! which are not evicted
+  std::unordered_set<size_t> materializing_fusions_;
+  //! Count of evicted fusions
+  size_t evictions_;
+  //! Approximate host memory released by evictions
+  size_t evicted_bytes_;
+  //! Bumped by every eviction that retires entries
+  size_t retire_epoch_;
+  //! Number of registered cursors by the epoch they were registered in
+  std::map<size_t, size_t> cursors_;
+  //! Entries pruned by eviction along with the epoch they were retired in,
+  //! kept alive for the cursors of definitions in flight
+  std::vector<std::pair<size_t, std::unique_ptr<FusionCacheEntry>>>
+      retired_entries_;
 };
 
 } // namespace nvfuser
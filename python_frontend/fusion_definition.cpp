@@ -45,6 +45,10 @@ FusionDefinition::FusionDefinition(FusionInterface* fusion, size_t max_length)
       end_record_(new EndRecord()),
       recording_(),
       recording_state_(),
+      fingerprint_(0),
+      fusion_cache_entry_(nullptr),
+      fusion_cache_path_(),
+      cursor_epoch_(c10::nullopt),
       fusion_state_(),
       ops(this) {}
 
@@ -73,39 +77,105 @@ FusionDefinition* FusionDefinition::enter() {
   TORCH_CHECK(max_length_ > 0, "Can't make a FusionDefinition with 0 records!");
   TORCH_CHECK(
       !fusionInterfacePtr()->defined(), "Fusion Interface is already defined!");
-  fusionCachePtr()->resetFusionCachePtr();
+  releaseCursor();
+  cursor_epoch_ = fusionCachePtr()->registerCursor();
+  fusion_cache_entry_ = fusionCachePtr()->startFusionCacheLookup();
+  fusion_cache_path_.clear();
+  fingerprint_ = 0;
   return this;
 }
 
 void FusionDefinition::exit() {
   FUSER_PERF_SCOPE("FusionDefinition::exit");
-  auto cache_entry =
-      fusionCachePtr()->lookupFusionCacheEntry(end_record_.get());
-  if (!cache_entry.has_value()) {
+  try {
+    finalizeDefinition();
+  } catch (...) {
+    releaseCursor();
+    throw;
+  }
+  releaseCursor();
+}
+
+void FusionDefinition::releaseCursor() {
+  if (cursor_epoch_.has_value()) {
+    fusionCachePtr()->releaseCursor(cursor_epoch_.value());
+    cursor_epoch_ = c10::nullopt;
+  }
+}
+
+void FusionDefinition::finalizeDefinition() {
+  auto fingerprint_entry =
+      fusionCachePtr()->lookupFusionFingerprint(fingerprint_, recording_);
+  if (fingerprint_entry.has_value()) {
     if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
-      std::cout << "\nFusionDefinition: Terminal Node not found.\n";
-    }
-    auto fusion_id =
-        fusionCachePtr()->createFusionCacheEntry(end_record_.get());
-    TORCH_CHECK(fusion_id.has_value(), "Invalid fusion id!");
-    fusionInterfacePtr()->define(fusion_id.value());
-    fusionCachePtr()->traverseFusionCache(end_record_.get());
-
-    if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonDefinition)) {
-      print(std::cout);
+      std::cout << "\nFusionDefinition: Fingerprint (hash: 0x" << std::hex
+                << fingerprint_ << ") hit in Fusion Cache.\n";
     }
+    fusionInterfacePtr()->define(fingerprint_entry.value()->fusion_id);
+    return;
+  }
 
-    buildFusionIr();
-
-    if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::FusionIrPresched)) {
-      fusionInterfacePtr()->print();
+  traverseRecords();
+  auto cache_entry = fusionCachePtr()->lookupFusionCacheEntry(
+      fusion_cache_entry_, end_record_.get());
+  if (!cache_entry.has_value()) {
+    if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
+      std::cout << "\nFusionDefinition: Terminal Node not found.\n";
     }
+    fusionCachePtr()->createFusionCacheEntry(
+        fusion_cache_entry_, end_record_.get());
   } else {
     if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
       std::cout << "\nFusionDefinition: Terminal Node found!\n";
     }
-    fusionInterfacePtr()->define(cache_entry.value()->fusion_id);
-    fusionCachePtr()->traverseFusionCache(end_record_.get());
+  }
+  fusion_cache_entry_ = fusionCachePtr()->traverseFusionCache(
+      fusion_cache_entry_, end_record_.get());
+  fusion_cache_path_.push_back(fusion_cache_entry_);
+  fusionInterfacePtr()->define(fusion_cache_entry_->fusion_id);
+
+  // The Fusion IR is built by the first definition that reaches a new or
+  // restored fusion, concurrent definitions of it wait until it is built
+  fusionCachePtr()->materializeFusion(
+      fusion_cache_entry_->fusion_id, [this]() {
+        if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonDefinition)) {
+          print(std::cout);
+        }
+
+        buildFusionIr();
+
+        if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::FusionIrPresched)) {
+          fusionInterfacePtr()->print();
+        }
+      });
+  fusionCachePtr()->registerFusionFingerprint(
+      fingerprint_, fusion_cache_path_);
+}
+
+void FusionDefinition::traverseRecords() {
+  FUSER_PERF_SCOPE("FusionDefinition::traverseRecords");
+  for (auto& record : recording_) {
+    auto cache_entry = fusionCachePtr()->lookupFusionCacheEntry(
+        fusion_cache_entry_, record.get());
+    // If the Record is found in the cache, the FusionDefinition and the Cache
+    // will not share Record given the Record had to be created in order to
+    // match it but it also already existed in the cache.
+    if (cache_entry.has_value()) {
+      if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
+        std::cout << "\nFusionDefinition: Record (hash: 0x" << std::hex
+                  << record->hash() << ") hit in Fusion Cache.\n";
+      }
+    } else {
+      if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
+        std::cout << "\nFusionDefinition: Record (hash: 0x" << std::hex
+                  << record->hash() << ") missed in Fusion Cache.\n";
+      }
+      fusionCachePtr()->createFusionCacheEntry(
+          fusion_cache_entry_, record.get());
+    }
+    fusion_cache_entry_ = fusionCachePtr()->traverseFusionCache(
+        fusion_cache_entry_, record.get());
+    fusion_cache_path_.push_back(fusion_cache_entry_);
   }
 }
 
@@ -144,25 +214,9 @@ void FusionDefinition::defineRecord(RecordFunctor* record) {
       "operations.  The max_length for FusionDefintion's might need to be ",
       "increased if the definition is created as expected.");
   recording_.emplace_back(record);
-  auto cache_entry =
-      fusionCachePtr()->lookupFusionCacheEntry(recording_.back().get());
-  // If the Record is found in the cache, the FusionDefinition and the Cache
-  // will not share Record given the Record had to be created in order to
-  // match it but it also already existed in the cache.
-  if (cache_entry.has_value()) {
-    if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
-      std::cout << "\nFusionDefinition: Record (hash: 0x" << std::hex
-                << record->hash() << ") hit in Fusion Cache.\n";
-    }
-    // The FusionDefinition and the Cache will share the Record
-  } else {
-    if (Nvf::isDebugDumpEnabled(Nvf::DebugDumpOption::PythonFrontendDebug)) {
-      std::cout << "\nFusionDefinition: Record (hash: 0x" << std::hex
-                << record->hash() << ") missed in Fusion Cache.\n";
-    }
-    fusionCachePtr()->createFusionCacheEntry(recording_.back().get());
-  }
-  fusionCachePtr()->traverseFusionCache(recording_.back().get());
+  // The cache lookup is deferred to exit(), see
+  // Note [Fusion Fingerprint Fast Path]
+  fingerprint_ = FusionCache::extendFingerprint(fingerprint_, record);
 }
 
 void FusionDefinition::addInput(Nvf::Val* input) {
@@ -9,6 +9,7 @@ namespace Nvf = torch::jit::fuser::cuda;
 namespace nvfuser {
 
 class FusionCache;
+struct FusionCacheEntry;
 class FusionInterface;
 struct RecordFunctor;
 
@@ -73,6 +74,19 @@ struct Scalar {
 //! in a cache and the recorded records are used to build an nvFuser Fusion
 //! object if the definition missed in the cache.
 //!
+//! Note [Fusion Fingerprint Fast Path]
+//!
+//! Records are not looked up in the FusionCache as they are defined.
+//! Instead, the FusionDefinition folds the hash of each record into a
+//! fingerprint of the whole definition.  Upon exit, the fingerprint is
+//! queried in a flat index of the FusionCache, and a definition that was
+//! seen before gets its fusion id from a single lookup.  Only on a miss are
+//! the records replayed through the prefix tree, creating the entries the
+//! cache doesn't have yet, and the new definition is indexed for next time.
+//! The FusionDefinition owns its cursor into the tree, so definitions on
+//! different threads don't interfere, see
+//! Note [Concurrent Fusion Definitions].
+//!
 //! The nested Operators class was designed to allow the user to query all the
 //! available Operators in the FusionDefinition via python help.
 //!
@@ -122,6 +136,14 @@ class TORCH_CUDA_CU_API FusionDefinition {
   //! Builds an nvFuser Fusion IR object upon exit of a FusionDefintion
   //! when a cache lookup fails.
   void buildFusionIr();
+  //! Looks up the definition in the FusionCache upon exit, and defines the
+  //! fusion if it is not cached yet
+  void finalizeDefinition();
+  //! Walks the records through the FusionCache's prefix tree, creating the
+  //! entries that are missing, when the fingerprint lookup fails.
+  void traverseRecords();
+  //! Releases the cursor registered with the FusionCache on enter, if any
+  void releaseCursor();
   //! Returns the FusionCache Ptr that holds the cache of Fusions
   FusionCache* fusionCachePtr() const;
   //! Returns the FusionInterface Ptr that represents the corresponding
@@ -145,6 +167,18 @@ class TORCH_CUDA_CU_API FusionDefinition {
   std::vector<std::unique_ptr<RecordFunctor>> recording_;
   //! A vector of state recorded in the FusionDefinition
   std::vector<State> recording_state_;
+  //! Hash of the records defined so far, see
+  //! Note [Fusion Fingerprint Fast Path]
+  size_t fingerprint_;
+  //! The current cache entry in the walk of the records through the
+  //! FusionCache's prefix tree
+  FusionCacheEntry* fusion_cache_entry_;
+  //! The entries visited by the walk, used to index the definition by its
+  //! fingerprint once its terminal entry is reached
+  std::vector<FusionCacheEntry*> fusion_cache_path_;
+  //! The epoch the cursor was registered in with the FusionCache, from
+  //! enter to the end of exit
+  c10::optional<size_t> cursor_epoch_;
 
   //! A vector of nvFuser Fusion IR TensorViews/Vals for building the Fusion
   //! IR graph.
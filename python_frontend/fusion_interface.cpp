@@ -9,7 +9,12 @@ FusionInterface::FusionInterface(size_t fusion_id)
 
 void FusionInterface::define(size_t fusion_id) {
   auto fc = FusionCache::get();
-  TORCH_CHECK(fusion_id < fc->fusions_.size(), "Invalid fusion id!");
+  {
+    std::lock_guard<std::mutex> guard(fc->mutex_);
+    TORCH_CHECK(
+        fc->fusionSlot(fusion_id) < fc->fusions_.size(),
+        "Invalid fusion id!");
+  }
   fusion_id_ = c10::optional<size_t>(fusion_id);
 }
 
@@ -23,41 +28,72 @@ size_t FusionInterface::id() const {
 }
 
 void FusionInterface::addInput(Nvf::Val* input) const {
-  fusionPtr()->addInput(input);
+  auto fusion_executor_cache = fusionExecutorCache();
+  fusionOf(fusion_executor_cache.get())->addInput(input);
 }
 
 void FusionInterface::addOutput(Nvf::Val* output) const {
-  fusionPtr()->addOutput(output);
+  auto fusion_executor_cache = fusionExecutorCache();
+  fusionOf(fusion_executor_cache.get())->addOutput(output);
 }
 
 std::vector<at::Tensor> FusionInterface::execute(
     const at::ArrayRef<c10::IValue>& inputs) const {
+  // Holds on to the fusion in case it is evicted by another thread while
+  // it runs
+  auto fusion_executor_cache = fusionExecutorCache();
   // aliasOutputToInput always adds Tensors as outputs that we don't want
   // to return to the user. We need to remove them.
-  auto count_output_aliases = fusionPtr()->getOutputAliasIndices().size();
-  auto result = fusionExecutorCachePtr()->runFusionWithInputs(inputs);
+  auto count_output_aliases =
+      fusion_executor_cache->fusion()->getOutputAliasIndices().size();
+  auto result = fusion_executor_cache->runFusionWithInputs(inputs);
   result.erase(result.begin(), result.begin() + count_output_aliases);
   return result;
 }
 
+std::vector<std::vector<at::Tensor>> FusionInterface::execute(
+    const std::vector<std::vector<c10::IValue>>& input_sets,
+    const std::vector<c10::cuda::CUDAStream>& streams) const {
+  auto fusion_executor_cache = fusionExecutorCache();
+  auto count_output_aliases =
+      fusion_executor_cache->fusion()->getOutputAliasIndices().size();
+  auto results =
+      fusion_executor_cache->runFusionWithInputsBatch(input_sets, streams);
+  for (auto& result : results) {
+    result.erase(result.begin(), result.begin() + count_output_aliases);
+  }
+  return results;
+}
+
 Nvf::FusionGuard FusionInterface::guard() const {
-  return Nvf::FusionGuard(fusionPtr());
+  // The fusion is built under the guard while FusionCache::materializeFusion
+  // holds on to it
+  auto fusion_executor_cache = fusionExecutorCache();
+  return Nvf::FusionGuard(fusionOf(fusion_executor_cache.get()));
 }
 
 void FusionInterface::print() const {
-  fusionExecutorCachePtr()->printFusion();
+  auto fusion_executor_cache = fusionExecutorCache();
+  fusion_executor_cache->printFusion();
 }
 
-Nvf::FusionExecutorCache* FusionInterface::fusionExecutorCachePtr() const {
+std::shared_ptr<Nvf::FusionExecutorCache> FusionInterface::
+    fusionExecutorCache() const {
   auto fc = FusionCache::get();
   TORCH_CHECK(defined(), "Invalid fusion id!");
+  auto fusion_executor_cache = fc->fusionExecutorCache(fusion_id_.value());
   TORCH_CHECK(
-      fc->fusions_.at(fusion_id_.value()), "FusionExecutorCache Ptr is Null!");
-  return fc->fusions_.at(fusion_id_.value()).get();
+      fusion_executor_cache,
+      "FusionExecutorCache Ptr is Null! The fusion was either evicted from ",
+      "the FusionCache, or restored by FusionCache::load and not built yet. ",
+      "Restored fusions are built once their FusionDefinition is entered ",
+      "again.");
+  return fusion_executor_cache;
 }
 
-Nvf::Fusion* FusionInterface::fusionPtr() const {
-  auto fusion_ptr = fusionExecutorCachePtr()->fusion();
+Nvf::Fusion* FusionInterface::fusionOf(
+    Nvf::FusionExecutorCache* fusion_executor_cache) {
+  auto fusion_ptr = fusion_executor_cache->fusion();
   TORCH_CHECK(fusion_ptr != nullptr, "Fusion IR pointer is null!");
   return fusion_ptr;
 }
@@ -25,6 +25,13 @@ namespace nvfuser {
 //!   for _ in range(5) :
 //!      outputs = fs.execute([input])
 //!
+//!   # Runs several input sets, e.g. micro-batches, in one call
+//!   outputs = fs.execute([[input], [input * 2]])
+//!
+//!   # Runs the input sets round-robin on side streams
+//!   s0, s1 = torch.cuda.Stream(), torch.cuda.Stream()
+//!   outputs = fs.execute([[input], [input * 2]], streams=[s0, s1])
+//!
 //! Example 2 - Use cached fusion, directly, based on id:
 //!
 //!   fs = Fusion(fusion_id)
@@ -54,17 +61,24 @@ class TORCH_CUDA_CU_API FusionInterface {
   //! Executes a fusion if the current cache pointer points at a terminal node
   std::vector<at::Tensor> execute(
       const at::ArrayRef<c10::IValue>& inputs) const;
+  //! Executes a fusion on each of the input sets, resolving their kernels
+  //! in one pass. The input sets are run round-robin on the streams given.
+  std::vector<std::vector<at::Tensor>> execute(
+      const std::vector<std::vector<c10::IValue>>& input_sets,
+      const std::vector<c10::cuda::CUDAStream>& streams = {}) const;
   //! Activates a guard around the represented Fusion IR.
   Nvf::FusionGuard guard() const;
   //! Prints the represented nvFuser IR
   void print() const;
 
  private:
-  //! Provides a pointer to the FusionExecutorCache that maps the current
-  //! unscheduled Fusion IRs to scheduled Fusion IRs for execution.
-  Nvf::FusionExecutorCache* fusionExecutorCachePtr() const;
-  //! Points to the nvFuser Fusion IR object
-  Nvf::Fusion* fusionPtr() const;
+  //! Provides the FusionExecutorCache that maps the current unscheduled
+  //! Fusion IRs to scheduled Fusion IRs for execution, shared with the
+  //! FusionCache.  Callers hold on to it for as long as they use it, as the
+  //! fusion may be evicted by another thread.
+  std::shared_ptr<Nvf::FusionExecutorCache> fusionExecutorCache() const;
+  //! Points to the nvFuser Fusion IR object of a FusionExecutorCache
+  static Nvf::Fusion* fusionOf(Nvf::FusionExecutorCache* fusion_executor_cache);
 
   c10::optional<size_t> fusion_id_;
 };
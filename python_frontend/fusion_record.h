@@ -974,6 +974,9 @@ struct TensorRecord : RecordFunctor {
       }
     }
     os << "], dtype=" << dtypeToPyString(dtype_);
+    if (is_cpu_) {
+      os << ", is_cpu=True";
+    }
     if (close_function) {
       os << ")";
     }
@@ -1,6 +1,7 @@
 #include <third_party/nvfuser/python_frontend/python_bindings.h>
 
 #ifdef USE_CUDA
+#include <c10/cuda/CUDAStream.h>
 #include <c10/util/ArrayRef.h>
 #include <c10/util/irange.h>
 #include <third_party/nvfuser/arith.h>
@@ -14,6 +15,7 @@
 #include <third_party/nvfuser/python_frontend/fusion_record.h>
 #include <third_party/nvfuser/python_frontend/python_bindings.h>
 #include <torch/csrc/jit/python/pybind_utils.h>
+#include <algorithm>
 #include <iostream>
 #include <tuple>
 
@@ -41,18 +43,25 @@ void initNvFuserPythonBindings(PyObject* module) {
 
   //! Binding the FusionCache that holds a cache of Fusions
   //! This is only bound to provide an interface to get the number of fusions
-  //! that are cached.
+  //! that are cached, and to save and load the cache.
   py::class_<nvfuser::FusionCache> fusion_cache(nvfuser, "FusionCache");
   fusion_cache
       .def_static(
           "get",
-          &nvfuser::FusionCache::get,
-          py::arg("max_fusions") = int(8192),
+          static_cast<nvfuser::FusionCache* (*)()>(&nvfuser::FusionCache::get),
+          py::return_value_policy::reference)
+      .def_static(
+          "get",
+          static_cast<nvfuser::FusionCache* (*)(size_t)>(
+              &nvfuser::FusionCache::get),
+          py::arg("max_fusions"),
           py::return_value_policy::reference)
       .def("num_fusions", &nvfuser::FusionCache::numFusions)
-      .def("print_stats", [](nvfuser::FusionCache& self) {
-        self.print(std::cout);
-      });
+      .def(
+          "print_stats",
+          [](nvfuser::FusionCache& self) { self.print(std::cout); })
+      .def("save", &nvfuser::FusionCache::save, py::arg("filename"))
+      .def("load", &nvfuser::FusionCache::load, py::arg("filename"));
 
   py::class_<nvfuser::FusionInterface> fusion(nvfuser, "Fusion");
   fusion.def(py::init<>())
@@ -61,14 +70,57 @@ void initNvFuserPythonBindings(PyObject* module) {
       .def("defined", &nvfuser::FusionInterface::defined)
       .def(
           "execute",
-          [](nvfuser::FusionInterface& self, const py::iterable& iter) {
-            std::vector<IValue> inputs;
+          [](nvfuser::FusionInterface& self,
+             const py::iterable& iter,
+             const std::vector<c10::Stream>& streams) -> py::object {
+            std::vector<py::object> objs;
             for (py::handle obj : iter) {
+              objs.push_back(py::reinterpret_borrow<py::object>(obj));
+            }
+            // Fusion inputs are tensors and scalars, so a list of lists is a
+            // batch of input sets, run with one lookup of their kernels
+            bool is_batch = !objs.empty() &&
+                std::all_of(objs.begin(), objs.end(), [](py::handle obj) {
+                                return py::isinstance<py::list>(obj) ||
+                                    py::isinstance<py::tuple>(obj);
+                              });
+            if (is_batch) {
+              // Input sets are run round-robin on the streams
+              std::vector<c10::cuda::CUDAStream> cuda_streams;
+              for (const auto& stream : streams) {
+                cuda_streams.emplace_back(stream);
+              }
+              std::vector<std::vector<IValue>> input_sets(objs.size());
+              for (size_t i = 0; i < objs.size(); ++i) {
+                for (py::handle obj : objs[i]) {
+                  input_sets[i].push_back(toIValue(obj, c10::AnyType::get()));
+                }
+              }
+              std::vector<std::vector<at::Tensor>> results;
+              {
+                // Lets other python threads define and execute fusions
+                py::gil_scoped_release release;
+                results = self.execute(input_sets, cuda_streams);
+              }
+              return py::cast(results);
+            }
+            TORCH_CHECK(
+                streams.empty(),
+                "Streams are only taken along with a list of input sets.");
+
+            std::vector<IValue> inputs;
+            for (auto& obj : objs) {
               inputs.push_back(toIValue(obj, c10::AnyType::get()));
             }
-            return self.execute(inputs);
+            std::vector<at::Tensor> result;
+            {
+              py::gil_scoped_release release;
+              result = self.execute(inputs);
+            }
+            return py::cast(result);
           },
-          py::return_value_policy::reference)
+          py::arg("inputs"),
+          py::arg("streams") = py::list())
       .def("id", &nvfuser::FusionInterface::id)
       .def("print", &nvfuser::FusionInterface::print);
 
@@ -101,7 +153,10 @@ void initNvFuserPythonBindings(PyObject* module) {
              void* exc_type,
              void* exc_value,
              void* traceback) {
-            self.exit();
+            {
+              py::gil_scoped_release release;
+              self.exit();
+            }
             // Mark the end of a FusionDefinition Context Manager
             Nvf::inst::Trace::instance()->endEvent(nullptr);
           })
@@ -382,6 +437,7 @@ void initNvFuserPythonBindings(PyObject* module) {
   NVFUSER_PYTHON_BINDING_UNARY_OP("bitwise_not", bitwise_not)
   NVFUSER_PYTHON_BINDING_UNARY_OP("relu", relu)
   NVFUSER_PYTHON_BINDING_UNARY_OP("rand_like", randlike)
+  NVFUSER_PYTHON_BINDING_UNARY_OP("randn_like", randnlike)
   NVFUSER_PYTHON_BINDING_UNARY_OP("reciprocal", reciprocal)
   NVFUSER_PYTHON_BINDING_UNARY_OP("round", round)
   NVFUSER_PYTHON_BINDING_UNARY_OP("rsqrt", rsqrt)
@@ -2,9 +2,16 @@
 #include <gmock/gmock-matchers.h>
 #include <gtest/gtest.h>
 
+#include <c10/util/tempfile.h>
 #include <torch/torch.h>
 
+#include <atomic>
+#include <set>
+#include <thread>
+
 #include <third_party/nvfuser/python_frontend/fusion_cache.h>
+#include <third_party/nvfuser/python_frontend/fusion_definition.h>
+#include <third_party/nvfuser/python_frontend/fusion_interface.h>
 #include <third_party/nvfuser/test/test_gpu_validator.h>
 
 // Tests go in torch::jit
@@ -30,33 +37,39 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
   ASSERT_FALSE(fc == nullptr);
   ASSERT_TRUE(fc->numFusions() == 0);
 
+  // The cursor of a cache lookup is owned by the caller
+  FusionCacheEntry* cursor = fc->startFusionCacheLookup();
+  ASSERT_FALSE(cursor == nullptr);
+
   // Check that cache methods all assert when presented with a null record.
   {
     std::unique_ptr<RecordFunctor> null_record(nullptr);
 
     try {
-      auto bad_cache_entry_ptr = fc->lookupFusionCacheEntry(null_record.get());
+      auto bad_cache_entry_ptr =
+          fc->lookupFusionCacheEntry(cursor, null_record.get());
       FAIL() << "Should trigger an assert when the record is looked up!";
     } catch (...) {
       SUCCEED();
     }
 
     try {
-      fc->traverseFusionCache(null_record.get());
+      cursor = fc->traverseFusionCache(cursor, null_record.get());
       FAIL() << "Should trigger an assert when the record is looked up!";
     } catch (...) {
       SUCCEED();
     }
 
     try {
-      fc->createFusionCacheEntry(null_record.get());
+      fc->createFusionCacheEntry(cursor, null_record.get());
       FAIL() << "Should trigger an assert when the record is looked up!";
     } catch (...) {
       SUCCEED();
     }
 
     try {
-      auto id = fc->createFusionCacheEntry(null_record.get());
+      auto terminal_entry =
+          fc->createFusionCacheEntry(cursor, null_record.get());
       FAIL() << "Should trigger an assert when the record is looked up!";
     } catch (...) {
       SUCCEED();
@@ -74,7 +87,7 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
     // Cache Lookup should not succeed becase no records are in the cache
     try {
       auto empty_cache_entry_ptr =
-          fc->lookupFusionCacheEntry(test_record.get());
+          fc->lookupFusionCacheEntry(cursor, test_record.get());
       ASSERT_TRUE(empty_cache_entry_ptr == c10::nullopt);
       SUCCEED();
     } catch (const std::exception& e) {
@@ -83,7 +96,7 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
 
     // Traversal of the cache should fail because there is nothing to traverse
     try {
-      fc->traverseFusionCache(test_record.get());
+      cursor = fc->traverseFusionCache(cursor, test_record.get());
       FAIL() << "Expected the cache traversal to fail!";
     } catch (...) {
       SUCCEED();
@@ -92,14 +105,15 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
     // Add a cache entry and check methods
 
     try {
-      fc->createFusionCacheEntry(test_record.get());
+      fc->createFusionCacheEntry(cursor, test_record.get());
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "An unexpected assert on Cache Entry creation!" << e.what();
     }
 
     try {
-      auto cache_entry_ptr = fc->lookupFusionCacheEntry(test_record.get());
+      auto cache_entry_ptr =
+          fc->lookupFusionCacheEntry(cursor, test_record.get());
       ASSERT_FALSE(cache_entry_ptr == c10::nullopt);
       SUCCEED();
     } catch (const std::exception& e) {
@@ -107,7 +121,7 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
     }
 
     try {
-      fc->traverseFusionCache(test_record.get());
+      cursor = fc->traverseFusionCache(cursor, test_record.get());
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "An unexpected assert during Cache Traverse!" << e.what();
@@ -117,7 +131,8 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
 
     std::unique_ptr<RecordFunctor> end_record(new EndRecord());
     try {
-      auto id = fc->createFusionCacheEntry(end_record.get());
+      auto terminal_entry =
+          fc->createFusionCacheEntry(cursor, end_record.get());
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "An unexpected assert on Terminal Cache Entry creation!"
@@ -125,7 +140,7 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
     }
 
     try {
-      fc->traverseFusionCache(end_record.get());
+      cursor = fc->traverseFusionCache(cursor, end_record.get());
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "An unexpected assert while traversing to a Terminal Entry!"
@@ -133,14 +148,15 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
     }
 
     try {
-      auto no_cache_entry_ptr = fc->lookupFusionCacheEntry(test_record.get());
+      auto no_cache_entry_ptr =
+          fc->lookupFusionCacheEntry(cursor, test_record.get());
       FAIL() << "Expected an assert from a terminal entry!";
     } catch (...) {
       SUCCEED();
     }
 
     try {
-      fc->traverseFusionCache(test_record.get());
+      cursor = fc->traverseFusionCache(cursor, test_record.get());
       FAIL() << "Expected an assert from a terminal entry!";
     } catch (...) {
       SUCCEED();
@@ -149,7 +165,7 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
 
   // Setup cache for a new cache lookup
   try {
-    fc->resetFusionCachePtr();
+    cursor = fc->startFusionCacheLookup();
     SUCCEED();
   } catch (const std::exception& e) {
     FAIL() << "Did not properly set cache to pointer to top of tree!"
@@ -165,7 +181,8 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
         new ScalarRecord({State(1, StateType::Scalar)}, Nvf::DataType::Float));
 
     try {
-      auto hit_cache_entry = fc->lookupFusionCacheEntry(cached_record.get());
+      auto hit_cache_entry =
+          fc->lookupFusionCacheEntry(cursor, cached_record.get());
       ASSERT_FALSE(hit_cache_entry == c10::nullopt);
       SUCCEED();
     } catch (const std::exception& e) {
@@ -173,14 +190,15 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
     }
 
     try {
-      fc->traverseFusionCache(cached_record.get());
+      cursor = fc->traverseFusionCache(cursor, cached_record.get());
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "Fusion cache traverse unexpectedly asserted!" << e.what();
     }
 
     try {
-      auto miss_cache_entry = fc->lookupFusionCacheEntry(new_record.get());
+      auto miss_cache_entry =
+          fc->lookupFusionCacheEntry(cursor, new_record.get());
       ASSERT_TRUE(miss_cache_entry == c10::nullopt);
       SUCCEED();
     } catch (const std::exception& e) {
@@ -188,38 +206,46 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
     }
 
     try {
-      fc->createFusionCacheEntry(new_record.get());
+      fc->createFusionCacheEntry(cursor, new_record.get());
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "An unexpected assert on Cache Entry creation!" << e.what();
     }
 
     try {
-      fc->traverseFusionCache(new_record.get());
+      cursor = fc->traverseFusionCache(cursor, new_record.get());
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "Fusion cache traverse unexpectedly asserted!" << e.what();
     }
 
+    // The cache is full, so the first fusion is evicted to make room
     std::unique_ptr<RecordFunctor> end_record(new EndRecord());
     try {
-      auto id = fc->createFusionCacheEntry(end_record.get());
-      FAIL() << "Expected the cache to assert because it is full!";
-    } catch (...) {
+      auto terminal_entry =
+          fc->createFusionCacheEntry(cursor, end_record.get());
+      ASSERT_TRUE(terminal_entry->isTerminal());
+      // The new fusion takes the slot of the evicted one under a new id
+      ASSERT_TRUE(terminal_entry->fusion_id != 0);
+      ASSERT_TRUE(fc->numFusions() == 1);
       SUCCEED();
+    } catch (const std::exception& e) {
+      FAIL() << "Expected the cache to evict a fusion when it is full!"
+             << e.what();
     }
   }
 
   // Setup cache for a new cache lookup
   try {
-    fc->resetFusionCachePtr();
+    cursor = fc->startFusionCacheLookup();
     SUCCEED();
   } catch (const std::exception& e) {
     FAIL() << "Did not properly set cache to pointer to top of tree!"
            << e.what();
   }
 
-  // Verify proper cache lookup up of complete fusion already cached.
+  // Verify proper cache lookup up of the prefix the evicted fusion shared
+  // with the remaining one, while its terminal entry is gone.
   // This tends to flush out pointer problems in the cache.
   {
     std::unique_ptr<RecordFunctor> test_record(new TensorRecord(
@@ -228,7 +254,8 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
         {State(0, StateType::Tensor)}, {3}, {true}, Nvf::DataType::Float));
 
     try {
-      auto cache_entry_ptr = fc->lookupFusionCacheEntry(test_record.get());
+      auto cache_entry_ptr =
+          fc->lookupFusionCacheEntry(cursor, test_record.get());
       ASSERT_FALSE(cache_entry_ptr == c10::nullopt);
       SUCCEED();
     } catch (const std::exception& e) {
@@ -236,7 +263,7 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
     }
 
     try {
-      fc->traverseFusionCache(test_record.get());
+      cursor = fc->traverseFusionCache(cursor, test_record.get());
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "An unexpected assert during Cache Traverse!" << e.what();
@@ -244,22 +271,342 @@ TEST_F(NVFuserTest, PyFusionCache_CUDA) {
 
     std::unique_ptr<RecordFunctor> end_record(new EndRecord());
     try {
-      auto no_cache_entry_ptr = fc->lookupFusionCacheEntry(end_record.get());
+      auto no_cache_entry_ptr =
+          fc->lookupFusionCacheEntry(cursor, end_record.get());
+      ASSERT_TRUE(no_cache_entry_ptr == c10::nullopt);
       SUCCEED();
     } catch (const std::exception& e) {
       FAIL() << "An unexpected assert on cache lookup!" << e.what();
     }
 
     try {
-      fc->traverseFusionCache(end_record.get());
+      cursor = fc->traverseFusionCache(cursor, end_record.get());
+      FAIL() << "Expected the traversal to an evicted entry to fail!";
+    } catch (...) {
       SUCCEED();
-    } catch (const std::exception& e) {
-      FAIL() << "An unexpected assert while traversing to a Terminal Entry!"
-             << e.what();
     }
   }
 }
 
+// RUN CMD: bin/test_jit --gtest_filter="NVFuserTest*PyFusionCacheFingerprint*"
+TEST_F(NVFuserTest, PyFusionCacheFingerprint_CUDA) {
+  FusionCache::reset();
+  FusionCache* fc = FusionCache::get();
+  ASSERT_TRUE(fc->numFusions() == 0);
+
+  using ArithOp = Nvf::TensorView* (*)(Nvf::TensorView*, Nvf::Val*);
+  auto add_op = static_cast<ArithOp>(Nvf::add);
+  auto mul_op = static_cast<ArithOp>(Nvf::mul);
+
+  // Defines t0 + s1 or t0 * s1 and returns the fusion id
+  auto define_fusion = [add_op, mul_op](bool use_add) {
+    FusionInterface fusion;
+    FusionDefinition fd(&fusion, 8);
+    fd.enter();
+    auto t0 = fd.defineTensor();
+    fd.defineRecord(new TensorRecord(
+        {fd.recordingState(t0())}, {3}, {true}, Nvf::DataType::Float));
+    auto s1 = fd.defineScalar();
+    fd.defineRecord(
+        new ScalarRecord({fd.recordingState(s1())}, Nvf::DataType::Double));
+    auto t2 = fd.defineTensor();
+    fd.defineRecord(new OpRecord<Nvf::TensorView*, Nvf::TensorView*, Nvf::Val*>(
+        {fd.recordingState(t0()), fd.recordingState(s1())},
+        {fd.recordingState(t2())},
+        use_add ? "ops.add" : "ops.mul",
+        use_add ? add_op : mul_op));
+    fd.defineRecord(
+        new OutputRecord<Nvf::TensorView>({fd.recordingState(t2())}));
+    fd.exit();
+    return fusion.id();
+  };
+
+  auto fingerprint_hits = [fc]() {
+    std::stringstream ss;
+    fc->print(ss);
+    auto stats = ss.str();
+    auto pos = stats.find("Fingerprint Hits: ");
+    EXPECT_NE(pos, std::string::npos);
+    return std::stoi(stats.substr(pos + std::strlen("Fingerprint Hits: ")));
+  };
+
+  // The first definition is built through the tree
+  auto add_id = define_fusion(true);
+  ASSERT_EQ(fc->numFusions(), 1);
+  ASSERT_EQ(fingerprint_hits(), 0);
+
+  // Repeating it is found by its fingerprint
+  ASSERT_EQ(define_fusion(true), add_id);
+  ASSERT_EQ(define_fusion(true), add_id);
+  ASSERT_EQ(fc->numFusions(), 1);
+  ASSERT_EQ(fingerprint_hits(), 2);
+
+  // A definition sharing a prefix still gets its own fusion. OpRecords of
+  // add and mul hash alike, so the fingerprints collide as well.
+  auto mul_id = define_fusion(false);
+  ASSERT_NE(mul_id, add_id);
+  ASSERT_EQ(fc->numFusions(), 2);
+  ASSERT_EQ(fingerprint_hits(), 2);
+  ASSERT_EQ(define_fusion(false), mul_id);
+  ASSERT_EQ(fingerprint_hits(), 3);
+}
+
+namespace {
+
+using ArithOp = Nvf::TensorView* (*)(Nvf::TensorView*, Nvf::Val*);
+
+// Defines t0 + c1 or t0 * c1 with a constant c1 and returns the fusion id.
+// Only the FusionCache and the unscheduled Fusion IR are involved, no device.
+size_t defineBinaryFusion(bool use_add, double constant) {
+  FusionInterface fusion;
+  FusionDefinition fd(&fusion, 8);
+  fd.enter();
+  auto t0 = fd.defineTensor();
+  fd.defineRecord(new TensorRecord(
+      {fd.recordingState(t0())}, {-1, -1}, {true, true}, Nvf::DataType::Float));
+  auto c1 = fd.defineScalar();
+  fd.defineRecord(new ConstantRecord<Nvf::Double, double>(
+      {fd.recordingState(c1())}, constant));
+  auto t2 = fd.defineTensor();
+  fd.defineRecord(new OpRecord<Nvf::TensorView*, Nvf::TensorView*, Nvf::Val*>(
+      {fd.recordingState(t0()), fd.recordingState(c1())},
+      {fd.recordingState(t2())},
+      use_add ? "ops.add" : "ops.mul",
+      use_add ? static_cast<ArithOp>(Nvf::add)
+              : static_cast<ArithOp>(Nvf::mul)));
+  fd.defineRecord(new OutputRecord<Nvf::TensorView>({fd.recordingState(t2())}));
+  fd.exit();
+  return fusion.id();
+}
+
+} // namespace
+
+// RUN CMD: bin/test_jit --gtest_filter="NVFuserTest*PyFusionCacheSerial*"
+TEST_F(NVFuserTest, PyFusionCacheSerialization_CUDA) {
+  FusionCache::reset();
+  FusionCache* fc = FusionCache::get();
+  auto define_fusion = defineBinaryFusion;
+
+  auto add_id = define_fusion(true, 1.0);
+  auto mul_id = define_fusion(false, 1.0);
+  // Constants that only differ beyond the default print precision
+  auto add_eps_id = define_fusion(true, 1.0 + 1e-12);
+  ASSERT_EQ(fc->numFusions(), 3);
+
+  auto file = c10::make_tempfile();
+  fc->save(file.name);
+
+  // Restore the cache as a fresh process would
+  FusionCache::reset();
+  fc = FusionCache::get();
+  ASSERT_EQ(fc->numFusions(), 0);
+  fc->load(file.name);
+  ASSERT_EQ(fc->numFusions(), 3);
+
+  // Saving a restored cache that has not been used yet reproduces the file
+  {
+    auto file_copy = c10::make_tempfile();
+    fc->save(file_copy.name);
+    std::ifstream original(file.name, std::ios::binary);
+    std::ifstream copy(file_copy.name, std::ios::binary);
+    std::stringstream original_bytes;
+    std::stringstream copy_bytes;
+    original_bytes << original.rdbuf();
+    copy_bytes << copy.rdbuf();
+    ASSERT_EQ(original_bytes.str(), copy_bytes.str());
+  }
+
+  // Restored fusions are not built until their definition is seen again
+  try {
+    FusionInterface(mul_id).print();
+    FAIL() << "Expected an assert for a fusion that has not been built!";
+  } catch (...) {
+    SUCCEED();
+  }
+
+  // Redefining the fusions finds them under their saved ids
+  ASSERT_EQ(define_fusion(false, 1.0), mul_id);
+  ASSERT_EQ(define_fusion(true, 1.0 + 1e-12), add_eps_id);
+  ASSERT_EQ(define_fusion(true, 1.0), add_id);
+  ASSERT_EQ(fc->numFusions(), 3);
+
+  // The restored fusion was rebuilt from its records
+  {
+    FusionInterface fusion(mul_id);
+    auto fusion_guard = fusion.guard();
+    auto fusion_ptr = FusionGuard::getCurFusion();
+    ASSERT_EQ(fusion_ptr->inputs().size(), 1);
+    ASSERT_EQ(fusion_ptr->outputs().size(), 1);
+    auto def = fusion_ptr->outputs().at(0)->definition();
+    ASSERT_TRUE(def != nullptr && def->isA<BinaryOp>());
+    ASSERT_EQ(def->as<BinaryOp>()->getBinaryOpType(), BinaryOpType::Mul);
+  }
+
+  // New definitions still extend the restored tree
+  ASSERT_EQ(define_fusion(false, 2.0), 3);
+  ASSERT_EQ(fc->numFusions(), 4);
+
+  // Only an empty cache can be loaded into
+  try {
+    fc->load(file.name);
+    FAIL() << "Expected an assert for loading into a populated cache!";
+  } catch (...) {
+    SUCCEED();
+  }
+}
+
+// RUN CMD: bin/test_jit --gtest_filter="NVFuserTest*PyFusionCacheEviction*"
+TEST_F(NVFuserTest, PyFusionCacheEviction_CUDA) {
+  FusionCache::reset();
+  FusionCache* fc = FusionCache::get(2);
+
+  auto add_id = defineBinaryFusion(true, 1.0);
+  auto mul_id = defineBinaryFusion(false, 1.0);
+  ASSERT_EQ(fc->numFusions(), 2);
+
+  // Using the add fusion again leaves the mul fusion least recently used
+  ASSERT_EQ(defineBinaryFusion(true, 1.0), add_id);
+  auto add_two_id = defineBinaryFusion(true, 2.0);
+  ASSERT_EQ(fc->numFusions(), 2);
+
+  std::stringstream stats;
+  fc->print(stats);
+  ASSERT_NE(stats.str().find("Evictions: 1"), std::string::npos);
+
+  // The evicted fusion can no longer be used through its id
+  try {
+    FusionInterface(mul_id).print();
+    FAIL() << "Expected an assert for an evicted fusion!";
+  } catch (...) {
+    SUCCEED();
+  }
+  // The fusion that was kept is found as before
+  ASSERT_EQ(defineBinaryFusion(true, 1.0), add_id);
+
+  // The entries only the mul fusion went through are pruned, while the
+  // prefix shared with the add fusion is kept
+  {
+    std::unique_ptr<RecordFunctor> tensor_record(new TensorRecord(
+        {State(0, StateType::Tensor)},
+        {-1, -1},
+        {true, true},
+        Nvf::DataType::Float));
+    std::unique_ptr<RecordFunctor> constant_record(
+        new ConstantRecord<Nvf::Double, double>(
+            {State(1, StateType::Scalar)}, 1.0));
+    std::unique_ptr<RecordFunctor> mul_record(
+        new OpRecord<Nvf::TensorView*, Nvf::TensorView*, Nvf::Val*>(
+            {State(0, StateType::Tensor), State(1, StateType::Scalar)},
+            {State(2, StateType::Tensor)},
+            "ops.mul",
+            static_cast<ArithOp>(Nvf::mul)));
+
+    auto cursor = fc->startFusionCacheLookup();
+    ASSERT_TRUE(
+        fc->lookupFusionCacheEntry(cursor, tensor_record.get()).has_value());
+    cursor = fc->traverseFusionCache(cursor, tensor_record.get());
+    ASSERT_TRUE(
+        fc->lookupFusionCacheEntry(cursor, constant_record.get()).has_value());
+    cursor = fc->traverseFusionCache(cursor, constant_record.get());
+    ASSERT_FALSE(
+        fc->lookupFusionCacheEntry(cursor, mul_record.get()).has_value());
+  }
+
+  // Defining it again compiles it under a new id, evicting the least
+  // recently used fusion
+  auto new_mul_id = defineBinaryFusion(false, 1.0);
+  ASSERT_NE(new_mul_id, mul_id);
+  ASSERT_EQ(fc->numFusions(), 2);
+  ASSERT_EQ(defineBinaryFusion(true, 1.0), add_id);
+  try {
+    FusionInterface(add_two_id).print();
+    FAIL() << "Expected an assert for an evicted fusion!";
+  } catch (...) {
+    SUCCEED();
+  }
+
+  // Pruned entries are freed once no definition in flight can point at them
+  auto retired_entries = [fc]() {
+    std::stringstream stats;
+    fc->print(stats);
+    auto pos = stats.str().find("Retired Entries: ");
+    TORCH_INTERNAL_ASSERT(pos != std::string::npos);
+    return std::stoul(stats.str().substr(pos + 17));
+  };
+  ASSERT_EQ(retired_entries(), 0UL);
+  auto epoch = fc->registerCursor();
+  defineBinaryFusion(true, 3.0);
+  ASSERT_GT(retired_entries(), 0UL);
+  fc->releaseCursor(epoch);
+  ASSERT_EQ(retired_entries(), 0UL);
+
+  // Slots of evicted fusions are reused under new ids, so the id of an
+  // evicted fusion never runs the fusion that took its slot
+  std::set<size_t> fusion_ids = {add_id, mul_id, add_two_id, new_mul_id};
+  for (int i = 0; i < 8; ++i) {
+    auto fusion_id = defineBinaryFusion(i % 2 == 0, 10.0 + i);
+    ASSERT_TRUE(fusion_ids.insert(fusion_id).second);
+    ASSERT_EQ(fc->numFusions(), 2);
+  }
+  try {
+    FusionInterface(mul_id).print();
+    FAIL() << "Expected an assert for an evicted fusion!";
+  } catch (...) {
+    SUCCEED();
+  }
+}
+
+// RUN CMD: bin/test_jit --gtest_filter="NVFuserTest*PyFusionCacheConcurrent*"
+TEST_F(NVFuserTest, PyFusionCacheConcurrentDefinitions_CUDA) {
+  FusionCache::reset();
+  FusionCache* fc = FusionCache::get();
+
+  // Each thread defines the same fusions repeatedly, starting from a
+  // different one, so that threads create and find entries at once
+  const int num_threads = 8;
+  const int num_fusions = 8;
+  std::vector<std::vector<size_t>> fusion_ids(
+      num_threads, std::vector<size_t>(num_fusions, 0));
+  std::atomic<bool> failed(false);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid]() {
+      try {
+        for (int repeat = 0; repeat < 4; ++repeat) {
+          for (int i = 0; i < num_fusions; ++i) {
+            auto fusion = (i + tid) % num_fusions;
+            fusion_ids[tid][fusion] =
+                defineBinaryFusion(fusion % 2 == 0, (double)(fusion / 2));
+          }
+        }
+      } catch (...) {
+        failed = true;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_FALSE(failed);
+
+  // Every thread got the same fusion for the same definition
+  ASSERT_EQ(fc->numFusions(), num_fusions);
+  for (int tid = 1; tid < num_threads; ++tid) {
+    ASSERT_EQ(fusion_ids[tid], fusion_ids[0]);
+  }
+  std::set<size_t> unique_ids(fusion_ids[0].begin(), fusion_ids[0].end());
+  ASSERT_EQ(unique_ids.size(), num_fusions);
+
+  // Each fusion was built exactly once
+  for (auto fusion_id : unique_ids) {
+    FusionInterface fusion(fusion_id);
+    auto fusion_guard = fusion.guard();
+    auto fusion_ptr = FusionGuard::getCurFusion();
+    ASSERT_EQ(fusion_ptr->inputs().size(), 1);
+    ASSERT_EQ(fusion_ptr->outputs().size(), 1);
+  }
+}
+
 } // namespace jit
 } // namespace torch
 #endif // #if defined(USE_CUDA)
@@ -67,3 +67,36 @@ __device__ double rng_uniform(const uint4& rng_result, int rng_component) {
 __device__ float rng_uniformf(const uint4& rng_result, int rng_component) {
   return uniformf((&rng_result.x)[rng_component]);
 }
+
+// Box-Muller transform, matching curand_normal4 and curand_normal2_double.
+// Each Philox result carries two pairs of uniforms in float, and a single
+// pair in double, and each pair makes two normally distributed values, so
+// all four 32-bit lanes are used.
+__device__ double rng_normal(const uint4& rng_result, int rng_component) {
+  constexpr double kRan2Pow53Inv = 1.1102230246251565e-16;
+  const unsigned long long zu = (unsigned long long)rng_result.x ^
+      ((unsigned long long)rng_result.y << (53 - 32));
+  const unsigned long long zv = (unsigned long long)rng_result.z ^
+      ((unsigned long long)rng_result.w << (53 - 32));
+  // u is in (0, 1), so the log is finite
+  double u = zu * kRan2Pow53Inv + (kRan2Pow53Inv / 2.0);
+  double v = zv * (kRan2Pow53Inv * 2.0) + kRan2Pow53Inv;
+  double s = sqrt(-2.0 * log(u));
+  double sin_v, cos_v;
+  sincospi(v, &sin_v, &cos_v);
+  return s * (rng_component == 0 ? sin_v : cos_v);
+}
+
+__device__ float rng_normalf(const uint4& rng_result, int rng_component) {
+  constexpr float kRanInvM32 = 2.3283064e-10f; // Inverse of 2^32.
+  constexpr float kRanInvM32x2Pi = 1.4629181e-09f; // 2 * pi / 2^32.
+  int pair = rng_component / 2;
+  unsigned int x = (&rng_result.x)[pair * 2];
+  unsigned int y = (&rng_result.x)[pair * 2 + 1];
+  float u = x * kRanInvM32 + (kRanInvM32 / 2.0f);
+  float v = y * kRanInvM32x2Pi + (kRanInvM32x2Pi / 2.0f);
+  float s = sqrtf(-2.0f * logf(u));
+  float sin_v, cos_v;
+  __sincosf(v, &sin_v, &cos_v);
+  return s * (rng_component % 2 == 0 ? sin_v : cos_v);
+}
@@ -22,6 +22,41 @@ __inline__ __device__ void welfordCombine(
   a_N = ab_N;
 }
 
+// Merge a chunk of unrolled values into a welford result. The chunk is reduced
+// with a two-pass local mean and merged with a single welfordCombine, so no
+// division is done per value. Values with a false valid flag were predicated
+// out and are skipped.
+template <int CHUNK, typename T, typename TN>
+__inline__ __device__ void welfordChunkCombine(
+    T& a_avg,
+    T& a_M2,
+    TN& a_N,
+    const T (&vals)[CHUNK],
+    const bool (&valid)[CHUNK]) {
+  T sum = 0;
+  nvfuser_index_t n = 0;
+#pragma unroll
+  for (int i = 0; i < CHUNK; ++i) {
+    if (valid[i]) {
+      sum += vals[i];
+      ++n;
+    }
+  }
+  if (n == 0) {
+    return;
+  }
+  const T mean = sum / (T)n;
+  T M2 = 0;
+#pragma unroll
+  for (int i = 0; i < CHUNK; ++i) {
+    if (valid[i]) {
+      const T delta = vals[i] - mean;
+      M2 += delta * delta;
+    }
+  }
+  welfordCombine(a_avg, a_M2, a_N, mean, M2, (TN)n);
+}
+
 // [Z,Y,X]_THREADS is the number of participating threads in the z, y, x
 // dimension of the block.
 template <
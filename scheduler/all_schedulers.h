@@ -1,4 +1,5 @@
 #pragma once
+#include <third_party/nvfuser/scheduler/matmul.h>
 #include <third_party/nvfuser/scheduler/normalization.h>
 #include <third_party/nvfuser/scheduler/pointwise.h>
 #include <third_party/nvfuser/scheduler/reduction.h>
@@ -14,7 +15,8 @@ enum class TORCH_CUDA_CU_API ScheduleHeuristic {
   PointWise,
   Reduction,
   Persistent,
-  Transpose
+  Transpose,
+  Matmul
 };
 }
 } // namespace fuser
@@ -0,0 +1,153 @@
+#include <third_party/nvfuser/scheduler/heuristic_cache.h>
+
+#include <third_party/nvfuser/expr_evaluator.h>
+#include <third_party/nvfuser/fusion_signature.h>
+#include <third_party/nvfuser/instrumentation.h>
+#include <third_party/nvfuser/ir_all_nodes.h>
+#include <third_party/nvfuser/ir_utils.h>
+#include <third_party/nvfuser/scheduler/registry.h>
+
+#include <c10/cuda/CUDAFunctions.h>
+
+#include <sstream>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cuda {
+
+namespace {
+
+// Default number of parameter sets kept across the process
+constexpr size_t kDefaultHeuristicCacheSize = 4096;
+
+} // namespace
+
+HeuristicParamsCache& HeuristicParamsCache::get() {
+  static HeuristicParamsCache cache(kDefaultHeuristicCacheSize);
+  return cache;
+}
+
+std::string HeuristicParamsCache::makeKey(
+    ScheduleHeuristic sh,
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info) {
+  FUSER_PERF_SCOPE("HeuristicParamsCache::makeKey");
+  std::stringstream ss;
+  ss << sh << ';' << (int)runtime_info.getIndexMode() << ';'
+     << (int)c10::cuda::current_device() << ';';
+
+  // Structure of the fusion, see Note [Fusion Signature]
+  ss << FusionSignature(fusion).bytes() << ';';
+
+  // Runtime properties of the inputs as the heuristics see them
+  auto& expr_eval = runtime_info.expressionEvaluator();
+  for (auto inp : fusion->inputs()) {
+    if (auto tv = dynamic_cast<TensorView*>(inp)) {
+      for (auto id : TensorDomain::noReductions(tv->getMaybeRFactorDomain())) {
+        auto extent = expr_eval.evaluate(id->extent());
+        if (extent.has_value()) {
+          ss << extent.value();
+        } else {
+          ss << '?';
+        }
+        ss << ',';
+      }
+      ss << 'a' << runtime_info.getAlignmentSize(tv) << 'v'
+         << runtime_info.getMaxVectorizableWidth(tv) << 'i'
+         << runtime_info.getInnerDimVectorizableWidth(tv);
+    } else if (inp->isScalar()) {
+      auto value = expr_eval.evaluate(inp);
+      if (value.has_value()) {
+        ss << value.value();
+      } else {
+        ss << '?';
+      }
+    }
+    ss << ';';
+  }
+  return ss.str();
+}
+
+std::shared_ptr<HeuristicParams> HeuristicParamsCache::lookup(
+    const std::string& key) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto entry_it = entries_.find(key);
+  if (entry_it == entries_.end()) {
+    misses_++;
+    return nullptr;
+  }
+  hits_++;
+  auto& entry = entry_it->second;
+  lru_keys_.splice(lru_keys_.begin(), lru_keys_, entry.lru_iter);
+  // Entries hand out copies, since launch constraints of scheduler entries
+  //  are updated in place
+  return entry.params->clone();
+}
+
+void HeuristicParamsCache::insert(
+    const std::string& key,
+    const HeuristicParams& params) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (max_size_ == 0) {
+    return;
+  }
+  auto entry_it = entries_.find(key);
+  if (entry_it != entries_.end()) {
+    entry_it->second.params = params.clone();
+    lru_keys_.splice(lru_keys_.begin(), lru_keys_, entry_it->second.lru_iter);
+    return;
+  }
+  evictToSize(max_size_ - 1);
+  lru_keys_.push_front(key);
+  entries_.emplace(key, Entry{params.clone(), lru_keys_.begin()});
+}
+
+void HeuristicParamsCache::setMaxSize(size_t max_size) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  max_size_ = max_size;
+  evictToSize(max_size_);
+}
+
+void HeuristicParamsCache::clear() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  entries_.clear();
+  lru_keys_.clear();
+  hits_ = 0;
+  misses_ = 0;
+  evictions_ = 0;
+}
+
+HeuristicParamsCache::Stats HeuristicParamsCache::stats() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  stats.size = entries_.size();
+  stats.max_size = max_size_;
+  return stats;
+}
+
+std::string HeuristicParamsCache::statsString() {
+  auto cache_stats = stats();
+  std::stringstream ss;
+  ss << "Heuristic params cache: " << cache_stats.hits << " hits, "
+     << cache_stats.misses << " misses, " << cache_stats.evictions
+     << " evictions, " << cache_stats.size << "/" << cache_stats.max_size
+     << " entries";
+  return ss.str();
+}
+
+void HeuristicParamsCache::evictToSize(size_t size) {
+  while (entries_.size() > size) {
+    entries_.erase(lru_keys_.back());
+    lru_keys_.pop_back();
+    evictions_++;
+  }
+}
+
+} // namespace cuda
+} // namespace fuser
+} // namespace jit
+} // namespace torch
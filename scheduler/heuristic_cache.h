@@ -0,0 +1,104 @@
+#pragma once
+
+#include <third_party/nvfuser/fusion.h>
+#include <third_party/nvfuser/scheduler/all_schedulers.h>
+#include <third_party/nvfuser/scheduler/heuristic.h>
+#include <third_party/nvfuser/utils.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cuda {
+
+class SchedulerRuntimeInfo;
+
+//! Note [Heuristic Params Cache]
+//!
+//! The same fusion is routinely owned by many FusionExecutorCache instances,
+//!  e.g. one per TorchScript graph in CudaFusionManager and one per
+//!  FusionDefinition in the python FusionCache. Without sharing, each of
+//!  them re-runs the scheduler analysis and heuristics for every segment.
+//!
+//! HeuristicParamsCache is a process-wide LRU memo of HeuristicParams keyed
+//!  on everything the heuristics observe:
+//!   - the scheduler and index mode, and the current device,
+//!   - the structure of the (segment) fusion, i.e. its FusionSignature,
+//!   - the runtime properties of the fusion inputs, i.e. extents, alignment
+//!     and vectorizable widths of tensors, and values of scalars.
+//!
+//! Only the parameters are shared. HeuristicSummary entries point into the
+//!  fusion they were computed on, so they stay owned by the SegmentedFusion
+//!  and are only recorded once a group's heuristics are re-checked.
+//!
+//! Can be disabled with PYTORCH_NVFUSER_DISABLE=heuristic_cache, and stats
+//!  are printed with PYTORCH_NVFUSER_DUMP=heuristic_cache_stats.
+class TORCH_CUDA_CU_API HeuristicParamsCache : public NonCopyable {
+ public:
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t evictions = 0;
+    size_t size = 0;
+    size_t max_size = 0;
+  };
+
+  //! The process-wide instance
+  static HeuristicParamsCache& get();
+
+  //! Build the lookup key of scheduling fusion with heuristic sh
+  static std::string makeKey(
+      ScheduleHeuristic sh,
+      Fusion* fusion,
+      SchedulerRuntimeInfo& runtime_info);
+
+  //! Returns a copy of the cached params, nullptr on a miss
+  std::shared_ptr<HeuristicParams> lookup(const std::string& key);
+
+  //! Record a copy of params under key, evicting the least recently used
+  //!  entry if the cache is full
+  void insert(const std::string& key, const HeuristicParams& params);
+
+  //! Change the maximum number of entries, evicting if needed. 0 disables
+  //!  caching.
+  void setMaxSize(size_t max_size);
+
+  void clear();
+
+  Stats stats();
+
+  std::string statsString();
+
+ private:
+  explicit HeuristicParamsCache(size_t max_size) : max_size_(max_size) {}
+
+  void evictToSize(size_t size);
+
+  struct Entry {
+    std::shared_ptr<HeuristicParams> params;
+    std::list<std::string>::iterator lru_iter;
+  };
+
+  std::mutex mutex_;
+
+  size_t max_size_;
+
+  //! Keys ordered by their most recent use, freshest first
+  std::list<std::string> lru_keys_;
+
+  std::unordered_map<std::string, Entry> entries_;
+
+  int64_t hits_ = 0;
+  int64_t misses_ = 0;
+  int64_t evictions_ = 0;
+};
+
+} // namespace cuda
+} // namespace fuser
+} // namespace jit
+} // namespace torch
@@ -1,7 +1,17 @@
 #include <third_party/nvfuser/scheduler/matmul.h>
+
+#include <third_party/nvfuser/instrumentation.h>
+#include <third_party/nvfuser/ir_utils.h>
+#include <third_party/nvfuser/iter_visitor.h>
 #include <third_party/nvfuser/scheduler/mma_utils.h>
+#include <third_party/nvfuser/scheduler/registry.h>
 #include <third_party/nvfuser/scheduler/utils.h>
 
+#include <ATen/cuda/CUDAContext.h>
+
+#include <algorithm>
+#include <iterator>
+
 namespace torch {
 namespace jit {
 namespace fuser {
@@ -40,6 +50,192 @@ void moveInnerBroadcastLeft(TensorView* tv, int number_of_inner_pos = 3) {
   tv->reorder(order_map);
 }
 
+// Number of pipelining stages of the operand loads on Ampere
+constexpr int kMaxSmemBufferStages = 4;
+
+// Split-K limits, see Note [Matmul Split-K]. Each CTA keeps enough K
+//  tiles to fill its load pipeline, and the number of partial tiles to
+//  reduce stays bounded.
+constexpr int64_t kMinKTilesPerSplit = 4;
+constexpr int64_t kMaxSplitKFactor = 16;
+
+// Width of the vectorized shared memory stores of the operands, see
+//  scheduleContiguousVectorLoad in scheduleMatmul
+constexpr int64_t kOperandVectorWidth = 8;
+
+// The tensors of a fusion taken by the Matmul heuristic, see
+//  Note [Matmul Scheduler]
+struct MatmulPattern {
+  //! Output of the single MmaOp in the fusion
+  TensorView* c = nullptr;
+
+  //! Fusion inputs of the operands
+  TensorView* a = nullptr;
+  TensorView* b = nullptr;
+
+  MmaOptions::MmaInputLayout layout = MmaOptions::MmaInputLayout::TT;
+};
+
+// Returns the cast of a matmul operand input done in the prologue, or
+//  nullptr if the operand isn't cast
+TensorView* getPrologueCast(TensorView* operand_input) {
+  if (operand_input->uses().size() != 1) {
+    return nullptr;
+  }
+  auto uop = dynamic_cast<UnaryOp*>(operand_input->uses().front());
+  if (uop == nullptr || uop->getUnaryOpType() != UnaryOpType::Cast) {
+    return nullptr;
+  }
+  return uop->out()->as<TensorView>();
+}
+
+// Walks from the broadcast mma operand back to the fusion input, see
+//  Note [Matmul Scheduler]. Returns nullptr if the prologue isn't supported.
+TensorView* getOperandInput(TensorView* mma_operand, int broadcast_pos) {
+  auto bcast = dynamic_cast<BroadcastOp*>(mma_operand->definition());
+  if (bcast == nullptr || mma_operand->uses().size() != 1) {
+    return nullptr;
+  }
+  const auto& bcast_flags = bcast->getBroadcastDimFlags();
+  for (auto i : c10::irange(bcast_flags.size())) {
+    if (bcast_flags.at(i) != ((int)i == broadcast_pos)) {
+      return nullptr;
+    }
+  }
+
+  auto operand = bcast->in()->as<TensorView>();
+  if (!operand->isFusionInput()) {
+    auto uop = dynamic_cast<UnaryOp*>(operand->definition());
+    if (uop == nullptr || uop->getUnaryOpType() != UnaryOpType::Cast ||
+        operand->uses().size() != 1 || operand->isFusionOutput()) {
+      return nullptr;
+    }
+    operand = uop->in()->as<TensorView>();
+  }
+  if (!operand->isFusionInput() || operand->uses().size() != 1) {
+    return nullptr;
+  }
+  return operand;
+}
+
+// Finds the matmul tensors of fusion, returns the reason the fusion doesn't
+//  match Note [Matmul Scheduler] or an empty string if it does
+std::string findMatmulPattern(Fusion* fusion, MatmulPattern& pattern) {
+  auto exprs = fusion->exprs();
+  std::vector<MmaOp*> mma_ops;
+  for (auto mma : ir_utils::filterByType<MmaOp>(exprs)) {
+    mma_ops.push_back(mma);
+  }
+  if (mma_ops.empty()) {
+    return "no mma op";
+  }
+  if (mma_ops.size() > 1) {
+    return "only a single mma op is supported";
+  }
+  auto mma = mma_ops.front();
+  pattern.c = mma->out()->as<TensorView>();
+
+  // Root domain of the mma output is ordered as [Operand Layout Convention]
+  const auto& root_domain = pattern.c->getRootDomain();
+  if (root_domain.size() != 3) {
+    return "only 2D matmuls are supported";
+  }
+  int k_pos = -1;
+  for (auto i : c10::irange(root_domain.size())) {
+    if (root_domain.at(i)->isReduction()) {
+      if (k_pos != -1) {
+        return "only a single reduction axis is supported";
+      }
+      k_pos = (int)i;
+    }
+  }
+  // Positions of the M and N axes, which are broadcast in B and A
+  int m_pos = 0, n_pos = 2;
+  switch (k_pos) {
+    case 0:
+      pattern.layout = MmaOptions::MmaInputLayout::NT;
+      m_pos = 1;
+      break;
+    case 1:
+      pattern.layout = MmaOptions::MmaInputLayout::TT;
+      break;
+    case 2:
+      pattern.layout = MmaOptions::MmaInputLayout::TN;
+      n_pos = 1;
+      break;
+    default:
+      return "no reduction axis in mma";
+  }
+
+  pattern.a = getOperandInput(mma->inA()->as<TensorView>(), n_pos);
+  pattern.b = getOperandInput(mma->inB()->as<TensorView>(), m_pos);
+  if (pattern.a == nullptr || pattern.b == nullptr) {
+    return "unsupported operand prologue";
+  }
+  // The mma operands are the targets of the prologue casts, if any
+  for (auto operand : {mma->inA(), mma->inB()}) {
+    if (operand->getDataType() != DataType::Half) {
+      return "mma operands need to be Half";
+    }
+  }
+
+  // Everything depending on the mma output has to be a pointwise op on
+  //  [M, N], other branches of the epilogue can also be broadcast
+  auto epilogue_vals = DependencyCheck::getAllDependentVals({pattern.c});
+  std::unordered_set<Expr*> prologue_exprs = {mma};
+  for (auto operand : {pattern.a, pattern.b}) {
+    for (auto val : DependencyCheck::getAllValsBetween(
+             {operand}, {mma->inA(), mma->inB()})) {
+      if (val->definition() != nullptr) {
+        prologue_exprs.insert(val->definition());
+      }
+    }
+  }
+  for (auto expr : exprs) {
+    if (prologue_exprs.count(expr)) {
+      continue;
+    }
+    bool is_pointwise =
+        expr->isA<UnaryOp>() || expr->isA<BinaryOp>() || expr->isA<TernaryOp>();
+    bool in_epilogue = std::any_of(
+        expr->outputs().begin(), expr->outputs().end(), [&](Val* out) {
+          return epilogue_vals.count(out);
+        });
+    if (!is_pointwise && (in_epilogue || !expr->isA<BroadcastOp>())) {
+      return "unsupported op in epilogue: " + expr->toString();
+    }
+    for (auto out_tv : ir_utils::filterByType<TensorView>(expr->outputs())) {
+      auto ndims =
+          TensorDomain::noReductions(out_tv->getMaybeRFactorDomain()).size();
+      if (out_tv->hasReduction() || ndims > 2 || (in_epilogue && ndims != 2)) {
+        return "epilogue needs to be pointwise on the mma output";
+      }
+    }
+  }
+
+  for (auto out : fusion->outputs()) {
+    if (!out->isA<TensorView>() ||
+        (out != pattern.c && !epilogue_vals.count(out))) {
+      return "all fusion outputs need to depend on the mma output";
+    }
+  }
+
+  return "";
+}
+
+MmaOptions::MacroType getMatmulMacro() {
+  const auto properties = at::cuda::getCurrentDeviceProperties();
+  const int arch = properties->major * 10 + properties->minor;
+  if (arch >= 80) {
+    return MmaOptions::MacroType::Ampere_16_8_16;
+  } else if (arch >= 75) {
+    return MmaOptions::MacroType::Turing_16_8_16;
+  } else if (arch >= 70) {
+    return MmaOptions::MacroType::Volta_16_16_4;
+  }
+  return MmaOptions::MacroType::NoMMA;
+}
+
 } // namespace
 
 void scheduleMatmul(
@@ -77,13 +273,26 @@ void scheduleMatmul(
   //
   //  result in global memory: c
 
-  // Currently only support a, b, c as fusion inputs/outputs
-  //  aka. no prolog and epilog fusion yet.
+  // Operands have to be fusion inputs, the prologue and epilogue are
+  //  described in Note [Matmul Scheduler]
   TORCH_CHECK(
-      c->isFusionOutput() && a->isFusionInput() && b->isFusionInput(),
-      "not supporting matmul fusion yet");
+      a->isFusionInput() && b->isFusionInput(),
+      "matmul operands need to be fusion inputs");
   TORCH_CHECK(c->definition() && c->definition()->isA<MmaOp>());
 
+  // Epilogue outputs, c itself for a pure matmul
+  auto fusion = c->fusion();
+  auto outputs = ir_utils::filterByType<TensorView>(fusion->outputs());
+  std::vector<TensorView*> epilogue_outputs(outputs.begin(), outputs.end());
+
+  // Other fusion inputs read in the epilogue, e.g. bias
+  std::vector<TensorView*> epilogue_inputs;
+  for (auto tv : ir_utils::filterByType<TensorView>(fusion->inputs())) {
+    if (tv != a && tv != b) {
+      epilogue_inputs.push_back(tv);
+    }
+  }
+
   mma_builder.configureMma(c);
 
   // TODO:
@@ -111,12 +320,16 @@ void scheduleMatmul(
   mma_builder.accumulatorTv(cc);
   auto mma_options = mma_builder.build();
 
-  // Staging register for global memory load
-  TensorView *ar = a, *br = b;
+  // Staging register for global memory load. Prologue casts already
+  //  produce a register copy of the operands.
+  auto a_cast = getPrologueCast(a);
+  auto b_cast = getPrologueCast(b);
+  TensorView* ar = a_cast != nullptr ? a_cast : a;
+  TensorView* br = b_cast != nullptr ? b_cast : b;
 
   if (!params.async_gmem_load_operands) {
-    ar = a->cacheAfter();
-    br = b->cacheAfter();
+    ar = ar == a ? a->cacheAfter() : ar;
+    br = br == b ? b->cacheAfter() : br;
   }
 
   // TODO:
@@ -157,14 +370,15 @@ void scheduleMatmul(
     }
 
   } else {
-    // Use cp.async as requested in scheduler params.
+    // Use cp.async as requested in scheduler params, for the operands that
+    //  are copied to shared memory as is.
     c10::optional<LoadStoreOpType> load_op = c10::nullopt;
     if (params.async_gmem_load_operands) {
       load_op = LoadStoreOpType::CpAsync;
     }
 
-    acw_smem = ar->cacheAfter(load_op);
-    bcw_smem = br->cacheAfter(load_op);
+    acw_smem = ar->cacheAfter(ar == a ? load_op : c10::nullopt);
+    bcw_smem = br->cacheAfter(br == b ? load_op : c10::nullopt);
     acr = acw_smem->cacheAfter(
         mma_builder.operand(MmaOptions::Operand::A).ldMatrix());
     bcr = bcw_smem->cacheAfter(
@@ -178,6 +392,16 @@ void scheduleMatmul(
   scheduler_utils::matmul_utils::makeTile(cc, gemm_tile.cta_tile.toVector());
 
   // [Mo, No, Ko, Mi, Ni, Ki]
+  // Split the K tiles across CTAs, see Note [Matmul Split-K]
+  const bool split_k = params.split_k_factor > 1;
+  if (split_k) {
+    TORCH_CHECK(
+        gemm_tile.cta_tile.k == gemm_tile.warp_tile.k,
+        "Split-K requires the warp tile to cover the K of the CTA tile");
+    cc->split(2, params.split_k_factor, false);
+    // [Mo, No, Kso, Ko, Mi, Ni, Ki]
+  }
+
   // Propagate tiling globally
   scheduler_utils::transformPropagateToAllFrom(cc, -1);
 
@@ -188,6 +412,16 @@ void scheduleMatmul(
   scheduler_utils::BoundedDirectionalTransformPropagator::bothWays(
       cc, -1, {acw_smem, bcw_smem}, {c});
 
+  // With split-K, the mma op produces the partial sums of a CTA, which are
+  //  then reduced across BIDz into cc.
+  TensorView* mma_tv = cc;
+  if (split_k) {
+    //  0   1   2   3   4    5    6  7  8  9  10 11
+    // [Mo No Kso Ko Mwo  Nwo Kw Mw Nw (Mi Ni Ki)]
+    mma_tv = cc->rFactor({-9, -6, -1});
+    mma_builder.accumulatorTv(mma_tv);
+  }
+
   // Schedule prolog:
   //   TODO: this section goes to a separate matmul util,
   //   and needs more configurability.
@@ -226,18 +460,22 @@ void scheduleMatmul(
   // CTA tile:
 
   // Swizzle block tiles:
-  c->swizzle(Swizzle2DType::ZShape, 0, 1, SwizzleMode::Loop);
+  for (auto output : epilogue_outputs) {
+    output->swizzle(Swizzle2DType::ZShape, 0, 1, SwizzleMode::Loop);
+  }
 
-  a->computeAt(c, 2);
-  b->computeAt(c, 2);
+  for (auto output : epilogue_outputs) {
+    a->computeAt(output, 2);
+    b->computeAt(output, 2);
+  }
 
   // Prolog:
-  a->computeAt(cc, 3);
-  b->computeAt(cc, 3);
+  a->computeAt(mma_tv, split_k ? 4 : 3);
+  b->computeAt(mma_tv, split_k ? 4 : 3);
 
   // Main Loop:
-  acr->computeAt(cc, -6);
-  bcr->computeAt(cc, -6);
+  acr->computeAt(mma_tv, -6);
+  bcr->computeAt(mma_tv, -6);
 
   // Add mma swizzle:
   //   TODO: this section goes to a separate matmul util,
@@ -266,6 +504,10 @@ void scheduleMatmul(
       scheduler_utils::BoundedDirectionalTransformPropagator::Options()
           .propagateParallelType());
 
+  if (split_k) {
+    mma_tv->applyMmaSwizzle(
+        mma_builder.operand(MmaOptions::Operand::Accumulator).build());
+  }
   cc->applyMmaSwizzle(
       mma_builder.operand(MmaOptions::Operand::Accumulator).build());
 
@@ -285,12 +527,30 @@ void scheduleMatmul(
   acr->axis(-1)->parallelize(ParallelType::Vectorize);
   bcr->axis(-1)->parallelize(ParallelType::Vectorize);
 
-  //  0   1  2  3    4   5  6  7  8  9  10
-  // [Mo No Ko Mwo  Nwo Kw Mw Nw (Mi Ni Ki)]
-  cc->axis(0)->parallelize(ParallelType::BIDx);
-  cc->axis(1)->parallelize(ParallelType::BIDy);
-  cc->axis(3)->parallelize(ParallelType::TIDz);
-  cc->axis(4)->parallelize(ParallelType::TIDy);
+  if (split_k) {
+    //  0   1   2   3   4    5    6  7  8  9  10 11
+    // [Mo No Kso Ko Mwo  Nwo Kw Mw Nw (Mi Ni Ki)]
+    mma_tv->axis(0)->parallelize(ParallelType::BIDx);
+    mma_tv->axis(1)->parallelize(ParallelType::BIDy);
+    mma_tv->axis(2)->parallelize(ParallelType::BIDz);
+    mma_tv->axis(4)->parallelize(ParallelType::TIDz);
+    mma_tv->axis(5)->parallelize(ParallelType::TIDy);
+
+    //  0   1   2    3   4   5  6  7  8
+    // [Mo No Kso Mwo Nwo Mw Nw (Mi Ni)]
+    cc->axis(0)->parallelize(ParallelType::BIDx);
+    cc->axis(1)->parallelize(ParallelType::BIDy);
+    cc->axis(2)->parallelize(ParallelType::BIDz);
+    cc->axis(3)->parallelize(ParallelType::TIDz);
+    cc->axis(4)->parallelize(ParallelType::TIDy);
+  } else {
+    //  0   1  2  3    4   5  6  7  8  9  10
+    // [Mo No Ko Mwo  Nwo Kw Mw Nw (Mi Ni Ki)]
+    cc->axis(0)->parallelize(ParallelType::BIDx);
+    cc->axis(1)->parallelize(ParallelType::BIDy);
+    cc->axis(3)->parallelize(ParallelType::TIDz);
+    cc->axis(4)->parallelize(ParallelType::TIDy);
+  }
 
   // Propagate mma output swizzle and parallelization down the DAG
   if (params.double_buffer_options.double_buffer_smem_write) {
@@ -299,7 +559,8 @@ void scheduleMatmul(
         "Invalid buffer stage config")
     if (params.double_buffer_options.smem_double_buffer_stage > 2) {
       TORCH_CHECK(
-          params.async_gmem_load_operands,
+          params.async_gmem_load_operands && a_cast == nullptr &&
+              b_cast == nullptr,
           "Circular buffer only supports async load");
     }
 
@@ -317,10 +578,186 @@ void scheduleMatmul(
   scheduler_utils::BoundedDirectionalTransformPropagator::forward(
       cc,
       -1,
-      {c},
+      epilogue_outputs,
       scheduler_utils::BoundedDirectionalTransformPropagator::Options()
           .propagateParallelType()
           .propagateToBoundary());
+
+  // Schedule the epilogue:
+  //   Other inputs are read as the outputs are written, and with a single
+  //   output the epilogue is computed element by element from the
+  //   accumulator. With multiple outputs, the epilogue tensors stay at the
+  //   CTA tile so they can be shared across the outputs.
+  // ------------------------------------------------------------------
+  for (auto output : epilogue_outputs) {
+    std::vector<TensorView*> output_inputs;
+    std::copy_if(
+        epilogue_inputs.begin(),
+        epilogue_inputs.end(),
+        std::back_inserter(output_inputs),
+        [&](TensorView* tv) {
+          return DependencyCheck::isDependencyOf(tv, output);
+        });
+    if (output_inputs.empty()) {
+      continue;
+    }
+    scheduler_utils::BoundedDirectionalTransformPropagator::backward(
+        output,
+        -1,
+        output_inputs,
+        scheduler_utils::BoundedDirectionalTransformPropagator::Options()
+            .propagateParallelType());
+    for (auto tv : output_inputs) {
+      tv->computeAt(output, -1);
+    }
+  }
+
+  if (epilogue_outputs.size() == 1 && epilogue_outputs.front() != c) {
+    c->computeAt(epilogue_outputs.front(), -1);
+  }
+}
+
+std::string getMatmulCompileTimeRejectReason(Fusion* fusion) {
+  MatmulPattern pattern;
+  return findMatmulPattern(fusion, pattern);
+}
+
+std::string getMatmulRunTimeRejectReason(
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info) {
+  if (getMatmulMacro() == MmaOptions::MacroType::NoMMA) {
+    return "no mma support on device";
+  }
+
+  MatmulPattern pattern;
+  auto reason = findMatmulPattern(fusion, pattern);
+  TORCH_INTERNAL_ASSERT(reason.empty(), reason);
+
+  // Operands are stored to shared memory with vectorized stores
+  for (auto operand : {pattern.a, pattern.b}) {
+    if (getPrologueCast(operand) == nullptr) {
+      if (runtime_info.getInnerDimVectorizableWidth(operand) <
+          kOperandVectorWidth) {
+        return "operands need to be vectorizable";
+      }
+      continue;
+    }
+    auto inner_extent = runtime_info.expressionEvaluator().evaluate(
+        operand->getMaybeRFactorDomain().back()->extent());
+    if (!inner_extent.has_value() ||
+        inner_extent.value() % kOperandVectorWidth != 0) {
+      return "operands need to be vectorizable";
+    }
+  }
+  return "";
+}
+
+std::shared_ptr<MatmulParam> getMatmulHeuristics(
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    HeuristicSummary* data_cache) {
+  FUSER_PERF_SCOPE("getMatmulHeuristics");
+  MatmulPattern pattern;
+  auto reason = findMatmulPattern(fusion, pattern);
+  TORCH_INTERNAL_ASSERT(reason.empty(), reason);
+
+  // Problem size, from the root domain of the mma output
+  int64_t m = 1, n = 1, k = 1;
+  auto& expr_eval = runtime_info.expressionEvaluator();
+  const auto& root_domain = pattern.c->getRootDomain();
+  for (auto i : c10::irange(root_domain.size())) {
+    auto id = root_domain.at(i);
+    auto extent = expr_eval.evaluate(id->extent());
+    TORCH_INTERNAL_ASSERT(
+        extent.has_value(), "Could not evaluate matmul extent ", id);
+    if (id->isReduction()) {
+      k = extent.value();
+    } else if (
+        (pattern.layout == MmaOptions::MmaInputLayout::NT && i == 1) ||
+        (pattern.layout != MmaOptions::MmaInputLayout::NT && i == 0)) {
+      m = extent.value();
+    } else {
+      n = extent.value();
+    }
+  }
+
+  const auto properties = at::cuda::getCurrentDeviceProperties();
+  const auto macro = getMatmulMacro();
+
+  // Large CTA tiles reuse the operands the most, smaller ones are used
+  //  when the large ones would leave SMs idle
+  MatMulTileOptions gemm_tile;
+  if (ceilDiv(m, 128) * ceilDiv(n, 128) >=
+      (int64_t)properties->multiProcessorCount) {
+    gemm_tile.cta_tile = GemmTile(128, 128, 32);
+    gemm_tile.warp_tile = GemmTile(64, 64, 32);
+  } else {
+    gemm_tile.cta_tile = GemmTile(64, 64, 32);
+    gemm_tile.warp_tile = GemmTile(32, 32, 32);
+  }
+  gemm_tile.instruction_tile =
+      isVolta(macro) ? GemmTile(16, 16, 4) : GemmTile(16, 8, 16);
+
+  auto params = std::make_shared<MatmulParam>(
+      MmaBuilder(macro, gemm_tile).layout(pattern.layout));
+  params->tile_sizes = gemm_tile;
+  params->tag = "Matmul heuristics";
+
+  // Spread the K loop over more CTAs when the output tiles can't fill the
+  //  SMs, see Note [Matmul Split-K]
+  const int64_t num_tiles =
+      ceilDiv(m, gemm_tile.cta_tile.m) * ceilDiv(n, gemm_tile.cta_tile.n);
+  const int64_t k_tiles = ceilDiv(k, (int64_t)gemm_tile.cta_tile.k);
+  const int64_t split_k_factor = std::min(
+      {(int64_t)properties->multiProcessorCount / num_tiles,
+       k_tiles / kMinKTilesPerSplit,
+       kMaxSplitKFactor});
+  if (split_k_factor > 1) {
+    params->split_k_factor = (int)split_k_factor;
+  }
+  const int64_t k_tiles_per_cta =
+      ceilDiv(k_tiles, (int64_t)params->split_k_factor);
+
+  if (isAmpere(macro)) {
+    // Pipeline the operand loads as deep as shared memory and K allow.
+    //  Operands with a prologue cast can't be loaded with cp.async, which
+    //  limits buffering to double buffering.
+    bool has_prologue_cast = getPrologueCast(pattern.a) != nullptr ||
+        getPrologueCast(pattern.b) != nullptr;
+    int64_t smem_per_stage =
+        (int64_t)(gemm_tile.cta_tile.m + gemm_tile.cta_tile.n) *
+        gemm_tile.cta_tile.k * (int64_t)dataTypeSize(DataType::Half);
+    int64_t stages = std::min(
+        {(int64_t)kMaxSmemBufferStages,
+         (int64_t)properties->sharedMemPerBlockOptin / smem_per_stage,
+         k_tiles_per_cta});
+    params->async_gmem_load_operands = true;
+    params->double_buffer_options.double_buffer_smem_write = true;
+    params->double_buffer_options.smem_double_buffer_stage =
+        has_prologue_cast ? 2 : std::max(stages, (int64_t)2);
+    params->double_buffer_options.double_buffer_smem_read = true;
+  } else if (isVolta(macro)) {
+    params->double_buffer_options.double_buffer_smem_read = true;
+  }
+
+  if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
+    std::cerr << "\n===== Matmul Stats ========\n"
+              << "M: " << m << " N: " << n << " K: " << k << "\n"
+              << params->toString() << std::endl;
+  }
+  return params;
+}
+
+void scheduleMatmul(Fusion* fusion, const MatmulParam& params) {
+  FUSER_PERF_SCOPE("scheduleMatmul");
+  FusionGuard fg(fusion);
+  MatmulPattern pattern;
+  auto reason = findMatmulPattern(fusion, pattern);
+  TORCH_INTERNAL_ASSERT(reason.empty(), reason);
+
+  // The mma builder records the accumulator while scheduling
+  MatmulParam scheduling_params = params;
+  scheduleMatmul(pattern.c, pattern.a, pattern.b, scheduling_params);
 }
 
 } // namespace cuda
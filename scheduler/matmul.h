@@ -2,16 +2,23 @@
 
 #include <ATen/core/ivalue.h>
 
+#include <c10/util/hash.h>
 #include <third_party/nvfuser/fusion.h>
 #include <third_party/nvfuser/mma_type.h>
+#include <third_party/nvfuser/scheduler/heuristic.h>
+
+#include <sstream>
 
 namespace torch {
 namespace jit {
 namespace fuser {
 namespace cuda {
 
+class SchedulerRuntimeInfo;
+class HeuristicSummary;
+
 //! Starting point for a matmul scheduler parameters:
-class MatmulParam {
+class MatmulParam : public HeuristicParams {
  public:
   MatmulParam(MmaBuilder builder) : mma_builder(builder) {}
 
@@ -33,22 +40,165 @@ class MatmulParam {
 
   //! Specify which tensor we double buffer.
   DoubleBufferOptions double_buffer_options;
+
+  //! Number of CTAs along BIDz sharing the K loop of each output tile, see
+  //!  Note [Matmul Split-K]. 1 disables split-K.
+  int split_k_factor = 1;
+
+  bool sameAs(
+      const std::shared_ptr<HeuristicParams>& other_base) const override {
+    auto other_casted = std::dynamic_pointer_cast<MatmulParam>(other_base);
+    if (other_casted == nullptr) {
+      return false;
+    }
+    const MatmulParam& other = *other_casted;
+    return other.async_gmem_load_operands == async_gmem_load_operands &&
+        other.tile_sizes == tile_sizes &&
+        other.mma_builder.macro() == mma_builder.macro() &&
+        other.mma_builder.operandLayout() == mma_builder.operandLayout() &&
+        other.double_buffer_options.double_buffer_smem_write ==
+        double_buffer_options.double_buffer_smem_write &&
+        other.double_buffer_options.double_buffer_smem_read ==
+        double_buffer_options.double_buffer_smem_read &&
+        other.double_buffer_options.smem_double_buffer_stage ==
+        double_buffer_options.smem_double_buffer_stage &&
+        other.split_k_factor == split_k_factor;
+  }
+
+  std::string toString() const override {
+    std::stringstream ss;
+    ss << "\n===== Matmul Parameters ========\n"
+       << (tag == "" ? "" : "Tag: ") << tag << "\n"
+       << "MMA macro: " << cuda::toString(mma_builder.macro()) << "\n"
+       << "Operand layout: " << cuda::toString(mma_builder.operandLayout())
+       << "\n"
+       << "CTA tile: " << tileToString(tile_sizes.cta_tile) << "\n"
+       << "Warp tile: " << tileToString(tile_sizes.warp_tile) << "\n"
+       << "Instruction tile: " << tileToString(tile_sizes.instruction_tile)
+       << "\n";
+    if (async_gmem_load_operands) {
+      ss << "Async gmem load of operands\n";
+    }
+    if (double_buffer_options.double_buffer_smem_write) {
+      ss << "Smem write buffer stages: "
+         << double_buffer_options.smem_double_buffer_stage << "\n";
+    }
+    if (double_buffer_options.double_buffer_smem_read) {
+      ss << "Double buffered smem read\n";
+    }
+    if (split_k_factor > 1) {
+      ss << "Split-K factor: " << split_k_factor << "\n";
+    }
+    ss << "====================================\n";
+    return ss.str();
+  }
+
+  size_t hash() const override {
+    size_t attr_hash = c10::get_hash(
+        (int)mma_builder.macro(),
+        (int)mma_builder.operandLayout(),
+        async_gmem_load_operands,
+        double_buffer_options.double_buffer_smem_write,
+        double_buffer_options.double_buffer_smem_read,
+        double_buffer_options.smem_double_buffer_stage,
+        split_k_factor);
+    for (const auto& tile :
+         {tile_sizes.cta_tile,
+          tile_sizes.warp_tile,
+          tile_sizes.instruction_tile}) {
+      attr_hash = c10::hash_combine(
+          attr_hash, c10::get_hash(tile.m, tile.n, tile.k));
+    }
+    return attr_hash;
+  }
+
+  std::shared_ptr<HeuristicParams> clone() const override {
+    return std::make_shared<MatmulParam>(*this);
+  }
+
+ private:
+  static std::string tileToString(const GemmTile& tile) {
+    std::stringstream ss;
+    ss << tile.m << ", " << tile.n << ", " << tile.k;
+    return ss.str();
+  }
 };
 
-//! Prototype auto scheduling function.
-//!  Currently only support a pure matmul with no
-//!   fused prolog or epilog.
-//!
-//! TODO:
-//!   - will support a range of fusions in a follow up
-//!   - will formalize scheduling decisions into
-//! matmul params data structure.
+//! Schedule c = a x b, where a and b are fusion inputs, along with the
+//!  prologue and epilogue described in Note [Matmul Scheduler].
 TORCH_CUDA_CU_API void scheduleMatmul(
     TensorView* c_tv,
     TensorView* a_tv,
     TensorView* b_tv,
     MatmulParam& params);
 
+//! Note [Matmul Scheduler]
+//!
+//! The Matmul heuristic takes fusions made of a single 2D MmaOp, i.e.
+//!  fusedMultiplySum of two broadcast Half operands, together with
+//!   - a prologue on each operand, which is a fusion input, optionally cast
+//!     to Half before it's broadcast. The cast is done in registers before
+//!     the operand is stored to shared memory, so cp.async is only used for
+//!     operands without a cast.
+//!   - a pointwise epilogue on the mma output, e.g. bias, gelu, residual add
+//!     and casts. Other fusion inputs can be broadcast into the epilogue.
+//!     All the fusion outputs are part of the epilogue.
+//!
+//! The epilogue is computed from the accumulator registers, so the mma
+//!  output doesn't round trip through global memory as it would if the
+//!  epilogue were segmented into a pointwise kernel.
+
+//! Note [Matmul Split-K]
+//!
+//! With small M and N there are too few output tiles to fill the SMs, e.g.
+//!  inference GEMMs with a small batch and a large hidden size. Split-K
+//!  splits the K tiles into split_k_factor contiguous chunks, each reduced
+//!  by its own CTA along BIDz:
+//!    [Mo, No, Ko, ...] -> [Mo, No, Kso, Ko/Kso, ...]
+//!  The mma output is rFactored over everything but Kso, so each CTA
+//!  accumulates its chunk in registers as usual, and the partial tiles are
+//!  summed by a grid reduction across BIDz. The epilogue then runs on the
+//!  last CTA along BIDz of each output tile.
+//!
+//! Requires the warp tile to cover the K of the CTA tile, i.e. no K split
+//!  across warps.
+//!
+//! Stream-K is not implemented, and remains open. Split-K gives every output
+//!  tile the same number of CTAs, so when the tile count doesn't divide the
+//!  SM count the last wave still leaves SMs idle. Stream-K balances this by
+//!  launching a persistent grid where each CTA walks a contiguous range of
+//!  the linearized (tile, K tile) iteration space, and CTAs that end
+//!  mid-tile fix up the partial tile through a global workspace. The
+//!  loop-nest IR has no way to express either part:
+//!  - a persistent loop whose iterations map to (tile, K range) pairs that
+//!    differ per CTA, rather than loops bound to BIDx/BIDy/BIDz;
+//!  - a fixup that reduces partial tiles from a varying number of CTAs,
+//!    ordered by flags or semaphores instead of a fixed grid reduction.
+
+//! Returns the reason the Matmul heuristic can't take fusion, or an empty
+//!  string if it can
+TORCH_CUDA_CU_API std::string getMatmulCompileTimeRejectReason(
+    Fusion* fusion);
+
+//! Returns the reason the Matmul heuristic can't take fusion with the given
+//!  inputs on the current device, or an empty string if it can
+TORCH_CUDA_CU_API std::string getMatmulRunTimeRejectReason(
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info);
+
+//! Picks the mma macro for the current device, and the tile sizes and
+//!  pipelining stages for the problem size
+TORCH_CUDA_CU_API std::shared_ptr<MatmulParam> getMatmulHeuristics(
+    Fusion* fusion,
+    SchedulerRuntimeInfo& runtime_info,
+    HeuristicSummary* data_cache = nullptr);
+
+//! Schedule a fusion accepted by getMatmulCompileTimeRejectReason, see
+//!  Note [Matmul Scheduler]
+TORCH_CUDA_CU_API void scheduleMatmul(
+    Fusion* fusion,
+    const MatmulParam& params);
+
 } // namespace cuda
 } // namespace fuser
 } // namespace jit
@@ -20,6 +20,144 @@ namespace cuda {
 
 namespace {
 
+// Shared memory a persistent kernel needs besides its persistent buffers,
+//  enough for a block wide welford on doubles (avg, var and N)
+int64_t reservedSharedMemory() {
+  const auto properties = at::cuda::getCurrentDeviceProperties();
+  return 3 * (int64_t)sizeof(double) * (int64_t)properties->maxThreadsPerBlock;
+}
+
+// Registers a persistent kernel uses per thread besides its persistent
+//  buffers, e.g. for indexing, reduction partials and loop counters
+constexpr int64_t kPersistentKernelRegisterOverhead = 32;
+// The compiler never assigns more registers than this to a thread
+constexpr int64_t kMaxRegistersPerThread = 255;
+// Registers are assigned to threads in multiples of this
+constexpr int64_t kRegisterAllocationUnit = 8;
+constexpr int64_t kBytesPerRegister = 4;
+
+int64_t roundUpRegisters(int64_t registers) {
+  return ceilDiv(registers, kRegisterAllocationUnit) * kRegisterAllocationUnit;
+}
+
+//! Estimated residency of a block persistent kernel, one reduction per
+//!  block
+struct PersistenceOccupancy {
+  //! Threads resident per SM, 0 if the kernel can't be launched
+  int64_t resident_threads = 0;
+  //! Bytes of persistent buffers each thread spills to local memory
+  int64_t spilled_bytes = 0;
+};
+
+// Threads of a block working on one reduction. Like the heuristics, each
+//  thread keeps a few elements per buffer to amortize the block reduction,
+//  and larger reductions are spread over up to a full block.
+int64_t persistentThreadsPerBlock(int64_t total_reduction_numel) {
+  constexpr int64_t kMinElementsPerThread = 8;
+  const auto properties = at::cuda::getCurrentDeviceProperties();
+  const int64_t warp_size = (int64_t)properties->warpSize;
+  const int64_t min_threads = ceilDiv(
+      std::max(total_reduction_numel, (int64_t)1), kMinElementsPerThread);
+  const int64_t warps = ceilDiv(min_threads, warp_size);
+  return std::min((int64_t)properties->maxThreadsPerBlock, warps * warp_size);
+}
+
+PersistenceOccupancy registerPersistenceOccupancy(
+    int64_t total_reduction_numel,
+    int64_t persistent_buffer_size) {
+  const auto properties = at::cuda::getCurrentDeviceProperties();
+  const int64_t threads = persistentThreadsPerBlock(total_reduction_numel);
+
+  // Registers a thread can get while the whole block is still launchable
+  const int64_t max_registers = std::min(
+      kMaxRegistersPerThread,
+      (int64_t)properties->regsPerBlock / threads / kRegisterAllocationUnit *
+          kRegisterAllocationUnit);
+  const int64_t needed_registers =
+      ceilDiv(persistent_buffer_size, threads * kBytesPerRegister) +
+      kPersistentKernelRegisterOverhead;
+  const int64_t registers =
+      std::min(roundUpRegisters(needed_registers), max_registers);
+
+  PersistenceOccupancy occupancy;
+  occupancy.spilled_bytes =
+      std::max(needed_registers - max_registers, (int64_t)0) *
+      kBytesPerRegister;
+  const int64_t blocks = std::min(
+      (int64_t)properties->regsPerMultiprocessor / (registers * threads),
+      (int64_t)properties->maxThreadsPerMultiProcessor / threads);
+  occupancy.resident_threads = blocks * threads;
+  return occupancy;
+}
+
+PersistenceOccupancy sharedMemoryPersistenceOccupancy(
+    int64_t total_reduction_numel,
+    int64_t persistent_buffer_size) {
+  PersistenceOccupancy occupancy;
+  if (persistent_buffer_size > sharedMemoryPersistentBufferLimit()) {
+    return occupancy;
+  }
+
+  const auto properties = at::cuda::getCurrentDeviceProperties();
+#ifndef USE_ROCM
+  const int64_t smem_per_sm = (int64_t)properties->sharedMemPerMultiprocessor;
+#else
+  const int64_t smem_per_sm = (int64_t)properties->sharedMemPerBlock;
+#endif
+  const int64_t threads = persistentThreadsPerBlock(total_reduction_numel);
+  const int64_t registers =
+      roundUpRegisters(kPersistentKernelRegisterOverhead);
+
+  const int64_t blocks = std::min(
+      {smem_per_sm / (persistent_buffer_size + reservedSharedMemory()),
+       (int64_t)properties->regsPerMultiprocessor / (registers * threads),
+       (int64_t)properties->maxThreadsPerMultiProcessor / threads});
+  occupancy.resident_threads = blocks * threads;
+  return occupancy;
+}
+
+} // namespace
+
+int64_t sharedMemoryPersistentBufferLimit() {
+  const auto properties = at::cuda::getCurrentDeviceProperties();
+#ifndef USE_ROCM
+  const int64_t smem_per_block = (int64_t)properties->sharedMemPerBlockOptin;
+#else
+  const int64_t smem_per_block = (int64_t)properties->sharedMemPerBlock;
+#endif
+  return std::max(smem_per_block - reservedSharedMemory(), (int64_t)0);
+}
+
+bool useSharedMemoryPersistence(
+    int64_t total_reduction_numel,
+    int64_t persistent_buffer_size) {
+  if (isOptionDisabled(DisableOption::SmemPersistence)) {
+    return false;
+  }
+
+  const auto smem_occupancy = sharedMemoryPersistenceOccupancy(
+      total_reduction_numel, persistent_buffer_size);
+  if (smem_occupancy.resident_threads == 0) {
+    return false;
+  }
+
+  // Register persistence is rejected beyond the register file budget
+  if (persistent_buffer_size > scheduler_utils::register_file_size) {
+    return true;
+  }
+
+  // Spilled buffers round trip through local memory, which is slower than
+  //  shared memory. Otherwise registers are preferred unless shared memory
+  //  keeps more threads resident, as shared memory persistence adds smem
+  //  traffic.
+  const auto register_occupancy = registerPersistenceOccupancy(
+      total_reduction_numel, persistent_buffer_size);
+  return register_occupancy.spilled_bytes > 0 ||
+      smem_occupancy.resident_threads > register_occupancy.resident_threads;
+}
+
+namespace {
+
 // round up to multiple of 8 or pow2 whichever smaller
 int64_t roundUpPow2Or8(const int64_t x) {
   auto round_up_pow2 = scheduler_utils::lastPow2(x);
@@ -40,7 +178,8 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
     const int64_t n_tensor_inputs,
     const int64_t max_input_dtype_size,
     const int64_t max_persistent_buffer_size,
-    const size_t vectorize_factor) {
+    const size_t vectorize_factor,
+    const bool shared_mem_persistence) {
   // Set some targets for parallelization
   const int64_t n_elems = total_reduction_numel * total_iteration_numel;
 
@@ -168,8 +307,11 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
 
   // Compute maximum number of reductions we could do in the same kernel based
   // on persistent buffer size
+  const int64_t persistent_buffer_budget = shared_mem_persistence
+      ? sharedMemoryPersistentBufferLimit()
+      : scheduler_utils::register_file_size;
   const int64_t max_multi_reduction_factor = scheduler_utils::safeDiv(
-      scheduler_utils::register_file_size, max_persistent_buffer_size);
+      persistent_buffer_budget, max_persistent_buffer_size);
 
   // To get to target threads:
   // Prioritize
@@ -462,6 +604,8 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
       bdimy,
       LaunchParams::UNINITIALIZED_VAL);
 
+  rparams->shared_mem_persistent_buffer = shared_mem_persistence;
+
   rparams->tag = "Inner Persistent Heuristic.\n";
 
   if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
@@ -477,6 +621,7 @@ std::shared_ptr<ReductionParams> innerPersistentHeuristic(
               << "\n"
               << "max_multi_reduction_factor: " << max_multi_reduction_factor
               << "\n"
+              << "shared_mem_persistence: " << shared_mem_persistence << "\n"
               << "block(" << (pad_bdimx ? padded_bdimx : bdimx) << ", " << bdimy
               << ", " << bdimz << ")";
     std::cerr << rparams->toString() << std::endl;
@@ -494,7 +639,8 @@ std::shared_ptr<ReductionParams> outerPersistentHeuristic(
     const int64_t n_tensor_inputs,
     const int64_t max_input_dtype_size,
     const int64_t max_persistent_buffer_size,
-    const size_t vectorize_factor) {
+    const size_t vectorize_factor,
+    const bool shared_mem_persistence) {
   // Set some targets for parallelization
   const int64_t n_elems = total_reduction_numel * total_iteration_numel;
 
@@ -556,9 +702,11 @@ std::shared_ptr<ReductionParams> outerPersistentHeuristic(
   // Compute maximum number of reductions we could do in the same kernel based
   // on persistent buffer size
 
+  const int64_t persistent_buffer_budget = shared_mem_persistence
+      ? sharedMemoryPersistentBufferLimit()
+      : scheduler_utils::register_file_size;
   const int64_t max_multi_reduction_factor = std::max(
-      scheduler_utils::register_file_size / max_persistent_buffer_size,
-      (int64_t)1);
+      persistent_buffer_budget / max_persistent_buffer_size, (int64_t)1);
 
   // To get to target threads:
   // Prioritize
@@ -684,8 +832,10 @@ std::shared_ptr<ReductionParams> outerPersistentHeuristic(
   }
 
   // If we're close to the limit on the register file size, drop down block dim
-  // x so we don't throw an error when we try to launch the kernel.
-  while (bdimy * bdimx * inner_reduction_unroll_factor * batches_per_block *
+  // x so we don't throw an error when we try to launch the kernel. Shared
+  // memory buffers are already bounded by max_multi_reduction_factor.
+  while (!shared_mem_persistence &&
+         bdimy * bdimx * inner_reduction_unroll_factor * batches_per_block *
              max_input_dtype_size * 4 >
          scheduler_utils::register_file_size * 3) {
     if (bdimx == 1) {
@@ -736,6 +886,8 @@ std::shared_ptr<ReductionParams> outerPersistentHeuristic(
       LaunchParams::UNINITIALIZED_VAL,
       LaunchParams::UNINITIALIZED_VAL);
 
+  rparams->shared_mem_persistent_buffer = shared_mem_persistence;
+
   rparams->tag = "Outer persistent kernel heuristic.\n";
 
   if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
@@ -749,6 +901,7 @@ std::shared_ptr<ReductionParams> outerPersistentHeuristic(
               << "\n"
               << "max_multi_reduction_factor: " << max_multi_reduction_factor
               << "\n"
+              << "shared_mem_persistence: " << shared_mem_persistence << "\n"
               << "block(" << bdimx << ", " << bdimy << ", 1)" << std::endl;
     std::cerr << rparams->toString() << std::endl;
   }
@@ -756,8 +909,215 @@ std::shared_ptr<ReductionParams> outerPersistentHeuristic(
   return rparams;
 }
 
+// Threads per block of grid persistent kernels
+constexpr int64_t kGridPersistentThreadsPerBlock = 256;
+
+// Launch configuration of an outer persistent kernel splitting its
+// reductions across a cooperative grid
+struct GridPersistenceConfig {
+  // Threads and blocks over the iteration domain
+  int64_t bdimx = 1;
+  int64_t gdimx = 1;
+  // Threads and blocks over the reduction domain
+  int64_t bdimy = 1;
+  int64_t gdimy = 1;
+  // Reduction elements each thread keeps persistent
+  int64_t batches_per_block = 1;
+};
+
+// See Note [Grid Persistent Normalization]. Returns nullopt if the blocks
+// needed to hold the persistent buffers can't all be resident at once.
+c10::optional<GridPersistenceConfig> getGridPersistenceConfig(
+    const int64_t total_reduction_numel,
+    const int64_t total_iteration_numel,
+    const int64_t persistent_buffer_size) {
+  // WARNING: Current device for codegen may not be the target device
+  const auto properties = at::cuda::getCurrentDeviceProperties();
+  const int64_t device_multiprocessor_count =
+      (int64_t)properties->multiProcessorCount;
+  const int64_t device_max_threads_per_multiprocessor =
+      (int64_t)properties->maxThreadsPerMultiProcessor;
+  const int64_t warp_size = (int64_t)properties->warpSize;
+
+  GridPersistenceConfig config;
+
+  // At most a warp over the iteration domain keeps reads of each row of the
+  // reduction coalesced, the rest of the block goes into the reduction
+  config.bdimx = std::min(roundUpPow2Or8(total_iteration_numel), warp_size);
+  config.gdimx = ceilDiv(total_iteration_numel, config.bdimx);
+  config.bdimy = std::max(
+      kGridPersistentThreadsPerBlock / config.bdimx, (int64_t)1);
+
+  // Target half the threads of an SM, so each thread has twice the registers
+  // of its share of the persistent budget
+  const int64_t blocks_per_sm = std::max(
+      device_max_threads_per_multiprocessor /
+          (2 * config.bdimx * config.bdimy),
+      (int64_t)1);
+  const int64_t block_buffer_budget =
+      scheduler_utils::register_file_size / blocks_per_sm;
+
+  // Split the reduction finely enough for each block's slice of the buffers
+  // to fit, and to fill at least a wave of SMs
+  const int64_t max_gdimy = std::min(
+      ceilDiv(total_reduction_numel, config.bdimy),
+      scheduler_utils::y_grid_limit);
+  const int64_t min_gdimy =
+      ceilDiv(persistent_buffer_size * config.bdimx, block_buffer_budget);
+  config.gdimy = std::max(
+      std::min(
+          std::max(
+              ceilDiv(device_multiprocessor_count, config.gdimx), (int64_t)2),
+          max_gdimy),
+      min_gdimy);
+
+  if (config.gdimy < 2 || config.gdimy > max_gdimy ||
+      config.gdimx * config.gdimy >
+          blocks_per_sm * device_multiprocessor_count) {
+    return c10::nullopt;
+  }
+
+  config.batches_per_block =
+      ceilDiv(total_reduction_numel, config.gdimy * config.bdimy);
+  config.bdimy = ceilDiv(
+      ceilDiv(total_reduction_numel, config.gdimy), config.batches_per_block);
+  return config;
+}
+
+std::shared_ptr<ReductionParams> outerGridPersistentHeuristic(
+    const int64_t total_reduction_numel,
+    const int64_t total_iteration_numel,
+    const int64_t max_persistent_buffer_size) {
+  auto config = getGridPersistenceConfig(
+      total_reduction_numel, total_iteration_numel, max_persistent_buffer_size);
+  TORCH_INTERNAL_ASSERT(
+      config.has_value(), "Error generating grid persistent kernel.");
+
+  auto rparams = std::make_shared<ReductionParams>();
+  rparams->batches_per_block_inner_reduction = config->batches_per_block;
+  rparams->persistent_kernel = true;
+
+  rparams->fastest_dim = false;
+  rparams->cross_block_inner_reduction = true;
+  rparams->cross_grid_inner_reduction = true;
+  rparams->split_grid_dim_inner_reduction = true;
+  rparams->grid_dim_inner_reduction = ParallelType::BIDy;
+  rparams->multiple_reds_per_blk = config->bdimx > 1;
+
+  if (rparams->multiple_reds_per_blk) {
+    rparams->block_dim_iter_dom = ParallelType::TIDx;
+    rparams->block_dim_inner_reduction = ParallelType::TIDy;
+  } else {
+    rparams->block_dim_inner_reduction = ParallelType::TIDx;
+  }
+
+  rparams->grid_dim_iter_dom = ParallelType::BIDx;
+  rparams->split_grid_dim_iter_dom =
+      config->gdimx > scheduler_utils::x_grid_limit;
+
+  rparams->unroll_factor_inner_reduction = 1;
+
+  rparams->lparams = LaunchParams(
+      LaunchParams::UNINITIALIZED_VAL,
+      config->gdimy,
+      LaunchParams::UNINITIALIZED_VAL,
+      rparams->multiple_reds_per_blk ? config->bdimx : config->bdimy,
+      LaunchParams::UNINITIALIZED_VAL,
+      LaunchParams::UNINITIALIZED_VAL);
+
+  rparams->tag = "Outer grid persistent kernel heuristic.\n";
+
+  if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
+    std::cerr << "\n===== Reduction Stats ========\n"
+              << "total_reduction_numel: " << total_reduction_numel << "\n"
+              << "total_iteration_numel: " << total_iteration_numel << "\n"
+              << "max_persistent_buffer_size: " << max_persistent_buffer_size
+              << "\n"
+              << "grid(" << config->gdimx << ", " << config->gdimy << ", 1)\n"
+              << "block(" << config->bdimx << ", " << config->bdimy << ", 1)"
+              << std::endl;
+    std::cerr << rparams->toString() << std::endl;
+  }
+
+  return rparams;
+}
+
 } // namespace
 
+std::string blockPersistenceRejectReason(
+    const bool fastest_dim_reduction,
+    const int64_t total_reduction_numel,
+    const int64_t total_iteration_numel,
+    const int64_t persistent_buffer_size) {
+  // See Note [Shared Memory Persistence]
+  const bool shared_mem_persistence = useSharedMemoryPersistence(
+      total_reduction_numel, persistent_buffer_size);
+
+  if (!shared_mem_persistence &&
+      persistent_buffer_size > scheduler_utils::register_file_size) {
+    return "not enough registers or shared memory for persistence";
+  }
+
+  // If there's a small iteration dimension but a large reduction dimension it
+  // may not make sense to make a persistent kernel
+  const int64_t device_max_threads_per_multiprocessor =
+      (int64_t)at::cuda::getCurrentDeviceProperties()
+          ->maxThreadsPerMultiProcessor;
+
+  const int64_t device_multiprocessor_count =
+      (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
+
+  const int64_t warp_size = at::cuda::warp_size();
+
+  // Maximum number of iteration dimensions we can have and still be
+  // persistent.
+  const int64_t persistent_buffer_budget = shared_mem_persistence
+      ? sharedMemoryPersistentBufferLimit()
+      : scheduler_utils::register_file_size;
+  const int64_t max_multi_reduction_factor = std::max(
+      persistent_buffer_budget / persistent_buffer_size, (int64_t)1);
+
+  // If outer reduction, and we have few iteration numel but large reduction
+  // numel, don't generate a block persistent kernel, see
+  // Note [Grid Persistent Normalization]
+  if (
+      // Don't go persistent if we can't fit half a warp on an SM
+      (!fastest_dim_reduction &&
+       max_multi_reduction_factor < warp_size / 2) ||
+      ( // Don't go persistent if we can't use a small fraction of the
+        // available SMs yet have a large reduction size
+          total_iteration_numel <
+              (fastest_dim_reduction
+                   ? std::max(device_multiprocessor_count / 8, (int64_t)1)
+                   // Make sure we at least use a quarter of the device * a
+                   // half warp
+                   : (warp_size / 8) * device_multiprocessor_count) &&
+          // Reduction count is larger than max thread count * 4
+          total_reduction_numel >= device_max_threads_per_multiprocessor * 4)) {
+    return "unsupported cross grid persistence";
+  }
+
+  return "";
+}
+
+bool useGridPersistence(
+    const bool fastest_dim_reduction,
+    const int64_t total_reduction_numel,
+    const int64_t total_iteration_numel,
+    const int64_t persistent_buffer_size) {
+  return !fastest_dim_reduction &&
+      !isOptionDisabled(DisableOption::GridPersistence) &&
+      !blockPersistenceRejectReason(
+           fastest_dim_reduction,
+           total_reduction_numel,
+           total_iteration_numel,
+           persistent_buffer_size)
+           .empty() &&
+      getGridPersistenceConfig(
+          total_reduction_numel, total_iteration_numel, persistent_buffer_size)
+          .has_value();
+}
+
 std::shared_ptr<ReductionParams> persistentHeuristic(
     const int64_t total_reduction_numel,
     const int64_t total_iteration_numel,
@@ -767,7 +1127,8 @@ std::shared_ptr<ReductionParams> persistentHeuristic(
     const size_t max_input_dtype_size,
     const int64_t max_persistent_buffer_size,
     size_t vectorize_factor,
-    bool project_persistent_buffers) {
+    bool project_persistent_buffers,
+    bool shared_mem_persistence) {
   std::shared_ptr<ReductionParams> rparams;
   if (fastest_dim_reduction) {
     rparams = innerPersistentHeuristic(
@@ -777,7 +1138,8 @@ std::shared_ptr<ReductionParams> persistentHeuristic(
         n_tensor_inputs,
         max_input_dtype_size,
         max_persistent_buffer_size,
-        vectorize_factor);
+        vectorize_factor,
+        shared_mem_persistence);
   } else {
     rparams = outerPersistentHeuristic(
         total_reduction_numel,
@@ -785,7 +1147,8 @@ std::shared_ptr<ReductionParams> persistentHeuristic(
         n_tensor_inputs,
         max_input_dtype_size,
         max_persistent_buffer_size,
-        vectorize_factor);
+        vectorize_factor,
+        shared_mem_persistence);
   }
   rparams->project_persistent_buffers = project_persistent_buffers;
   return rparams;
@@ -934,6 +1297,20 @@ TORCH_CUDA_CU_API std::shared_ptr<ReductionParams> getPersistentHeuristics(
     n_tensor_inputs++;
   }
 
+  // See Note [Grid Persistent Normalization]
+  if (useGridPersistence(
+          properties.fastest_dim_reduction,
+          properties.total_reduction_numel,
+          properties.total_iteration_numel,
+          max_persistent_size)) {
+    auto rparams = outerGridPersistentHeuristic(
+        properties.total_reduction_numel,
+        properties.total_iteration_numel,
+        max_persistent_size);
+    rparams->project_persistent_buffers = project_persistent_buffers;
+    return rparams;
+  }
+
   return persistentHeuristic(
       properties.total_reduction_numel,
       properties.total_iteration_numel,
@@ -943,7 +1320,9 @@ TORCH_CUDA_CU_API std::shared_ptr<ReductionParams> getPersistentHeuristics(
       max_dtype_size,
       max_persistent_size,
       vectorize_factor,
-      project_persistent_buffers);
+      project_persistent_buffers,
+      useSharedMemoryPersistence(
+          properties.total_reduction_numel, max_persistent_size));
 }
 
 TORCH_CUDA_CU_API std::shared_ptr<ReductionParams> getPersistentHeuristics(
@@ -988,6 +1367,16 @@ TORCH_CUDA_CU_API void schedulePersistentKernel(
 
   auto persistent_info = scheduler_utils::persistentBuffers(fusion);
 
+  // Stage the persistent buffers in shared memory, see
+  // Note [Shared Memory Persistence]. Their producers are computed in
+  // registers as before and inlined into the shared memory copies.
+  if (rparams.shared_mem_persistent_buffer) {
+    for (auto buffer : persistent_info.persistent_buffers) {
+      auto smem_buffer = buffer->cacheAfter();
+      smem_buffer->setMemoryType(MemoryType::Shared);
+    }
+  }
+
   auto reduction_tvs =
       scheduler_utils::getReductionTvs(fusion /*, ignore_trivial = true */);
 
@@ -18,6 +18,87 @@ namespace cuda {
 class SchedulerRuntimeInfo;
 class HeuristicSummary;
 
+//! Note [Shared Memory Persistence]
+//!
+//! Persistent kernels keep the persistent buffers of a normalization, e.g.
+//!  the input of a softmax, resident on chip between the reduction and its
+//!  consumers. By default the buffers are kept in registers, bounded by
+//!  scheduler_utils::register_file_size. Larger buffers, e.g. layer norms
+//!  with very large hidden sizes, used to be rejected and segmented into
+//!  kernels re-reading the input from global memory.
+//!
+//! Buffers can instead be placed in the shared memory a block can opt in
+//!  to. The scheduler caches each persistent buffer with cacheAfter into
+//!  MemoryType::Shared, and the heuristics size the rows per block against
+//!  the shared memory budget instead of the register file.
+//!
+//! The memory is chosen by estimating, for one reduction per block spread
+//!  over as many threads as possible, the threads resident per SM and the
+//!  registers spilled by either choice. Shared memory is used when the
+//!  buffers exceed the register budget or would spill, or when it keeps
+//!  more threads resident. Otherwise registers are preferred, as shared
+//!  memory persistence adds smem traffic.
+//!
+//! All persistent buffers of a kernel live in the same memory, since buffer
+//!  sizes are only known in aggregate and projection and input caching
+//!  change which tensors are persistent during scheduling.
+//!
+//! Each thread only accesses its own elements of the buffers, so no
+//!  synchronization is needed, and buffers with disjoint lifetimes alias each
+//!  other in lower_alias_memory.
+//!
+//! Can be disabled with PYTORCH_NVFUSER_DISABLE=smem_persistence.
+
+//! Bytes of persistent buffers a block can keep in shared memory, leaving
+//!  space for block reductions and broadcasts
+TORCH_CUDA_CU_API int64_t sharedMemoryPersistentBufferLimit();
+
+//! Whether persistent buffers needing persistent_buffer_size bytes per
+//!  reduction of total_reduction_numel elements are kept in shared memory
+TORCH_CUDA_CU_API bool useSharedMemoryPersistence(
+    int64_t total_reduction_numel,
+    int64_t persistent_buffer_size);
+
+//! Note [Grid Persistent Normalization]
+//!
+//! Outer normalizations with a huge reduction and a small iteration domain,
+//!  e.g. batch norms over N*H*W with few channels, can't keep each
+//!  reduction within a block: its persistent buffers don't fit on one SM,
+//!  and a block per channel would leave most of the device idle. Such
+//!  fusions used to be rejected and segmented into a reduction kernel and a
+//!  pointwise kernel re-reading the input.
+//!
+//! Instead, the reduction domain is split across gridDim.y blocks, so each
+//!  block only keeps its slice of the persistent buffers in registers. The
+//!  reduction is then a grid reduction immediately broadcast to its
+//!  consumers, which lowering turns into a grid allreduce (see
+//!  ParallelReduce in fused_reduction.cu), and the kernel is launched with
+//!  cuLaunchCooperativeKernel.
+//!
+//! A cooperative launch requires all blocks of the grid to be resident at
+//!  once. The heuristics target half the threads an SM can hold, giving
+//!  each block an equal share of scheduler_utils::register_file_size, and
+//!  only use this path when gridDim.x * gridDim.y blocks fit on the device.
+//!  The executor re-checks the occupancy of the compiled kernel at launch.
+//!
+//! Can be disabled with PYTORCH_NVFUSER_DISABLE=grid_persistence.
+
+//! Why a persistent kernel keeping each reduction within a block can't be
+//!  used, or an empty string if it can
+TORCH_CUDA_CU_API std::string blockPersistenceRejectReason(
+    bool fastest_dim_reduction,
+    int64_t total_reduction_numel,
+    int64_t total_iteration_numel,
+    int64_t persistent_buffer_size);
+
+//! Whether the reductions of an outer persistent kernel are split across a
+//!  cooperative grid, see Note [Grid Persistent Normalization]
+TORCH_CUDA_CU_API bool useGridPersistence(
+    bool fastest_dim_reduction,
+    int64_t total_reduction_numel,
+    int64_t total_iteration_numel,
+    int64_t persistent_buffer_size);
+
 TORCH_CUDA_CU_API std::shared_ptr<ReductionParams> getPersistentHeuristics(
     Fusion* fusion,
     const at::ArrayRef<c10::IValue>& runtime_inputs,
@@ -28,6 +28,13 @@ namespace {
 // Unused at the moment, commenting for clang tidy
 constexpr int64_t kThreadX = 128;
 
+// Parameters of Note [Pointwise Load Ring]. The ring pays off for fusions
+// with many inputs, and each block iterates over at most kMaxTilesPerBlock
+// tiles to keep enough blocks for the device.
+constexpr int64_t kMinLoadRingInputs = 4;
+constexpr int64_t kMaxLoadRingStages = 4;
+constexpr int64_t kMaxTilesPerBlock = 16;
+
 class DomainMap : public pointwise_utils::DomainMap {
  public:
   using pointwise_utils::DomainMap::DomainMap;
@@ -65,6 +72,33 @@ class DomainMap : public pointwise_utils::DomainMap {
   }
 };
 
+// Returns the vectorizable fusion inputs that can be loaded into the ring of
+// Note [Pointwise Load Ring] with the given vectorization factor
+std::vector<TensorView*> getLoadRingInputs(
+    const std::vector<TensorView*>& vectorizable_inputs_outputs,
+    int64_t vectorize_factor) {
+  std::vector<TensorView*> ring_inputs;
+  for (auto tv : vectorizable_inputs_outputs) {
+    if (!tv->isFusionInput() || tv->isFusionOutput()) {
+      continue;
+    }
+    const auto& root_domain = tv->getMaybeRFactorDomain();
+    if (std::any_of(
+            root_domain.begin(), root_domain.end(), [](IterDomain* id) {
+              return id->isBroadcast();
+            })) {
+      continue;
+    }
+    // cp.async copies 4, 8 or 16 bytes at a time
+    auto load_size =
+        vectorize_factor * (int64_t)dataTypeSize(tv->getDataType().value());
+    if (load_size == 4 || load_size == 8 || load_size == 16) {
+      ring_inputs.push_back(tv);
+    }
+  }
+  return ring_inputs;
+}
+
 } // namespace
 
 std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
@@ -402,6 +436,37 @@ std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
     params->split_grid_y_dim = true;
   }
 
+  // Stream the inputs of wide fusions through a ring of shared memory tiles
+  // on sm80+, see Note [Pointwise Load Ring]
+  if (break_point == 0 && params->vectorize &&
+      at::cuda::getCurrentDeviceProperties()->major >= 8 &&
+      !isOptionDisabled(DisableOption::CircularBufferLoads)) {
+    auto ring_inputs = getLoadRingInputs(
+        vectorizable_inputs_outputs, (int64_t)params->unroll_factor);
+    int64_t tile_size = 0;
+    for (auto tv : ring_inputs) {
+      tile_size += kThreadX * (int64_t)params->unroll_factor *
+          (int64_t)dataTypeSize(tv->getDataType().value());
+    }
+    const int64_t n_tiles =
+        ceilDiv(n_elems, kThreadX * (int64_t)params->unroll_factor);
+    // Keep enough blocks for a few waves on the device
+    const int64_t tiles_per_block = scheduler_utils::lastPow2(std::min(
+        kMaxTilesPerBlock,
+        std::max(n_tiles / (device_multiprocessor_count * 4), (int64_t)1)));
+    if ((int64_t)ring_inputs.size() >= kMinLoadRingInputs) {
+      const int64_t stages = std::min(
+          {kMaxLoadRingStages,
+           (int64_t)at::cuda::getCurrentDeviceProperties()->sharedMemPerBlock /
+               tile_size,
+           tiles_per_block});
+      if (stages > 1) {
+        params->circular_buffer_stages = stages;
+        params->tiles_per_block = tiles_per_block;
+      }
+    }
+  }
+
   if (isDebugDumpEnabled(DebugDumpOption::SchedulerDebug)) {
     std::cerr << "\n===== Pointwise Stats ========\n"
               << "num_elems: " << n_elems << "\n"
@@ -495,6 +560,27 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
       reference_tv != nullptr,
       "Could not find a fully broadcasted output to reference schedule on.");
 
+  // Copy the inputs to the ring of shared memory tiles, see
+  // Note [Pointwise Load Ring]
+  const bool use_load_ring = params.circular_buffer_stages > 1;
+  TORCH_INTERNAL_ASSERT(
+      !use_load_ring || (params.break_point == 0 && params.vectorize),
+      "Load ring requires the 1D vectorized schedule");
+  std::vector<TensorView*> ring_tvs;
+  std::vector<TensorView*> ring_reads;
+  if (use_load_ring) {
+    auto ring_inputs = getLoadRingInputs(
+        scheduler_utils::getInputsOutputsWithInnerDim(reference_tv, true, true),
+        (int64_t)params.unroll_factor);
+    for (auto input : ring_inputs) {
+      auto cached_input = input->uses().front()->output(0)->as<TensorView>();
+      auto ring_tv = input->cacheAfter(LoadStoreOpType::CpAsync);
+      ring_tv->setMemoryType(MemoryType::Shared);
+      ring_tvs.push_back(ring_tv);
+      ring_reads.push_back(cached_input);
+    }
+  }
+
   auto all_tvs = ir_utils::allTvs(fusion);
 
   // Merge right side of break point
@@ -638,7 +724,27 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
     // unmerged...]
     reference_tv->reorder({{-1, 0}});
 
-    if (params.vectorize) {
+    if (params.vectorize && use_load_ring) {
+      // Vectorize
+      reference_tv->split(0, params.unroll_factor);
+      // Unswitch
+      reference_tv->split(0, 1);
+      // Threads
+      reference_tv->split(0, kThreadX);
+      // Tiles of a block
+      reference_tv->split(0, params.tiles_per_block);
+
+      reference_tv->axis(0)->parallelize(ParallelType::BIDx);
+      reference_tv->axis(2)->parallelize(ParallelType::TIDx);
+      reference_tv->axis(3)->parallelize(ParallelType::Unswitch);
+      // Vectorization are propagated separately
+      vectorize_id = reference_tv->axis(4);
+
+      //[BIDx, Tiles, TIDx, Unswitch, Vectorization]
+      // To make consistent with unrolling:
+      reference_tv->reorder({{2, 4}, {3, 2}, {4, 3}});
+      //[BIDx, Tiles, Unswitch, Vectorization, TIDx]
+    } else if (params.vectorize) {
       // Vectorize
       reference_tv->split(0, params.unroll_factor);
       // Unswitch
@@ -674,7 +780,7 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
       // step 2: inline at the inner most dim for the rest of the graph
       reference_tv->axis(3)->parallelize(ParallelType::TIDx);
     }
-    unswitch_pos = 2;
+    unswitch_pos = use_load_ring ? 3 : 2;
   }
 
   TransformPropagator propagator(reference_tv);
@@ -701,6 +807,9 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
       vectorized_tvs.insert(
           vectorized_tvs.end(), consumer_tvs.begin(), consumer_tvs.end());
     }
+    // Reads of the load ring are vectorized like the copies into it
+    vectorized_tvs.insert(
+        vectorized_tvs.end(), ring_reads.begin(), ring_reads.end());
     // Aggressively mark with vectorized and cleanup later. That way we
     // don't have to manually specify parallelization outside the reference.
     vectorize_id->parallelize(ParallelType::Vectorize);
@@ -716,10 +825,37 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
   // get a higher position in later inline propagation. We need this separate
   // step because we were not using ParallelType::Unroll, so we have to do
   // unrolling manually.
+  //
+  // The load ring is inlined at the tile loop instead, so that it holds a tile
+  // of each input per stage.
+  std::unordered_set<TensorView*> unswitch_tensors;
+  if (use_load_ring) {
+    unswitch_tensors.insert(all_tvs.begin(), all_tvs.end());
+    for (auto ring_tv : ring_tvs) {
+      unswitch_tensors.erase(ring_tv);
+    }
+  }
   InlinePropagator inline_unswitch(
-      reference_tv, unswitch_pos, ComputeAtMode::BestEffort);
+      reference_tv,
+      unswitch_pos,
+      ComputeAtMode::BestEffort,
+      unswitch_tensors);
   spanning_tree.traverse(&inline_unswitch);
 
+  if (use_load_ring) {
+    InlinePropagator inline_ring(
+        reference_tv,
+        unswitch_pos - 1,
+        ComputeAtMode::BestEffort,
+        {ring_tvs.begin(), ring_tvs.end()});
+    spanning_tree.traverse(&inline_ring);
+    for (auto ring_tv : ring_tvs) {
+      if (ring_tv->getComputeAtPosition() > 0) {
+        ring_tv->circularBuffer((unsigned int)params.circular_buffer_stages);
+      }
+    }
+  }
+
   // Inline at the inner most position. The CA position of all tensors except
   // inputs, cached inputs and outputs will be updated.
   std::unordered_set<TensorView*> inner_most_tensors(
@@ -727,6 +863,9 @@ void schedulePointwise(Fusion* fusion, const PointwiseParams& params) {
   for (auto cached_input : cached_inputs) {
     inner_most_tensors.erase(cached_input);
   }
+  for (auto ring_tv : ring_tvs) {
+    inner_most_tensors.erase(ring_tv);
+  }
   for (auto entry : cached_outputs) {
     auto output = entry.second;
     inner_most_tensors.erase(output);
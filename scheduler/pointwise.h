@@ -13,6 +13,36 @@ namespace cuda {
 class SchedulerRuntimeInfo;
 class HeuristicSummary;
 
+//! Note [Pointwise Load Ring]
+//!
+//! Wide pointwise fusions, i.e. ones reading many inputs, are bound by how
+//!  many bytes each SM keeps in flight. Every thread issues its loads and
+//!  then waits on them, and register pressure caps how far the loads can be
+//!  unrolled.
+//!
+//! With PointwiseParams::circular_buffer_stages > 1, each block of the 1D
+//!  vectorized schedule iterates over tiles_per_block tiles:
+//!    [BIDx, tiles, Unswitch, Vectorize, TIDx]
+//!  and the vectorized inputs are copied to a ring of shared memory tiles
+//!  with cp.async, circular buffered along the tile loop. While a tile is
+//!  computed and stored, the loads of the following stages are in flight,
+//!  held in shared memory rather than registers.
+//!
+//! Only inputs without broadcasts whose vectorized loads are 4, 8 or 16
+//!  bytes are put in the ring, as required by cp.async.
+//!
+//! The ring is not warp specialization. Every thread still both issues
+//!  loads and computes. A schedule where a few producer warps stream the
+//!  inputs into the ring and consumer warps compute and store is not
+//!  implemented, and remains open. It needs lowering and codegen support
+//!  that doesn't exist yet:
+//!  - loop nests that diverge by warp role, so producer warps run only the
+//!    copies and consumer warps only the math and stores;
+//!  - named barriers or mbarriers to signal full and empty ring slots
+//!    between the roles, instead of the block wide syncs and cp.async waits
+//!    circular buffering inserts;
+//!  - heuristics that split a block's warps between the two roles.
+
 TORCH_CUDA_CU_API std::shared_ptr<PointwiseParams> getPointwiseHeuristics(
     Fusion* fusion,
     const at::ArrayRef<c10::IValue>& runtime_inputs,
@@ -39,6 +39,14 @@ class PointwiseParams : public HeuristicParams {
   // Unroll or vectorization factor
   size_t unroll_factor = 1;
 
+  // Number of shared memory stages input loads are circular buffered with,
+  // see Note [Pointwise Load Ring]. 1 disables the ring.
+  int64_t circular_buffer_stages = 1;
+
+  // Number of vectorized tiles each block iterates over when input loads
+  // are circular buffered
+  int64_t tiles_per_block = 1;
+
   using HeuristicParams::HeuristicParams;
 
   // Warning: Does not check launch parameters!
@@ -53,7 +61,9 @@ class PointwiseParams : public HeuristicParams {
         other.break_point == break_point && other.split_block == split_block &&
         other.split_grid_y_dim == split_grid_y_dim &&
         other.unroll_factor == unroll_factor &&
-        other.flip_grid_binding == flip_grid_binding;
+        other.flip_grid_binding == flip_grid_binding &&
+        other.circular_buffer_stages == circular_buffer_stages &&
+        other.tiles_per_block == tiles_per_block;
     return attr_equal;
   }
 
@@ -83,6 +93,10 @@ class PointwiseParams : public HeuristicParams {
     if (flip_grid_binding) {
       ss << "Flip BIDx/BIDy bindings\n";
     }
+    if (circular_buffer_stages > 1) {
+      ss << "Load ring stages: " << circular_buffer_stages
+         << ", tiles per block: " << tiles_per_block << "\n";
+    }
     ss << "====================================\n";
     return ss.str();
   }
@@ -94,7 +108,9 @@ class PointwiseParams : public HeuristicParams {
         static_cast<size_t>(split_block) << 5 ^
         static_cast<size_t>(split_grid_y_dim) << 6 ^
         static_cast<size_t>(unroll_factor) << 9 ^
-        static_cast<size_t>(flip_grid_binding) << 10;
+        static_cast<size_t>(flip_grid_binding) << 10 ^
+        static_cast<size_t>(circular_buffer_stages) << 11 ^
+        static_cast<size_t>(tiles_per_block) << 14;
     return attr_hash;
   }
 
@@ -44,6 +44,12 @@ int64_t clamp(const int64_t val, const int64_t min_val, const int64_t max_val) {
   return std::min(std::max(val, min_val), max_val);
 }
 
+// Maximum number of cp.async stages of circular buffered reduction loads, and
+// the minimum number of serial reduction iterations per stage to bother, see
+// Note [Circular Buffered Reduction Loads]
+constexpr int64_t kMaxLoadStages = 4;
+constexpr int64_t kMinIterationsPerLoadStage = 2;
+
 // Reduce x, y, z until it's product is less than max value, reduce round robin
 // starting with x
 void reduceProductTo(int64_t& z, int64_t& y, int64_t& x, const int64_t max) {
@@ -817,6 +823,25 @@ std::shared_ptr<ReductionParams> outerReductionHeuristic(
     rparams->vectorize_iter_dom = vectorize;
   }
 
+  // Keep the vectorized loads of long serial reduction loops in flight with
+  // cp.async on sm80+, see Note [Circular Buffered Reduction Loads]
+  if (rparams->vectorize_iter_dom &&
+      at::cuda::getCurrentDeviceProperties()->major >= 8 &&
+      !isOptionDisabled(DisableOption::CircularBufferLoads)) {
+    const int64_t serial_iterations = ceilDiv(
+        total_reduction_numel, bdimy * grdim * inner_reduction_unroll_factor);
+    const int64_t stage_size = n_tensor_inputs * max_input_dtype_size *
+        bdimx * bdimy * iter_unroll_factor * inner_reduction_unroll_factor;
+    const int64_t stages = std::min(
+        {kMaxLoadStages,
+         (int64_t)at::cuda::getCurrentDeviceProperties()->sharedMemPerBlock /
+             stage_size,
+         serial_iterations / kMinIterationsPerLoadStage});
+    if (stages > 1) {
+      rparams->circular_buffer_stages = stages;
+    }
+  }
+
   rparams->lparams = LaunchParams(
       gdimx,
       gdimy,
@@ -24,6 +24,15 @@ class ReductionParams : public HeuristicParams {
   // Project persistent buffers back to inputs to reduce persistent buffer size
   bool project_persistent_buffers = false;
 
+  // Keep persistent buffers in shared memory instead of registers, see
+  // Note [Shared Memory Persistence]
+  bool shared_mem_persistent_buffer = false;
+
+  // Number of shared memory stages the input loads of the serial reduction
+  // loop are circular buffered with, see
+  // Note [Circular Buffered Reduction Loads]. 1 disables circular buffering.
+  int64_t circular_buffer_stages = 1;
+
   // Are we treating the scheduling as 3 dimensional, can be useful for patterns
   // like [reduction, iteration, reduction].
   bool schedule_3D = false;
@@ -119,6 +128,8 @@ class ReductionParams : public HeuristicParams {
     bool attr_equal = other.fastest_dim == fastest_dim &&
         other.persistent_kernel == persistent_kernel &&
         other.project_persistent_buffers == project_persistent_buffers &&
+        other.shared_mem_persistent_buffer == shared_mem_persistent_buffer &&
+        other.circular_buffer_stages == circular_buffer_stages &&
         other.schedule_3D == schedule_3D && other.flip_grid == flip_grid &&
         other.cross_block_inner_reduction == cross_block_inner_reduction &&
         other.cross_grid_inner_reduction == cross_grid_inner_reduction &&
@@ -149,7 +160,13 @@ class ReductionParams : public HeuristicParams {
        << (tag == "" ? "" : "Tag: ") << tag << "\n"
        << (fastest_dim ? "Red On Fastest Dim\n" : "Red On Slow Dim\n")
        << (persistent_kernel ? "Persistent Kernel\n" : "")
-       << (project_persistent_buffers ? "Project Persistent Buffers\n" : "");
+       << (project_persistent_buffers ? "Project Persistent Buffers\n" : "")
+       << (shared_mem_persistent_buffer ? "Shared Memory Persistent Buffers\n"
+                                        : "");
+    if (circular_buffer_stages > 1) {
+      ss << "Circular buffered loads: " << circular_buffer_stages
+         << " stages\n";
+    }
     if (batches_per_block_inner_reduction > 1 || persistent_kernel) {
       ss << "Batches per block: " << batches_per_block_inner_reduction << "\n";
     }
@@ -244,7 +261,9 @@ class ReductionParams : public HeuristicParams {
         static_cast<size_t>(cross_grid_outer_reduction) << (bits - 18) ^
         static_cast<size_t>(split_grid_dim_outer_reduction) << (bits - 19) ^
         static_cast<size_t>(batches_per_block_outer_reduction) << (bits - 20) ^
-        static_cast<size_t>(unroll_factor_outer_reduction) << (bits - 21);
+        static_cast<size_t>(unroll_factor_outer_reduction) << (bits - 21) ^
+        static_cast<size_t>(shared_mem_persistent_buffer) << (bits - 22) ^
+        static_cast<size_t>(circular_buffer_stages) << (bits - 25);
     return attr_hash;
   }
 
@@ -2,6 +2,7 @@
 
 #include <third_party/nvfuser/expr_evaluator.h>
 #include <third_party/nvfuser/inline_propagator.h>
+#include <third_party/nvfuser/ir_builder.h>
 #include <third_party/nvfuser/ir_cloner.h>
 #include <third_party/nvfuser/ir_utils.h>
 #include <third_party/nvfuser/maxinfo_propagator.h>
@@ -213,6 +214,78 @@ TensorView* scheduleReductionTV(
   return sortAndRFactor(reduction_tv);
 }
 
+namespace {
+
+// Returns the position of the innermost serial loop of reference_tv over the
+// reduction, i.e. the loop that strides over a tall reduction, or -1
+int getSerialReductionLoopPos(TensorView* reference_tv) {
+  int pos = -1;
+  for (const auto i : c10::irange(reference_tv->nDims())) {
+    auto id = reference_tv->axis((int)i);
+    if (id->isReduction() && id->getParallelType() == ParallelType::Serial &&
+        !id->extent()->isConstScalar()) {
+      pos = (int)i;
+    }
+  }
+  return pos;
+}
+
+// Stages the loads of cached inputs in shared memory with cp.async, see
+// Note [Circular Buffered Reduction Loads]. Returns the shared memory tensor
+// of each staged cached input.
+std::unordered_map<TensorView*, TensorView*> stageInputLoads(
+    const ReductionParams& rparams,
+    TensorView* reference_tv,
+    const std::vector<TensorView*>& cached_inputs) {
+  std::unordered_map<TensorView*, TensorView*> smem_stages;
+  if (rparams.circular_buffer_stages <= 1 ||
+      getSerialReductionLoopPos(reference_tv) < 0) {
+    return smem_stages;
+  }
+
+  int64_t vector_size = 1;
+  if (rparams.vectorize_iter_dom) {
+    vector_size = rparams.unroll_factor_iter_dom;
+  } else if (rparams.vectorize_inner_reduction) {
+    vector_size = rparams.unroll_factor_inner_reduction;
+  }
+
+  auto vectorizable_inputs =
+      scheduler_utils::getInputsOutputsWithInnerDim(reference_tv, true, true);
+
+  for (auto cached_input : cached_inputs) {
+    auto input = cached_input->definition()->input(0)->as<TensorView>();
+    // Only inputs spanning the whole reduction are read in the serial loop
+    const auto& input_domain = input->getMaybeRFactorDomain();
+    if (input_domain.size() != reference_tv->getRootDomain().size() ||
+        std::any_of(
+            input_domain.begin(),
+            input_domain.end(),
+            [](IterDomain* id) { return id->isBroadcast(); })) {
+      continue;
+    }
+    // cp.async copies 4, 8 or 16 bytes at a time, so loads that aren't
+    // vectorized with the others are left in registers
+    if (vector_size > 1 &&
+        std::find(
+            vectorizable_inputs.begin(), vectorizable_inputs.end(), input) ==
+            vectorizable_inputs.end()) {
+      continue;
+    }
+    auto load_size =
+        vector_size * (int64_t)dataTypeSize(input->getDataType().value());
+    if (load_size != 4 && load_size != 8 && load_size != 16) {
+      continue;
+    }
+    auto smem_tv = input->cacheAfter(LoadStoreOpType::CpAsync);
+    smem_tv->setMemoryType(MemoryType::Shared);
+    smem_stages.emplace(cached_input, smem_tv);
+  }
+  return smem_stages;
+}
+
+} // namespace
+
 void multiReductionInliner(
     Fusion* fusion,
     const ReductionParams& rparams,
@@ -221,6 +294,10 @@ void multiReductionInliner(
     std::vector<TensorView*> reduction_tvs,
     std::vector<TensorView*> cached_inputs,
     std::vector<std::pair<TensorView*, TensorView*>> cached_outputs) {
+  // Stage input loads in shared memory before they're scheduled like the
+  // reference, see Note [Circular Buffered Reduction Loads]
+  auto smem_stages = stageInputLoads(rparams, reference_tv, cached_inputs);
+
   // Propagate transformations before we rfactor the other reductions
   TransformPropagator propagator(reference_tv);
   MaxRootDomainInfoSpanningTree(reference_tv).traverse(&propagator);
@@ -274,6 +351,14 @@ void multiReductionInliner(
     };
 
     for (auto cached_input : cached_inputs) {
+      auto smem_stage_it = smem_stages.find(cached_input);
+      if (smem_stage_it != smem_stages.end()) {
+        // Staged loads are vectorized if the others are, see
+        // stageInputLoads
+        are_unrolled.emplace(smem_stage_it->second);
+        are_unrolled.emplace(cached_input);
+        continue;
+      }
       if (vectorize) {
         auto producer_tvs = ir_utils::producerTvsOf(cached_input);
         if (producer_tvs.size() == 1 &&
@@ -335,15 +420,76 @@ void multiReductionInliner(
   std::unordered_set<IterDomain*> mapped_to_trivial_reduction =
       scheduler_utils::getTrivialReductionMap(fusion);
 
-  // Inline the schedule
+  // Inline the schedule, except for the shared memory stages of the loads
+  std::unordered_set<TensorView*> inlined_tvs;
+  if (!smem_stages.empty()) {
+    for (auto tv : ir_utils::allTvs(fusion)) {
+      inlined_tvs.emplace(tv);
+    }
+    for (const auto& smem_stage : smem_stages) {
+      inlined_tvs.erase(smem_stage.second);
+    }
+  }
+
   InlinePropagator inline_propagator(
       reference_tv,
       -1,
       ComputeAtMode::MostInlined,
-      {},
+      inlined_tvs,
       mapped_to_trivial_reduction);
 
   MaxRootDomainInfoSpanningTree(reference_tv).traverse(&inline_propagator);
+
+  if (smem_stages.empty()) {
+    return;
+  }
+
+  // Load a tile of the inputs per iteration of the serial reduction loop, and
+  // keep circular_buffer_stages tiles in flight
+  std::unordered_set<TensorView*> smem_tvs;
+  for (const auto& smem_stage : smem_stages) {
+    smem_tvs.emplace(smem_stage.second);
+  }
+
+  InlinePropagator smem_inline_propagator(
+      reference_tv,
+      getSerialReductionLoopPos(reference_tv) + 1,
+      ComputeAtMode::BestEffort,
+      smem_tvs,
+      mapped_to_trivial_reduction);
+
+  MaxRootDomainInfoSpanningTree(reference_tv).traverse(&smem_inline_propagator);
+
+  // A stage that couldn't be inlined into the serial loop would hold the
+  // whole reduction in shared memory and isn't circular buffered. Undo the
+  // staging and keep the load in registers like the other cached inputs.
+  std::unordered_set<TensorView*> unstaged_tvs;
+  for (auto smem_tv : smem_tvs) {
+    if (smem_tv->getComputeAtPosition() > 0) {
+      smem_tv->circularBuffer((unsigned int)rparams.circular_buffer_stages);
+      continue;
+    }
+    auto load = smem_tv->definition();
+    auto input = load->input(0);
+    fusion->removeExpr(load);
+    IrBuilder::create<UnaryOp>(UnaryOpType::Set, smem_tv, input);
+    smem_tv->setMemoryType(MemoryType::Local);
+    unstaged_tvs.emplace(smem_tv);
+  }
+
+  if (unstaged_tvs.empty()) {
+    return;
+  }
+
+  InlinePropagator unstaged_inline_propagator(
+      reference_tv,
+      -1,
+      ComputeAtMode::MostInlined,
+      unstaged_tvs,
+      mapped_to_trivial_reduction);
+
+  MaxRootDomainInfoSpanningTree(reference_tv)
+      .traverse(&unstaged_inline_propagator);
 }
 
 namespace {
@@ -21,7 +21,25 @@ TensorView* scheduleReductionTV(
     TensorView* reduction_tv,
     bool has_iter_axis);
 
-// Inlining function intended for single or multi reduction fusions.
+// Note [Circular Buffered Reduction Loads]
+//
+// Tall reductions, e.g. outer reductions over many rows, spend most of their
+// time in the serial loop striding over the reduction, waiting on global
+// loads that only an unrolled tile covers. With
+// ReductionParams::circular_buffer_stages > 1, the inputs read in that loop
+// are copied to shared memory with cp.async, and circular buffered along the
+// loop, so the loads of the next stages are in flight while the current tile
+// is reduced.
+//
+// Only inputs spanning the whole reduction whose loads are 4, 8 or 16 bytes
+// are staged, as required by cp.async. Staging is skipped when the reference
+// has no serial loop over the reduction, e.g. in persistent kernels which
+// hold the whole reduction in registers. A stage that can't be inlined into
+// the serial loop is turned back into a register load, as it would otherwise
+// hold the whole reduction in shared memory.
+
+// Inlining function intended for single or multi reduction fusions. Stages
+// input loads as described in Note [Circular Buffered Reduction Loads].
 TORCH_CUDA_CU_API void multiReductionInliner(
     Fusion* fusion,
     const ReductionParams& rparams,
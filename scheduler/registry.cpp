@@ -7,6 +7,7 @@
 #include <third_party/nvfuser/ir_utils.h>
 #include <third_party/nvfuser/root_domain_map.h>
 #include <third_party/nvfuser/scheduler/debug_utils.h>
+#include <third_party/nvfuser/scheduler/heuristic_cache.h>
 #include <third_party/nvfuser/scheduler/pointwise.h>
 #include <third_party/nvfuser/scheduler/registry.h>
 #include <third_party/nvfuser/scheduler/transpose.h>
@@ -798,6 +799,9 @@ class ReductionScheduler : public SchedulerEntry {
     computeHeuristics(fusion, runtime_info, data_cache);
   }
 
+  explicit ReductionScheduler(std::shared_ptr<HeuristicParams> params)
+      : SchedulerEntry(ScheduleHeuristic::Reduction, std::move(params)) {}
+
   //! Check if the reduction heuristics apply in given fusion
   static bool canScheduleCompileTime(Fusion* fusion) {
     // Temporarily disallow view in reduction scheduler
@@ -947,6 +951,9 @@ class PointWiseScheduler : public SchedulerEntry {
     computeHeuristics(fusion, runtime_info, data_cache);
   }
 
+  explicit PointWiseScheduler(std::shared_ptr<HeuristicParams> params)
+      : SchedulerEntry(ScheduleHeuristic::PointWise, std::move(params)) {}
+
   static bool canScheduleCompileTime(Fusion* fusion) {
     //   Currently using the same path as the scheduler
     // to eliminate mismatch between canSchedule and
@@ -1007,6 +1014,10 @@ class PersistentKernelScheduler : public SchedulerEntry {
     computeHeuristics(fusion, runtime_info, data_cache);
   }
 
+  explicit PersistentKernelScheduler(
+      std::shared_ptr<HeuristicParams> params)
+      : SchedulerEntry(ScheduleHeuristic::Persistent, std::move(params)) {}
+
   void schedule(Fusion* fusion) override {
     FUSER_PERF_SCOPE("Schedule Persistent Fusion");
     schedulePersistentKernel(fusion, reductionParams());
@@ -1152,54 +1163,25 @@ class PersistentKernelScheduler : public SchedulerEntry {
         persistent_buffer_size_info.persistent_buffer_size,
         persistent_buffer_size_info.projected_persistent_buffer_size);
 
-    if (persistent_buffer_size > scheduler_utils::register_file_size) {
-      scheduler_debug_utils::canScheduleRejectReason(
-          ScheduleHeuristic::Persistent,
-          "not enough registers for persistence");
-      return false;
-    }
-
-    // If there's a small iteration dimension but a large reduction dimension it
-    // may not make sense to make a persistent kernel
     auto properties =
         scheduler_utils::getProperties(fusion, runtime_info, reduction_tvs[0]);
 
-    const int64_t device_max_threads_per_multiprocessor =
-        (int64_t)at::cuda::getCurrentDeviceProperties()
-            ->maxThreadsPerMultiProcessor;
-
-    const int64_t device_multiprocessor_count =
-        (int64_t)at::cuda::getCurrentDeviceProperties()->multiProcessorCount;
-
-    const int64_t warp_size = at::cuda::warp_size();
-
-    // Maximum number of iteration dimensions we can have and still be
-    // persistent.
-    const int64_t max_multi_reduction_factor = std::max(
-        scheduler_utils::register_file_size / persistent_buffer_size,
-        (int64_t)1);
-
-    // If outer reduction, and we have few iteration numel but large reduction
-    // numel, don't generate kernel because we don't support cross grid
-    // persistence
-    if (
-        // Don't go persistent if we can't fit half a warp on an SM
-        (!properties.fastest_dim_reduction &&
-         max_multi_reduction_factor < warp_size / 2) ||
-        ( // Don't go persistent if we can't use a small fraction of the
-          // available SMs yet have a large reduction size
-            properties.total_iteration_numel <
-                (properties.fastest_dim_reduction
-                     ? std::max(device_multiprocessor_count / 8, (int64_t)1)
-                     // Make sure we at least use a quarter of the device * a
-                     // half warp
-                     : (warp_size / 8) * device_multiprocessor_count) &&
-            // Reduction count is larger than max thread count * 4
-            properties.total_reduction_numel >=
-                device_max_threads_per_multiprocessor * 4)) {
+    auto reject_reason = blockPersistenceRejectReason(
+        properties.fastest_dim_reduction,
+        properties.total_reduction_numel,
+        properties.total_iteration_numel,
+        persistent_buffer_size);
+
+    // Reductions too large for a block may still be split across a
+    // cooperative grid, see Note [Grid Persistent Normalization]
+    if (!reject_reason.empty() &&
+        !useGridPersistence(
+            properties.fastest_dim_reduction,
+            properties.total_reduction_numel,
+            properties.total_iteration_numel,
+            persistent_buffer_size)) {
       scheduler_debug_utils::canScheduleRejectReason(
-          ScheduleHeuristic::Persistent, "unsupported cross grid persistence");
-
+          ScheduleHeuristic::Persistent, reject_reason);
       return false;
     }
 
@@ -1226,6 +1208,9 @@ class TransposeScheduler : public SchedulerEntry {
     computeHeuristics(fusion, runtime_info, data_cache);
   }
 
+  explicit TransposeScheduler(std::shared_ptr<HeuristicParams> params)
+      : SchedulerEntry(ScheduleHeuristic::Transpose, std::move(params)) {}
+
   static bool canScheduleCompileTime(Fusion* fusion) {
     if (!isOptionEnabled(EnableOption::TransposeScheduler)) {
       scheduler_debug_utils::canScheduleRejectReason(
@@ -1291,9 +1276,61 @@ class TransposeScheduler : public SchedulerEntry {
   }
 };
 
+class MatmulScheduler : public SchedulerEntry {
+ public:
+  explicit MatmulScheduler(
+      Fusion* fusion,
+      SchedulerRuntimeInfo& runtime_info,
+      HeuristicSummary* data_cache = nullptr)
+      : SchedulerEntry(ScheduleHeuristic::Matmul) {
+    computeHeuristics(fusion, runtime_info, data_cache);
+  }
+
+  explicit MatmulScheduler(std::shared_ptr<HeuristicParams> params)
+      : SchedulerEntry(ScheduleHeuristic::Matmul, std::move(params)) {}
+
+  static bool canScheduleCompileTime(Fusion* fusion) {
+    auto reason = getMatmulCompileTimeRejectReason(fusion);
+    if (!reason.empty()) {
+      scheduler_debug_utils::canScheduleRejectReason(
+          ScheduleHeuristic::Matmul, reason);
+      return false;
+    }
+    return true;
+  }
+
+  static bool canScheduleRunTime(
+      Fusion* fusion,
+      SchedulerRuntimeInfo& runtime_info,
+      HeuristicSummary* data_cache = nullptr) {
+    auto reason = getMatmulRunTimeRejectReason(fusion, runtime_info);
+    if (!reason.empty()) {
+      scheduler_debug_utils::canScheduleRejectReason(
+          ScheduleHeuristic::Matmul, reason);
+      return false;
+    }
+    return true;
+  }
+
+  void schedule(Fusion* fusion) override {
+    FUSER_PERF_SCOPE("Schedule Matmul Fusion");
+    scheduleMatmul(fusion, matmulParams());
+  }
+
+ private:
+  void computeHeuristics(
+      Fusion* fusion,
+      SchedulerRuntimeInfo& runtime_info,
+      HeuristicSummary* data_cache = nullptr) {
+    params_ = getMatmulHeuristics(fusion, runtime_info, data_cache);
+    TORCH_INTERNAL_ASSERT(params_ != nullptr);
+  }
+};
+
 // Schedule Table
 const std::vector<ScheduleHeuristic>& all_heuristics() {
   static const std::vector<ScheduleHeuristic> hlist = {
+      ScheduleHeuristic::Matmul,
       ScheduleHeuristic::Reduction,
       ScheduleHeuristic::Transpose,
       ScheduleHeuristic::PointWise,
@@ -1345,6 +1382,9 @@ bool SchedulerEntry::canSchedule(
     case ScheduleHeuristic::Transpose:
       return checkCanSchedule<TransposeScheduler>(
           fusion, runtime_info, data_cache);
+    case ScheduleHeuristic::Matmul:
+      return checkCanSchedule<MatmulScheduler>(
+          fusion, runtime_info, data_cache);
     default:
       TORCH_INTERNAL_ASSERT(false, "unreachable");
       return false;
@@ -1357,7 +1397,42 @@ std::unique_ptr<SchedulerEntry> SchedulerEntry::makeEntry(
     Fusion* fusion,
     SchedulerRuntimeInfo& runtime_info,
     HeuristicSummary* data_cache) {
+  FUSER_PERF_SCOPE("SchedulerEntry::makeEntry");
+  const bool use_heuristic_cache =
+      !isOptionDisabled(DisableOption::HeuristicCache);
+  std::string cache_key;
+  std::shared_ptr<HeuristicParams> cached_params = nullptr;
+  if (use_heuristic_cache) {
+    cache_key = HeuristicParamsCache::makeKey(sh, fusion, runtime_info);
+    cached_params = HeuristicParamsCache::get().lookup(cache_key);
+  }
+
   std::unique_ptr<SchedulerEntry> scheduler_entry = nullptr;
+  if (cached_params != nullptr) {
+    switch (sh) {
+      case ScheduleHeuristic::PointWise:
+        scheduler_entry = std::make_unique<PointWiseScheduler>(cached_params);
+        break;
+      case ScheduleHeuristic::Reduction:
+        scheduler_entry = std::make_unique<ReductionScheduler>(cached_params);
+        break;
+      case ScheduleHeuristic::Persistent:
+        scheduler_entry =
+            std::make_unique<PersistentKernelScheduler>(cached_params);
+        break;
+      case ScheduleHeuristic::Transpose:
+        scheduler_entry = std::make_unique<TransposeScheduler>(cached_params);
+        break;
+      case ScheduleHeuristic::Matmul:
+        scheduler_entry = std::make_unique<MatmulScheduler>(cached_params);
+        break;
+      default:
+        TORCH_INTERNAL_ASSERT(false, "unreachable");
+    }
+    scheduler_entry->index_mode_ = runtime_info.getIndexMode();
+    return scheduler_entry;
+  }
+
   switch (sh) {
     case ScheduleHeuristic::PointWise:
       scheduler_entry = std::make_unique<PointWiseScheduler>(
@@ -1375,11 +1450,18 @@ std::unique_ptr<SchedulerEntry> SchedulerEntry::makeEntry(
       scheduler_entry = std::make_unique<TransposeScheduler>(
           fusion, runtime_info, data_cache);
       break;
+    case ScheduleHeuristic::Matmul:
+      scheduler_entry = std::make_unique<MatmulScheduler>(
+          fusion, runtime_info, data_cache);
+      break;
     default:
       TORCH_INTERNAL_ASSERT(false, "unreachable");
   }
 
   scheduler_entry->index_mode_ = runtime_info.getIndexMode();
+  if (use_heuristic_cache) {
+    HeuristicParamsCache::get().insert(cache_key, *scheduler_entry->params());
+  }
   return scheduler_entry;
 }
 
@@ -1410,6 +1492,8 @@ std::string toString(ScheduleHeuristic sh) {
       return "persistent";
     case ScheduleHeuristic::Transpose:
       return "transpose";
+    case ScheduleHeuristic::Matmul:
+      return "matmul";
     default:
       TORCH_INTERNAL_ASSERT(false, "undefined schedule");
   }
@@ -1466,6 +1550,10 @@ HeuristicSummary::HeuristicSummary(
       getTransposeHeuristics(fusion, runtime_info, this);
       TransposeScheduler::canScheduleRunTime(fusion, runtime_info, this);
       break;
+    case ScheduleHeuristic::Matmul:
+      getMatmulHeuristics(fusion, runtime_info, this);
+      MatmulScheduler::canScheduleRunTime(fusion, runtime_info, this);
+      break;
     default:
       TORCH_INTERNAL_ASSERT(false, "unknown heuristic");
   }
@@ -1517,6 +1605,10 @@ void HeuristicSummary::validate() const {
           EntryType::INPUTS_AND_OUTPUTS_INNER_DIM_GROUPS));
       break;
     }
+    case ScheduleHeuristic::Matmul: {
+      // Matmul heuristics don't record compile time info
+      break;
+    }
     default:
       TORCH_INTERNAL_ASSERT(false, "unknown heuristic");
   }
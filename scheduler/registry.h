@@ -136,7 +136,8 @@ class TORCH_CUDA_CU_API SchedulerEntry {
  public:
   //! Fusion runtime facing API,
   //!   builds a new entry with the given heuristics
-  //!   corresponding to the given fusion
+  //!   corresponding to the given fusion. Parameters are shared through
+  //!   the process-wide cache, see Note [Heuristic Params Cache]
   static std::unique_ptr<SchedulerEntry> makeEntry(
       ScheduleHeuristic sh,
       Fusion* fusion,
@@ -201,6 +202,13 @@ class TORCH_CUDA_CU_API SchedulerEntry {
     return *tparams;
   }
 
+  const MatmulParam& matmulParams() const {
+    auto mparams = std::dynamic_pointer_cast<MatmulParam>(params_);
+    TORCH_INTERNAL_ASSERT(
+        mparams != nullptr, "Heuristic parameter is not a matmul parameter");
+    return *mparams;
+  }
+
   void updateLaunchConstraint(const LaunchParams& launch_params) {
     params_->lparams = launch_params;
   }
@@ -208,6 +216,11 @@ class TORCH_CUDA_CU_API SchedulerEntry {
  protected:
   explicit SchedulerEntry(ScheduleHeuristic heuristic) : heuristc_(heuristic) {}
 
+  SchedulerEntry(
+      ScheduleHeuristic heuristic,
+      std::shared_ptr<HeuristicParams> params)
+      : params_(std::move(params)), heuristc_(heuristic) {}
+
   //! Heuristic parameters if applicable
   std::shared_ptr<HeuristicParams> params_ = nullptr;
 
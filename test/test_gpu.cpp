@@ -9,7 +9,9 @@
 #include <third_party/nvfuser/executor_launch_params.h>
 #include <third_party/nvfuser/expr_evaluator.h>
 #include <third_party/nvfuser/fusion.h>
+#include <third_party/nvfuser/fusion_signature.h>
 #include <third_party/nvfuser/fusion_segmenter.h>
+#include <third_party/nvfuser/graph_signature.h>
 #include <third_party/nvfuser/grouped_reduction.h>
 #include <third_party/nvfuser/inline_propagator.h>
 #include <third_party/nvfuser/interface.h>
@@ -25,10 +27,12 @@
 #include <third_party/nvfuser/kernel_ir_dispatch.h>
 #include <third_party/nvfuser/lower2device.h>
 #include <third_party/nvfuser/lower_magic_zero.h>
+#include <third_party/nvfuser/manager.h>
 #include <third_party/nvfuser/mutator.h>
 #include <third_party/nvfuser/ops/all_ops.h>
 #include <third_party/nvfuser/root_domain_map.h>
 #include <third_party/nvfuser/scheduler/all_schedulers.h>
+#include <third_party/nvfuser/scheduler/heuristic_cache.h>
 #include <third_party/nvfuser/scheduler/reduction_utils.h>
 #include <third_party/nvfuser/scheduler/utils.h>
 #include <third_party/nvfuser/test/test_gpu_validator.h>
@@ -44,10 +48,13 @@
 
 #include <ATen/cuda/CUDAContext.h>
 #include <ATen/cuda/Exceptions.h>
+#include <c10/cuda/CUDAGuard.h>
 #include <c10/cuda/CUDAStream.h>
 
 #include <algorithm>
+#include <chrono>
 #include <iostream>
+#include <random>
 #include <sstream>
 #include <thread>
 
@@ -1473,6 +1480,244 @@ __global__ void CUDAGeneratedKernel(Tensor<float, 1> T0, Tensor<float, 1> T1, Te
   TORCH_CHECK(output_ref.equal(outputs[0]));
 }
 
+TEST_F(NVFuserTest, FusionGraphSignature_CUDA) {
+  auto make_graph = [](const std::string& ir) {
+    auto g = std::make_shared<Graph>();
+    parseIR(ir, g.get());
+    return g;
+  };
+
+  const auto graph0 = make_graph(R"IR(
+    graph(%x.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %y.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %2 : int = prim::Constant[value=1]()
+      %3 : Tensor = aten::add(%x.1, %y.1, %2)
+      %4 : Tensor = aten::relu(%3)
+      return (%4))IR");
+
+  // Only value names differ
+  const auto graph1 = make_graph(R"IR(
+    graph(%a : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %b : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %alpha : int = prim::Constant[value=1]()
+      %sum : Tensor = aten::add(%a, %b, %alpha)
+      %out : Tensor = aten::relu(%sum)
+      return (%out))IR");
+
+  // Different constant
+  const auto graph2 = make_graph(R"IR(
+    graph(%x.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %y.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %2 : int = prim::Constant[value=2]()
+      %3 : Tensor = aten::add(%x.1, %y.1, %2)
+      %4 : Tensor = aten::relu(%3)
+      return (%4))IR");
+
+  // Different memory layout of an input
+  const auto graph3 = make_graph(R"IR(
+    graph(%x.1 : Float(4, 8, strides=[1, 4], requires_grad=0, device=cuda:0),
+          %y.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %2 : int = prim::Constant[value=1]()
+      %3 : Tensor = aten::add(%x.1, %y.1, %2)
+      %4 : Tensor = aten::relu(%3)
+      return (%4))IR");
+
+  // Different dtype of an input
+  const auto graph4 = make_graph(R"IR(
+    graph(%x.1 : Half(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %y.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %2 : int = prim::Constant[value=1]()
+      %3 : Tensor = aten::add(%x.1, %y.1, %2)
+      %4 : Tensor = aten::relu(%3)
+      return (%4))IR");
+
+  // Swapped operands
+  const auto graph5 = make_graph(R"IR(
+    graph(%x.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %y.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %2 : int = prim::Constant[value=1]()
+      %3 : Tensor = aten::add(%y.1, %x.1, %2)
+      %4 : Tensor = aten::relu(%3)
+      return (%4))IR");
+
+  GraphSignature signature0(graph0);
+  TORCH_CHECK(signature0 == GraphSignature(graph1));
+  TORCH_CHECK(signature0.hash() == GraphSignature(graph1).hash());
+  TORCH_CHECK(signature0 == GraphSignature(graph0->copy()));
+  TORCH_CHECK(signature0 != GraphSignature(graph2));
+  TORCH_CHECK(signature0 != GraphSignature(graph3));
+  TORCH_CHECK(signature0 != GraphSignature(graph4));
+  TORCH_CHECK(signature0 != GraphSignature(graph5));
+}
+
+// Identical fusion groups, e.g. the repeated blocks of a model, are parsed
+// once: the manager keys their GraphCache, which owns the parsed fusion, on
+// the canonical GraphSignature, see [ Note -- cache entry indexing ]
+TEST_F(NVFuserTest, FusionManagerSharesParsedFusions_CUDA) {
+  auto make_fusion_group = [](const std::string& ir) {
+    auto subgraph = std::make_shared<Graph>();
+    parseIR(ir, subgraph.get());
+    auto g = std::make_shared<Graph>();
+    std::vector<Value*> inputs;
+    for (auto input : subgraph->inputs()) {
+      inputs.push_back(g->addInput()->setType(input->type()));
+    }
+    auto fusion_group = g->insertNode(g->create(
+        prim::CudaFusionGroup, inputs, subgraph->outputs().size()));
+    fusion_group->g_(attr::Subgraph, subgraph);
+    for (auto output : fusion_group->outputs()) {
+      g->registerOutput(output);
+    }
+    return g;
+  };
+  auto cache_id = [](const std::shared_ptr<Graph>& g) {
+    auto fusion_group = g->outputs()[0]->node();
+    compileCudaFusionGroup(fusion_group);
+    return fusion_group->i(attr::cache_id);
+  };
+
+  const auto graph0 = make_fusion_group(R"IR(
+    graph(%x.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %y.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %2 : int = prim::Constant[value=1]()
+      %3 : Tensor = aten::add(%x.1, %y.1, %2)
+      %4 : Tensor = aten::relu(%3)
+      return (%4))IR");
+
+  // Only value names differ
+  const auto graph1 = make_fusion_group(R"IR(
+    graph(%a : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %b : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %alpha : int = prim::Constant[value=1]()
+      %sum : Tensor = aten::add(%a, %b, %alpha)
+      %out : Tensor = aten::relu(%sum)
+      return (%out))IR");
+
+  // Different op
+  const auto graph2 = make_fusion_group(R"IR(
+    graph(%x.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %y.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %2 : int = prim::Constant[value=1]()
+      %3 : Tensor = aten::sub(%x.1, %y.1, %2)
+      %4 : Tensor = aten::relu(%3)
+      return (%4))IR");
+
+  auto id0 = cache_id(graph0);
+  TORCH_CHECK(cache_id(graph1) == id0);
+  TORCH_CHECK(cache_id(graph2) != id0);
+
+  // The shared GraphCache runs the fusion groups of both graphs
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({4, 8}, options);
+  at::Tensor t1 = at::randn({4, 8}, options);
+  for (const auto& g : {graph0, graph1}) {
+    Stack stack{t0, t1};
+    runCudaFusionGroup(g->outputs()[0]->node(), stack);
+    TORCH_CHECK(stack.size() == 1);
+    TORCH_CHECK(stack[0].toTensor().allclose((t0 + t1).relu()));
+  }
+}
+
+// Graphs profiled separately get their own symbols for dynamic dims, which
+// shouldn't keep them from sharing a signature, and a GraphCache
+TEST_F(NVFuserTest, FusionGraphSignatureDynamicShapes_CUDA) {
+  auto make_graph = [](c10::ShapeSymbol inner) {
+    auto g = std::make_shared<Graph>();
+    parseIR(
+        R"IR(
+    graph(%x.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0),
+          %y.1 : Float(4, 8, strides=[8, 1], requires_grad=0, device=cuda:0)):
+      %2 : int = prim::Constant[value=1]()
+      %3 : Tensor = aten::add(%x.1, %y.1, %2)
+      %4 : Tensor = aten::relu(%3)
+      return (%4))IR",
+        g.get());
+    // Same as profiling dynamic sizes in the outer dim
+    auto outer = c10::ShapeSymbol::newSymbol();
+    for (auto input : g->inputs()) {
+      auto type = input->type()->expect<TensorType>();
+      input->setType(type->withSymbolicShapes(
+          c10::SymbolicShape(std::vector<c10::ShapeSymbol>{outer, inner})));
+    }
+    return g;
+  };
+
+  auto graph0 = make_graph(c10::ShapeSymbol::fromStaticSize(8));
+  auto graph1 = make_graph(c10::ShapeSymbol::fromStaticSize(8));
+  auto graph2 = make_graph(c10::ShapeSymbol::fromStaticSize(16));
+  auto graph3 = make_graph(c10::ShapeSymbol::newSymbol());
+
+  GraphSignature signature0(graph0);
+  TORCH_CHECK(signature0 == GraphSignature(graph1));
+  TORCH_CHECK(signature0.hash() == GraphSignature(graph1).hash());
+  TORCH_CHECK(signature0 != GraphSignature(graph2));
+  TORCH_CHECK(signature0 != GraphSignature(graph3));
+}
+
+TEST_F(NVFuserTest, FusionCompiledKernelRegistry_CUDA) {
+  auto define = [](Fusion& fusion, double factor) {
+    FusionGuard fg(&fusion);
+    auto tv0 = makeSymbolicTensor(2);
+    fusion.addInput(tv0);
+    auto tv1 = add(tv0, IrBuilder::create<Double>(1.0));
+    auto tv2 = mul(tv1, IrBuilder::create<Double>(factor));
+    fusion.addOutput(tv2);
+    tv2->axis(0)->parallelize(ParallelType::BIDx);
+    tv2->axis(1)->parallelize(ParallelType::TIDx);
+    tv1->computeAt(tv2, -1);
+  };
+
+  Fusion fusion0;
+  Fusion fusion1;
+  Fusion fusion2;
+  define(fusion0, 2.0);
+  define(fusion1, 2.0);
+  define(fusion2, 3.0);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({8, 32}, options);
+
+  auto& registry = executor_utils::CompiledKernelRegistry::get();
+  registry.clear();
+
+  std::weak_ptr<const executor_utils::CompiledKernel> shared_kernel;
+  {
+    FusionExecutor fe0;
+    FusionExecutor fe1;
+    FusionExecutor fe2;
+    fe0.compileFusion(&fusion0, {t0});
+    fe1.compileFusion(&fusion1, {t0});
+    fe2.compileFusion(&fusion2, {t0});
+
+    // Identical code up to the kernel name shares the module
+    TORCH_CHECK(fe0.kernelName() != fe1.kernelName());
+    TORCH_CHECK(fe0.compiledKernel() == fe1.compiledKernel());
+    TORCH_CHECK(fe0.compiledKernel() != fe2.compiledKernel());
+    auto stats = registry.stats();
+    TORCH_CHECK(
+        stats.hits == 1 && stats.misses == 2 && stats.live == 2,
+        registry.statsString());
+
+    auto cg_outputs0 = fe0.runFusion({t0});
+    auto cg_outputs1 = fe1.runFusion({t0});
+    auto cg_outputs2 = fe2.runFusion({t0});
+    testValidate(
+        &fusion0, cg_outputs0, {t0}, {(t0 + 1) * 2}, __LINE__, __FILE__);
+    testValidate(
+        &fusion1, cg_outputs1, {t0}, {(t0 + 1) * 2}, __LINE__, __FILE__);
+    testValidate(
+        &fusion2, cg_outputs2, {t0}, {(t0 + 1) * 3}, __LINE__, __FILE__);
+
+    shared_kernel = fe0.compiledKernel();
+  }
+
+  // The module is released with the last executor using it
+  TORCH_CHECK(shared_kernel.expired());
+  TORCH_CHECK(registry.stats().live == 0, registry.statsString());
+
+  registry.clear();
+}
+
 TEST_F(NVFuserTest, FusionOuterSplit_CUDA) {
   Fusion fusion;
   FusionGuard fg(&fusion);
@@ -8837,23 +9082,565 @@ TEST_F(NVFuserTest, FusionMagicSchedulerSoftmax_CUDA) {
   auto reduction_params = getPersistentHeuristics(&fusion, {aten_input});
   TORCH_CHECK(reduction_params, "Reduction schedule was not generated!");
 
-  schedulePersistentKernel(&fusion, *reduction_params);
+  schedulePersistentKernel(&fusion, *reduction_params);
+
+  auto lparams = reduction_params->lparams;
+
+  torch::jit::fuser::cuda::FusionExecutor fe;
+  fe.compileFusion(&fusion, {aten_input}, lparams);
+  auto cg_outputs = fe.runFusion({aten_input}, lparams);
+
+  testValidate(
+      &fusion,
+      cg_outputs,
+      {aten_input},
+      {aten_output},
+      __LINE__,
+      __FILE__,
+      "",
+      lparams);
+}
+
+TEST_F(NVFuserTest, FusionSharedMemoryPersistentSoftmax_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  const int kReductionAxis = 1;
+  std::vector<int64_t> input_shape{256, 1024};
+  TensorView* input = makeSymbolicTensor(input_shape.size());
+  fusion.addInput(input);
+
+  auto output = softmax(input, kReductionAxis);
+
+  fusion.addOutput(output);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor aten_input = at::randn(input_shape, options);
+  auto aten_output =
+      at::_softmax(aten_input.to(at::kDouble), kReductionAxis, false);
+
+  // Small buffers stay in registers, ones beyond the register budget go to
+  // shared memory as long as a block can hold them
+  const int64_t reduction_numel = input_shape[kReductionAxis];
+  const auto smem_limit = sharedMemoryPersistentBufferLimit();
+  TORCH_CHECK(!useSharedMemoryPersistence(
+      reduction_numel, reduction_numel * (int64_t)sizeof(float)));
+  TORCH_CHECK(
+      useSharedMemoryPersistence(
+          reduction_numel, scheduler_utils::register_file_size + 1) ==
+      (smem_limit > scheduler_utils::register_file_size));
+  TORCH_CHECK(!useSharedMemoryPersistence(
+      reduction_numel,
+      std::max(smem_limit, scheduler_utils::register_file_size) + 1));
+
+  auto reduction_params = getPersistentHeuristics(&fusion, {aten_input});
+  TORCH_CHECK(reduction_params, "Reduction schedule was not generated!");
+  TORCH_CHECK(!reduction_params->shared_mem_persistent_buffer);
+
+  // Force the buffers into shared memory
+  reduction_params->shared_mem_persistent_buffer = true;
+  schedulePersistentKernel(&fusion, *reduction_params);
+
+  auto all_tvs = ir_utils::allTvs(&fusion);
+  TORCH_CHECK(
+      std::any_of(
+          all_tvs.begin(),
+          all_tvs.end(),
+          [](TensorView* tv) {
+            return tv->getMemoryType() == MemoryType::Shared;
+          }),
+      "Persistent buffers were not placed in shared memory");
+
+  auto lparams = reduction_params->lparams;
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {aten_input}, lparams);
+  TORCH_CHECK(!fe.kernel()->summary().dynamic_smem_allocations.empty());
+  auto cg_outputs = fe.runFusion({aten_input}, lparams);
+
+  testValidate(
+      &fusion,
+      cg_outputs,
+      {aten_input},
+      {aten_output},
+      __LINE__,
+      __FILE__,
+      "",
+      lparams);
+}
+
+// Softmaxes over 16k-64k hidden sizes through the FusionExecutorCache. Each
+// softmax of the chain keeps its own persistent buffer, and the first one is
+// dead by the time the last one is written, so with shared memory
+// persistence lower_alias_memory should let them share memory.
+TEST_F(NVFuserTest, FusionSharedMemoryPersistentLargeHidden_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  const int kReductionAxis = 1;
+  TensorView* tv0 = makeContigTensor(2, DataType::Half);
+  fusion->addInput(tv0);
+  auto tv1 = castOp(DataType::Float, tv0);
+  auto tv2 = softmax(tv1, kReductionAxis);
+  auto tv3 = softmax(tv2, kReductionAxis);
+  auto tv4 = softmax(tv3, kReductionAxis);
+  auto tv5 = castOp(DataType::Half, tv4);
+  fusion->addOutput(tv5);
+
+  FusionExecutorCache fec(std::move(fusion));
+  fec.profile(true);
+
+  auto options = at::TensorOptions().dtype(at::kHalf).device(at::kCUDA, 0);
+  int smem_persistent_runs = 0;
+  for (int64_t hidden_size : {16 * 1024, 32 * 1024, 64 * 1024}) {
+    at::Tensor t0 = at::randn({128, hidden_size}, options);
+    auto cg_outputs = fec.runFusionWithInputs({t0});
+
+    auto t1 = t0.to(at::kFloat);
+    auto t2 = at::_softmax(t1, kReductionAxis, false);
+    auto t3 = at::_softmax(t2, kReductionAxis, false);
+    auto t4 = at::_softmax(t3, kReductionAxis, false);
+    auto t5 = t4.to(at::kHalf);
+    testValidate(fec.fusion(), cg_outputs, {t0}, {t5}, __LINE__, __FILE__);
+
+    auto runtime = fec.getMostRecentKernelRuntime();
+    if (runtime->isSegmented()) {
+      continue;
+    }
+    auto log = fec.getMostRecentExecutorInfo();
+    auto rparams = std::dynamic_pointer_cast<ReductionParams>(log.params);
+    if (rparams == nullptr || !rparams->persistent_kernel ||
+        !rparams->shared_mem_persistent_buffer) {
+      continue;
+    }
+    ++smem_persistent_runs;
+
+    const auto& smem_allocations =
+        log.fusion_executor->kernel()->summary().dynamic_smem_allocations;
+    TORCH_CHECK(
+        std::any_of(
+            smem_allocations.begin(),
+            smem_allocations.end(),
+            [](const kir::Allocate* alloc) {
+              return alloc->alias() != nullptr;
+            }),
+        "Persistent buffers in shared memory were not reused, hidden size ",
+        hidden_size);
+  }
+
+  if (smem_persistent_runs == 0) {
+    GTEST_SKIP() << "No hidden size was persistent in shared memory";
+  }
+}
+
+TEST_F(NVFuserTest, FusionGridPersistentOuterNormalization_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  // A tall reduction over few channels, like batch norms over N*H*W
+  std::vector<int64_t> input_shape{16384, 32};
+  TensorView* tv0 = makeContigTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {0});
+  auto tv2 = broadcast(tv1, {true, false});
+  auto tv3 = div(tv2, IrBuilder::create<Double>((double)input_shape[0]));
+  auto tv4 = sub(tv0, tv3);
+  fusion->addOutput(tv4);
+
+  // Each channel needs 64KB of persistent buffers, too much to keep half a
+  // warp of channels on an SM
+  const int64_t persistent_buffer_size =
+      input_shape[0] * (int64_t)dataTypeSize(DataType::Float);
+  auto reject_reason = blockPersistenceRejectReason(
+      false, input_shape[0], input_shape[1], persistent_buffer_size);
+  TORCH_CHECK(!reject_reason.empty());
+  if (!useGridPersistence(
+          false, input_shape[0], input_shape[1], persistent_buffer_size)) {
+    GTEST_SKIP() << "skipping tests on GPUs too small to co-schedule the grid";
+    return;
+  }
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor aten_input = at::randn(input_shape, options);
+  auto aten_output = aten_input - aten_input.mean({0}, true);
+
+  FusionExecutorCache fec(std::move(fusion));
+  auto cg_outputs = fec.runFusionWithInputs({aten_input});
+
+  auto runtime = fec.getMostRecentKernelRuntime();
+  TORCH_CHECK(!runtime->isSegmented(), "normalization was segmented");
+  auto heuristic = runtime->schedulerHeuristics()->heuristicsList().front();
+  TORCH_CHECK(
+      heuristic->heuristic() == ScheduleHeuristic::Persistent,
+      "expected persistent heuristic");
+  TORCH_CHECK(heuristic->reductionParams().cross_grid_inner_reduction);
+  TORCH_CHECK(heuristic->reductionParams().lparams.gdimy() > 1);
+
+  testValidate(
+      fec.fusion(),
+      cg_outputs,
+      {aten_input},
+      {aten_output},
+      __LINE__,
+      __FILE__);
+}
+
+TEST_F(NVFuserTest, FusionHorizontalFusion_CUDA) {
+  // Three independent kernels, the first two with 128 threads per block
+  Fusion fusion0;
+  {
+    FusionGuard fg(&fusion0);
+    auto tv0 = makeSymbolicTensor(1);
+    fusion0.addInput(tv0);
+    auto tv1 = add(tv0, IrBuilder::create<Double>(1));
+    fusion0.addOutput(tv1);
+    tv1->split(0, 128);
+    tv1->axis(0)->parallelize(ParallelType::BIDx);
+    tv1->axis(1)->parallelize(ParallelType::TIDx);
+  }
+
+  Fusion fusion1;
+  {
+    FusionGuard fg(&fusion1);
+    auto tv0 = makeSymbolicTensor(2);
+    fusion1.addInput(tv0);
+    auto tv1 = sum(tv0, {1});
+    fusion1.addOutput(tv1);
+    tv1->axis(0)->parallelize(ParallelType::BIDx);
+    tv1->axis(1)->parallelize(ParallelType::TIDx);
+  }
+
+  Fusion fusion2;
+  {
+    FusionGuard fg(&fusion2);
+    auto tv0 = makeSymbolicTensor(1);
+    fusion2.addInput(tv0);
+    auto tv1 = mul(tv0, IrBuilder::create<Double>(2));
+    fusion2.addOutput(tv1);
+    tv1->split(0, 64);
+    tv1->axis(0)->parallelize(ParallelType::BIDx);
+    tv1->axis(1)->parallelize(ParallelType::TIDx);
+  }
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::manual_seed(0);
+  at::Tensor t0 = at::randn({1000}, options);
+  at::Tensor t1 = at::randn({16, 128}, options);
+  at::Tensor t2 = at::randn({300}, options);
+
+  FusionExecutor fe0;
+  fe0.compileFusion(&fusion0, {t0});
+  FusionExecutor fe1;
+  fe1.compileFusion(&fusion1, {t1});
+  FusionExecutor fe2;
+  fe2.compileFusion(&fusion2, {t2});
+
+  std::vector<FusionExecutor*> executors{&fe0, &fe1, &fe2};
+  for (auto executor : executors) {
+    TORCH_CHECK(HorizontalFusionExecutor::canPack(*executor));
+  }
+
+  auto args0 = KernelArgumentHolder::createKernelArgumentHolder({t0});
+  auto args1 = KernelArgumentHolder::createKernelArgumentHolder({t1});
+  auto args2 = KernelArgumentHolder::createKernelArgumentHolder({t2});
+
+  // See Note [Horizontal Fusion]
+  HorizontalFusionExecutor hfe;
+  auto outputs = hfe.runFusion(
+      executors, {&args0, &args1, &args2}, std::vector<LaunchParams>(3));
+  TORCH_CHECK(
+      hfe.kernelString().find("const uint3 blockIdx") != std::string::npos,
+      "Kernels weren't packed as device functions");
+
+  testValidate(&fusion0, outputs[0], {t0}, {t0 + 1}, __LINE__, __FILE__);
+  testValidate(&fusion1, outputs[1], {t1}, {t1.sum({1})}, __LINE__, __FILE__);
+  testValidate(&fusion2, outputs[2], {t2}, {t2 * 2}, __LINE__, __FILE__);
+}
+
+// Independent segments run by a FusionExecutorCache with horizontal fusion
+// enabled, where the RNG segment can't be packed with the others, see
+// Note [Horizontal Fusion]
+TEST_F(NVFuserTest, FusionExecutorCacheHorizontalFusion_CUDA) {
+  EnableOptionGuard horizontal_fusion(EnableOption::HorizontalFusion, true);
+
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeSymbolicTensor(2);
+  auto tv1 = makeSymbolicTensor(2);
+  auto tv2 = makeSymbolicTensor(1);
+  fusion->addInput(tv0);
+  fusion->addInput(tv1);
+  fusion->addInput(tv2);
+  // Reductions over different axes of one input can't share a kernel
+  auto tv3 = sum(tv0, {1});
+  auto tv4 = sum(tv0, {0});
+  auto tv5 = sum(tv1, {1});
+  auto tv6 = add(tv2, randlike(tv2));
+  fusion->addOutput(tv3);
+  fusion->addOutput(tv4);
+  fusion->addOutput(tv5);
+  fusion->addOutput(tv6);
+
+  FusionExecutorCache fec(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::manual_seed(0);
+  at::Tensor t0 = at::randn({256, 128}, options);
+  at::Tensor t1 = at::randn({64, 512}, options);
+  at::Tensor t2 = at::randn({1000}, options);
+
+  // The second run launches the kernels compiled by the first
+  for (const auto i : c10::irange(2)) {
+    (void)i; // Suppress unused variable warning
+    auto cg_outputs = fec.runFusionWithInputs({t0, t1, t2});
+
+    auto runtime = fec.getMostRecentKernelRuntime();
+    TORCH_CHECK(runtime->isSegmented());
+    auto waves = runtime->fusionSegments()->independentGroupWaves();
+    TORCH_CHECK(waves.front().size() > 1, "No independent segments");
+
+    TORCH_CHECK(cg_outputs[0].allclose(t0.sum({1}), 1e-3, 1e-3));
+    TORCH_CHECK(cg_outputs[1].allclose(t0.sum({0}), 1e-3, 1e-3));
+    TORCH_CHECK(cg_outputs[2].allclose(t1.sum({1}), 1e-3, 1e-3));
+    auto rand_values = cg_outputs[3] - t2;
+    TORCH_CHECK(rand_values.ge(0).all().item<bool>());
+    TORCH_CHECK(rand_values.le(1).all().item<bool>());
+  }
+}
+
+// Host packing and code generation of a batched fusion, which don't need a
+// device, see Note [Batched Fusion]
+TEST(NVFuserHostTest, FusionBatchedFusionTable) {
+  auto options = at::TensorOptions().dtype(at::kFloat);
+  std::vector<std::vector<at::Tensor>> tensor_sets{
+      {at::empty({300}, options), at::empty({10, 30}, options)},
+      {at::empty({50}, options), at::empty({50}, options)},
+      {at::empty({0}, options), at::empty({0}, options)}};
+
+  auto table = BatchedFusionExecutor::packTable(tensor_sets, 128);
+
+  // (set index, chunk start) of each chunk, then (numel, data pointers) of
+  // each set
+  std::vector<int64_t> expected_words{0, 0, 0, 128, 0, 256, 1, 0};
+  for (const auto& tensors : tensor_sets) {
+    expected_words.push_back(tensors.front().numel());
+    for (const auto& tensor : tensors) {
+      expected_words.push_back(reinterpret_cast<int64_t>(tensor.data_ptr()));
+    }
+  }
+  TORCH_CHECK(table.num_chunks == 4);
+  TORCH_CHECK(table.words == expected_words);
+
+  // The kernel reads the 2 inputs and the output of its set from the table,
+  // and takes the scalar as a parameter
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+  auto tv0 = makeContigTensor(1);
+  auto tv1 = makeContigTensor(1);
+  auto lr = IrBuilder::create<Double>();
+  fusion.addInput(tv0);
+  fusion.addInput(tv1);
+  fusion.addInput(lr);
+  auto tv2 = sub(tv0, mul(lr, tv1));
+  fusion.addOutput(tv2);
+  tv2->split(0, 128);
+  tv2->axis(1)->parallelize(ParallelType::TIDx);
+  tv0->computeAt(tv2, -1);
+  tv1->computeAt(tv2, -1);
+  scheduler_utils::parallelizeAllLike(tv2);
+
+  GpuLower lower(&fusion);
+  auto code = codegen::generateBatchedCudaKernel(lower.kernel(), "batched");
+  for (const auto& expected :
+       {"__global__ void batched(Tensor<int64_t, 1> table",
+        ", double ",
+        "table.data + num_chunks * 2 + chunk[0] * 4",
+        "tensor_set[3]) + chunk_start",
+        "batched_chunk("}) {
+    TORCH_CHECK(
+        code.find(expected) != std::string::npos,
+        "Missing ",
+        expected,
+        " in:\n",
+        code);
+  }
+  TORCH_CHECK(code.find("tensor_set[4]") == std::string::npos, code);
+}
+
+TEST_F(NVFuserTest, FusionBatchedFusion_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  // An SGD style update, tv0 - lr * tv1
+  auto tv0 = makeContigTensor(1);
+  auto tv1 = makeContigTensor(1);
+  auto lr = IrBuilder::create<Double>();
+  fusion.addInput(tv0);
+  fusion.addInput(tv1);
+  fusion.addInput(lr);
+  auto tv2 = sub(tv0, mul(lr, tv1));
+  fusion.addOutput(tv2);
+
+  // Scheduled for a single chunk, without block parallelization
+  tv2->split(0, 128);
+  tv2->axis(1)->parallelize(ParallelType::TIDx);
+  tv0->computeAt(tv2, -1);
+  tv1->computeAt(tv2, -1);
+  scheduler_utils::parallelizeAllLike(tv2);
+
+  BatchedFusionExecutor bfe;
+  bfe.compileFusion(&fusion, 512);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::manual_seed(0);
+  std::vector<std::vector<c10::IValue>> input_sets;
+  std::vector<at::Tensor> expected_outputs;
+  for (auto size : {1000, 7, 2048, 513}) {
+    auto t0 = at::randn({size}, options);
+    auto t1 = at::randn({size}, options);
+    input_sets.push_back({t0, t1, 0.1});
+    expected_outputs.push_back(t0 - 0.1 * t1);
+  }
+
+  auto outputs = bfe.runFusion(input_sets);
+  for (const auto i : c10::irange(input_sets.size())) {
+    testValidate(
+        &fusion,
+        outputs[i],
+        input_sets[i],
+        {expected_outputs[i]},
+        __LINE__,
+        __FILE__);
+  }
+
+  // Every set is checked against the dtypes and device of the kernel
+  auto t0 = at::randn({100}, options);
+  auto t1 = at::randn({100}, options);
+  ASSERT_ANY_THROW(bfe.runFusion({{t0, t1, 0.1}, {t0, t1.to(at::kHalf), 0.1}}));
+  ASSERT_ANY_THROW(bfe.runFusion({{t0, t1, 0.1}, {t0.cpu(), t1.cpu(), 0.1}}));
+  // Scalars are shared by all sets
+  ASSERT_ANY_THROW(bfe.runFusion({{t0, t1, 0.1}, {t0, t1, 0.2}}));
+}
+
+TEST_F(NVFuserTest, FusionCircularBufferedOuterReduction_CUDA) {
+  // cp.async requires ampere+ GPU
+  if (!deviceMajorMinorCheck(8)) {
+    GTEST_SKIP() << "skipping tests on pre-AMPERE GPUs";
+    return;
+  }
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  std::vector<int64_t> input_shape{65536, 1024};
+  TensorView* tv0 = makeContigTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = sum(tv0, {0});
+  fusion.addOutput(tv1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor aten_input = at::randn(input_shape, options);
+  auto aten_output = aten_input.to(at::kDouble).sum({0});
+
+  auto reduction_params = getReductionHeuristics(&fusion, {aten_input});
+  TORCH_CHECK(reduction_params, "Reduction schedule was not generated!");
+  TORCH_CHECK(reduction_params->vectorize_iter_dom);
+
+  // Force the loads of the serial reduction loop through shared memory
+  reduction_params->circular_buffer_stages = 3;
+  scheduleReduction(&fusion, *reduction_params);
+
+  auto all_tvs = ir_utils::allTvs(&fusion);
+  TORCH_CHECK(
+      std::any_of(
+          all_tvs.begin(),
+          all_tvs.end(),
+          [](TensorView* tv) {
+            return tv->getMemoryType() == MemoryType::Shared &&
+                tv->isCircularBuffered();
+          }),
+      "Input loads were not circular buffered");
+
+  auto lparams = reduction_params->lparams;
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {aten_input}, lparams);
+  auto cg_outputs = fe.runFusion({aten_input}, lparams);
+
+  testValidate(
+      &fusion,
+      cg_outputs,
+      {aten_input},
+      {aten_output},
+      __LINE__,
+      __FILE__,
+      "",
+      lparams);
+}
+
+// Wide pointwise fusions stream their inputs through a ring of shared memory
+// tiles, see Note [Pointwise Load Ring]
+TEST_F(NVFuserTest, FusionPointwiseLoadRing_CUDA) {
+  // cp.async requires ampere+ GPU
+  if (!deviceMajorMinorCheck(8)) {
+    GTEST_SKIP() << "skipping tests on pre-AMPERE GPUs";
+    return;
+  }
+
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  constexpr int kNumInputs = 6;
+  std::vector<int64_t> shape{1 << 22};
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  TensorView* result = nullptr;
+  std::vector<IValue> aten_inputs;
+  at::Tensor aten_output;
+  for (auto i : c10::irange(kNumInputs)) {
+    auto tv = makeContigTensor(1);
+    fusion.addInput(tv);
+    auto t = at::randn(shape, options);
+    aten_inputs.push_back(t);
+    if (result == nullptr) {
+      result = tv;
+      aten_output = t;
+    } else {
+      result = i % 2 ? mul(result, tv) : add(result, tv);
+      aten_output = i % 2 ? aten_output * t : aten_output + t;
+    }
+  }
+  fusion.addOutput(result);
+
+  auto params = getPointwiseHeuristics(&fusion, aten_inputs);
+  TORCH_CHECK(params->circular_buffer_stages > 1);
+  TORCH_CHECK(params->tiles_per_block >= params->circular_buffer_stages);
+  schedulePointwise(&fusion, *params);
 
-  auto lparams = reduction_params->lparams;
+  auto all_tvs = ir_utils::allTvs(&fusion);
+  TORCH_CHECK(
+      std::count_if(
+          all_tvs.begin(),
+          all_tvs.end(),
+          [](TensorView* tv) {
+            return tv->getMemoryType() == MemoryType::Shared &&
+                tv->isCircularBuffered();
+          }) == kNumInputs,
+      "Inputs were not loaded through the ring");
 
-  torch::jit::fuser::cuda::FusionExecutor fe;
-  fe.compileFusion(&fusion, {aten_input}, lparams);
-  auto cg_outputs = fe.runFusion({aten_input}, lparams);
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, aten_inputs, params->lparams);
+  auto cg_outputs = fe.runFusion(aten_inputs, params->lparams);
 
   testValidate(
       &fusion,
       cg_outputs,
-      {aten_input},
+      aten_inputs,
       {aten_output},
       __LINE__,
       __FILE__,
       "",
-      lparams);
+      params->lparams);
 }
 
 TEST_F(NVFuserTest, FusionTestMaskSoftmax_CUDA) {
@@ -11572,6 +12359,293 @@ TEST_F(NVFuserTest, FusionDisjointSet_CUDA) {
   }
 }
 
+// UnionFind must produce the same sets, in the same order, as DisjointSets
+// for the same sequence of operations as ComputeAtMap relies on that for
+// deterministic concrete ID selection.
+TEST_F(NVFuserTest, FusionUnionFind_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  std::vector<Val*> vals;
+  for (const auto i : c10::irange(64)) {
+    vals.push_back(IrBuilder::create<Int>(i));
+  }
+
+  std::mt19937 rng(0);
+  for (const auto trial : c10::irange(20)) {
+    (void)trial;
+    DisjointSets<Val*> disjoint_sets;
+    UnionFind<Val*> union_find;
+    for (const auto i : c10::irange(vals.size() * 2)) {
+      (void)i;
+      auto val0 = vals[rng() % vals.size()];
+      auto val1 = vals[rng() % vals.size()];
+      if (rng() % 3 == 0) {
+        disjoint_sets.initializeSet(val0);
+        union_find.initializeSet(val0);
+      } else {
+        disjoint_sets.mapEntries(val0, val1);
+        union_find.mapEntries(val0, val1);
+      }
+      TORCH_CHECK(
+          disjoint_sets.permissiveAreMapped(val0, val1) ==
+          union_find.permissiveAreMapped(val0, val1));
+    }
+
+    TORCH_CHECK(union_find.numSets() == disjoint_sets.disjointSets().size());
+    for (const auto& set : disjoint_sets.disjointSets()) {
+      TORCH_CHECK(union_find.getMembersOf(set->front()) == set->vector());
+    }
+
+    auto materialized = union_find.toDisjointSets();
+    TORCH_CHECK(
+        materialized.disjointSets().size() ==
+        disjoint_sets.disjointSets().size());
+    for (const auto i : c10::irange(materialized.disjointSets().size())) {
+      TORCH_CHECK(
+          materialized.disjointSets()[i]->vector() ==
+          disjoint_sets.disjointSets()[i]->vector());
+    }
+  }
+}
+
+// Traversals are memoized until the fusion is mutated, see
+// Note [Fusion Analysis Cache]
+TEST_F(NVFuserTest, FusionAnalysisCache_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tv1 = add(tv0, IrBuilder::create<Double>(1));
+  auto tv2 = sum(tv1, {1});
+  fusion.addOutput(tv2);
+
+  auto exprs = fusion.exprs();
+  auto all_tvs = ir_utils::allTvs(&fusion);
+  auto version = fusion.version();
+
+  // Nothing changed, results must be identical
+  TORCH_CHECK(fusion.exprs() == exprs);
+  TORCH_CHECK(StmtSort::getExprs(&fusion) == exprs);
+  TORCH_CHECK(ir_utils::allTvs(&fusion) == all_tvs);
+  TORCH_CHECK(fusion.version() == version);
+
+  // Adding an output must invalidate
+  auto tv3 = add(tv2, IrBuilder::create<Double>(1));
+  fusion.addOutput(tv3);
+  TORCH_CHECK(fusion.version() != version);
+  TORCH_CHECK(fusion.exprs().size() == exprs.size() + 1);
+  TORCH_CHECK(ir_utils::allTvs(&fusion).size() == all_tvs.size() + 1);
+
+  // Scheduling registers new exprs, exprs() excludes IterDomain exprs but
+  // the results must still be recomputed correctly
+  version = fusion.version();
+  tv1->split(1, 4);
+  TORCH_CHECK(fusion.version() != version);
+  TORCH_CHECK(fusion.exprs().size() == exprs.size() + 1);
+
+  // A copy doesn't share the cache
+  Fusion fusion_copy(fusion);
+  TORCH_CHECK(fusion_copy.exprs().size() == fusion.exprs().size());
+  for (auto expr : fusion_copy.exprs()) {
+    TORCH_CHECK(expr->fusion() == &fusion_copy);
+  }
+}
+
+// See Note [Fusion Signature]
+TEST_F(NVFuserTest, FusionStructuralHash_CUDA) {
+  auto make_fusion = [](int reduction_axis, double scale, bool shift_names) {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    if (shift_names) {
+      // Unused statements only change the names of the ones that follow
+      IrBuilder::create<Int>();
+      makeSymbolicTensor(1);
+    }
+    auto tv0 = makeSymbolicTensor(2);
+    auto tv1 = makeSymbolicTensor(2, DataType::Half);
+    fusion->addInput(tv0);
+    fusion->addInput(tv1);
+    auto tv2 = mul(tv0, IrBuilder::create<Double>(scale));
+    auto tv3 = add(tv2, castOp(DataType::Float, tv1));
+    auto tv4 = sum(tv3, {reduction_axis});
+    auto tv5 = broadcast(tv4, {reduction_axis == 0, reduction_axis == 1});
+    auto tv6 = div(tv3, tv5);
+    fusion->addOutput(tv6);
+    return fusion;
+  };
+
+  auto fusion = make_fusion(1, 2.0, false);
+  FusionSignature signature(fusion.get());
+
+  // Names and copies don't matter
+  auto renamed = make_fusion(1, 2.0, true);
+  TORCH_CHECK(structurallyEqual(fusion.get(), renamed.get()));
+  TORCH_CHECK(signature.hash() == structuralHash(renamed.get()));
+  Fusion fusion_copy(*fusion);
+  TORCH_CHECK(FusionSignature(&fusion_copy) == signature);
+
+  // Structure, constants and aliasing do
+  TORCH_CHECK(
+      FusionSignature(make_fusion(0, 2.0, false).get()) != signature);
+  TORCH_CHECK(
+      FusionSignature(make_fusion(1, 3.0, false).get()) != signature);
+  fusion_copy.aliasOutputToInput(
+      fusion_copy.outputs()[0], fusion_copy.inputs()[0]);
+  TORCH_CHECK(FusionSignature(&fusion_copy) != signature);
+
+  // Guarding a fusion to a segment signs the segment only
+  auto segment = make_fusion(1, 2.0, false);
+  auto segment_out = segment->outputs()[0]->definition()->input(1);
+  segment->removeOutput(segment->outputs()[0]);
+  segment->addOutput(segment_out);
+  TORCH_CHECK(FusionSignature(segment.get()).size() < signature.size());
+}
+
+// Op attributes and dtypes are part of the signature of even long fusions,
+// see Note [Fusion Signature]
+TEST_F(NVFuserTest, FusionStructuralHashAttributes_CUDA) {
+  auto make_fusion =
+      [](DataType dtype, BinaryOpType reduction_op_type, bool shift_names) {
+        auto fusion = std::make_unique<Fusion>();
+        FusionGuard fg(fusion.get());
+        if (shift_names) {
+          IrBuilder::create<Double>();
+        }
+        auto tv0 = makeSymbolicTensor(3, dtype);
+        fusion->addInput(tv0);
+        TensorView* tv = castOp(DataType::Float, tv0);
+        for (const auto i : c10::irange(200)) {
+          tv = add(tv, IrBuilder::create<Double>(i));
+          if (i % 50 == 49) {
+            auto reduction = reductionOp(
+                reduction_op_type, {2}, IrBuilder::create<Double>(0), tv);
+            tv = broadcast(reduction, {false, false, true});
+          }
+        }
+        fusion->addOutput(tv);
+        return fusion;
+      };
+
+  auto fusion = make_fusion(DataType::Half, BinaryOpType::Add, false);
+  FusionSignature signature(fusion.get());
+
+  // Clones and renumbered IR sign the same
+  Fusion fusion_copy(*fusion);
+  TORCH_CHECK(FusionSignature(&fusion_copy) == signature);
+  TORCH_CHECK(
+      FusionSignature(
+          make_fusion(DataType::Half, BinaryOpType::Add, true).get()) ==
+      signature);
+
+  // A changed op attribute or input dtype doesn't
+  TORCH_CHECK(
+      FusionSignature(
+          make_fusion(DataType::Half, BinaryOpType::Max, false).get()) !=
+      signature);
+  TORCH_CHECK(
+      FusionSignature(
+          make_fusion(DataType::Float, BinaryOpType::Add, false).get()) !=
+      signature);
+}
+
+// Matmul fusions that only differ in their mma options don't share a
+// signature, see Note [Fusion Signature]
+TEST_F(NVFuserTest, FusionStructuralHashMmaOptions_CUDA) {
+  auto make_fusion = [](c10::optional<MmaOptions::MmaInputLayout> layout) {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2, DataType::Half);
+    auto tv1 = makeContigTensor(2, DataType::Half);
+    fusion->addInput(tv0);
+    fusion->addInput(tv1);
+    auto tv0b = broadcast(tv0, {false, false, true});
+    auto tv1b = broadcast(tv1, {true, false, false});
+    auto tv2 = fusedMultiplySum(tv0b, tv1b, {1});
+    fusion->addOutput(tv2);
+    if (layout.has_value()) {
+      MmaOptions options;
+      options.macro = MmaOptions::MacroType::Ampere_16_8_16;
+      options.operand_layout = layout.value();
+      options.accumulator_stride = 1;
+      tv2->definition()->as<MmaOp>()->configureOptions(options);
+    }
+    return fusion;
+  };
+
+  auto tt = make_fusion(MmaOptions::MmaInputLayout::TT);
+  Fusion tt_copy(*tt);
+  TORCH_CHECK(structurallyEqual(tt.get(), &tt_copy));
+  TORCH_CHECK(!structurallyEqual(
+      tt.get(), make_fusion(MmaOptions::MmaInputLayout::TN).get()));
+  TORCH_CHECK(!structurallyEqual(tt.get(), make_fusion(c10::nullopt).get()));
+}
+
+// Structurally equal fusions share heuristics, see
+// Note [Heuristic Params Cache]
+TEST_F(NVFuserTest, FusionHeuristicParamsCache_CUDA) {
+  if (isOptionDisabled(DisableOption::HeuristicCache)) {
+    GTEST_SKIP() << "heuristic cache disabled";
+  }
+
+  auto make_fusion = []() {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(2);
+    fusion->addInput(tv0);
+    auto tv1 = add(tv0, IrBuilder::create<Double>(1));
+    auto tv2 = sum(tv1, {1});
+    fusion->addOutput(tv2);
+    return fusion;
+  };
+
+  auto& heuristic_cache = HeuristicParamsCache::get();
+  heuristic_cache.clear();
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({128, 1024}, options);
+  auto ref = (t0 + 1).sum({1});
+
+  FusionExecutorCache fec0(make_fusion());
+  auto cg_outputs0 = fec0.runFusionWithInputs({t0});
+  auto stats = heuristic_cache.stats();
+  TORCH_CHECK(stats.hits == 0 && stats.misses == 1 && stats.size == 1);
+
+  // A second, separately built fusion reuses the parameters
+  FusionExecutorCache fec1(make_fusion());
+  auto cg_outputs1 = fec1.runFusionWithInputs({t0});
+  stats = heuristic_cache.stats();
+  TORCH_CHECK(stats.hits == 1 && stats.misses == 1 && stats.size == 1);
+  TORCH_CHECK(fec0.getMostRecentKernelRuntime()
+                  ->schedulerHeuristics()
+                  ->heuristicsList()
+                  .at(0)
+                  ->sameAs(fec1.getMostRecentKernelRuntime()
+                               ->schedulerHeuristics()
+                               ->heuristicsList()
+                               .at(0)
+                               .get()));
+
+  // Different sizes are a different entry
+  at::Tensor t1 = at::randn({128, 4}, options);
+  FusionExecutorCache fec2(make_fusion());
+  fec2.runFusionWithInputs({t1});
+  stats = heuristic_cache.stats();
+  TORCH_CHECK(stats.misses == 2 && stats.size == 2);
+
+  // Shrinking the cache evicts the least recently used entry
+  heuristic_cache.setMaxSize(1);
+  stats = heuristic_cache.stats();
+  TORCH_CHECK(stats.size == 1 && stats.evictions == 1);
+
+  testValidate(fec0.fusion(), cg_outputs0, {t0}, {ref}, __LINE__, __FILE__);
+  testValidate(fec1.fusion(), cg_outputs1, {t0}, {ref}, __LINE__, __FILE__);
+
+  heuristic_cache.clear();
+  heuristic_cache.setMaxSize(4096);
+}
+
 TEST_F(NVFuserTest, FusionNonUniqueBroadcastSize_CUDA) {
   Fusion fusion;
   FusionGuard fg(&fusion);
@@ -12873,6 +13947,52 @@ TEST_F(NVFuserTest, FusionWelfordOp_CUDA) {
       __FILE__);
 }
 
+TEST_F(NVFuserTest, FusionChunkedWelford_CUDA) {
+  Fusion fusion;
+  FusionGuard fg(&fusion);
+
+  // N isn't a multiple of the chunk, so the last chunk is partially valid
+  int M = 64, N = 130;
+
+  auto tv0 = makeSymbolicTensor(2);
+  fusion.addInput(tv0);
+  auto tvs = Welford(tv0, {1});
+  auto tv_avg = set(tvs.avg);
+  auto tv_M2 = set(tvs.var_sum);
+  fusion.addOutput(tv_avg);
+  fusion.addOutput(tv_M2);
+
+  // [I, R/4, R4] with the inner reduction unrolled
+  tvs.avg->split(1, 4);
+  tvs.avg->axis(-1)->parallelize(ParallelType::Unroll);
+  tvs.avg->computeAt(tv_avg, 1);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::manual_seed(0);
+  at::Tensor t0 = at::randn({M, N}, options);
+
+  FusionExecutor fe;
+  fe.compileFusion(&fusion, {t0});
+
+  // See Note [Chunked Welford]
+  TORCH_CHECK(
+      fe.kernelString().find("welfordChunkCombine") != std::string::npos,
+      "Unrolled welford wasn't merged in chunks");
+
+  auto outputs = fe.runFusion({t0});
+
+  // by default Welford outputs sum of square diff so need to divide to get var
+  outputs[1] /= N;
+
+  testValidate(
+      fe.kernel(),
+      outputs,
+      {t0},
+      {t0.mean({1}), t0.var({1}, false)},
+      __LINE__,
+      __FILE__);
+}
+
 TEST_F(NVFuserTest, FusionBlockWelfordOp_CUDA) {
   Fusion fusion;
   FusionGuard fg(&fusion);
@@ -15716,6 +16836,62 @@ TEST_F(NVFuserTest, FusionSegmentMixReduction_CUDA) {
   TORCH_CHECK(segmented_fusion->groups().size() <= 2);
 }
 
+TEST_F(NVFuserTest, FusionSegmentParallelProbing_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+
+  auto tv0 = makeSymbolicTensor(3);
+
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {2});
+  auto tv2 = broadcast(tv1, {false, false, true});
+  auto tv3 = add(tv0, tv2);
+  auto tv4 = sum(tv3, {0});
+  auto tv5 = broadcast(tv4, {true, false, false});
+  auto tv6 = add(tv3, tv5);
+  auto tv7 = sum(tv6, {1});
+  auto tv8 = unaryOp(UnaryOpType::Rsqrt, tv0);
+  auto tv9 = sum(tv8, {0, 1});
+
+  fusion->addOutput(tv7);
+  fusion->addOutput(tv9);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({8, 16, 32}, options);
+
+  KernelArgumentHolder args(KernelIndexMode::INT32);
+  args.setDeviceIndex(0);
+  args.push(t0);
+
+  SegmentCandidateFinderOptions serial_options;
+  SegmentCandidateFinderOptions parallel_options;
+  parallel_options.run_parallel_probing = true;
+
+  auto serial_segments =
+      SegmentCandidateFinder::segment(fusion.get(), args, serial_options);
+  auto parallel_segments =
+      SegmentCandidateFinder::segment(fusion.get(), args, parallel_options);
+
+  // Probing in parallel must not change which groups get merged
+  auto group_signature = [](SegmentedGroup* group) {
+    std::vector<StmtNameType> expr_names;
+    for (auto expr : group->exprs()) {
+      expr_names.push_back(expr->name());
+    }
+    std::sort(expr_names.begin(), expr_names.end());
+    return std::make_pair(group->heuristic(), expr_names);
+  };
+
+  TORCH_CHECK(serial_segments->groups().size() > 1);
+  TORCH_CHECK(
+      serial_segments->groups().size() == parallel_segments->groups().size());
+  for (const auto i : c10::irange(serial_segments->groups().size())) {
+    TORCH_CHECK(
+        group_signature(serial_segments->groups()[i]) ==
+        group_signature(parallel_segments->groups()[i]));
+  }
+}
+
 TEST_F(NVFuserTest, FusionSBAR_CUDA) {
   Fusion fusion;
   FusionGuard fg(&fusion);
@@ -23152,6 +24328,149 @@ TEST_F(NVFuserMultithreadedTest, MultipleFunctions_CUDA) {
   }
 }
 
+// Runs of independent caches and of a shared cache from multiple threads.
+// Only runs of the same FusionExecutorCache are serialized, so the threads
+// interleave compiling and running the independent caches.
+TEST_F(NVFuserMultithreadedTest, ConcurrentCaches_CUDA) {
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kRunsPerThread = 20;
+
+  auto make_cache = [](double offset) {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeSymbolicTensor(2);
+    fusion->addInput(tv0);
+    auto tv1 = add(tv0, IrBuilder::create<Double>(offset));
+    auto tv2 = sum(tv1, {1});
+    fusion->addOutput(tv2);
+    return std::make_unique<FusionExecutorCache>(std::move(fusion));
+  };
+
+  std::vector<std::unique_ptr<FusionExecutorCache>> caches;
+  for (const auto i : c10::irange(kNumThreads)) {
+    caches.emplace_back(make_cache((double)i));
+  }
+  auto shared_cache = make_cache(-1.0);
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({128, 64}, options);
+
+  auto run = [&](size_t id) {
+    for (const auto i : c10::irange(kRunsPerThread)) {
+      (void)i; // Suppress unused variable warning
+      auto outputs = caches[id]->runFusionWithInputs({t0});
+      ASSERT_TRUE(
+          at::allclose(outputs[0], (t0 + (double)id).sum({1}), 1e-4, 1e-4));
+      auto shared_outputs = shared_cache->runFusionWithInputs({t0});
+      ASSERT_TRUE(
+          at::allclose(shared_outputs[0], (t0 - 1.0).sum({1}), 1e-4, 1e-4));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < kNumThreads; ++id) {
+    threads.emplace_back(run, id);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+// Runs of one FusionExecutorCache from multiple threads, each on its own
+// stream and with its own input sizes, so that threads both insert into and
+// hit the runtime index concurrently
+TEST_F(NVFuserMultithreadedTest, SharedCacheConcurrentRuns_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sin(tv0);
+  auto tv2 = sum(tv1, {1});
+  fusion->addOutput(tv2);
+
+  FusionExecutorCache fec(std::move(fusion));
+
+  constexpr size_t kNumThreads = 4;
+  constexpr size_t kNumRuns = 20;
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+
+  auto run = [&](size_t id) {
+    auto stream = c10::cuda::getStreamFromPool();
+    c10::cuda::CUDAStreamGuard stream_guard(stream);
+    for (const auto i : c10::irange(kNumRuns)) {
+      // Alternate between input sizes shared by all threads and input sizes
+      // unique to this thread
+      int64_t rows = i % 2 == 0 ? 64 : 64 + id + 1;
+      at::Tensor t0 = at::randn({rows, 128 * (int64_t)(i % 3 + 1)}, options);
+      auto cg_outputs = fec.runFusionWithInputs({t0});
+      auto ref = t0.sin().sum({1});
+      ASSERT_TRUE(at::allclose(cg_outputs[0], ref, 1e-4, 1e-4));
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (size_t id = 0; id < kNumThreads; ++id) {
+    threads.emplace_back(run, id);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+}
+
+// New input ids that are matched against a segmented runtime while other
+// threads are running that runtime, see [ Note -- Concurrent Executions ]
+TEST_F(NVFuserMultithreadedTest, RuntimeReuseWhileRunning_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sum(tv0, {1});
+  auto tv2 = broadcast(tv1, {false, true});
+  auto tv3 = add(tv0, tv2);
+  auto tv4 = sum(tv3, {0});
+  fusion->addOutput(tv4);
+
+  FusionExecutorCache fec(std::move(fusion));
+
+  constexpr size_t kNumRuns = 50;
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  auto ref_of = [](const at::Tensor& t) {
+    return (t + t.sum({1}).unsqueeze(1)).sum({0});
+  };
+
+  at::Tensor t0 = at::randn({256, 128}, options);
+  auto outputs = fec.runFusionWithInputs({t0});
+  ASSERT_TRUE(fec.getMostRecentKernelRuntime()->isSegmented());
+  ASSERT_TRUE(at::allclose(outputs[0], ref_of(t0), 1e-3, 1e-3));
+
+  // Keeps running the first input id
+  auto run_first = [&]() {
+    auto stream = c10::cuda::getStreamFromPool();
+    c10::cuda::CUDAStreamGuard stream_guard(stream);
+    for (const auto i : c10::irange(kNumRuns)) {
+      (void)i; // Suppress unused variable warning
+      auto cg_outputs = fec.runFusionWithInputs({t0});
+      ASSERT_TRUE(at::allclose(cg_outputs[0], ref_of(t0), 1e-3, 1e-3));
+    }
+  };
+
+  // Every run is a new input id, most of which reuse the runtime above
+  auto run_new_ids = [&]() {
+    auto stream = c10::cuda::getStreamFromPool();
+    c10::cuda::CUDAStreamGuard stream_guard(stream);
+    for (const auto i : c10::irange(kNumRuns)) {
+      at::Tensor t1 = at::randn({256 + (int64_t)i + 1, 128}, options);
+      auto cg_outputs = fec.runFusionWithInputs({t1});
+      ASSERT_TRUE(at::allclose(cg_outputs[0], ref_of(t1), 1e-3, 1e-3));
+    }
+  };
+
+  std::thread first(run_first);
+  std::thread new_ids(run_new_ids);
+  first.join();
+  new_ids.join();
+}
+
 // Repro of issue #1655
 TEST_F(NVFuserTest, FusionIncompleteConcreteID_CUDA) {
   Fusion fusion;
@@ -25808,6 +27127,52 @@ TEST_F(NVFuserTest, FusionMergeBroadcastingTrivialReduction2_CUDA) {
       fusion, {out}, {t0, t1}, {t1 + t0.squeeze(-1)}, __LINE__, __FILE__);
 }
 
+// Runs several input sets through one FusionExecutorCache call, with sets
+// of two different shapes spread over two streams. The inputs are produced on
+// the current stream, which the streams of the batch wait for.
+TEST_F(NVFuserTest, FusionExecutorCacheBatchedRuns_CUDA) {
+  auto fusion = std::make_unique<Fusion>();
+  FusionGuard fg(fusion.get());
+  auto tv0 = makeSymbolicTensor(2);
+  fusion->addInput(tv0);
+  auto tv1 = sin(tv0);
+  auto tv2 = sum(tv1, {1});
+  fusion->addOutput(tv1);
+  fusion->addOutput(tv2);
+
+  FusionExecutorCache fec(std::move(fusion));
+
+  auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+  std::vector<at::Tensor> inputs;
+  std::vector<std::vector<IValue>> input_sets;
+  for (const auto i : c10::irange(6)) {
+    inputs.push_back(at::randn({i % 2 == 0 ? 64 : 96, 128}, options));
+    input_sets.push_back({inputs.back()});
+  }
+  std::vector<c10::cuda::CUDAStream> streams = {
+      c10::cuda::getStreamFromPool(), c10::cuda::getStreamFromPool()};
+
+  auto outputs_list = fec.runFusionWithInputsBatch(input_sets, streams);
+  for (auto& stream : streams) {
+    stream.synchronize();
+  }
+
+  ASSERT_EQ(outputs_list.size(), input_sets.size());
+  for (const auto i : c10::irange(inputs.size())) {
+    testValidate(
+        fec.fusion(),
+        outputs_list[i],
+        input_sets[i],
+        {inputs[i].sin(), inputs[i].sin().sum({1})},
+        __LINE__,
+        __FILE__);
+  }
+
+  // The batch gives the same results as running the sets one by one
+  auto outputs = fec.runFusionWithInputs(input_sets[1]);
+  ASSERT_TRUE(outputs[1].equal(outputs_list[1][1]));
+}
+
 } // namespace jit
 } // namespace torch
 #endif // #if defined(USE_CUDA)
@@ -7,6 +7,7 @@
 #include <third_party/nvfuser/fusion.h>
 #include <third_party/nvfuser/ir_all_nodes.h>
 #include <third_party/nvfuser/kernel_cache.h>
+#include <third_party/nvfuser/ops/all_ops.h>
 #include <third_party/nvfuser/scheduler/all_schedulers.h>
 #include <third_party/nvfuser/test/test_gpu_validator.h>
 #include <third_party/nvfuser/test/test_utils.h>
@@ -27,8 +28,8 @@ using namespace torch::jit::fuser::cuda;
 
 namespace {
 
-template <typename T>
-__global__ void generate_uniform_kernel(
+template <typename T, bool normal>
+__global__ void generate_random_kernel(
     T* output,
     int64_t size,
     PhiloxCudaState philox_args) {
@@ -39,7 +40,8 @@ __global__ void generate_uniform_kernel(
   curand_init(std::get<0>(seeds), tid, std::get<1>(seeds), &state);
 
   if (std::is_same<T, double>::value) {
-    double2 result = curand_uniform2_double(&state);
+    double2 result = normal ? curand_normal2_double(&state)
+                            : curand_uniform2_double(&state);
     if (tid * 2 < size) {
       output[tid * 2] = result.x;
     }
@@ -49,7 +51,7 @@ __global__ void generate_uniform_kernel(
   } else {
     auto is_float = std::is_same<T, float>::value;
     assert(is_float);
-    float4 result = curand_uniform4(&state);
+    float4 result = normal ? curand_normal4(&state) : curand_uniform4(&state);
     if (tid * 4 < size) {
       output[tid * 4] = result.x;
     }
@@ -65,7 +67,8 @@ __global__ void generate_uniform_kernel(
   }
 }
 
-at::Tensor generate_uniform(int64_t size, at::ScalarType dtype) {
+template <bool normal>
+at::Tensor generate_random(int64_t size, at::ScalarType dtype) {
   auto options = at::TensorOptions().dtype(dtype).device(at::kCUDA, 0);
   auto result = at::empty({size}, options);
 
@@ -82,7 +85,7 @@ at::Tensor generate_uniform(int64_t size, at::ScalarType dtype) {
     int64_t block = 128;
     int64_t block_elems = block * 4;
     int64_t grid = (size + block_elems - 1) / block_elems;
-    generate_uniform_kernel<<<
+    generate_random_kernel<float, normal><<<
         grid,
         block,
         0,
@@ -93,7 +96,7 @@ at::Tensor generate_uniform(int64_t size, at::ScalarType dtype) {
     int64_t block = 128;
     int64_t block_elems = block * 2;
     int64_t grid = (size + block_elems - 1) / block_elems;
-    generate_uniform_kernel<<<
+    generate_random_kernel<double, normal><<<
         grid,
         block,
         0,
@@ -103,6 +106,14 @@ at::Tensor generate_uniform(int64_t size, at::ScalarType dtype) {
   return result;
 }
 
+at::Tensor generate_uniform(int64_t size, at::ScalarType dtype) {
+  return generate_random<false>(size, dtype);
+}
+
+at::Tensor generate_normal(int64_t size, at::ScalarType dtype) {
+  return generate_random<true>(size, dtype);
+}
+
 } // namespace
 
 TEST_F(NVFuserTest, FusionRNGValidateWithCURand_CUDA) {
@@ -166,6 +177,115 @@ TEST_F(NVFuserTest, FusionRNGManualScheduleValidateWithCURand_CUDA) {
   testValidate(fusion, {out}, {t0}, {ref}, __LINE__, __FILE__);
 }
 
+TEST_F(NVFuserTest, FusionRNGNormalValidateWithCURand_CUDA) {
+  std::unique_ptr<Fusion> fusion_ptr = std::make_unique<Fusion>();
+  auto fusion = fusion_ptr.get();
+  FusionGuard fg(fusion);
+
+  Int* size_val = IrBuilder::create<Int>();
+  fusion->addInput(size_val);
+  TensorView* tv0 = randn({size_val}, DataType::Float);
+  TensorView* tv1 = randn({size_val}, DataType::Double);
+  fusion->addOutput(tv0);
+  fusion->addOutput(tv1);
+
+  FusionExecutorCache fec(std::move(fusion_ptr));
+
+  for (int64_t size : {16, 1024, 10001, 10002, 10003, 100000, 10000001}) {
+    at::manual_seed(0);
+    auto cg_outputs = fec.runFusionWithInputs({size});
+
+    at::manual_seed(0);
+    auto ref0 = generate_normal(size, kFloat);
+    auto ref1 = generate_normal(size, kDouble);
+
+    testValidate(
+        fec.fusion(), cg_outputs, {size}, {ref0, ref1}, __LINE__, __FILE__);
+  }
+}
+
+TEST_F(NVFuserTest, FusionPackedDropoutMask_CUDA) {
+  std::unique_ptr<Fusion> fusion_ptr = std::make_unique<Fusion>();
+  auto fusion = fusion_ptr.get();
+  FusionGuard fg(fusion);
+
+  auto x = makeSymbolicTensor(2);
+  auto dy = makeSymbolicTensor(2);
+  fusion->addInput(x);
+  fusion->addInput(dy);
+
+  auto prob = IrBuilder::create<Double>(0.9);
+  auto scale = IrBuilder::create<Double>(1.0 / 0.9);
+  auto result = dropout(x, prob, scale);
+  auto packed_mask = pack_mask(result.mask);
+  auto dx = dropout_backward(dy, packed_mask, scale);
+  fusion->addOutput(result.output);
+  fusion->addOutput(result.mask);
+  fusion->addOutput(packed_mask);
+  fusion->addOutput(dx);
+
+  FusionExecutorCache fec(std::move(fusion_ptr));
+
+  auto options = at::TensorOptions().dtype(kFloat).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({129, 1024}, options);
+  at::Tensor t1 = at::randn({129, 1024}, options);
+  auto cg_outputs = fec.runFusionWithInputs({t0, t1});
+
+  auto mask = cg_outputs[1];
+  auto packed = cg_outputs[2];
+  TORCH_CHECK(packed.scalar_type() == at::kInt);
+  TORCH_CHECK(packed.sizes() == at::IntArrayRef({129, 1024 / 32}));
+
+  auto bits = at::arange(32, options.dtype(at::kLong));
+  auto ref_packed = at::bitwise_left_shift(
+                        mask.view({129, 1024 / 32, 32}).to(at::kLong), bits)
+                        .sum(-1)
+                        .to(at::kInt);
+  auto ref_dx = t1 * mask * (1.0 / 0.9);
+
+  TORCH_CHECK(packed.equal(ref_packed));
+  TORCH_CHECK(cg_outputs[3].allclose(ref_dx));
+
+  // Packing sums the bits of each word, so the dropout fusion is no longer
+  //  scheduled as pointwise only, see Note [Packed Masks]
+  const auto& heuristics = fec.getMostRecentKernelRuntime()
+                               ->schedulerHeuristics()
+                               ->heuristicsList();
+  TORCH_CHECK(std::any_of(
+      heuristics.begin(), heuristics.end(), [](const auto& heuristic) {
+        return heuristic->heuristic() != ScheduleHeuristic::PointWise;
+      }));
+}
+
+TEST_F(NVFuserTest, FusionPackedDropoutMaskNonDivisible_CUDA) {
+  {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto mask = makeConcreteTensor({4, 48}, DataType::Bool);
+    fusion.addInput(mask);
+    ASSERT_ANY_THROW(pack_mask(mask));
+  }
+
+  std::unique_ptr<Fusion> fusion_ptr = std::make_unique<Fusion>();
+  auto fusion = fusion_ptr.get();
+  FusionGuard fg(fusion);
+
+  auto mask = makeSymbolicTensor(2, DataType::Bool);
+  fusion->addInput(mask);
+  fusion->addOutput(pack_mask(mask));
+
+  FusionExecutorCache fec(std::move(fusion_ptr));
+
+  auto options = at::TensorOptions().dtype(at::kBool).device(at::kCUDA, 0);
+  at::Tensor t0 = at::randn({4, 64}, options.dtype(kFloat)) > 0;
+  auto cg_outputs = fec.runFusionWithInputs({t0});
+  TORCH_CHECK(cg_outputs[0].sizes() == at::IntArrayRef({4, 2}));
+
+  // 48 isn't a multiple of 32, which is only known at run time
+  at::Tensor t1 = at::randn({4, 48}, options.dtype(kFloat)) > 0;
+  ASSERT_ANY_THROW(fec.runFusionWithInputs({t1}));
+}
+
 TEST_F(NVFuserTest, FusionBroadcastingRNG_CUDA) {
   for (auto dtype : {kFloat, kDouble}) {
     std::unique_ptr<Fusion> fusion_ptr = std::make_unique<Fusion>();
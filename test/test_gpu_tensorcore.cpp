@@ -2857,6 +2857,198 @@ TEST_F(NVFuserTest, FusionTuringMatmulLargeLoad_CUDA) {
   }
 }
 
+// Matmul scheduled by the Matmul heuristic, with a prologue cast and a
+//  bias, gelu, residual add and cast epilogue fused into the kernel
+TEST_F(NVFuserTest, FusionMatmulSchedulerEpilogue_CUDA) {
+  NVFUSER_TEST_CUDA_ARCH_GUARD(7, 0);
+
+  // Keep multiples of 8 to keep vectorizable.
+  int M = 504, N = 136, K = 248;
+
+  for (auto layout : kAllSupportedLayout) {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2, DataType::Half);
+    auto tv1 = makeContigTensor(2, DataType::Float);
+    auto bias = makeContigTensor(1, DataType::Float);
+    auto residual = makeContigTensor(2, DataType::Half);
+
+    fusion->addInput(tv0);
+    fusion->addInput(tv1);
+    fusion->addInput(bias);
+    fusion->addInput(residual);
+
+    auto tv2 = matmul(tv0, castOp(DataType::Half, tv1), layout);
+    auto tv3 = add(tv2, broadcast(bias, {true, false}));
+    auto tv4 = tanh_gelu(tv3);
+    auto tv5 = add(tv4, residual);
+    auto tv6 = castOp(DataType::Half, tv5);
+
+    fusion->addOutput(tv6);
+
+    at::manual_seed(0);
+    auto inputs = fp16MatmulAtInput(M, N, K, layout);
+    auto options = at::TensorOptions().dtype(at::kHalf).device(at::kCUDA, 0);
+    auto t1 = inputs.second.to(at::kFloat);
+    auto t_bias = at::randn({N}, options.dtype(at::kFloat));
+    auto t_residual = at::randn({M, N}, options);
+
+    FusionExecutorCache fec(std::move(fusion));
+    auto cg_outputs =
+        fec.runFusionWithInputs({inputs.first, t1, t_bias, t_residual});
+
+    auto runtime = fec.getMostRecentKernelRuntime();
+    TORCH_CHECK(!runtime->isSegmented(), "epilogue was segmented");
+    TORCH_CHECK(
+        runtime->schedulerHeuristics()->heuristicsList().front()->heuristic() ==
+            ScheduleHeuristic::Matmul,
+        "expected matmul heuristic");
+
+    auto t2 = atMatmul(inputs.first.to(at::kFloat), t1, layout);
+    auto t3 = t2 + t_bias;
+    auto t4 = at::gelu(t3, "tanh");
+    auto tref = (t4 + t_residual.to(at::kFloat)).to(at::kHalf);
+    TORCH_CHECK(cg_outputs[0].allclose(tref, 0.01, 0.01));
+  }
+}
+
+// The Matmul heuristic only takes fusions with Half mma operands.
+//  fusedMultiplySum only takes Half operands, so the mma is created directly.
+TEST_F(NVFuserTest, FusionMatmulSchedulerOperandDtype_CUDA) {
+  auto reject_reason = [](DataType input_dtype, DataType operand_dtype) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2, input_dtype);
+    auto tv1 = makeContigTensor(2, input_dtype);
+    fusion.addInput(tv0);
+    fusion.addInput(tv1);
+
+    // TT layout, [M, K, N] with K reduced
+    auto tv0b = broadcast(castOp(operand_dtype, tv0), {false, false, true});
+    auto tv1b = broadcast(castOp(operand_dtype, tv1), {true, false, false});
+    std::vector<IterDomain*> domain;
+    for (auto i : c10::irange(3)) {
+      auto id = tv0b->axis(i)->isBroadcast() ? tv1b->axis(i) : tv0b->axis(i);
+      domain.push_back(
+          IterDomainBuilder(id->start(), id->extent())
+              .iter_type(i == 1 ? IterType::Reduction : IterType::Iteration)
+              .build());
+    }
+    auto tv2 = IrBuilder::create<TensorView>(
+        IrBuilder::create<TensorDomain>(domain, std::vector<bool>(3, true)),
+        DataType::Float);
+    IrBuilder::create<MmaOp>(tv2, tv0b, tv1b, IrBuilder::create<Double>(0));
+    fusion.addOutput(tv2);
+    return getMatmulCompileTimeRejectReason(&fusion);
+  };
+
+  TORCH_CHECK(reject_reason(DataType::Float, DataType::Half).empty());
+  TORCH_CHECK(!reject_reason(DataType::Float, DataType::BFloat16).empty());
+  TORCH_CHECK(!reject_reason(DataType::Half, DataType::Float).empty());
+}
+
+// Matmul test for Ampere MMA: with K split across CTAs
+TEST_F(NVFuserTest, FusionAmpereMatmulSplitK_CUDA) {
+  // Keep multiples of 8 to keep vectorizable.
+  int M = 136, N = 248, K = 4096;
+
+  for (auto layout : kAllSupportedLayout) {
+    Fusion fusion;
+    FusionGuard fg(&fusion);
+    auto tv0 = makeContigTensor(2, DataType::Half);
+    auto tv1 = makeContigTensor(2, DataType::Half);
+
+    fusion.addInput(tv0);
+    fusion.addInput(tv1);
+
+    auto tv2 = matmul(tv0, tv1, layout);
+
+    fusion.addOutput(tv2);
+
+    MatMulTileOptions gemm_tile;
+    gemm_tile.cta_tile = GemmTile(64, 64, 32);
+    gemm_tile.warp_tile = GemmTile(32, 32, 32);
+    gemm_tile.instruction_tile = GemmTile(16, 8, 16);
+
+    auto mma_builder =
+        MmaBuilder(MmaOptions::MacroType::Ampere_16_8_16, gemm_tile)
+            .layout(layout);
+
+    MatmulParam params(mma_builder);
+    params.tile_sizes = gemm_tile;
+    params.async_gmem_load_operands = true;
+    params.double_buffer_options.double_buffer_smem_write = true;
+    params.double_buffer_options.smem_double_buffer_stage = 3;
+    params.split_k_factor = 4;
+    scheduleMatmul(tv2, tv0, tv1, params);
+
+    at::manual_seed(0);
+    auto inputs = fp16MatmulAtInput(M, N, K, layout);
+
+    FusionExecutor fe;
+    NVFUSER_TEST_CUDA_ARCH_COMPILE_CHECK(
+        8, 0, fe.compileFusion(&fusion, {inputs.first, inputs.second}));
+    auto cg_outputs = fe.runFusion({inputs.first, inputs.second});
+    TORCH_CHECK(fe.kernel()->summary().has_grid_reductions);
+    auto tref = atMatmul(
+        inputs.first.to(at::kFloat), inputs.second.to(at::kFloat), layout);
+    TORCH_CHECK(cg_outputs[0].allclose(tref, 0.001, 0.001));
+  }
+}
+
+// Small M and N with a large K should be split across CTAs by the Matmul
+//  heuristic, see Note [Matmul Split-K]
+TEST_F(NVFuserTest, FusionMatmulSchedulerSplitK_CUDA) {
+  NVFUSER_TEST_CUDA_ARCH_GUARD(7, 0);
+
+  // Keep multiples of 8 to keep vectorizable.
+  int M = 16, N = 128, K = 8192;
+
+  for (auto layout : kAllSupportedLayout) {
+    auto fusion = std::make_unique<Fusion>();
+    FusionGuard fg(fusion.get());
+    auto tv0 = makeContigTensor(2, DataType::Half);
+    auto tv1 = makeContigTensor(2, DataType::Half);
+    auto bias = makeContigTensor(1, DataType::Float);
+
+    fusion->addInput(tv0);
+    fusion->addInput(tv1);
+    fusion->addInput(bias);
+
+    auto tv2 = matmul(tv0, tv1, layout);
+    auto tv3 = add(tv2, broadcast(bias, {true, false}));
+    auto tv4 = castOp(DataType::Half, tv3);
+
+    fusion->addOutput(tv4);
+
+    at::manual_seed(0);
+    auto inputs = fp16MatmulAtInput(M, N, K, layout);
+    auto options = at::TensorOptions().dtype(at::kFloat).device(at::kCUDA, 0);
+    auto t_bias = at::randn({N}, options);
+
+    FusionExecutorCache fec(std::move(fusion));
+    auto cg_outputs =
+        fec.runFusionWithInputs({inputs.first, inputs.second, t_bias});
+
+    auto runtime = fec.getMostRecentKernelRuntime();
+    TORCH_CHECK(!runtime->isSegmented(), "epilogue was segmented");
+    auto heuristic = runtime->schedulerHeuristics()->heuristicsList().front();
+    TORCH_CHECK(
+        heuristic->heuristic() == ScheduleHeuristic::Matmul,
+        "expected matmul heuristic");
+    TORCH_CHECK(
+        heuristic->matmulParams().split_k_factor > 1, "expected split-K");
+
+    auto tref = (atMatmul(
+                     inputs.first.to(at::kFloat),
+                     inputs.second.to(at::kFloat),
+                     layout) +
+                 t_bias)
+                    .to(at::kHalf);
+    TORCH_CHECK(cg_outputs[0].allclose(tref, 0.01, 0.01));
+  }
+}
+
 #undef NVFUSER_TEST_CUDA_ARCH_GUARD
 
 } // namespace jit
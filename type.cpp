@@ -656,6 +656,8 @@ static const char* rng_op_type_inline_op2string(RNGOpType t) {
   switch (t) {
     case RNGOpType::Uniform:
       return "rng_uniform";
+    case RNGOpType::Normal:
+      return "rng_normal";
     default:
       break;
   }
@@ -694,6 +696,8 @@ static const char* rng_op_type2string(RNGOpType t) {
   switch (t) {
     case RNGOpType::Uniform:
       return "rng_uniform";
+    case RNGOpType::Normal:
+      return "rng_normal";
     default:
       TORCH_INTERNAL_ASSERT(false, "Unexpected RNGOpType");
   }
@@ -245,6 +245,7 @@ enum class BinaryOpType {
 
 enum class RNGOpType {
   Uniform,
+  Normal,
 };
 
 // Return if output of operator should be a boolean
@@ -43,7 +43,10 @@ auto parseDebugDumpOptions() {
       {DebugDumpOption::TransformPropagator, false},
       {DebugDumpOption::InlinePropagator, false},
       {DebugDumpOption::Cubin, false},
-      {DebugDumpOption::Ptx, false}};
+      {DebugDumpOption::Ptx, false},
+      {DebugDumpOption::AnalysisCacheStats, false},
+      {DebugDumpOption::HeuristicCacheStats, false},
+      {DebugDumpOption::KernelRegistryStats, false}};
 
   if (const char* dump_options = std::getenv("PYTORCH_NVFUSER_DUMP")) {
     c10::string_view options_view(dump_options);
@@ -106,6 +109,12 @@ auto parseDebugDumpOptions() {
         options_map[DebugDumpOption::Cubin] = true;
       } else if (token == "ptx") {
         options_map[DebugDumpOption::Ptx] = true;
+      } else if (token == "analysis_cache_stats") {
+        options_map[DebugDumpOption::AnalysisCacheStats] = true;
+      } else if (token == "heuristic_cache_stats") {
+        options_map[DebugDumpOption::HeuristicCacheStats] = true;
+      } else if (token == "kernel_registry_stats") {
+        options_map[DebugDumpOption::KernelRegistryStats] = true;
       } else {
         TORCH_CHECK(
             false,
@@ -118,7 +127,9 @@ auto parseDebugDumpOptions() {
             "\tdraw_segmented_fusion, scheduler_params, parallel_dimensions,\n",
             "\tbuffer_reuse_verbose, ptxas_verbose, halo, segmenter_logging,\n",
             "\tperf_debug_verbose, python_definition, python_frontend_debug,\n",
-            "\ttransform_propagator, inline_propagator, cubin, ptx\n");
+            "\ttransform_propagator, inline_propagator, cubin, ptx,\n",
+            "\tanalysis_cache_stats, heuristic_cache_stats,\n",
+            "\tkernel_registry_stats\n");
       }
       options_view = (end_pos != c10::string_view::npos)
           ? options_view.substr(end_pos + 1)
@@ -136,7 +147,13 @@ auto parseDisableOptions() {
       {DisableOption::Fma, false},
       {DisableOption::IndexHoist, false},
       {DisableOption::Nvtx, false},
-      {DisableOption::PredicateElimination, false}};
+      {DisableOption::PredicateElimination, false},
+      {DisableOption::HeuristicCache, false},
+      {DisableOption::KernelRegistry, false},
+      {DisableOption::SmemPersistence, false},
+      {DisableOption::CircularBufferLoads, false},
+      {DisableOption::GridPersistence, false},
+      {DisableOption::ChunkedWelford, false}};
 
   if (const char* dump_options = std::getenv("PYTORCH_NVFUSER_DISABLE")) {
     c10::string_view options_view(dump_options);
@@ -157,13 +174,27 @@ auto parseDisableOptions() {
         options_map[DisableOption::Nvtx] = true;
       } else if (token == "predicate_elimination") {
         options_map[DisableOption::PredicateElimination] = true;
+      } else if (token == "heuristic_cache") {
+        options_map[DisableOption::HeuristicCache] = true;
+      } else if (token == "kernel_registry") {
+        options_map[DisableOption::KernelRegistry] = true;
+      } else if (token == "smem_persistence") {
+        options_map[DisableOption::SmemPersistence] = true;
+      } else if (token == "circular_buffer_loads") {
+        options_map[DisableOption::CircularBufferLoads] = true;
+      } else if (token == "grid_persistence") {
+        options_map[DisableOption::GridPersistence] = true;
+      } else if (token == "chunked_welford") {
+        options_map[DisableOption::ChunkedWelford] = true;
       } else {
         TORCH_CHECK(
             false,
             "Invalid disable option: '",
             token,
             "'\nAvailable options:\n",
-            "\tarch_check, fallback, fma, index_hoist, nvtx, predicate_elimination\n");
+            "\tarch_check, fallback, fma, index_hoist, nvtx, predicate_elimination,\n",
+            "\theuristic_cache, kernel_registry, smem_persistence,\n",
+            "\tcircular_buffer_loads, grid_persistence, chunked_welford\n");
       }
       options_view = (end_pos != c10::string_view::npos)
           ? options_view.substr(end_pos + 1)
@@ -180,7 +211,9 @@ auto parseEnableOptions() {
       {EnableOption::KernelProfile, false},
       {EnableOption::LinearDecomposition, false},
       {EnableOption::ConvDecomposition, false},
-      {EnableOption::TransposeScheduler, false}};
+      {EnableOption::TransposeScheduler, false},
+      {EnableOption::ParallelSegmenter, false},
+      {EnableOption::HorizontalFusion, false}};
 
   if (const char* dump_options = std::getenv("PYTORCH_NVFUSER_ENABLE")) {
     c10::string_view options_view(dump_options);
@@ -197,6 +230,10 @@ auto parseEnableOptions() {
         options_map[EnableOption::ConvDecomposition] = true;
       } else if (token == "transpose_scheduler") {
         options_map[EnableOption::TransposeScheduler] = true;
+      } else if (token == "parallel_segmenter") {
+        options_map[EnableOption::ParallelSegmenter] = true;
+      } else if (token == "horizontal_fusion") {
+        options_map[EnableOption::HorizontalFusion] = true;
       } else {
         TORCH_CHECK(
             false,
@@ -204,7 +241,8 @@ auto parseEnableOptions() {
             token,
             "'\nAvailable options:\n",
             "\tcomplex, kernel_profile, linear_decomposition,",
-            "conv_decomposition, transpose_scheduler");
+            "conv_decomposition, transpose_scheduler, parallel_segmenter,",
+            " horizontal_fusion");
       }
       options_view = (end_pos != c10::string_view::npos)
           ? options_view.substr(end_pos + 1)
@@ -375,9 +413,27 @@ bool isOptionDisabled(DisableOption option) {
   return options.at(option);
 }
 
+namespace {
+
+// Enable options parsed on first use, overridden by EnableOptionGuard
+std::unordered_map<EnableOption, bool>& enableOptions() {
+  static auto options = parseEnableOptions();
+  return options;
+}
+
+} // namespace
+
 bool isOptionEnabled(EnableOption option) {
-  const static auto options = parseEnableOptions();
-  return options.at(option);
+  return enableOptions().at(option);
+}
+
+EnableOptionGuard::EnableOptionGuard(EnableOption option, bool enabled)
+    : option_(option), prev_enabled_(isOptionEnabled(option)) {
+  enableOptions().at(option_) = enabled;
+}
+
+EnableOptionGuard::~EnableOptionGuard() {
+  enableOptions().at(option_) = prev_enabled_;
 }
 
 bool useFallback() {
@@ -60,7 +60,13 @@ enum class DebugDumpOption {
   InlinePropagator, //! When running InlinePropagator, print propagation
                     //! path and inlining result
   Cubin, //! Dump compiled CUBIN
-  Ptx //! Dump compiled PTX
+  Ptx, //! Dump compiled PTX
+  AnalysisCacheStats, //! Dump hit counts of the fusion analysis cache after
+                      //! segmentation
+  HeuristicCacheStats, //! Dump hit counts of the process-wide heuristic
+                       //! params cache when a kernel runtime is created
+  KernelRegistryStats //! Dump hit counts of the process-wide compiled
+                      //! kernel registry when a kernel is compiled
 };
 
 TORCH_CUDA_CU_API bool isDebugDumpEnabled(DebugDumpOption option);
@@ -75,7 +81,17 @@ enum class DisableOption {
   Fma, //! Disable FMA instructions
   IndexHoist, //! Disable index hoisting
   Nvtx, //! Disable NVTX instrumentation
-  PredicateElimination //! Disable predicate elimination
+  PredicateElimination, //! Disable predicate elimination
+  HeuristicCache, //! Disable sharing heuristic params across fusions
+  KernelRegistry, //! Disable sharing compiled kernels across executors
+  SmemPersistence, //! Disable shared memory persistent buffers in persistent
+                   //! kernels
+  CircularBufferLoads, //! Disable circular buffering input loads in
+                       //! reduction and pointwise kernels
+  GridPersistence, //! Disable splitting outer persistent normalizations
+                   //! across a cooperative grid
+  ChunkedWelford //! Disable merging unrolled chunks of serial welfords at
+                 //! once
 };
 
 TORCH_CUDA_CU_API bool isOptionDisabled(DisableOption option);
@@ -89,11 +105,29 @@ enum class EnableOption {
   KernelProfile, //! Enable intra-kernel performance profiling
   LinearDecomposition, //! Enable linear-bias decomposition
   ConvDecomposition, //! Enable conv-bias decomposition
-  TransposeScheduler //! Enable the experimental transpose scheduler
+  TransposeScheduler, //! Enable the experimental transpose scheduler
+  ParallelSegmenter, //! Probe segment merges on a thread pool
+  HorizontalFusion //! Pack independent segments into one kernel
 };
 
 TORCH_CUDA_CU_API bool isOptionEnabled(EnableOption option);
 
+//! Overrides an enable option while in scope, e.g. in tests, since
+//! `PYTORCH_NVFUSER_ENABLE` is only read once. Not meant to be used while
+//! other threads query the option.
+class TORCH_CUDA_CU_API EnableOptionGuard {
+ public:
+  EnableOptionGuard(EnableOption option, bool enabled);
+  ~EnableOptionGuard();
+
+  EnableOptionGuard(const EnableOptionGuard&) = delete;
+  EnableOptionGuard& operator=(const EnableOptionGuard&) = delete;
+
+ private:
+  EnableOption option_;
+  bool prev_enabled_;
+};
+
 // Check if fallback path should be used which will dispatch to eagermode if any
 // errors are encountered. Helpful for debugging.
 bool useFallback();